@@ -28,6 +28,7 @@ endif
 endif # ($(BOARD), AT91SAM9G20_EK)
 
 CSRC += $(wildcard $(CURRENTPATH)/utility/CRC.c)
+CSRC += $(wildcard $(CURRENTPATH)/utility/fused_copy.c)
 CSRC += $(wildcard $(CURRENTPATH)/config/faultHandler.c)
 
 ifndef IOBC
@@ -4,6 +4,8 @@
 #include <fatfs_config.h>
 
 #include <bsp_sam9g20/common/fram/CommonFRAM.h>
+#include <bsp_sam9g20/common/imageCompression.h>
+#include <bootloader/utility/CRC.h>
 
 #include <hcc/api_hcc_mem.h>
 #include <at91/memories/sdmmc/MEDSdcard.h>
@@ -31,7 +33,14 @@ extern int handle_hamming_code_check(SlotType slotType, size_t image_size);
 int handle_hamming_code_result(int result);
 
 #if USE_TINY_FS == 0
-int copy_with_hcc_lib(BootSelect boot_select, size_t* image_size);
+int copy_with_hcc_lib(BootSelect boot_select, size_t* image_size, bool* compressed);
+static int decompress_to_sdram(F_FILE* file, const ImageCompressionHeader* header,
+        size_t file_length);
+
+//! Size of the chunks which are read from the SD card for compressed images
+#define DECOMPRESSION_READ_SIZE     16384
+static uint8_t decompression_read_buffer[DECOMPRESSION_READ_SIZE];
+static ImageDecompressor decompressor;
 #else
 int copy_with_tinyfatfs_lib(BootSelect boot_select);
 #endif
@@ -43,12 +52,22 @@ int copy_sdcard_binary_to_sdram(BootSelect boot_select, bool use_hamming) {
     }
 #if USE_TINY_FS == 0
     size_t image_size = 0;
-    int result = copy_with_hcc_lib(boot_select, &image_size);
+    bool compressed = false;
+    int result = copy_with_hcc_lib(boot_select, &image_size, &compressed);
     if(result != 0) {
         /* Copy operation failed, we can not jump */
         return result;
     }
 
+    if(compressed) {
+        /* The hamming code belongs to the compressed file. The decompressed image was
+        already verified with its CRC16 instead */
+        if(use_hamming) {
+            set_sram0_status_field(SRAM_OK);
+        }
+        return result;
+    }
+
     if(!use_hamming) {
         return result;
     }
@@ -74,7 +93,7 @@ int copy_sdcard_binary_to_sdram(BootSelect boot_select, bool use_hamming) {
 
 
 #if USE_TINY_FS == 0
-int copy_with_hcc_lib(BootSelect boot_select, size_t* image_size) {
+int copy_with_hcc_lib(BootSelect boot_select, size_t* image_size, bool* compressed) {
     VolumeId current_volume = SD_CARD_0;
     if (boot_select == BOOT_SD_CARD_1_SLOT_1 || boot_select == BOOT_SD_CARD_1_SLOT_0) {
         current_volume = SD_CARD_1;
@@ -142,6 +161,35 @@ int copy_with_hcc_lib(BootSelect boot_select, size_t* image_size) {
         *image_size = filelength;
     }
 
+    /* Compressed images are recognized by their header */
+    if(filelength >= IMAGE_COMPRESSION_HEADER_SIZE) {
+        if(f_read(decompression_read_buffer, 1, IMAGE_COMPRESSION_HEADER_SIZE, file) !=
+                IMAGE_COMPRESSION_HEADER_SIZE) {
+            f_close(file);
+            close_filesystem(true, true, current_volume);
+            return -1;
+        }
+        ImageCompressionHeader header;
+        if(image_compression_read_header(decompression_read_buffer,
+                IMAGE_COMPRESSION_HEADER_SIZE, &header) == IMAGE_COMPRESSION_OK) {
+#if BOOTLOADER_VERBOSE_LEVEL >= 1
+            TRACE_INFO("Decompressing image \"%s\" from SD card %u to SDRAM\n\r", slot_name,
+                    (unsigned int) current_volume);
+#endif
+            result = decompress_to_sdram(file, &header, filelength);
+            if(compressed != NULL) {
+                *compressed = true;
+            }
+            if(image_size != NULL) {
+                *image_size = header.image_size;
+            }
+            f_close(file);
+            close_filesystem(true, true, current_volume);
+            return result;
+        }
+        f_seek(file, 0, F_SEEK_SET);
+    }
+
 #if BOOTLOADER_VERBOSE_LEVEL >= 1
     TRACE_INFO("Copying image \"%s\" from SD card %u to SDRAM\n\r", slot_name,
             (unsigned int) current_volume);
@@ -159,6 +207,60 @@ int copy_with_hcc_lib(BootSelect boot_select, size_t* image_size) {
     return 0;
 }
 
+static int decompress_to_sdram(F_FILE* file, const ImageCompressionHeader* header,
+        size_t file_length) {
+    if(header->compressed_size != file_length - IMAGE_COMPRESSION_HEADER_SIZE ||
+            header->image_size == 0 || header->image_size > SDRAM_IMAGE_RESERVED_SIZE) {
+#if BOOTLOADER_VERBOSE_LEVEL >= 1
+        TRACE_ERROR("Compressed image header invalid\n\r");
+#endif
+        return -1;
+    }
+
+    image_decompressor_init(&decompressor);
+    uint8_t* output = (uint8_t*) SDRAM_DESTINATION;
+    size_t output_size = header->image_size;
+    size_t remaining_size = header->compressed_size;
+    uint16_t crc = 0xffff;
+    while(remaining_size > 0) {
+        size_t chunk_size = remaining_size;
+        if(chunk_size > DECOMPRESSION_READ_SIZE) {
+            chunk_size = DECOMPRESSION_READ_SIZE;
+        }
+        if(f_read(decompression_read_buffer, 1, chunk_size, file) != (long) chunk_size) {
+            return -1;
+        }
+        remaining_size -= chunk_size;
+
+        /* The CRC is calculated for each decompressed chunk while it is still cached */
+        const uint8_t* input = decompression_read_buffer;
+        uint8_t* chunk_output = output;
+        int result = image_decompress(&decompressor, &input, &chunk_size, &output,
+                &output_size);
+        crc = crc16ccitt(chunk_output, output - chunk_output, crc);
+        if(result != IMAGE_COMPRESSION_OK || chunk_size > 0) {
+            /* Corrupted data or more data than the image size in the header */
+#if BOOTLOADER_VERBOSE_LEVEL >= 1
+            TRACE_ERROR("Compressed image corrupted\n\r");
+#endif
+            return -1;
+        }
+    }
+
+    if(output_size > 0 || !image_decompressor_finished(&decompressor) ||
+            crc != header->image_crc) {
+#if BOOTLOADER_VERBOSE_LEVEL >= 1
+        TRACE_ERROR("Decompressed image invalid, CRC16 0x%04x, expected 0x%04x\n\r",
+                (unsigned int) crc, (unsigned int) header->image_crc);
+#endif
+        return -1;
+    }
+#if BOOTLOADER_VERBOSE_LEVEL >= 1
+    TRACE_INFO("Decompressed %lu bytes to SDRAM\n\r", (unsigned long) header->image_size);
+#endif
+    return 0;
+}
+
 #else
 
 // Unfortunately, the tiny FATFS library is not working yet. There are issues reading
@@ -6,6 +6,7 @@
 #include <bsp_sam9g20/common/SRAMApi.h>
 #include <bsp_sam9g20/common/At91SpiDriver.h>
 #include <bootloader/core/timer.h>
+#include <bootloader/utility/fused_copy.h>
 
 #ifdef ISIS_OBC_G20
 #include <bsp_sam9g20/common/fram/FRAMApiNoOs.h>
@@ -79,6 +80,66 @@ int handle_hamming_code_check(SlotType slotType, size_t image_size, size_t ham_c
     return result;
 }
 
+/**
+ * Copies the image to the SDRAM and performs the hamming code check in a single pass.
+ * Used instead of a regular copy operation followed by #handle_hamming_code_check, which
+ * requires a second pass over the whole image in the SDRAM.
+ * @param source        Start of the image
+ * @param copied_size   The first part of the image might already have been copied without
+ *                      verification, for example while waiting for the hamming code.
+ *                      This part is verified in the SDRAM. Needs to be a multiple of 256.
+ * @param hook          Called periodically during the copy operation, may be NULL
+ * @return
+ * Same as #handle_hamming_code_check. The image was copied completely unless a multibit error
+ * was detected.
+ */
+int handle_hamming_code_copy_and_check(SlotType slotType, const uint8_t* source,
+        size_t image_size, size_t ham_code_size, size_t copied_size, fused_copy_hook_t hook) {
+    int result = -1;
+    if(slotType != BOOTLOADER_0) {
+        result = read_hamming_code(slotType, ham_code_size);
+    }
+    /* The last block is always handled by the fused copy operation because it might need to
+    be padded */
+    size_t full_blocks_size = image_size - image_size % FUSED_COPY_HAMMING_BLOCK_SIZE;
+    if(copied_size > full_blocks_size) {
+        copied_size = full_blocks_size;
+    }
+    if(result != 0) {
+        /* Still copy the image so we can jump to it */
+        fused_copy_in_chunks((uint8_t*) SDRAM_DESTINATION + copied_size, source + copied_size,
+                image_size - copied_size, hook);
+        if(image_size % FUSED_COPY_HAMMING_BLOCK_SIZE != 0) {
+            memset((void*) SDRAM_DESTINATION + image_size, 0,
+                    FUSED_COPY_HAMMING_BLOCK_SIZE - image_size % FUSED_COPY_HAMMING_BLOCK_SIZE);
+        }
+        return result;
+    }
+
+#if BOOTLOADER_VERBOSE_LEVEL >= 1
+    TRACE_INFO("Copying and verifying %d bytes with %d hamming code bytes\n\r", image_size,
+            ham_code_size);
+#endif
+    int prefix_result = 0;
+    if(copied_size > 0) {
+        /* Verified in place */
+        prefix_result = fused_copy_hamming_verify((uint8_t*) SDRAM_DESTINATION,
+                (const uint8_t*) SDRAM_DESTINATION, copied_size, hamming_code_buf, hook);
+        if(prefix_result == Hamming_ERROR_MULTIPLEBITS) {
+            return prefix_result;
+        }
+    }
+    size_t ham_code_offset = copied_size / FUSED_COPY_HAMMING_BLOCK_SIZE *
+            FUSED_COPY_HAMMING_CODE_BYTES_PER_BLOCK;
+    result = fused_copy_hamming_verify((uint8_t*) SDRAM_DESTINATION + copied_size,
+            source + copied_size, image_size - copied_size, hamming_code_buf + ham_code_offset,
+            hook);
+    if(prefix_result > result) {
+        result = prefix_result;
+    }
+    return result;
+}
+
 int read_hamming_code(SlotType slotType, size_t ham_code_size) {
     int result = 0;
 #ifdef ISIS_OBC_G20
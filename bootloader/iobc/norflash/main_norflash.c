@@ -4,6 +4,7 @@
 #include <commonIOBCConfig.h>
 
 #include <bootloader/utility/CRC.h>
+#include <bootloader/utility/fused_copy.h>
 #include <bsp_sam9g20/common/lowlevel.h>
 #include <bootloader/core/timer.h>
 #include <bsp_sam9g20/common/SRAMApi.h>
@@ -62,6 +63,9 @@ extern void fram_callback(At91SpiBuses bus, At91TransferStates state, void* args
 #endif
 
 int increment_reboot_counter_no_os(SlotType slot_type, uint16_t* new_reboot_counter);
+#if BOOTLOADER_KICK_WATCHDOG_IN_PIT_IRQ == 0
+void kick_watchdog_hook(void);
+#endif
 
 #endif /* USE_FREERTOS == 0 */
 
@@ -77,7 +81,8 @@ int copy_sdcard_binary_to_sdram(BootSelect boot_select, bool use_hamming);
 void handle_problematic_sdc_copy_result(BootSelect boot_select);
 int increment_sdc_loc_reboot_counter(BootSelect boot_select, uint16_t* curr_reboot_counter);
 void handle_problematic_norflash_copy_result();
-int handle_hamming_code_check(SlotType slotType, size_t image_size, size_t ham_code_size);
+int handle_hamming_code_copy_and_check(SlotType slotType, const uint8_t* source,
+        size_t image_size, size_t ham_code_size, size_t copied_size, fused_copy_hook_t hook);
 int handle_hamming_code_result(int result);
 
 #if BOOTLOADER_VERBOSE_LEVEL >= 1
@@ -249,7 +254,8 @@ int perform_iobc_copy_operation_to_sdram() {
 }
 
 /**
- * Handles the copy operation from NOR-Flash to SDRAM
+ * Handles the copy operation from NOR-Flash to SDRAM. If the hamming code check is enabled,
+ * the image is verified while it is copied, so only one pass over the image is required.
  * @param copy_size
  * @return
  *  - 0 on success (jump to SDRAM)
@@ -258,13 +264,21 @@ int perform_iobc_copy_operation_to_sdram() {
 int copy_norflash_binary_to_sdram(size_t copy_size, bool use_hamming)
 {
     int result = 0;
+    size_t image_size = 0;
+    size_t ham_code_size = 0;
+    fused_copy_hook_t copy_hook = NULL;
+#if USE_FREERTOS == 0 && BOOTLOADER_KICK_WATCHDOG_IN_PIT_IRQ == 0
+    /* The copy operations need to be split up to kick the watchdog. Watchdog window
+    is 1ms to 50ms */
+    copy_hook = kick_watchdog_hook;
+#endif
     // Initialize Nor
     //-------------------------------------------------------------------------
     // => the configuration was already done in LowLevelInit()
     // Transfert data from Nor to External RAM
     //-------------------------------------------------------------------------
 
-    /* For the OSless case, we try to read the hamming code in parallel to the memcpy operation */
+    /* For the OSless case, we try to read the hamming code in parallel to the copy operation */
 #if USE_FREERTOS == 0
 
 #if USE_FRAM_NON_INTERRUPT_DRV == 0
@@ -285,76 +299,98 @@ int copy_norflash_binary_to_sdram(size_t copy_size, bool use_hamming)
     #endif
             use_hamming = false;
         }
-
-#if USE_FRAM_NON_INTERRUPT_DRV == 0
-        /* Start DMA transfer in background to be run in parallel to the memcpy operation */
-        result = fram_no_os_read_ham_code(FLASH_SLOT, hamming_code_buf,
-                sizeof(hamming_code_buf), 0, ham_size);
-        if(result != 0) {
-            use_hamming = false;
-        }
-#endif
     }
 #endif /* USE_FREERTOS == 0 */
 
+    if(use_hamming) {
+        image_size = bl_fram_block.nor_flash_binary_size;
+        ham_code_size = bl_fram_block.nor_flash_hamming_code_size;
+        if (image_size == 0 || image_size == 0xffffffff || image_size > copy_size) {
 #if BOOTLOADER_VERBOSE_LEVEL >= 1
-    TRACE_INFO("Copying NOR-Flash binary to SDRAM..\n\r");
+            TRACE_WARNING("Flash image size %d invalid\n\r", image_size);
 #endif
-
-#if USE_FREERTOS == 1 || BOOTLOADER_KICK_WATCHDOG_IN_PIT_IRQ == 1
-    /* This operation takes 100-200 milliseconds if the whole NOR-Flash is
-    copied. But the watchdog is running in a separate task with the highest priority
-    and we are using a pre-emptive scheduler so this should not be an issue. */
-    memcpy((void*) SDRAM_DESTINATION, (const void*) BINARY_BASE_ADDRESS_READ, copy_size);
-#else
-    /* Now we need to split up the copy operation to kick the watchdog. Watchdog window
-    is 1ms to 50ms */
-    {
-        uint8_t bucket_num = 10;
-        size_t bucket_size = copy_size / bucket_num;
-        size_t bucket_rest = copy_size % bucket_num;
-        size_t offset = 0;
-        for(uint8_t idx = 0; idx < bucket_num; idx++) {
-            offset = idx * bucket_size;
-            memcpy((void*) SDRAM_DESTINATION + offset,
-                    (const void*) BINARY_BASE_ADDRESS_READ + offset, bucket_size);
-            WDT_forceKick();
+            /* Still jump to binary */
+            use_hamming = false;
+        }
+        else if(ham_code_size == 0 || ham_code_size == 0xffffffff ||
+                ham_code_size > IMAGES_HAMMING_RESERVED_SIZE) {
+#if BOOTLOADER_VERBOSE_LEVEL >= 1
+            TRACE_WARNING("Flash hamming code size %d invalid\n\r", ham_code_size);
+#endif
+            /* Still jump to binary */
+            use_hamming = false;
         }
-        offset = bucket_size * bucket_num;
-        memcpy((void*) SDRAM_DESTINATION + offset,
-                (const void*) BINARY_BASE_ADDRESS_READ + offset, bucket_rest);
     }
-#endif /* USE_FREERTOS == 0 */
 
-    /* Now we can perform the hamming code check on the image in the SDRAM */
+#if USE_FREERTOS == 0 && USE_FRAM_NON_INTERRUPT_DRV == 0
     if(use_hamming) {
-#if BOOTLOADER_VERBOSE_LEVEL >= 1
-        TRACE_INFO("Performing hamming code ECC check..\n\r");
+        /* Start DMA transfer in background to be run in parallel to the copy operation */
+        result = fram_no_os_read_ham_code(FLASH_SLOT, hamming_code_buf,
+                sizeof(hamming_code_buf), 0, ham_code_size);
+        if(result != 0) {
+            use_hamming = false;
+        }
+    }
 #endif
-        size_t image_size = bl_fram_block.nor_flash_binary_size;
-        size_t ham_code_size = bl_fram_block.nor_flash_hamming_code_size;
-        if (image_size == 0 || image_size == 0xffffffff) {
+
 #if BOOTLOADER_VERBOSE_LEVEL >= 1
-            TRACE_WARNING("Flash image size %d invalid\n\r", image_size);
-            /* Still jump to binary */
-            return 0;
+    TRACE_INFO("Copying NOR-Flash binary to SDRAM..\n\r");
 #endif
+
+    size_t copied_size = 0;
+    if(use_hamming) {
+#if USE_FREERTOS == 0 && USE_FRAM_NON_INTERRUPT_DRV == 0
+        /* Copy the image without verification until the hamming code has arrived. This part
+        will be verified in the SDRAM */
+        size_t full_blocks_size = image_size - image_size % FUSED_COPY_HAMMING_BLOCK_SIZE;
+        while(spi_transfer_state == IDLE && copied_size < full_blocks_size) {
+            size_t chunk_size = full_blocks_size - copied_size;
+            if(chunk_size > NORFLASH_SMALL_SECTOR_SIZE) {
+                chunk_size = NORFLASH_SMALL_SECTOR_SIZE;
+            }
+            fused_copy_in_chunks((uint8_t*) SDRAM_DESTINATION + copied_size,
+                    (const uint8_t*) BINARY_BASE_ADDRESS_READ + copied_size, chunk_size,
+                    NULL);
+            copied_size += chunk_size;
+            if(copy_hook != NULL && copied_size % FUSED_COPY_HOOK_INTERVAL == 0) {
+                copy_hook();
+            }
         }
-        else if(ham_code_size == 0 || ham_code_size == 0xffffffff) {
+#endif
 #if BOOTLOADER_VERBOSE_LEVEL >= 1
-            TRACE_WARNING("Flash hamming code size %d invalid\n\r", image_size);
-            /* Still jump to binary */
-            return 0;
+        TRACE_INFO("Performing hamming code ECC check..\n\r");
 #endif
+        int check_result = handle_hamming_code_copy_and_check(FLASH_SLOT,
+                (const uint8_t*) BINARY_BASE_ADDRESS_READ, image_size, ham_code_size,
+                copied_size, copy_hook);
+        result = handle_hamming_code_result(check_result);
+        if(result != 0) {
+            return result;
         }
-        else {
-            int check_result = handle_hamming_code_check(FLASH_SLOT, image_size, ham_code_size);
-            result = handle_hamming_code_result(check_result);
+        /* The padding of the last block was written to the SDRAM as well */
+        copied_size = image_size;
+        if(image_size % FUSED_COPY_HAMMING_BLOCK_SIZE != 0) {
+            copied_size += FUSED_COPY_HAMMING_BLOCK_SIZE -
+                    image_size % FUSED_COPY_HAMMING_BLOCK_SIZE;
         }
     }
+
+    /* Copy the rest of the reserved area. This operation takes 100-200 milliseconds if the
+    whole NOR-Flash is copied. */
+    if(copied_size < copy_size) {
+        fused_copy_in_chunks((uint8_t*) SDRAM_DESTINATION + copied_size,
+                (const uint8_t*) BINARY_BASE_ADDRESS_READ + copied_size, copy_size - copied_size,
+                copy_hook);
+    }
     return result;
 }
 
+#if USE_FREERTOS == 0 && BOOTLOADER_KICK_WATCHDOG_IN_PIT_IRQ == 0
+void kick_watchdog_hook(void) {
+    WDT_forceKick();
+}
+#endif
+
 #if USE_FREERTOS == 1
 
 void init_task(void * args) {
@@ -418,6 +454,19 @@ void perform_bootloader_check() {
 	variable at the end of SRAM0 to notify the primary software that the
 	bootloader is faulty. */
 
+    /* The check might be requested by the initialization and the core operation. The
+    bootloader does not change, so it is only performed once. */
+    static bool check_performed = false;
+    if(check_performed) {
+        return;
+    }
+    check_performed = true;
+
+    fused_copy_hook_t copy_hook = NULL;
+#if USE_FREERTOS == 0 && BOOTLOADER_KICK_WATCHDOG_IN_PIT_IRQ == 0
+    copy_hook = kick_watchdog_hook;
+#endif
+
     uint16_t written_crc16 = 0;
     size_t bootloader_size = 0;
     /* Bootloader size and CRC16 are written at the end of the reserved bootloader space. */
@@ -433,16 +482,25 @@ void perform_bootloader_check() {
     TRACE_INFO("Written CRC16: 0x%4x.\n\r", written_crc16);
 #endif /* BOOTLOADER_VERBOSE_LEVEL >= 1 */
 
-    if(written_crc16 != 0x00 || written_crc16 != 0xff) {
-        uint16_t calculated_crc = crc16ccitt_default_start_crc(
-                (const void *) BOOTLOADER_BASE_ADDRESS_READ, bootloader_size);
+    if(bootloader_size == 0 || bootloader_size > NORFLASH_BL_SIZE_START) {
+#if BOOTLOADER_VERBOSE_LEVEL >= 1
+        TRACE_WARNING("Bootloader size field is invalid!\n\r");
+#endif /* BOOTLOADER_VERBOSE_LEVEL >= 1 */
+    }
+    else if(written_crc16 != 0x0000 && written_crc16 != 0xffff) {
+        /* Word accesses to the NOR-Flash are used for the calculation */
+        uint16_t calculated_crc = fused_copy_crc16(NULL,
+                (const uint8_t*) BOOTLOADER_BASE_ADDRESS_READ, bootloader_size, 0xffff,
+                copy_hook);
         if(written_crc16 != calculated_crc) {
-            memcpy((void*)SDRAM_DESTINATION, (const void*) BINARY_BASE_ADDRESS_READ,
-                    PRIMARY_IMAGE_RESERVED_SIZE);
 #if BOOTLOADER_VERBOSE_LEVEL >= 1
             TRACE_WARNING("Bootloader CRC check failed. Copying and jumping to "
                     "NOR-Flash image..\n\r");
 #endif
+            /* This is the only copy operation of the image for this boot */
+            fused_copy_in_chunks((uint8_t*) SDRAM_DESTINATION,
+                    (const uint8_t*) BINARY_BASE_ADDRESS_READ, PRIMARY_IMAGE_RESERVED_SIZE,
+                    copy_hook);
             set_sram0_status_field(SRAM_BOOTLOADER_INVALID);
 #if USE_FREERTOS == 1
             vTaskEndScheduler();
@@ -0,0 +1,213 @@
+#include "fused_copy.h"
+#include "CRC.h"
+
+#include <at91/utility/hamming.h>
+
+#include <string.h>
+
+/* Parity of each byte value, generated at compile time */
+#define FC_P2(n) n, n ^ 1, n ^ 1, n
+#define FC_P4(n) FC_P2(n), FC_P2(n ^ 1), FC_P2(n ^ 1), FC_P2(n)
+#define FC_P6(n) FC_P4(n), FC_P4(n ^ 1), FC_P4(n ^ 1), FC_P4(n)
+static const uint8_t BYTE_PARITY[256] = { FC_P6(0), FC_P6(1), FC_P6(1), FC_P6(0) };
+
+static void copy_block_and_compute_code(uint8_t* destination, const uint8_t* source,
+        uint8_t* code);
+static void build_code(uint8_t column_sum, uint8_t line_parity, uint8_t odd_line_code,
+        uint8_t* code);
+
+static inline uint16_t crc16_update(uint16_t crc, uint8_t byte) {
+    return crc16ccitt_table[((crc >> 8) ^ byte) & 0xff] ^ (uint16_t) (crc << 8);
+}
+
+void fused_copy_in_chunks(uint8_t* destination, const uint8_t* source, size_t size,
+        fused_copy_hook_t hook) {
+    while(size > 0) {
+        size_t chunk_size = size;
+        if(chunk_size > FUSED_COPY_HOOK_INTERVAL) {
+            chunk_size = FUSED_COPY_HOOK_INTERVAL;
+        }
+        memcpy(destination, source, chunk_size);
+        destination += chunk_size;
+        source += chunk_size;
+        size -= chunk_size;
+        if(hook != NULL) {
+            hook();
+        }
+    }
+}
+
+int fused_copy_hamming_verify(uint8_t* destination, const uint8_t* source, size_t image_size,
+        const uint8_t* hamming_code, fused_copy_hook_t hook) {
+    /* Only used for the last block if it needs to be padded */
+    uint8_t padded_block[FUSED_COPY_HAMMING_BLOCK_SIZE];
+    uint8_t computed_code[FUSED_COPY_HAMMING_CODE_BYTES_PER_BLOCK];
+    int result = 0;
+    size_t bytes_since_hook = 0;
+    while(image_size > 0) {
+        size_t block_size = FUSED_COPY_HAMMING_BLOCK_SIZE;
+        const uint8_t* block_source = source;
+        if(image_size < FUSED_COPY_HAMMING_BLOCK_SIZE) {
+            block_size = image_size;
+            memcpy(padded_block, source, block_size);
+            memset(padded_block + block_size, 0, FUSED_COPY_HAMMING_BLOCK_SIZE - block_size);
+            block_source = padded_block;
+        }
+
+        copy_block_and_compute_code(destination, block_source, computed_code);
+        if(memcmp(computed_code, hamming_code, FUSED_COPY_HAMMING_CODE_BYTES_PER_BLOCK) != 0) {
+            /* Rare case: Let the hamming library classify and correct the error in the
+            destination */
+            unsigned char block_result = Hamming_Verify256x(destination,
+                    FUSED_COPY_HAMMING_BLOCK_SIZE, hamming_code);
+            if(block_result == Hamming_ERROR_MULTIPLEBITS) {
+                /* The image can not be used anyway */
+                return Hamming_ERROR_MULTIPLEBITS;
+            }
+            if(block_result > result) {
+                result = block_result;
+            }
+        }
+
+        destination += FUSED_COPY_HAMMING_BLOCK_SIZE;
+        source += block_size;
+        hamming_code += FUSED_COPY_HAMMING_CODE_BYTES_PER_BLOCK;
+        image_size -= block_size;
+
+        bytes_since_hook += FUSED_COPY_HAMMING_BLOCK_SIZE;
+        if(bytes_since_hook >= FUSED_COPY_HOOK_INTERVAL) {
+            bytes_since_hook = 0;
+            if(hook != NULL) {
+                hook();
+            }
+        }
+    }
+    return result;
+}
+
+uint16_t fused_copy_crc16(uint8_t* destination, const uint8_t* source, size_t size,
+        uint16_t start_crc, fused_copy_hook_t hook) {
+    uint16_t crc = start_crc;
+    while(size > 0) {
+        size_t chunk_size = size;
+        if(chunk_size > FUSED_COPY_HOOK_INTERVAL) {
+            chunk_size = FUSED_COPY_HOOK_INTERVAL;
+        }
+        size_t idx = 0;
+        if((((uintptr_t) destination | (uintptr_t) source) & 3) == 0) {
+            /* Little endian word access, see copy_block_and_compute_code */
+            const uint32_t* word_source = (const uint32_t*) source;
+            uint32_t* word_destination = (uint32_t*) destination;
+            for(; idx < chunk_size / 4; idx++) {
+                uint32_t word = word_source[idx];
+                if(word_destination != NULL) {
+                    word_destination[idx] = word;
+                }
+                crc = crc16_update(crc, word & 0xff);
+                crc = crc16_update(crc, (word >> 8) & 0xff);
+                crc = crc16_update(crc, (word >> 16) & 0xff);
+                crc = crc16_update(crc, word >> 24);
+            }
+            idx *= 4;
+        }
+        for(; idx < chunk_size; idx++) {
+            if(destination != NULL) {
+                destination[idx] = source[idx];
+            }
+            crc = crc16_update(crc, source[idx]);
+        }
+        if(destination != NULL) {
+            destination += chunk_size;
+        }
+        source += chunk_size;
+        size -= chunk_size;
+        if(hook != NULL) {
+            hook();
+        }
+    }
+    return crc;
+}
+
+/**
+ * Copies one 256 byte block and computes the same code as the hamming library while the
+ * data is in the registers.
+ * The even line code of the library is the XOR of (255 - i) for all bytes with odd parity,
+ * which is the inverted odd line code if the number of these bytes is odd. Therefore, only the
+ * odd line code and the overall line parity need to be tracked.
+ */
+static void copy_block_and_compute_code(uint8_t* destination, const uint8_t* source,
+        uint8_t* code) {
+    uint8_t line_parity = 0;
+    uint8_t odd_line_code = 0;
+    uint8_t column_sum = 0;
+    if((((uintptr_t) destination | (uintptr_t) source) & 3) == 0) {
+        /* Word access is used for aligned buffers. The byte order is little endian, which
+        is the case for the AT91SAM9G20 and the usual host machines. */
+        const uint32_t* word_source = (const uint32_t*) source;
+        uint32_t* word_destination = (uint32_t*) destination;
+        uint32_t word_sum = 0;
+        for(uint32_t idx = 0; idx < FUSED_COPY_HAMMING_BLOCK_SIZE / 4; idx++) {
+            uint32_t word = word_source[idx];
+            word_destination[idx] = word;
+            word_sum ^= word;
+            for(uint8_t byte_idx = 0; byte_idx < 4; byte_idx++) {
+                uint8_t parity = BYTE_PARITY[(word >> (byte_idx * 8)) & 0xff];
+                line_parity ^= parity;
+                odd_line_code ^= (uint8_t) (idx * 4 + byte_idx) & (uint8_t) -parity;
+            }
+        }
+        word_sum ^= word_sum >> 16;
+        word_sum ^= word_sum >> 8;
+        column_sum = word_sum & 0xff;
+    }
+    else {
+        for(uint32_t idx = 0; idx < FUSED_COPY_HAMMING_BLOCK_SIZE; idx++) {
+            uint8_t byte = source[idx];
+            destination[idx] = byte;
+            column_sum ^= byte;
+            uint8_t parity = BYTE_PARITY[byte];
+            line_parity ^= parity;
+            odd_line_code ^= (uint8_t) idx & (uint8_t) -parity;
+        }
+    }
+    build_code(column_sum, line_parity, odd_line_code, code);
+}
+
+/**
+ * Same interleaving as in the hamming library
+ */
+static void build_code(uint8_t column_sum, uint8_t line_parity, uint8_t odd_line_code,
+        uint8_t* code) {
+    uint8_t even_line_code = odd_line_code;
+    if(line_parity != 0) {
+        even_line_code = ~odd_line_code;
+    }
+    uint8_t even_column_code = 0;
+    uint8_t odd_column_code = 0;
+    for(uint8_t idx = 0; idx < 8; idx++) {
+        if(column_sum & 1) {
+            even_column_code ^= (7 - idx);
+            odd_column_code ^= idx;
+        }
+        column_sum >>= 1;
+    }
+
+    code[0] = 0;
+    code[1] = 0;
+    code[2] = 0;
+    for(uint8_t idx = 0; idx < 4; idx++) {
+        code[0] <<= 2;
+        code[1] <<= 2;
+        code[2] <<= 2;
+        code[0] |= ((odd_line_code & 0x80) >> 6) | ((even_line_code & 0x80) >> 7);
+        code[1] |= ((odd_line_code & 0x08) >> 2) | ((even_line_code & 0x08) >> 3);
+        code[2] |= ((odd_column_code & 0x04) >> 1) | ((even_column_code & 0x04) >> 2);
+        odd_line_code <<= 1;
+        even_line_code <<= 1;
+        odd_column_code <<= 1;
+        even_column_code <<= 1;
+    }
+    code[0] = ~code[0];
+    code[1] = ~code[1];
+    code[2] = ~code[2];
+}
@@ -0,0 +1,71 @@
+#ifndef BOOTLOADER_UTILITY_FUSED_COPY_H_
+#define BOOTLOADER_UTILITY_FUSED_COPY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Block size of the hamming code used for the images. Each block has 3 bytes of hamming code.
+ */
+#define FUSED_COPY_HAMMING_BLOCK_SIZE           256
+#define FUSED_COPY_HAMMING_CODE_BYTES_PER_BLOCK 3
+
+/**
+ * The hook is called after this many bytes have been copied. 64 kB take around 10 ms when
+ * copied from the NOR-Flash, which is well inside the watchdog window.
+ */
+#define FUSED_COPY_HOOK_INTERVAL                65536
+
+/**
+ * Hook which is called periodically during long copy operations, for example to kick
+ * the watchdog. Can be NULL.
+ */
+typedef void (*fused_copy_hook_t)(void);
+
+/**
+ * Copy data in chunks and call the hook after each chunk.
+ */
+void fused_copy_in_chunks(uint8_t* destination, const uint8_t* source, size_t size,
+        fused_copy_hook_t hook);
+
+/**
+ * Copies an image and verifies it with its hamming code in a single pass.
+ * The code of each 256 byte block is computed while the data is moved through the registers
+ * and compared to the expected code. This way, the source is read only once, the destination
+ * is written only once and the destination is not read back in a separate verification pass.
+ * Only blocks with a mismatching code are verified and corrected in the destination with
+ * the hamming library.
+ *
+ * The hamming code is assumed to be generated with the image padded with zeros to a multiple
+ * of 256 bytes. The last block is padded in the same way and the padding is written to the
+ * destination as well, so the destination needs to have space for the padded size.
+ * @param destination   Can be the same as the source to verify the data in place
+ * @param source
+ * @param image_size    Size of the image without padding
+ * @param hamming_code  Hamming code with 3 bytes for each block
+ * @param hook          Called periodically, may be NULL
+ * @return
+ *  - 0 if no errors were detected
+ *  - Hamming_ERROR_SINGLEBIT(1) if at least one single bit error was corrected
+ *  - Hamming_ERROR_ECC(2) if the hamming code itself is corrupted. The image is still copied
+ *    completely in that case.
+ *  - Hamming_ERROR_MULTIPLEBITS(3) on uncorrectable errors. The copy operation is aborted.
+ */
+int fused_copy_hamming_verify(uint8_t* destination, const uint8_t* source, size_t image_size,
+        const uint8_t* hamming_code, fused_copy_hook_t hook);
+
+/**
+ * Copies data and calculates the CRC16-CCITT of the data in a single pass. The result is
+ * the same as for #crc16ccitt.
+ * @param destination   Can be NULL to only calculate the CRC. The source is still read with
+ *                      word accesses where possible, which is faster for the NOR-Flash.
+ * @param source
+ * @param size
+ * @param start_crc     0xffff for the default start value
+ * @param hook          Called periodically, may be NULL
+ * @return CRC16 of the data
+ */
+uint16_t fused_copy_crc16(uint8_t* destination, const uint8_t* source, size_t size,
+        uint16_t start_crc, fused_copy_hook_t hook);
+
+#endif /* BOOTLOADER_UTILITY_FUSED_COPY_H_ */
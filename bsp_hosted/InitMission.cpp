@@ -205,6 +205,17 @@ void initTask() {
         initmission::printAddObjectError("Test Task", objects::TEST_TASK);
     }
 
+#ifdef __unix__
+    taskPrio = 20;
+    /* Software image task */
+    PeriodicTaskIF* softwareImageTask = taskFactory->createPeriodicTask(
+            "SW_IMG_TASK", taskPrio, PeriodicTaskIF::MINIMUM_STACK_SIZE, 2.0, deadlineMissedFunc);
+    result = softwareImageTask->addComponent(objects::SOFTWARE_IMAGE_HANDLER);
+    if (result != HasReturnvaluesIF::RETURN_OK) {
+        initmission::printAddObjectError("SW Image Handler", objects::SOFTWARE_IMAGE_HANDLER);
+    }
+#endif
+
 #ifdef __unix__
     taskPrio = 80;
 #endif
@@ -248,4 +259,7 @@ void initTask() {
     //attitudeController->startTask();
     testTask->startTask();
     pollingSequenceTableTaskDefault->startTask();
+#ifdef __unix__
+    softwareImageTask->startTask();
+#endif
 }
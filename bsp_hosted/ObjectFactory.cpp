@@ -44,6 +44,12 @@
 #include <test/testdevices/devicedefinitions/testDeviceDefinitions.h>
 #include <test/testinterfaces/DummyCookie.h>
 
+#ifdef __unix__
+#include <bsp_sam9g20/core/SoftwareImageHandler.h>
+#include <bsp_sam9g20/memory/SDCardAccess.h>
+#include <bsp_sam9g20/common/fram/VirtualFRAMApi.h>
+#endif
+
 #include <cstdint>
 
 /**
@@ -170,6 +176,18 @@ void Factory::produce(void* args) {
     new TestDevice(objects::DUMMY_HANDLER_0, objects::DUMMY_INTERFACE,
             dummyCookie, testdevice::DeviceIndex::DEVICE_0, true);
     new TestTaskHost(objects::TEST_TASK, false);
+
+#ifdef __unix__
+    /* The software images are copied to the simulated NOR-Flash and the FRAM is virtualized
+    with a file on the simulated SD card */
+    {
+        SDCardAccess sdCardAccess;
+        if(FRAM_start() != 0) {
+            sif::printWarning("Factory::produce: Starting the virtualized FRAM failed\n");
+        }
+    }
+    new SoftwareImageHandler(objects::SOFTWARE_IMAGE_HANDLER);
+#endif
 }
 
 void Factory::setStaticFrameworkObjectIds() {
@@ -0,0 +1,454 @@
+#include "HostFlash.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE 0x100000
+#endif
+
+#define HOST_FLASH_FILL_CHUNK_SIZE      4096
+
+struct HostFlash {
+    HostFlashConfig config;
+    pthread_mutex_t mutex;
+    int fd;
+    uint8_t* memory;
+    uint32_t size;
+    uint32_t sector_count;
+    /* Set while an erase operation is in progress */
+    bool busy;
+    uint32_t* erase_counts;
+    /* Program operations per program unit since the last erase, only used with a limit */
+    uint8_t* program_counts;
+    uint32_t unit_count;
+    uint8_t* program_buffer;
+    size_t program_buffer_size;
+    HostFlashStatistics statistics;
+};
+
+static int fill_erased(int fd, off_t start, off_t end);
+static int map_image(HostFlash* flash);
+static void set_memory_protection(HostFlash* flash, int protection);
+static void inject_delay(uint64_t delay_us);
+static uint64_t get_monotonic_us(void);
+
+HostFlash* host_flash_open(const HostFlashConfig* config) {
+    if(config == NULL || config->image_path == NULL || config->region_count == 0 ||
+            config->region_count > HOST_FLASH_MAX_REGIONS) {
+        return NULL;
+    }
+    if(config->program_unit_size == 0) {
+        return NULL;
+    }
+
+    HostFlash* flash = calloc(1, sizeof(HostFlash));
+    if(flash == NULL) {
+        return NULL;
+    }
+    flash->config = *config;
+    if(flash->config.name == NULL) {
+        flash->config.name = "Flash";
+    }
+    flash->fd = -1;
+    pthread_mutex_init(&flash->mutex, NULL);
+
+    uint64_t total_size = 0;
+    for(uint8_t idx = 0; idx < config->region_count; idx++) {
+        const HostFlashRegion* region = &config->regions[idx];
+        if(region->sector_count == 0 || region->sector_size == 0) {
+            host_flash_close(flash);
+            return NULL;
+        }
+        total_size += (uint64_t) region->sector_count * region->sector_size;
+        flash->sector_count += region->sector_count;
+    }
+    if(total_size > UINT32_MAX) {
+        host_flash_close(flash);
+        return NULL;
+    }
+    flash->size = (uint32_t) total_size;
+
+    flash->erase_counts = calloc(flash->sector_count, sizeof(uint32_t));
+    if(config->max_programs_per_unit > 0) {
+        flash->unit_count = (flash->size + config->program_unit_size - 1) /
+                config->program_unit_size;
+        flash->program_counts = calloc(flash->unit_count, sizeof(uint8_t));
+    }
+    if(flash->erase_counts == NULL || (config->max_programs_per_unit > 0 &&
+            flash->program_counts == NULL)) {
+        host_flash_close(flash);
+        return NULL;
+    }
+
+    if(map_image(flash) != HOST_FLASH_OK) {
+        host_flash_close(flash);
+        return NULL;
+    }
+    return flash;
+}
+
+void host_flash_close(HostFlash* flash) {
+    if(flash == NULL) {
+        return;
+    }
+    if(flash->memory != NULL) {
+        set_memory_protection(flash, PROT_READ);
+        msync(flash->memory, flash->size, MS_SYNC);
+        munmap(flash->memory, flash->size);
+    }
+    if(flash->fd >= 0) {
+        close(flash->fd);
+    }
+    pthread_mutex_destroy(&flash->mutex);
+    free(flash->erase_counts);
+    free(flash->program_counts);
+    free(flash->program_buffer);
+    free(flash);
+}
+
+uint32_t host_flash_get_size(const HostFlash* flash) {
+    if(flash == NULL) {
+        return 0;
+    }
+    return flash->size;
+}
+
+const uint8_t* host_flash_get_memory(const HostFlash* flash) {
+    if(flash == NULL) {
+        return NULL;
+    }
+    return flash->memory;
+}
+
+int host_flash_get_sector(const HostFlash* flash, uint32_t offset, uint32_t* sector_start,
+        uint32_t* sector_size) {
+    if(flash == NULL || offset >= flash->size) {
+        return -1;
+    }
+    uint32_t region_start = 0;
+    uint32_t sector_idx = 0;
+    for(uint8_t idx = 0; idx < flash->config.region_count; idx++) {
+        const HostFlashRegion* region = &flash->config.regions[idx];
+        uint32_t region_size = region->sector_count * region->sector_size;
+        if(offset < region_start + region_size) {
+            uint32_t sector_in_region = (offset - region_start) / region->sector_size;
+            if(sector_start != NULL) {
+                *sector_start = region_start + sector_in_region * region->sector_size;
+            }
+            if(sector_size != NULL) {
+                *sector_size = region->sector_size;
+            }
+            return (int) (sector_idx + sector_in_region);
+        }
+        region_start += region_size;
+        sector_idx += region->sector_count;
+    }
+    return -1;
+}
+
+int host_flash_erase_sector(HostFlash* flash, uint32_t offset,
+        host_flash_poll_callback_t callback, void* args) {
+    if(flash == NULL) {
+        return HOST_FLASH_INVALID_ADDRESS;
+    }
+    uint32_t sector_start = 0;
+    uint32_t sector_size = 0;
+    int sector = host_flash_get_sector(flash, offset, &sector_start, &sector_size);
+    if(sector < 0 || sector_start != offset) {
+        return HOST_FLASH_INVALID_ADDRESS;
+    }
+
+    pthread_mutex_lock(&flash->mutex);
+    if(flash->busy) {
+        pthread_mutex_unlock(&flash->mutex);
+        return HOST_FLASH_BUSY;
+    }
+    flash->busy = true;
+    pthread_mutex_unlock(&flash->mutex);
+
+    uint32_t erase_latency_us = 0;
+    uint32_t region_start_sector = 0;
+    for(uint8_t idx = 0; idx < flash->config.region_count; idx++) {
+        const HostFlashRegion* region = &flash->config.regions[idx];
+        if((uint32_t) sector < region_start_sector + region->sector_count) {
+            erase_latency_us = region->erase_latency_us;
+            break;
+        }
+        region_start_sector += region->sector_count;
+    }
+
+    if(flash->config.protect_while_busy) {
+        set_memory_protection(flash, PROT_NONE);
+    }
+
+    /* Poll the device like the status polling loop of the drivers, at least once */
+    uint32_t poll_callbacks = 0;
+    if(flash->config.inject_latency) {
+        uint64_t start_us = get_monotonic_us();
+        do {
+            int result = 0;
+            if(callback != NULL) {
+                result = callback(args);
+                poll_callbacks++;
+            }
+            uint64_t elapsed_us = get_monotonic_us() - start_us;
+            if(result == 0 && elapsed_us < erase_latency_us) {
+                uint64_t remaining_us = erase_latency_us - elapsed_us;
+                if(flash->config.poll_interval_us > 0 &&
+                        remaining_us > flash->config.poll_interval_us) {
+                    remaining_us = flash->config.poll_interval_us;
+                }
+                inject_delay(remaining_us);
+            }
+        } while(get_monotonic_us() - start_us < erase_latency_us);
+    }
+    else if(callback != NULL) {
+        uint32_t polls = 1;
+        if(flash->config.poll_interval_us > 0) {
+            polls = (erase_latency_us + flash->config.poll_interval_us - 1) /
+                    flash->config.poll_interval_us;
+            if(polls == 0) {
+                polls = 1;
+            }
+        }
+        for(uint32_t idx = 0; idx < polls; idx++) {
+            callback(args);
+            poll_callbacks++;
+        }
+    }
+
+    int result = fill_erased(flash->fd, sector_start, (off_t) sector_start + sector_size);
+
+    if(flash->config.protect_while_busy) {
+        set_memory_protection(flash, PROT_READ);
+    }
+
+    pthread_mutex_lock(&flash->mutex);
+    flash->busy = false;
+    flash->statistics.poll_callbacks += poll_callbacks;
+    flash->statistics.busy_time_us += erase_latency_us;
+    if(result == HOST_FLASH_OK) {
+        flash->erase_counts[sector]++;
+        if(flash->erase_counts[sector] > flash->statistics.max_sector_erase_count) {
+            flash->statistics.max_sector_erase_count = flash->erase_counts[sector];
+        }
+        flash->statistics.sectors_erased++;
+        if(flash->program_counts != NULL) {
+            uint32_t unit_size = flash->config.program_unit_size;
+            memset(flash->program_counts + sector_start / unit_size, 0,
+                    (sector_size + unit_size - 1) / unit_size);
+        }
+    }
+    pthread_mutex_unlock(&flash->mutex);
+    return result;
+}
+
+int host_flash_program(HostFlash* flash, uint32_t offset, const uint8_t* data, size_t size) {
+    if(flash == NULL || data == NULL || offset > flash->size || size > flash->size - offset) {
+        return HOST_FLASH_INVALID_ADDRESS;
+    }
+    if(size == 0) {
+        return HOST_FLASH_OK;
+    }
+
+    pthread_mutex_lock(&flash->mutex);
+    if(flash->busy) {
+        pthread_mutex_unlock(&flash->mutex);
+        return HOST_FLASH_BUSY;
+    }
+    if(size > flash->program_buffer_size) {
+        uint8_t* new_buffer = realloc(flash->program_buffer, size);
+        if(new_buffer == NULL) {
+            pthread_mutex_unlock(&flash->mutex);
+            return HOST_FLASH_IO_ERROR;
+        }
+        flash->program_buffer = new_buffer;
+        flash->program_buffer_size = size;
+    }
+
+    /* Programming can only clear bits */
+    bool violation = false;
+    for(size_t idx = 0; idx < size; idx++) {
+        uint8_t old_value = flash->memory[offset + idx];
+        if(!flash->config.partial_programming && (data[idx] & ~old_value) != 0) {
+            violation = true;
+        }
+        flash->program_buffer[idx] = old_value & data[idx];
+    }
+
+    uint32_t unit_size = flash->config.program_unit_size;
+    uint32_t first_unit = offset / unit_size;
+    uint32_t last_unit = (uint32_t) ((offset + size - 1) / unit_size);
+    if(flash->program_counts != NULL) {
+        for(uint32_t unit = first_unit; unit <= last_unit; unit++) {
+            if(flash->program_counts[unit] >= flash->config.max_programs_per_unit) {
+                violation = true;
+            }
+            else {
+                flash->program_counts[unit]++;
+            }
+        }
+    }
+
+    int result = HOST_FLASH_OK;
+    if(pwrite(flash->fd, flash->program_buffer, size, offset) != (ssize_t) size) {
+        result = HOST_FLASH_IO_ERROR;
+    }
+    else if(violation) {
+        flash->statistics.program_violations++;
+        if(flash->config.strict_programming) {
+            result = HOST_FLASH_PROGRAM_VIOLATION;
+        }
+    }
+    uint64_t program_latency_us = (uint64_t) (last_unit - first_unit + 1) *
+            flash->config.program_latency_us;
+    flash->statistics.bytes_programmed += size;
+    flash->statistics.program_operations++;
+    flash->statistics.busy_time_us += program_latency_us;
+    pthread_mutex_unlock(&flash->mutex);
+
+    if(flash->config.inject_latency) {
+        inject_delay(program_latency_us);
+    }
+    return result;
+}
+
+int host_flash_read(HostFlash* flash, uint32_t offset, uint8_t* data, size_t size) {
+    if(flash == NULL || data == NULL || offset > flash->size || size > flash->size - offset) {
+        return HOST_FLASH_INVALID_ADDRESS;
+    }
+    pthread_mutex_lock(&flash->mutex);
+    if(flash->busy) {
+        pthread_mutex_unlock(&flash->mutex);
+        return HOST_FLASH_BUSY;
+    }
+    memcpy(data, flash->memory + offset, size);
+    flash->statistics.bytes_read += size;
+    pthread_mutex_unlock(&flash->mutex);
+    return HOST_FLASH_OK;
+}
+
+uint32_t host_flash_get_erase_count(const HostFlash* flash, uint32_t sector) {
+    if(flash == NULL || sector >= flash->sector_count) {
+        return 0;
+    }
+    return flash->erase_counts[sector];
+}
+
+void host_flash_get_statistics(const HostFlash* flash, HostFlashStatistics* statistics) {
+    if(flash == NULL || statistics == NULL) {
+        return;
+    }
+    pthread_mutex_lock((pthread_mutex_t*) &flash->mutex);
+    *statistics = flash->statistics;
+    pthread_mutex_unlock((pthread_mutex_t*) &flash->mutex);
+}
+
+void host_flash_reset_statistics(HostFlash* flash) {
+    if(flash == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&flash->mutex);
+    memset(&flash->statistics, 0, sizeof(flash->statistics));
+    memset(flash->erase_counts, 0, flash->sector_count * sizeof(uint32_t));
+    pthread_mutex_unlock(&flash->mutex);
+}
+
+static int fill_erased(int fd, off_t start, off_t end) {
+    uint8_t erased[HOST_FLASH_FILL_CHUNK_SIZE];
+    memset(erased, 0xff, sizeof(erased));
+    while(start < end) {
+        size_t chunk = sizeof(erased);
+        if((off_t) chunk > end - start) {
+            chunk = end - start;
+        }
+        ssize_t written = pwrite(fd, erased, chunk, start);
+        if(written < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            return HOST_FLASH_IO_ERROR;
+        }
+        start += written;
+    }
+    return HOST_FLASH_OK;
+}
+
+static int map_image(HostFlash* flash) {
+    flash->fd = open(flash->config.image_path, O_RDWR | O_CREAT, 0644);
+    if(flash->fd < 0) {
+        fprintf(stderr, "%s: Could not open image %s: %s\n", flash->config.name,
+                flash->config.image_path, strerror(errno));
+        return HOST_FLASH_IO_ERROR;
+    }
+    struct stat info;
+    if(fstat(flash->fd, &info) != 0) {
+        return HOST_FLASH_IO_ERROR;
+    }
+    /* A new or too small image is completed with erased memory */
+    if(info.st_size < (off_t) flash->size) {
+        if(fill_erased(flash->fd, info.st_size, flash->size) != HOST_FLASH_OK) {
+            fprintf(stderr, "%s: Could not initialize image %s\n", flash->config.name,
+                    flash->config.image_path);
+            return HOST_FLASH_IO_ERROR;
+        }
+    }
+
+    void* memory = MAP_FAILED;
+    if(flash->config.map_address != 0) {
+        memory = mmap((void*) flash->config.map_address, flash->size, PROT_READ,
+                MAP_SHARED | MAP_FIXED_NOREPLACE, flash->fd, 0);
+        if(memory != MAP_FAILED && memory != (void*) flash->config.map_address) {
+            /* Older kernels treat the address only as a hint */
+            munmap(memory, flash->size);
+            memory = MAP_FAILED;
+        }
+        if(memory == MAP_FAILED) {
+            fprintf(stderr, "%s: Could not map image to address 0x%08lx, direct memory "
+                    "access is not possible\n", flash->config.name,
+                    (unsigned long) flash->config.map_address);
+        }
+    }
+    if(memory == MAP_FAILED) {
+        memory = mmap(NULL, flash->size, PROT_READ, MAP_SHARED, flash->fd, 0);
+    }
+    if(memory == MAP_FAILED) {
+        fprintf(stderr, "%s: Could not map image %s: %s\n", flash->config.name,
+                flash->config.image_path, strerror(errno));
+        return HOST_FLASH_IO_ERROR;
+    }
+    flash->memory = memory;
+    return HOST_FLASH_OK;
+}
+
+static void set_memory_protection(HostFlash* flash, int protection) {
+    if(flash->memory != NULL) {
+        mprotect(flash->memory, flash->size, protection);
+    }
+}
+
+static void inject_delay(uint64_t delay_us) {
+    if(delay_us == 0) {
+        return;
+    }
+    struct timespec delay;
+    delay.tv_sec = delay_us / 1000000;
+    delay.tv_nsec = (delay_us % 1000000) * 1000;
+    while(nanosleep(&delay, &delay) != 0 && errno == EINTR) {
+    }
+}
+
+static uint64_t get_monotonic_us(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
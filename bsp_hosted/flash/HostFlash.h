@@ -0,0 +1,156 @@
+#ifndef BSP_HOSTED_FLASH_HOSTFLASH_H_
+#define BSP_HOSTED_FLASH_HOSTFLASH_H_
+
+/**
+ * @brief   File-backed flash memory simulator for host builds.
+ * @details
+ * The memory content is stored in an image file which is memory-mapped read-only, so the
+ * content can also be accessed directly like the memory-mapped NOR-Flash of the iOBC.
+ * The simulator models the properties of real flash memory which matter for the flash
+ * handling code of the OBSW:
+ *
+ *  - The device consists of regions of equally sized sectors (blocks for NAND-Flash).
+ *    Only complete sectors can be erased, which sets all bytes to 0xFF.
+ *  - Programming can only clear bits. Attempting to set a bit is counted as a program
+ *    violation and reported as an error if strict programming is enabled, like the
+ *    programming failure of real NOR-Flash devices. The resulting content is old & new data.
+ *  - The number of program operations per page between erases can be limited (NOP of
+ *    NAND-Flash devices).
+ *  - Erase and program latencies are modelled. The modelled busy time is always accumulated
+ *    in the statistics and can optionally be injected as real delays. While an erase
+ *    operation is busy, a poll callback is called periodically, like the status polling
+ *    loop of the flash drivers.
+ *  - Erase counts are tracked per sector, so the wear of erase strategies can be compared.
+ *
+ * The device functions are thread-safe. The device front-ends are HostNorFlash.c, which
+ * implements the NOR-Flash API of the ISIS HAL, and HostNandFlash.h.
+ */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HOST_FLASH_MAX_REGIONS          4
+
+static const int HOST_FLASH_OK = 0;
+static const int HOST_FLASH_INVALID_ADDRESS = -1;
+//! A bit was programmed from 0 to 1 or the page program limit was exceeded
+static const int HOST_FLASH_PROGRAM_VIOLATION = -2;
+//! The image file could not be opened, resized or mapped
+static const int HOST_FLASH_IO_ERROR = -3;
+//! The device is busy with an erase operation, e.g. when called from the poll callback
+static const int HOST_FLASH_BUSY = -4;
+
+typedef struct {
+    uint32_t sector_count;
+    uint32_t sector_size;
+    /* Modelled duration of erasing one sector of this region */
+    uint32_t erase_latency_us;
+} HostFlashRegion;
+
+typedef struct {
+    /* Name used in diagnostic output */
+    const char* name;
+    /* Image file, created and filled with 0xFF if it does not exist yet */
+    const char* image_path;
+    HostFlashRegion regions[HOST_FLASH_MAX_REGIONS];
+    uint8_t region_count;
+    /* Granularity of the program latency and the program counter, the word size for NOR-Flash,
+    page size including the spare area for NAND-Flash */
+    uint32_t program_unit_size;
+    /* Modelled duration of programming one program unit */
+    uint32_t program_latency_us;
+    /* Maximum number of program operations per program unit between erases, 0 for no limit */
+    uint8_t max_programs_per_unit;
+    /* Report program violations as errors instead of only counting them */
+    bool strict_programming;
+    /* Bits programmed to 1 keep their content instead of being counted as program violation,
+    used for the partial page programming of NAND-Flash */
+    bool partial_programming;
+    /* Sleep for the modelled latencies instead of only accounting them */
+    bool inject_latency;
+    /* Interval in which the poll callback is called while an erase operation is busy */
+    uint32_t poll_interval_us;
+    /* Address the content is mapped to, 0 to map it at any address */
+    uintptr_t map_address;
+    /* Remove all access rights of the mapping while an erase operation is busy. The
+    NOR-Flash only returns status information while erasing, so a read access in that time
+    is a bug which is turned into a segmentation fault this way */
+    bool protect_while_busy;
+} HostFlashConfig;
+
+typedef struct {
+    uint64_t bytes_read;
+    uint64_t bytes_programmed;
+    uint32_t program_operations;
+    uint32_t sectors_erased;
+    uint32_t program_violations;
+    uint32_t max_sector_erase_count;
+    uint32_t poll_callbacks;
+    /* Modelled busy time of the device */
+    uint64_t busy_time_us;
+} HostFlashStatistics;
+
+/**
+ * Called periodically while the device is erasing.
+ * @return 1 if work was done and the callback should be called again immediately,
+ * 0 to wait for the poll interval before calling it again
+ */
+typedef int (*host_flash_poll_callback_t)(void* args);
+
+typedef struct HostFlash HostFlash;
+
+/**
+ * Open the image file and map it.
+ * @param config    Copied, the strings have to stay valid while the device is open
+ * @return Device handle or NULL if the configuration is invalid or the image could not
+ * be opened
+ */
+HostFlash* host_flash_open(const HostFlashConfig* config);
+void host_flash_close(HostFlash* flash);
+
+uint32_t host_flash_get_size(const HostFlash* flash);
+
+/**
+ * Read-only view of the memory content. Reading it while the device is erasing is not
+ * allowed, see HostFlashConfig::protect_while_busy.
+ */
+const uint8_t* host_flash_get_memory(const HostFlash* flash);
+
+/**
+ * Look up the sector which contains the given offset.
+ * @param sector_start  Optional, set to the offset of the sector
+ * @param sector_size   Optional, set to the size of the sector
+ * @return Index of the sector or -1 for an invalid offset
+ */
+int host_flash_get_sector(const HostFlash* flash, uint32_t offset, uint32_t* sector_start,
+        uint32_t* sector_size);
+
+/**
+ * Erase one sector. Blocks for the modelled erase latency if latency injection is enabled.
+ * @param offset        Start of the sector
+ * @param callback      Optional callback called while the device is busy
+ * @param args          Passed to the callback
+ */
+int host_flash_erase_sector(HostFlash* flash, uint32_t offset,
+        host_flash_poll_callback_t callback, void* args);
+
+int host_flash_program(HostFlash* flash, uint32_t offset, const uint8_t* data, size_t size);
+int host_flash_read(HostFlash* flash, uint32_t offset, uint8_t* data, size_t size);
+
+/**
+ * @return Number of erase operations of the sector since the statistics were reset
+ */
+uint32_t host_flash_get_erase_count(const HostFlash* flash, uint32_t sector);
+
+void host_flash_get_statistics(const HostFlash* flash, HostFlashStatistics* statistics);
+void host_flash_reset_statistics(HostFlash* flash);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BSP_HOSTED_FLASH_HOSTFLASH_H_ */
@@ -0,0 +1,155 @@
+#include "HostNandFlash.h"
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HOST_NAND_FLASH_DEFAULT_IMAGE   "./host_nandflash.bin"
+#define HOST_NAND_FLASH_IMAGE_ENV       "HOST_NAND_FLASH_IMAGE"
+#define HOST_NAND_FLASH_PAGE_SIZE       (HOST_NAND_FLASH_PAGE_DATA_SIZE + \
+        HOST_NAND_FLASH_PAGE_SPARE_SIZE)
+#define HOST_NAND_FLASH_BLOCK_SIZE      (HOST_NAND_FLASH_PAGE_SIZE * \
+        HOST_NAND_FLASH_PAGES_PER_BLOCK)
+
+static pthread_mutex_t nandMutex = PTHREAD_MUTEX_INITIALIZER;
+static HostNandFlashConfig config;
+static bool configured = false;
+static HostFlash* device = NULL;
+
+static int get_page_offset(uint16_t block, uint16_t page, uint32_t* offset);
+
+void host_nand_flash_get_default_config(HostNandFlashConfig* defaultConfig) {
+    if(defaultConfig == NULL) {
+        return;
+    }
+    defaultConfig->image_path = NULL;
+    defaultConfig->block_count = HOST_NAND_FLASH_BLOCKS;
+    defaultConfig->block_erase_latency_us = HOST_NAND_FLASH_BLOCK_ERASE_LATENCY_US;
+    defaultConfig->page_program_latency_us = HOST_NAND_FLASH_PAGE_PROGRAM_LATENCY_US;
+    defaultConfig->inject_latency = false;
+    defaultConfig->strict_programming = true;
+}
+
+void host_nand_flash_configure(const HostNandFlashConfig* newConfig) {
+    pthread_mutex_lock(&nandMutex);
+    if(newConfig != NULL) {
+        config = *newConfig;
+    }
+    else {
+        host_nand_flash_get_default_config(&config);
+    }
+    configured = true;
+    host_flash_close(device);
+    device = NULL;
+    pthread_mutex_unlock(&nandMutex);
+}
+
+HostFlash* host_nand_flash_get_device(void) {
+    pthread_mutex_lock(&nandMutex);
+    if(device == NULL) {
+        if(!configured) {
+            host_nand_flash_get_default_config(&config);
+            configured = true;
+        }
+        const char* imagePath = config.image_path;
+        if(imagePath == NULL) {
+            imagePath = getenv(HOST_NAND_FLASH_IMAGE_ENV);
+        }
+        if(imagePath == NULL) {
+            imagePath = HOST_NAND_FLASH_DEFAULT_IMAGE;
+        }
+
+        HostFlashConfig flashConfig = {
+            .name = "NAND-Flash",
+            .image_path = imagePath,
+            .regions = {
+                { config.block_count, HOST_NAND_FLASH_BLOCK_SIZE, config.block_erase_latency_us }
+            },
+            .region_count = 1,
+            .program_unit_size = HOST_NAND_FLASH_PAGE_SIZE,
+            .program_latency_us = config.page_program_latency_us,
+            .max_programs_per_unit = HOST_NAND_FLASH_MAX_PAGE_PROGRAMS,
+            .strict_programming = config.strict_programming,
+            .partial_programming = true,
+            .inject_latency = config.inject_latency,
+            .poll_interval_us = 0,
+            .map_address = 0,
+            .protect_while_busy = false
+        };
+        device = host_flash_open(&flashConfig);
+    }
+    HostFlash* openedDevice = device;
+    pthread_mutex_unlock(&nandMutex);
+    return openedDevice;
+}
+
+uint16_t host_nand_flash_get_block_count(void) {
+    if(host_nand_flash_get_device() == NULL) {
+        return 0;
+    }
+    return config.block_count;
+}
+
+int host_nand_flash_erase_block(uint16_t block) {
+    uint32_t offset = 0;
+    int result = get_page_offset(block, 0, &offset);
+    if(result != HOST_FLASH_OK) {
+        return result;
+    }
+    return host_flash_erase_sector(host_nand_flash_get_device(), offset, NULL, NULL);
+}
+
+int host_nand_flash_write_page(uint16_t block, uint16_t page, const void* data,
+        const void* spare) {
+    uint32_t offset = 0;
+    int result = get_page_offset(block, page, &offset);
+    if(result != HOST_FLASH_OK) {
+        return result;
+    }
+    /* Bytes which are programmed to 0xFF keep their content, so the data and spare area
+    are always programmed together in one operation like on the device */
+    uint8_t pageBuffer[HOST_NAND_FLASH_PAGE_SIZE];
+    memset(pageBuffer, 0xff, sizeof(pageBuffer));
+    if(data != NULL) {
+        memcpy(pageBuffer, data, HOST_NAND_FLASH_PAGE_DATA_SIZE);
+    }
+    if(spare != NULL) {
+        memcpy(pageBuffer + HOST_NAND_FLASH_PAGE_DATA_SIZE, spare,
+                HOST_NAND_FLASH_PAGE_SPARE_SIZE);
+    }
+    return host_flash_program(host_nand_flash_get_device(), offset, pageBuffer,
+            sizeof(pageBuffer));
+}
+
+int host_nand_flash_read_page(uint16_t block, uint16_t page, void* data, void* spare) {
+    uint32_t offset = 0;
+    int result = get_page_offset(block, page, &offset);
+    if(result != HOST_FLASH_OK) {
+        return result;
+    }
+    HostFlash* nandFlash = host_nand_flash_get_device();
+    if(data != NULL) {
+        result = host_flash_read(nandFlash, offset, data, HOST_NAND_FLASH_PAGE_DATA_SIZE);
+        if(result != HOST_FLASH_OK) {
+            return result;
+        }
+    }
+    if(spare != NULL) {
+        result = host_flash_read(nandFlash, offset + HOST_NAND_FLASH_PAGE_DATA_SIZE, spare,
+                HOST_NAND_FLASH_PAGE_SPARE_SIZE);
+    }
+    return result;
+}
+
+static int get_page_offset(uint16_t block, uint16_t page, uint32_t* offset) {
+    if(host_nand_flash_get_device() == NULL) {
+        return HOST_FLASH_IO_ERROR;
+    }
+    if(block >= config.block_count || page >= HOST_NAND_FLASH_PAGES_PER_BLOCK) {
+        return HOST_FLASH_INVALID_ADDRESS;
+    }
+    *offset = (uint32_t) block * HOST_NAND_FLASH_BLOCK_SIZE +
+            (uint32_t) page * HOST_NAND_FLASH_PAGE_SIZE;
+    return HOST_FLASH_OK;
+}
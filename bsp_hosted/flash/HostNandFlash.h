@@ -0,0 +1,93 @@
+#ifndef BSP_HOSTED_FLASH_HOSTNANDFLASH_H_
+#define BSP_HOSTED_FLASH_HOSTNANDFLASH_H_
+
+/**
+ * @brief   Simulated NAND-Flash for host builds.
+ * @details
+ * Block and page based access to a HostFlash device with the geometry of the NAND-Flash on
+ * the AT91SAM9G20-EK. Every page consists of the data area followed by the spare area, which
+ * are programmed together, so a page can be programmed HOST_NAND_FLASH_MAX_PAGE_PROGRAMS
+ * times between erases. The image file is taken from the configuration passed to
+ * host_nand_flash_configure, the HOST_NAND_FLASH_IMAGE environment variable or
+ * ./host_nandflash.bin, in that order.
+ *
+ * All functions return the HOST_FLASH_* return values.
+ */
+#include "HostFlash.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HOST_NAND_FLASH_PAGE_DATA_SIZE              2048
+#define HOST_NAND_FLASH_PAGE_SPARE_SIZE             64
+#define HOST_NAND_FLASH_PAGES_PER_BLOCK             64
+#define HOST_NAND_FLASH_BLOCKS                      2048
+//! Number of partial page programs (NOP)
+#define HOST_NAND_FLASH_MAX_PAGE_PROGRAMS           4
+
+/* Typical timing of the NAND-Flash */
+#define HOST_NAND_FLASH_BLOCK_ERASE_LATENCY_US      2000
+#define HOST_NAND_FLASH_PAGE_PROGRAM_LATENCY_US     220
+
+typedef struct {
+    /* Image file, NULL to use the default */
+    const char* image_path;
+    /* Can be reduced to get a smaller image file */
+    uint16_t block_count;
+    uint32_t block_erase_latency_us;
+    uint32_t page_program_latency_us;
+    /* See HostFlashConfig */
+    bool inject_latency;
+    bool strict_programming;
+} HostNandFlashConfig;
+
+/**
+ * Default configuration which is also used if host_nand_flash_configure is not called:
+ * full size device with typical timing, without latency injection and with strict
+ * programming.
+ * @param config
+ */
+void host_nand_flash_get_default_config(HostNandFlashConfig* config);
+
+/**
+ * Configure the NAND-Flash. Closes the device if it is open already, it is opened again
+ * with the new configuration on the next access.
+ * @param config    NULL to restore the default configuration
+ */
+void host_nand_flash_configure(const HostNandFlashConfig* config);
+
+/**
+ * @return The device, opened on demand, or NULL if it could not be opened
+ */
+HostFlash* host_nand_flash_get_device(void);
+
+uint16_t host_nand_flash_get_block_count(void);
+
+int host_nand_flash_erase_block(uint16_t block);
+
+/**
+ * Program a page.
+ * @param data      HOST_NAND_FLASH_PAGE_DATA_SIZE bytes or NULL to leave the data area
+ *                  unchanged
+ * @param spare     HOST_NAND_FLASH_PAGE_SPARE_SIZE bytes or NULL to leave the spare area
+ *                  unchanged
+ */
+int host_nand_flash_write_page(uint16_t block, uint16_t page, const void* data,
+        const void* spare);
+
+/**
+ * Read a page.
+ * @param data      HOST_NAND_FLASH_PAGE_DATA_SIZE bytes or NULL
+ * @param spare     HOST_NAND_FLASH_PAGE_SPARE_SIZE bytes or NULL
+ */
+int host_nand_flash_read_page(uint16_t block, uint16_t page, void* data, void* spare);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BSP_HOSTED_FLASH_HOSTNANDFLASH_H_ */
@@ -0,0 +1,164 @@
+#include "HostNorFlash.h"
+
+#include <hal/Storage/NORflash.h>
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#define HOST_NOR_FLASH_DEFAULT_IMAGE    "./host_norflash.bin"
+#define HOST_NOR_FLASH_IMAGE_ENV        "HOST_NOR_FLASH_IMAGE"
+#define HOST_NOR_FLASH_SMALL_SECTORS    8
+#define HOST_NOR_FLASH_LARGE_SECTORS    15
+
+/* Implemented in norflashHook.c, called by the AT91 driver while the NOR-Flash is busy */
+extern void NorFlash_Hook(void);
+
+NorFlashInfo NORFlash;
+
+static pthread_mutex_t norMutex = PTHREAD_MUTEX_INITIALIZER;
+static HostNorFlashConfig config;
+static bool configured = false;
+
+static HostFlash* get_device(struct NorFlash* norFlash);
+static int poll_hook(void* args);
+
+void host_nor_flash_get_default_config(HostNorFlashConfig* defaultConfig) {
+    if(defaultConfig == NULL) {
+        return;
+    }
+    defaultConfig->image_path = NULL;
+    defaultConfig->small_sector_erase_latency_us = HOST_NOR_FLASH_SECTOR_ERASE_LATENCY_US;
+    defaultConfig->large_sector_erase_latency_us = HOST_NOR_FLASH_SECTOR_ERASE_LATENCY_US;
+    defaultConfig->word_program_latency_us = HOST_NOR_FLASH_WORD_PROGRAM_LATENCY_US;
+    defaultConfig->poll_interval_us = HOST_NOR_FLASH_POLL_INTERVAL_US;
+    defaultConfig->inject_latency = false;
+    defaultConfig->strict_programming = true;
+    defaultConfig->protect_while_busy = true;
+}
+
+void host_nor_flash_configure(const HostNorFlashConfig* newConfig) {
+    pthread_mutex_lock(&norMutex);
+    if(newConfig != NULL) {
+        config = *newConfig;
+    }
+    else {
+        host_nor_flash_get_default_config(&config);
+    }
+    configured = true;
+    host_flash_close(NORFlash.device);
+    NORFlash.device = NULL;
+    pthread_mutex_unlock(&norMutex);
+}
+
+HostFlash* host_nor_flash_get_device(void) {
+    return get_device(&NORFlash);
+}
+
+int NORflash_start(void) {
+    if(get_device(&NORFlash) == NULL) {
+        return -1;
+    }
+    return 0;
+}
+
+unsigned char NORFLASH_EraseSector(struct NorFlash* norFlash, unsigned int sectorAddr) {
+    HostFlash* device = get_device(norFlash);
+    if(device == NULL) {
+        return 1;
+    }
+    if(host_flash_erase_sector(device, sectorAddr, &poll_hook, NULL) != HOST_FLASH_OK) {
+        return 1;
+    }
+    return 0;
+}
+
+unsigned char NORFLASH_EraseChip(struct NorFlash* norFlash) {
+    HostFlash* device = get_device(norFlash);
+    if(device == NULL) {
+        return 1;
+    }
+    uint32_t sectorStart = 0;
+    uint32_t sectorSize = 0;
+    while(host_flash_get_sector(device, sectorStart, NULL, &sectorSize) >= 0) {
+        if(host_flash_erase_sector(device, sectorStart, &poll_hook, NULL) != HOST_FLASH_OK) {
+            return 1;
+        }
+        sectorStart += sectorSize;
+    }
+    return 0;
+}
+
+unsigned char NORFLASH_WriteData(struct NorFlash* norFlash, unsigned int address,
+        unsigned char* buffer, unsigned int size) {
+    HostFlash* device = get_device(norFlash);
+    if(device == NULL) {
+        return 1;
+    }
+    if(host_flash_program(device, address, buffer, size) != HOST_FLASH_OK) {
+        return 1;
+    }
+    return 0;
+}
+
+unsigned char NORFLASH_ReadData(struct NorFlash* norFlash, unsigned int address,
+        unsigned char* buffer, unsigned int size) {
+    HostFlash* device = get_device(norFlash);
+    if(device == NULL) {
+        return 1;
+    }
+    if(host_flash_read(device, address, buffer, size) != HOST_FLASH_OK) {
+        return 1;
+    }
+    return 0;
+}
+
+static HostFlash* get_device(struct NorFlash* norFlash) {
+    if(norFlash == NULL) {
+        return NULL;
+    }
+    pthread_mutex_lock(&norMutex);
+    if(norFlash->device == NULL) {
+        if(!configured) {
+            host_nor_flash_get_default_config(&config);
+            configured = true;
+        }
+        const char* imagePath = config.image_path;
+        if(imagePath == NULL) {
+            imagePath = getenv(HOST_NOR_FLASH_IMAGE_ENV);
+        }
+        if(imagePath == NULL) {
+            imagePath = HOST_NOR_FLASH_DEFAULT_IMAGE;
+        }
+
+        HostFlashConfig flashConfig = {
+            .name = "NOR-Flash",
+            .image_path = imagePath,
+            .regions = {
+                { HOST_NOR_FLASH_SMALL_SECTORS, NORFLASH_SMALL_SECTOR_SIZE,
+                        config.small_sector_erase_latency_us },
+                { HOST_NOR_FLASH_LARGE_SECTORS, NORFLASH_LARGE_SECTOR_SIZE,
+                        config.large_sector_erase_latency_us }
+            },
+            .region_count = 2,
+            .program_unit_size = 2,
+            .program_latency_us = config.word_program_latency_us,
+            .max_programs_per_unit = 0,
+            .strict_programming = config.strict_programming,
+            .partial_programming = false,
+            .inject_latency = config.inject_latency,
+            .poll_interval_us = config.poll_interval_us,
+            .map_address = NOR_FLASH_BASE_ADDRESS,
+            .protect_while_busy = config.protect_while_busy
+        };
+        norFlash->device = host_flash_open(&flashConfig);
+    }
+    HostFlash* device = norFlash->device;
+    pthread_mutex_unlock(&norMutex);
+    return device;
+}
+
+static int poll_hook(void* args) {
+    NorFlash_Hook();
+    return 0;
+}
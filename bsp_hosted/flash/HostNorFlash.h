@@ -0,0 +1,69 @@
+#ifndef BSP_HOSTED_FLASH_HOSTNORFLASH_H_
+#define BSP_HOSTED_FLASH_HOSTNORFLASH_H_
+
+/**
+ * @brief   Host specific extensions of the simulated iOBC NOR-Flash.
+ * @details
+ * The NOR-Flash API of the ISIS HAL (hal/Storage/NORflash.h) is implemented on top of a
+ * HostFlash device with 8 small and 15 large sectors. The image file is taken from the
+ * configuration passed to host_nor_flash_configure, the HOST_NOR_FLASH_IMAGE environment
+ * variable or ./host_norflash.bin, in that order.
+ *
+ * NorFlash_Hook is called in the poll interval while a sector is erased, like in the
+ * polling loop of the AT91 NOR-Flash driver, so work which is overlapped with the erase
+ * operation runs on the host as well.
+ */
+#include "HostFlash.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Typical timing of the NOR-Flash of the iOBC */
+#define HOST_NOR_FLASH_SECTOR_ERASE_LATENCY_US      500000
+#define HOST_NOR_FLASH_WORD_PROGRAM_LATENCY_US      6
+#define HOST_NOR_FLASH_POLL_INTERVAL_US             1000
+
+typedef struct {
+    /* Image file, NULL to use the default */
+    const char* image_path;
+    uint32_t small_sector_erase_latency_us;
+    uint32_t large_sector_erase_latency_us;
+    /* Programming is done in 16 bit words */
+    uint32_t word_program_latency_us;
+    uint32_t poll_interval_us;
+    /* See HostFlashConfig */
+    bool inject_latency;
+    bool strict_programming;
+    bool protect_while_busy;
+} HostNorFlashConfig;
+
+/**
+ * Default configuration which is also used if host_nor_flash_configure is not called:
+ * typical timing without latency injection, strict programming and protection of the
+ * memory while erasing.
+ * @param config
+ */
+void host_nor_flash_get_default_config(HostNorFlashConfig* config);
+
+/**
+ * Configure the NOR-Flash. Closes the device if it is open already, it is opened again with
+ * the new configuration on the next access.
+ * @param config    NULL to restore the default configuration
+ */
+void host_nor_flash_configure(const HostNorFlashConfig* config);
+
+/**
+ * @return The device, opened on demand, or NULL if it could not be opened. Can be used to
+ * retrieve the statistics and erase counts.
+ */
+HostFlash* host_nor_flash_get_device(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BSP_HOSTED_FLASH_HOSTNORFLASH_H_ */
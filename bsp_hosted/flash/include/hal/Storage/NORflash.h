@@ -0,0 +1,72 @@
+#ifndef BSP_HOSTED_FLASH_HAL_STORAGE_NORFLASH_H_
+#define BSP_HOSTED_FLASH_HAL_STORAGE_NORFLASH_H_
+
+/**
+ * Host replacement for the NOR-Flash API of the ISIS HAL. The NOR-Flash is simulated with the
+ * sector layout of the iOBC, see HostNorFlash.h. The content is mapped to
+ * NOR_FLASH_BASE_ADDRESS if possible, so memory-mapped reads work like on the iOBC.
+ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NOR_FLASH_BASE_ADDRESS          0x10000000
+#define BOARD_NORFLASH_SIZE             0x100000
+
+#define NORFLASH_SMALL_SECTOR_SIZE      8192
+#define NORFLASH_LARGE_SECTOR_SIZE      0x10000
+
+#define NORFLASH_SA0_ADDRESS            0x00000
+#define NORFLASH_SA1_ADDRESS            0x02000
+#define NORFLASH_SA2_ADDRESS            0x04000
+#define NORFLASH_SA3_ADDRESS            0x06000
+#define NORFLASH_SA4_ADDRESS            0x08000
+#define NORFLASH_SA5_ADDRESS            0x0A000
+#define NORFLASH_SA6_ADDRESS            0x0C000
+#define NORFLASH_SA7_ADDRESS            0x0E000
+#define NORFLASH_SA8_ADDRESS            0x10000
+#define NORFLASH_SA9_ADDRESS            0x20000
+#define NORFLASH_SA10_ADDRESS           0x30000
+#define NORFLASH_SA11_ADDRESS           0x40000
+#define NORFLASH_SA12_ADDRESS           0x50000
+#define NORFLASH_SA13_ADDRESS           0x60000
+#define NORFLASH_SA14_ADDRESS           0x70000
+#define NORFLASH_SA15_ADDRESS           0x80000
+#define NORFLASH_SA16_ADDRESS           0x90000
+#define NORFLASH_SA17_ADDRESS           0xA0000
+#define NORFLASH_SA18_ADDRESS           0xB0000
+#define NORFLASH_SA19_ADDRESS           0xC0000
+#define NORFLASH_SA20_ADDRESS           0xD0000
+#define NORFLASH_SA21_ADDRESS           0xE0000
+#define NORFLASH_SA22_ADDRESS           0xF0000
+
+struct HostFlash;
+
+/* Replaces the CFI driver instance of the AT91 library */
+struct NorFlash {
+    struct HostFlash* device;
+};
+
+typedef struct NorFlash NorFlashInfo;
+
+extern NorFlashInfo NORFlash;
+
+/**
+ * Opens the simulated NOR-Flash. The other functions open it on demand as well.
+ * @return 0 on success
+ */
+int NORflash_start(void);
+
+/* Addresses are offsets from the start of the NOR-Flash. All functions return 0 on success */
+unsigned char NORFLASH_EraseSector(struct NorFlash* norFlash, unsigned int sectorAddr);
+unsigned char NORFLASH_EraseChip(struct NorFlash* norFlash);
+unsigned char NORFLASH_WriteData(struct NorFlash* norFlash, unsigned int address,
+        unsigned char* buffer, unsigned int size);
+unsigned char NORFLASH_ReadData(struct NorFlash* norFlash, unsigned int address,
+        unsigned char* buffer, unsigned int size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BSP_HOSTED_FLASH_HAL_STORAGE_NORFLASH_H_ */
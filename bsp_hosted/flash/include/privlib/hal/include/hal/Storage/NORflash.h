@@ -0,0 +1,7 @@
+#ifndef BSP_HOSTED_FLASH_PRIVLIB_HAL_STORAGE_NORFLASH_H_
+#define BSP_HOSTED_FLASH_PRIVLIB_HAL_STORAGE_NORFLASH_H_
+
+/* The common iOBC configuration includes the HAL header with the path inside the library */
+#include <hal/Storage/NORflash.h>
+
+#endif /* BSP_HOSTED_FLASH_PRIVLIB_HAL_STORAGE_NORFLASH_H_ */
@@ -13,7 +13,11 @@
  */
 namespace SUBSYSTEM_ID {
 enum: uint8_t {
-	SUBSYSTEM_ID_START = COMMON_SUBSYSTEM_ID_RANGE
+	SUBSYSTEM_ID_START = COMMON_SUBSYSTEM_ID_RANGE,
+
+	SD_CARD_HANDLER = 180,
+	IMAGE_HANDLER = 181,
+	SD_CARD_MIRROR = 182
 };
 }
 
@@ -8,7 +8,7 @@
 
 namespace objects {
 	enum sourceObjects: object_id_t {
-
+		SOFTWARE_IMAGE_HANDLER = 0x4D009000
 	};
 }
 
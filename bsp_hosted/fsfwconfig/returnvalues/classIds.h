@@ -10,6 +10,8 @@
 namespace CLASS_ID {
 enum: uint8_t {
 	MISSION_CLASS_ID_START = COMMON_CLASS_ID_RANGE,
+	SD_CARD_HANDLER, //SDCH
+	SW_IMAGE_HANDLER, //SWIH
     MISSION_CLASS_ID_RANGE // [EXPORT] : [END]
 };
 }
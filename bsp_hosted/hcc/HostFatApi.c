@@ -0,0 +1,1229 @@
+#include "HostFatApi.h"
+
+#include <hcc/api_fat.h>
+#include <hcc/api_hcc_mem.h>
+#include <hcc/api_mdriver_atmel_mcipdc.h>
+
+#include <ctype.h>
+#include <dirent.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define HOST_FAT_DEFAULT_ROOT           "./hcc_host_fs"
+#define HOST_FAT_ROOT_ENV               "HCC_HOST_ROOT"
+#define HOST_FAT_MAX_SEARCHES           4
+
+typedef enum {
+    DRIVE_UNMOUNTED,
+    DRIVE_NOT_FORMATTED,
+    DRIVE_MOUNTED
+} DriveState;
+
+typedef struct {
+    DriveState state;
+    char root[PATH_MAX];
+} HostDrive;
+
+struct F_FILE {
+    bool inUse;
+    bool writable;
+    FILE* handle;
+    char hostPath[PATH_MAX];
+};
+
+/* Result of mapping a path of the FAT API to the host file system */
+typedef struct {
+    int drive;
+    /* Path relative to the drive root, "" for the root itself */
+    char virtualPath[F_MAXPATH];
+    char hostPath[PATH_MAX];
+    const char* leafName;
+    bool parentExists;
+    bool exists;
+    struct stat info;
+} HostPath;
+
+/* Open directory stream of a search started with f_findfirst */
+typedef struct {
+    F_FIND* owner;
+    DIR* dir;
+    long position;
+    uint32_t lastUse;
+    char hostDirectory[PATH_MAX];
+} HostSearch;
+
+static pthread_mutex_t fatMutex = PTHREAD_MUTEX_INITIALIZER;
+static HostDrive drives[HOST_FAT_MAX_DRIVES];
+static F_FILE files[F_MAXFILES];
+static HostFatConfig config;
+static char rootPath[PATH_MAX];
+static HostFatStatistics statistics;
+
+/* The HCC library keeps the current drive, directory and error per task */
+static _Thread_local int lastError = F_NO_ERROR;
+static _Thread_local int currentDrive = 0;
+static _Thread_local char currentDirectory[HOST_FAT_MAX_DRIVES][F_MAXPATH];
+static _Thread_local HostSearch searches[HOST_FAT_MAX_SEARCHES];
+static _Thread_local uint32_t searchCounter = 0;
+
+static int set_error(int error);
+static const char* get_root_path(void);
+static int check_drive(int drive);
+static bool lookup_entry(const char* hostDirectory, const char* name, char* realName,
+        size_t maxLength);
+static int resolve_path(const char* name, HostPath* path);
+static bool is_open(const char* hostPath, bool onlyWriters);
+static void flush_writers(const char* hostPath);
+static int remove_recursively(const char* hostPath);
+static bool matches_pattern(const char* name, const char* pattern);
+static void fill_find_entry(F_FIND* find, const char* hostDirectory, const char* name);
+static HostSearch* get_search(F_FIND* find);
+static int continue_search(F_FIND* find);
+static void inject_delay(size_t bytes, uint32_t bytesPerSecond);
+static int map_errno(int error);
+
+void host_fat_configure(const HostFatConfig* newConfig) {
+    pthread_mutex_lock(&fatMutex);
+    if(newConfig != NULL) {
+        config = *newConfig;
+    }
+    else {
+        memset(&config, 0, sizeof(config));
+    }
+    rootPath[0] = '\0';
+    pthread_mutex_unlock(&fatMutex);
+}
+
+void host_fat_get_statistics(HostFatStatistics* statisticsCopy) {
+    if(statisticsCopy == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&fatMutex);
+    *statisticsCopy = statistics;
+    pthread_mutex_unlock(&fatMutex);
+}
+
+void host_fat_reset_statistics(void) {
+    pthread_mutex_lock(&fatMutex);
+    memset(&statistics, 0, sizeof(statistics));
+    pthread_mutex_unlock(&fatMutex);
+}
+
+F_DRIVER* atmel_mcipdc_initfunc(unsigned long driver_param) {
+    return NULL;
+}
+
+int hcc_mem_init(void) {
+    return F_NO_ERROR;
+}
+
+int hcc_mem_delete(void) {
+    return F_NO_ERROR;
+}
+
+int fs_init(void) {
+    return F_NO_ERROR;
+}
+
+int fs_delete(void) {
+    return F_NO_ERROR;
+}
+
+int f_enterFS(void) {
+    currentDrive = 0;
+    memset(currentDirectory, 0, sizeof(currentDirectory));
+    return set_error(F_NO_ERROR);
+}
+
+void f_releaseFS(void) {
+    for(size_t idx = 0; idx < HOST_FAT_MAX_SEARCHES; idx++) {
+        if(searches[idx].dir != NULL) {
+            closedir(searches[idx].dir);
+        }
+    }
+    memset(searches, 0, sizeof(searches));
+}
+
+int f_getlasterror(void) {
+    return lastError;
+}
+
+int f_initvolume(int drvnumber, F_DRIVERINIT driver_init, unsigned long driver_param) {
+    if(drvnumber < 0 || drvnumber >= HOST_FAT_MAX_DRIVES) {
+        return set_error(F_ERR_INVALIDDRIVE);
+    }
+    if(driver_init != NULL) {
+        driver_init(driver_param);
+    }
+
+    pthread_mutex_lock(&fatMutex);
+    HostDrive* drive = &drives[drvnumber];
+    snprintf(drive->root, sizeof(drive->root), "%s/SD_CARD_%lu", get_root_path(),
+            driver_param);
+    struct stat info;
+    if(stat(drive->root, &info) == 0 && S_ISDIR(info.st_mode)) {
+        drive->state = DRIVE_MOUNTED;
+    }
+    else {
+        drive->state = DRIVE_NOT_FORMATTED;
+    }
+    DriveState state = drive->state;
+    pthread_mutex_unlock(&fatMutex);
+
+    memset(currentDirectory[drvnumber], 0, F_MAXPATH);
+    if(state == DRIVE_NOT_FORMATTED) {
+        return set_error(F_ERR_NOTFORMATTED);
+    }
+    return set_error(F_NO_ERROR);
+}
+
+int f_delvolume(int drvnumber) {
+    if(drvnumber < 0 || drvnumber >= HOST_FAT_MAX_DRIVES) {
+        return set_error(F_ERR_INVALIDDRIVE);
+    }
+    pthread_mutex_lock(&fatMutex);
+    DriveState state = drives[drvnumber].state;
+    drives[drvnumber].state = DRIVE_UNMOUNTED;
+    pthread_mutex_unlock(&fatMutex);
+    if(state == DRIVE_UNMOUNTED) {
+        return set_error(F_ERR_INVALIDDRIVE);
+    }
+    return set_error(F_NO_ERROR);
+}
+
+int f_format(int drvnumber, long fattype) {
+    if(drvnumber < 0 || drvnumber >= HOST_FAT_MAX_DRIVES) {
+        return set_error(F_ERR_INVALIDDRIVE);
+    }
+    if(fattype != F_FAT12_MEDIA && fattype != F_FAT16_MEDIA && fattype != F_FAT32_MEDIA) {
+        return set_error(F_ERR_INVFATTYPE);
+    }
+
+    pthread_mutex_lock(&fatMutex);
+    HostDrive* drive = &drives[drvnumber];
+    if(drive->state == DRIVE_UNMOUNTED) {
+        pthread_mutex_unlock(&fatMutex);
+        return set_error(F_ERR_INVALIDDRIVE);
+    }
+    for(size_t idx = 0; idx < F_MAXFILES; idx++) {
+        if(files[idx].inUse && strncmp(files[idx].hostPath, drive->root,
+                strlen(drive->root)) == 0) {
+            pthread_mutex_unlock(&fatMutex);
+            return set_error(F_ERR_BUSY);
+        }
+    }
+
+    int result = F_NO_ERROR;
+    /* Create the root directory first if required, then the volume directory itself */
+    const char* root = get_root_path();
+    if(mkdir(root, 0775) != 0 && errno != EEXIST) {
+        result = F_ERR_WRITE;
+    }
+    if(result == F_NO_ERROR) {
+        remove_recursively(drive->root);
+        if(mkdir(drive->root, 0775) != 0) {
+            result = F_ERR_WRITE;
+        }
+    }
+    if(result == F_NO_ERROR) {
+        drive->state = DRIVE_MOUNTED;
+    }
+    pthread_mutex_unlock(&fatMutex);
+
+    memset(currentDirectory[drvnumber], 0, F_MAXPATH);
+    return set_error(result);
+}
+
+int f_chdrive(int drvnumber) {
+    int result = check_drive(drvnumber);
+    if(result == F_NO_ERROR) {
+        currentDrive = drvnumber;
+    }
+    return set_error(result);
+}
+
+int f_getdrive(void) {
+    return currentDrive;
+}
+
+F_FILE* f_open(const char* filename, const char* mode) {
+    if(mode == NULL || mode[0] == '\0' || strchr("rwa", mode[0]) == NULL) {
+        set_error(F_ERR_NOTUSEABLE);
+        return NULL;
+    }
+    HostPath path;
+    int result = resolve_path(filename, &path);
+    if(result != F_NO_ERROR) {
+        set_error(result);
+        return NULL;
+    }
+
+    bool writable = mode[0] != 'r' || strchr(mode, '+') != NULL;
+    if(!path.parentExists) {
+        set_error(F_ERR_INVALIDDIR);
+        return NULL;
+    }
+    if(path.exists && S_ISDIR(path.info.st_mode)) {
+        set_error(F_ERR_INVALIDNAME);
+        return NULL;
+    }
+    if(!path.exists && mode[0] == 'r') {
+        set_error(F_ERR_NOTFOUND);
+        return NULL;
+    }
+    if(path.exists && writable && (path.info.st_mode & S_IWUSR) == 0) {
+        set_error(F_ERR_ACCESSDENIED);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&fatMutex);
+    /* Like the HCC library, allow several readers but only one writer per file */
+    if(is_open(path.hostPath, !writable)) {
+        pthread_mutex_unlock(&fatMutex);
+        set_error(F_ERR_LOCKED);
+        return NULL;
+    }
+    F_FILE* file = NULL;
+    for(size_t idx = 0; idx < F_MAXFILES; idx++) {
+        if(!files[idx].inUse) {
+            file = &files[idx];
+            break;
+        }
+    }
+    if(file == NULL) {
+        pthread_mutex_unlock(&fatMutex);
+        set_error(F_ERR_NOMOREENTRY);
+        return NULL;
+    }
+
+    char hostMode[4] = { mode[0], 'b', '\0', '\0' };
+    if(strchr(mode, '+') != NULL) {
+        hostMode[1] = '+';
+        hostMode[2] = 'b';
+    }
+    file->handle = fopen(path.hostPath, hostMode);
+    if(file->handle == NULL) {
+        int error = map_errno(errno);
+        pthread_mutex_unlock(&fatMutex);
+        set_error(error);
+        return NULL;
+    }
+    file->inUse = true;
+    file->writable = writable;
+    strncpy(file->hostPath, path.hostPath, sizeof(file->hostPath) - 1);
+    statistics.files_opened++;
+    pthread_mutex_unlock(&fatMutex);
+
+    set_error(F_NO_ERROR);
+    return file;
+}
+
+int f_close(F_FILE* filehandle) {
+    if(filehandle == NULL || !filehandle->inUse) {
+        return set_error(F_ERR_NOTOPEN);
+    }
+    pthread_mutex_lock(&fatMutex);
+    int result = fclose(filehandle->handle);
+    filehandle->handle = NULL;
+    filehandle->inUse = false;
+    pthread_mutex_unlock(&fatMutex);
+    if(result != 0) {
+        return set_error(F_ERR_WRITE);
+    }
+    return set_error(F_NO_ERROR);
+}
+
+long f_read(void* buf, long size, long size_st, F_FILE* filehandle) {
+    if(filehandle == NULL || !filehandle->inUse) {
+        set_error(F_ERR_NOTOPEN);
+        return 0;
+    }
+    if(size <= 0 || size_st <= 0) {
+        set_error(F_NO_ERROR);
+        return 0;
+    }
+    size_t itemsRead = fread(buf, size, size_st, filehandle->handle);
+    if(ferror(filehandle->handle)) {
+        clearerr(filehandle->handle);
+        set_error(F_ERR_READ);
+    }
+    else {
+        set_error(F_NO_ERROR);
+    }
+    inject_delay(itemsRead * size, config.read_bytes_per_second);
+
+    pthread_mutex_lock(&fatMutex);
+    statistics.bytes_read += itemsRead * size;
+    statistics.read_operations++;
+    pthread_mutex_unlock(&fatMutex);
+    return itemsRead;
+}
+
+long f_write(const void* buf, long size, long size_st, F_FILE* filehandle) {
+    if(filehandle == NULL || !filehandle->inUse) {
+        set_error(F_ERR_NOTOPEN);
+        return 0;
+    }
+    if(!filehandle->writable) {
+        set_error(F_ERR_ACCESSDENIED);
+        return 0;
+    }
+    if(size <= 0 || size_st <= 0) {
+        set_error(F_NO_ERROR);
+        return 0;
+    }
+    size_t itemsWritten = fwrite(buf, size, size_st, filehandle->handle);
+    if(itemsWritten != (size_t) size_st) {
+        clearerr(filehandle->handle);
+        set_error(F_ERR_WRITE);
+    }
+    else {
+        set_error(F_NO_ERROR);
+    }
+    inject_delay(itemsWritten * size, config.write_bytes_per_second);
+
+    pthread_mutex_lock(&fatMutex);
+    statistics.bytes_written += itemsWritten * size;
+    statistics.write_operations++;
+    pthread_mutex_unlock(&fatMutex);
+    return itemsWritten;
+}
+
+int f_seek(F_FILE* filehandle, long offset, long whence) {
+    if(filehandle == NULL || !filehandle->inUse) {
+        return set_error(F_ERR_NOTOPEN);
+    }
+    int hostWhence = SEEK_SET;
+    switch(whence) {
+    case(F_SEEK_SET): {
+        hostWhence = SEEK_SET;
+        break;
+    }
+    case(F_SEEK_CUR): {
+        hostWhence = SEEK_CUR;
+        break;
+    }
+    case(F_SEEK_END): {
+        hostWhence = SEEK_END;
+        break;
+    }
+    default: {
+        return set_error(F_ERR_NOTUSEABLE);
+    }
+    }
+    if(fseek(filehandle->handle, offset, hostWhence) != 0) {
+        return set_error(F_ERR_INVALIDPOS);
+    }
+    return set_error(F_NO_ERROR);
+}
+
+long f_tell(F_FILE* filehandle) {
+    if(filehandle == NULL || !filehandle->inUse) {
+        set_error(F_ERR_NOTOPEN);
+        return 0;
+    }
+    set_error(F_NO_ERROR);
+    return ftell(filehandle->handle);
+}
+
+int f_eof(F_FILE* filehandle) {
+    if(filehandle == NULL || !filehandle->inUse) {
+        set_error(F_ERR_NOTOPEN);
+        return 1;
+    }
+    /* The HCC library reports the end of file as soon as the position reaches the file size */
+    long position = ftell(filehandle->handle);
+    fflush(filehandle->handle);
+    struct stat info;
+    if(fstat(fileno(filehandle->handle), &info) != 0) {
+        return 1;
+    }
+    return position >= info.st_size;
+}
+
+int f_flush(F_FILE* filehandle) {
+    if(filehandle == NULL || !filehandle->inUse) {
+        return set_error(F_ERR_NOTOPEN);
+    }
+    if(fflush(filehandle->handle) != 0) {
+        return set_error(F_ERR_WRITE);
+    }
+    return set_error(F_NO_ERROR);
+}
+
+long f_filelength(const char* filename) {
+    HostPath path;
+    int result = resolve_path(filename, &path);
+    if(result != F_NO_ERROR) {
+        set_error(result);
+        return -1;
+    }
+    if(!path.exists || S_ISDIR(path.info.st_mode)) {
+        set_error(F_ERR_NOTFOUND);
+        return -1;
+    }
+    /* Data written to open files is visible immediately on the target */
+    pthread_mutex_lock(&fatMutex);
+    flush_writers(path.hostPath);
+    pthread_mutex_unlock(&fatMutex);
+    if(stat(path.hostPath, &path.info) != 0) {
+        set_error(F_ERR_NOTFOUND);
+        return -1;
+    }
+    set_error(F_NO_ERROR);
+    return path.info.st_size;
+}
+
+F_FILE* f_truncate(const char* filename, long length) {
+    if(length < 0) {
+        set_error(F_ERR_INVALIDPOS);
+        return NULL;
+    }
+    F_FILE* file = f_open(filename, "r+");
+    if(file == NULL) {
+        return NULL;
+    }
+    if(ftruncate(fileno(file->handle), length) != 0 ||
+            fseek(file->handle, 0, SEEK_END) != 0) {
+        f_close(file);
+        set_error(F_ERR_WRITE);
+        return NULL;
+    }
+    set_error(F_NO_ERROR);
+    return file;
+}
+
+int f_delete(const char* filename) {
+    HostPath path;
+    int result = resolve_path(filename, &path);
+    if(result != F_NO_ERROR) {
+        return set_error(result);
+    }
+    if(!path.exists) {
+        return set_error(F_ERR_NOTFOUND);
+    }
+    if(S_ISDIR(path.info.st_mode)) {
+        return set_error(F_ERR_INVALIDDIR);
+    }
+    if((path.info.st_mode & S_IWUSR) == 0) {
+        return set_error(F_ERR_ACCESSDENIED);
+    }
+
+    pthread_mutex_lock(&fatMutex);
+    if(is_open(path.hostPath, false)) {
+        pthread_mutex_unlock(&fatMutex);
+        return set_error(F_ERR_LOCKED);
+    }
+    result = F_NO_ERROR;
+    if(unlink(path.hostPath) != 0) {
+        result = map_errno(errno);
+    }
+    pthread_mutex_unlock(&fatMutex);
+    return set_error(result);
+}
+
+int f_rename(const char* filename, const char* newname) {
+    if(newname == NULL || newname[0] == '\0' || strpbrk(newname, "/\\:") != NULL) {
+        return set_error(F_ERR_INVALIDNAME);
+    }
+    HostPath path;
+    int result = resolve_path(filename, &path);
+    if(result != F_NO_ERROR) {
+        return set_error(result);
+    }
+    if(!path.exists) {
+        return set_error(F_ERR_NOTFOUND);
+    }
+
+    /* The new name is always located in the same directory */
+    char target[F_MAXPATH];
+    size_t parentLength = path.leafName - path.virtualPath;
+    if(parentLength + strlen(newname) + 3 >= sizeof(target)) {
+        return set_error(F_ERR_TOOLONGNAME);
+    }
+    snprintf(target, sizeof(target), "%c:%.*s%s", 'A' + path.drive, (int) parentLength,
+            path.virtualPath, newname);
+    return f_move(filename, target);
+}
+
+int f_move(const char* filename, const char* newname) {
+    HostPath source;
+    int result = resolve_path(filename, &source);
+    if(result != F_NO_ERROR) {
+        return set_error(result);
+    }
+    if(!source.exists) {
+        return set_error(F_ERR_NOTFOUND);
+    }
+    HostPath target;
+    result = resolve_path(newname, &target);
+    if(result != F_NO_ERROR) {
+        return set_error(result);
+    }
+    if(target.drive != source.drive) {
+        return set_error(F_ERR_INVALIDDRIVE);
+    }
+    if(!target.parentExists) {
+        return set_error(F_ERR_INVALIDDIR);
+    }
+    /* Only a change of the case of the same entry is allowed for existing targets */
+    if(target.exists && (target.info.st_ino != source.info.st_ino ||
+            target.info.st_dev != source.info.st_dev)) {
+        return set_error(F_ERR_DUPLICATED);
+    }
+    if(S_ISDIR(source.info.st_mode) && strncmp(target.virtualPath, source.virtualPath,
+            strlen(source.virtualPath)) == 0 && target.virtualPath[
+            strlen(source.virtualPath)] == '/') {
+        return set_error(F_ERR_INVALIDDIR);
+    }
+    if(target.exists) {
+        /* Keep the case of the new name */
+        char* leaf = strrchr(target.hostPath, '/');
+        if(leaf != NULL) {
+            leaf[1] = '\0';
+            strncat(target.hostPath, target.leafName,
+                    sizeof(target.hostPath) - strlen(target.hostPath) - 1);
+        }
+    }
+
+    pthread_mutex_lock(&fatMutex);
+    if(is_open(source.hostPath, false)) {
+        pthread_mutex_unlock(&fatMutex);
+        return set_error(F_ERR_LOCKED);
+    }
+    result = F_NO_ERROR;
+    if(rename(source.hostPath, target.hostPath) != 0) {
+        result = map_errno(errno);
+    }
+    pthread_mutex_unlock(&fatMutex);
+    return set_error(result);
+}
+
+int f_getattr(const char* filename, unsigned char* attr) {
+    if(attr == NULL) {
+        return set_error(F_ERR_NOTUSEABLE);
+    }
+    HostPath path;
+    int result = resolve_path(filename, &path);
+    if(result != F_NO_ERROR) {
+        return set_error(result);
+    }
+    if(!path.exists) {
+        return set_error(F_ERR_NOTFOUND);
+    }
+    *attr = S_ISDIR(path.info.st_mode) ? F_ATTR_DIR : F_ATTR_ARC;
+    if((path.info.st_mode & S_IWUSR) == 0) {
+        *attr |= F_ATTR_READONLY;
+    }
+    return set_error(F_NO_ERROR);
+}
+
+int f_setattr(const char* filename, unsigned char attr) {
+    HostPath path;
+    int result = resolve_path(filename, &path);
+    if(result != F_NO_ERROR) {
+        return set_error(result);
+    }
+    if(!path.exists) {
+        return set_error(F_ERR_NOTFOUND);
+    }
+    /* Only the read-only attribute is mapped to the host file system */
+    mode_t mode = path.info.st_mode & 0777;
+    if(attr & F_ATTR_READONLY) {
+        mode &= ~(S_IWUSR | S_IWGRP | S_IWOTH);
+    }
+    else {
+        mode |= S_IWUSR;
+    }
+    if(chmod(path.hostPath, mode) != 0) {
+        return set_error(map_errno(errno));
+    }
+    return set_error(F_NO_ERROR);
+}
+
+int f_gettimedate(const char* filename, unsigned short* pctime, unsigned short* pcdate) {
+    HostPath path;
+    int result = resolve_path(filename, &path);
+    if(result != F_NO_ERROR) {
+        return set_error(result);
+    }
+    if(!path.exists) {
+        return set_error(F_ERR_NOTFOUND);
+    }
+    F_FIND entry;
+    char* leaf = strrchr(path.hostPath, '/');
+    if(leaf == NULL) {
+        return set_error(F_ERR_NOTFOUND);
+    }
+    *leaf = '\0';
+    fill_find_entry(&entry, path.hostPath, leaf + 1);
+    if(pctime != NULL) {
+        *pctime = entry.ctime;
+    }
+    if(pcdate != NULL) {
+        *pcdate = entry.cdate;
+    }
+    return set_error(F_NO_ERROR);
+}
+
+int f_mkdir(const char* dirname) {
+    HostPath path;
+    int result = resolve_path(dirname, &path);
+    if(result != F_NO_ERROR) {
+        return set_error(result);
+    }
+    if(path.exists) {
+        return set_error(F_ERR_DUPLICATED);
+    }
+    if(!path.parentExists) {
+        return set_error(F_ERR_INVALIDDIR);
+    }
+    if(mkdir(path.hostPath, 0775) != 0) {
+        return set_error(map_errno(errno));
+    }
+    return set_error(F_NO_ERROR);
+}
+
+int f_rmdir(const char* dirname) {
+    HostPath path;
+    int result = resolve_path(dirname, &path);
+    if(result != F_NO_ERROR) {
+        return set_error(result);
+    }
+    if(!path.exists) {
+        return set_error(F_ERR_NOTFOUND);
+    }
+    if(!S_ISDIR(path.info.st_mode) || path.virtualPath[0] == '\0') {
+        return set_error(F_ERR_INVALIDDIR);
+    }
+    if(rmdir(path.hostPath) != 0) {
+        if(errno == ENOTEMPTY || errno == EEXIST) {
+            return set_error(F_ERR_NOTEMPTY);
+        }
+        return set_error(map_errno(errno));
+    }
+    return set_error(F_NO_ERROR);
+}
+
+int f_chdir(const char* dirname) {
+    HostPath path;
+    int result = resolve_path(dirname, &path);
+    if(result != F_NO_ERROR) {
+        return set_error(result);
+    }
+    if(!path.parentExists) {
+        return set_error(F_ERR_INVALIDDIR);
+    }
+    if(!path.exists) {
+        return set_error(F_ERR_NOTFOUND);
+    }
+    if(!S_ISDIR(path.info.st_mode)) {
+        return set_error(F_ERR_INVALIDDIR);
+    }
+    /* Store the path with the case of the existing directories */
+    pthread_mutex_lock(&fatMutex);
+    size_t rootLength = strlen(drives[path.drive].root);
+    pthread_mutex_unlock(&fatMutex);
+    snprintf(currentDirectory[path.drive], F_MAXPATH, "%s", path.hostPath + rootLength);
+    return set_error(F_NO_ERROR);
+}
+
+int f_getcwd(char* buffer, int maxlen) {
+    if(buffer == NULL || maxlen <= 0) {
+        return set_error(F_ERR_NOTUSEABLE);
+    }
+    const char* cwd = currentDirectory[currentDrive];
+    if(cwd[0] == '\0') {
+        cwd = "/";
+    }
+    if((int) strlen(cwd) >= maxlen) {
+        return set_error(F_ERR_TOOLONGNAME);
+    }
+    strcpy(buffer, cwd);
+    return set_error(F_NO_ERROR);
+}
+
+int f_findfirst(const char* filename, F_FIND* find) {
+    if(filename == NULL || find == NULL) {
+        return set_error(F_ERR_NOTUSEABLE);
+    }
+
+    /* Split the search into the directory and the name pattern */
+    char directory[F_MAXPATH];
+    const char* separator = strrchr(filename, '/');
+    const char* backslash = strrchr(filename, '\\');
+    if(backslash != NULL && (separator == NULL || backslash > separator)) {
+        separator = backslash;
+    }
+    const char* colon = strchr(filename, ':');
+    const char* pattern = filename;
+    if(separator != NULL) {
+        size_t length = separator - filename + 1;
+        if(length >= sizeof(directory)) {
+            return set_error(F_ERR_TOOLONGNAME);
+        }
+        memcpy(directory, filename, length);
+        directory[length] = '\0';
+        pattern = separator + 1;
+    }
+    else if(colon != NULL) {
+        snprintf(directory, sizeof(directory), "%.*s.", (int) (colon - filename + 1), filename);
+        pattern = colon + 1;
+    }
+    else {
+        strcpy(directory, ".");
+    }
+    if(pattern[0] == '\0' || strlen(pattern) >= sizeof(find->host_pattern)) {
+        return set_error(F_ERR_INVALIDNAME);
+    }
+
+    HostPath path;
+    int result = resolve_path(directory, &path);
+    if(result != F_NO_ERROR) {
+        return set_error(result);
+    }
+    if(!path.exists || !S_ISDIR(path.info.st_mode)) {
+        return set_error(F_ERR_INVALIDDIR);
+    }
+
+    memset(find, 0, sizeof(F_FIND));
+    snprintf(find->host_directory, sizeof(find->host_directory), "%c:%s", 'A' + path.drive,
+            path.virtualPath[0] == '\0' ? "/" : path.virtualPath);
+    strcpy(find->host_pattern, pattern);
+    find->host_position = 0;
+
+    HostSearch* search = get_search(find);
+    /* The F_FIND may be reused for a new search while the previous one is still open */
+    if(search->dir != NULL) {
+        closedir(search->dir);
+    }
+    search->dir = opendir(path.hostPath);
+    if(search->dir == NULL) {
+        search->owner = NULL;
+        return set_error(map_errno(errno));
+    }
+    strncpy(search->hostDirectory, path.hostPath, sizeof(search->hostDirectory) - 1);
+    search->position = 0;
+
+    pthread_mutex_lock(&fatMutex);
+    statistics.directory_searches++;
+    pthread_mutex_unlock(&fatMutex);
+    return set_error(continue_search(find));
+}
+
+int f_findnext(F_FIND* find) {
+    if(find == NULL || find->host_directory[0] == '\0') {
+        return set_error(F_ERR_NOTUSEABLE);
+    }
+    HostSearch* search = get_search(find);
+    if(search->dir == NULL || search->position != find->host_position) {
+        /* The directory stream was evicted by other searches, reopen and skip the entries
+        which were already reported */
+        HostPath path;
+        int result = resolve_path(find->host_directory, &path);
+        if(result != F_NO_ERROR) {
+            search->owner = NULL;
+            return set_error(result);
+        }
+        if(search->dir != NULL) {
+            closedir(search->dir);
+        }
+        search->dir = opendir(path.hostPath);
+        if(search->dir == NULL) {
+            search->owner = NULL;
+            return set_error(F_ERR_NOTFOUND);
+        }
+        strncpy(search->hostDirectory, path.hostPath, sizeof(search->hostDirectory) - 1);
+        long synthetic = path.virtualPath[0] == '\0' ? 0 : 2;
+        long skipped = 0;
+        while(skipped < find->host_position - synthetic) {
+            struct dirent* entry = readdir(search->dir);
+            if(entry == NULL) {
+                break;
+            }
+            if(strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+                continue;
+            }
+            skipped++;
+        }
+        search->position = find->host_position;
+    }
+    return set_error(continue_search(find));
+}
+
+static int continue_search(F_FIND* find) {
+    HostSearch* search = get_search(find);
+    /* Subdirectories report the . and .. entries first, like the FAT file system */
+    bool isRoot = strcmp(find->host_directory + 2, "/") == 0;
+    while(true) {
+        const char* name = NULL;
+        if(!isRoot && find->host_position == 0) {
+            name = ".";
+        }
+        else if(!isRoot && find->host_position == 1) {
+            name = "..";
+        }
+        else {
+            struct dirent* entry = readdir(search->dir);
+            if(entry == NULL) {
+                closedir(search->dir);
+                search->dir = NULL;
+                search->owner = NULL;
+                return F_ERR_NOTFOUND;
+            }
+            if(strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+                continue;
+            }
+            name = entry->d_name;
+        }
+        find->host_position++;
+        search->position = find->host_position;
+        if(matches_pattern(name, find->host_pattern)) {
+            fill_find_entry(find, search->hostDirectory, name);
+            return F_NO_ERROR;
+        }
+    }
+}
+
+static HostSearch* get_search(F_FIND* find) {
+    HostSearch* oldest = &searches[0];
+    for(size_t idx = 0; idx < HOST_FAT_MAX_SEARCHES; idx++) {
+        if(searches[idx].owner == find) {
+            searches[idx].lastUse = ++searchCounter;
+            return &searches[idx];
+        }
+        if(searches[idx].owner == NULL) {
+            oldest = &searches[idx];
+            oldest->lastUse = 0;
+        }
+        else if(oldest->owner != NULL && searches[idx].lastUse < oldest->lastUse) {
+            oldest = &searches[idx];
+        }
+    }
+    if(oldest->dir != NULL) {
+        closedir(oldest->dir);
+    }
+    memset(oldest, 0, sizeof(HostSearch));
+    oldest->owner = find;
+    oldest->lastUse = ++searchCounter;
+    /* Forces a reopen in f_findnext */
+    oldest->position = -1;
+    return oldest;
+}
+
+static void fill_find_entry(F_FIND* find, const char* hostDirectory, const char* name) {
+    char hostPath[PATH_MAX];
+    snprintf(hostPath, sizeof(hostPath), "%s/%s", hostDirectory, name);
+    strncpy(find->filename, name, sizeof(find->filename) - 1);
+    find->filename[sizeof(find->filename) - 1] = '\0';
+
+    struct stat info;
+    if(stat(hostPath, &info) != 0) {
+        memset(&info, 0, sizeof(info));
+    }
+    find->attr = S_ISDIR(info.st_mode) ? F_ATTR_DIR : F_ATTR_ARC;
+    if((info.st_mode & S_IWUSR) == 0) {
+        find->attr |= F_ATTR_READONLY;
+    }
+    find->filesize = S_ISDIR(info.st_mode) ? 0 : info.st_size;
+
+    /* FAT time and date format */
+    struct tm timeInfo;
+    time_t modificationTime = info.st_mtime;
+    localtime_r(&modificationTime, &timeInfo);
+    int year = timeInfo.tm_year + 1900 < 1980 ? 0 : timeInfo.tm_year + 1900 - 1980;
+    find->ctime = (timeInfo.tm_hour << 11) | (timeInfo.tm_min << 5) | (timeInfo.tm_sec / 2);
+    find->cdate = (year << 9) | ((timeInfo.tm_mon + 1) << 5) | timeInfo.tm_mday;
+}
+
+static int set_error(int error) {
+    lastError = error;
+    return error;
+}
+
+static const char* get_root_path(void) {
+    if(rootPath[0] != '\0') {
+        return rootPath;
+    }
+    const char* root = config.root_path;
+    if(root == NULL) {
+        root = getenv(HOST_FAT_ROOT_ENV);
+    }
+    if(root == NULL || root[0] == '\0') {
+        root = HOST_FAT_DEFAULT_ROOT;
+    }
+    strncpy(rootPath, root, sizeof(rootPath) - 1);
+    size_t length = strlen(rootPath);
+    while(length > 1 && rootPath[length - 1] == '/') {
+        rootPath[--length] = '\0';
+    }
+    return rootPath;
+}
+
+static int check_drive(int drive) {
+    if(drive < 0 || drive >= HOST_FAT_MAX_DRIVES) {
+        return F_ERR_INVALIDDRIVE;
+    }
+    pthread_mutex_lock(&fatMutex);
+    DriveState state = drives[drive].state;
+    pthread_mutex_unlock(&fatMutex);
+    if(state == DRIVE_UNMOUNTED) {
+        return F_ERR_INVALIDDRIVE;
+    }
+    if(state == DRIVE_NOT_FORMATTED) {
+        return F_ERR_NOTFORMATTED;
+    }
+    return F_NO_ERROR;
+}
+
+static bool lookup_entry(const char* hostDirectory, const char* name, char* realName,
+        size_t maxLength) {
+    char hostPath[PATH_MAX];
+    struct stat info;
+    snprintf(hostPath, sizeof(hostPath), "%s/%s", hostDirectory, name);
+    if(lstat(hostPath, &info) == 0) {
+        snprintf(realName, maxLength, "%s", name);
+        return true;
+    }
+
+    /* FAT names are case-insensitive */
+    DIR* dir = opendir(hostDirectory);
+    if(dir == NULL) {
+        return false;
+    }
+    bool found = false;
+    struct dirent* entry = NULL;
+    while((entry = readdir(dir)) != NULL) {
+        if(strcasecmp(entry->d_name, name) == 0) {
+            snprintf(realName, maxLength, "%s", entry->d_name);
+            found = true;
+            break;
+        }
+    }
+    closedir(dir);
+    return found;
+}
+
+static int resolve_path(const char* name, HostPath* path) {
+    memset(path, 0, sizeof(HostPath));
+    if(name == NULL || name[0] == '\0') {
+        return F_ERR_INVALIDNAME;
+    }
+    path->drive = currentDrive;
+    if(isalpha((unsigned char) name[0]) && name[1] == ':') {
+        path->drive = toupper((unsigned char) name[0]) - 'A';
+        name += 2;
+    }
+    int result = check_drive(path->drive);
+    if(result != F_NO_ERROR) {
+        return result;
+    }
+
+    /* Build the normalized path relative to the drive root */
+    size_t length = 0;
+    if(name[0] != '/' && name[0] != '\\') {
+        strcpy(path->virtualPath, currentDirectory[path->drive]);
+        length = strlen(path->virtualPath);
+    }
+    const char* component = name;
+    while(*component != '\0') {
+        size_t componentLength = strcspn(component, "/\\");
+        if(componentLength == 1 && component[0] == '.') {
+            /* Nothing to do */
+        }
+        else if(componentLength == 2 && component[0] == '.' && component[1] == '.') {
+            char* parent = strrchr(path->virtualPath, '/');
+            if(parent != NULL) {
+                *parent = '\0';
+                length = parent - path->virtualPath;
+            }
+        }
+        else if(componentLength > 0) {
+            if(length + componentLength + 1 >= sizeof(path->virtualPath)) {
+                return F_ERR_TOOLONGNAME;
+            }
+            path->virtualPath[length++] = '/';
+            memcpy(path->virtualPath + length, component, componentLength);
+            length += componentLength;
+            path->virtualPath[length] = '\0';
+        }
+        component += componentLength;
+        if(*component != '\0') {
+            component++;
+        }
+    }
+
+    /* Map every component to the host file system */
+    pthread_mutex_lock(&fatMutex);
+    strncpy(path->hostPath, drives[path->drive].root, sizeof(path->hostPath) - 1);
+    pthread_mutex_unlock(&fatMutex);
+    bool reachable = true;
+    path->parentExists = true;
+    path->leafName = path->virtualPath + length;
+    const char* next = path->virtualPath;
+    while(*next == '/') {
+        const char* current = next + 1;
+        const char* end = strchr(current, '/');
+        size_t componentLength = end == NULL ? strlen(current) : (size_t) (end - current);
+        char componentName[F_MAXPATH];
+        memcpy(componentName, current, componentLength);
+        componentName[componentLength] = '\0';
+
+        struct stat info;
+        bool isDirectory = reachable && stat(path->hostPath, &info) == 0 &&
+                S_ISDIR(info.st_mode);
+        if(end == NULL) {
+            path->parentExists = isDirectory;
+            path->leafName = current;
+        }
+        char realName[NAME_MAX + 1];
+        reachable = isDirectory && lookup_entry(path->hostPath, componentName, realName,
+                sizeof(realName));
+        size_t hostLength = strlen(path->hostPath);
+        if(hostLength + componentLength + 2 >= sizeof(path->hostPath)) {
+            return F_ERR_TOOLONGNAME;
+        }
+        snprintf(path->hostPath + hostLength, sizeof(path->hostPath) - hostLength, "/%s",
+                reachable ? realName : componentName);
+        next = end == NULL ? current + componentLength : end;
+    }
+    path->exists = reachable && lstat(path->hostPath, &path->info) == 0;
+    return F_NO_ERROR;
+}
+
+static bool is_open(const char* hostPath, bool onlyWriters) {
+    for(size_t idx = 0; idx < F_MAXFILES; idx++) {
+        if(files[idx].inUse && (files[idx].writable || !onlyWriters) &&
+                strcmp(files[idx].hostPath, hostPath) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void flush_writers(const char* hostPath) {
+    for(size_t idx = 0; idx < F_MAXFILES; idx++) {
+        if(files[idx].inUse && files[idx].writable &&
+                strcmp(files[idx].hostPath, hostPath) == 0) {
+            fflush(files[idx].handle);
+        }
+    }
+}
+
+static int remove_recursively(const char* hostPath) {
+    struct stat info;
+    if(lstat(hostPath, &info) != 0) {
+        return F_NO_ERROR;
+    }
+    if(!S_ISDIR(info.st_mode)) {
+        return unlink(hostPath) == 0 ? F_NO_ERROR : F_ERR_WRITE;
+    }
+    DIR* dir = opendir(hostPath);
+    if(dir == NULL) {
+        return F_ERR_WRITE;
+    }
+    int result = F_NO_ERROR;
+    struct dirent* entry = NULL;
+    while((entry = readdir(dir)) != NULL) {
+        if(strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+        char childPath[PATH_MAX];
+        snprintf(childPath, sizeof(childPath), "%s/%s", hostPath, entry->d_name);
+        if(remove_recursively(childPath) != F_NO_ERROR) {
+            result = F_ERR_WRITE;
+        }
+    }
+    closedir(dir);
+    if(rmdir(hostPath) != 0) {
+        result = F_ERR_WRITE;
+    }
+    return result;
+}
+
+static bool matches_pattern(const char* name, const char* pattern) {
+    /* "*.*" also matches names without an extension on FAT file systems */
+    if(strcmp(pattern, "*.*") == 0) {
+        return true;
+    }
+    const char* backtrackPattern = NULL;
+    const char* backtrackName = NULL;
+    while(*name != '\0') {
+        if(*pattern == '*') {
+            backtrackPattern = ++pattern;
+            backtrackName = name;
+        }
+        else if(*pattern == '?' || tolower((unsigned char) *pattern) ==
+                tolower((unsigned char) *name)) {
+            pattern++;
+            name++;
+        }
+        else if(backtrackPattern != NULL) {
+            pattern = backtrackPattern;
+            name = ++backtrackName;
+        }
+        else {
+            return false;
+        }
+    }
+    while(*pattern == '*') {
+        pattern++;
+    }
+    return *pattern == '\0';
+}
+
+static void inject_delay(size_t bytes, uint32_t bytesPerSecond) {
+    uint64_t delayUs = config.access_latency_us;
+    if(bytesPerSecond > 0) {
+        delayUs += (uint64_t) bytes * 1000000 / bytesPerSecond;
+    }
+    if(delayUs == 0) {
+        return;
+    }
+    struct timespec delay = { (time_t) (delayUs / 1000000), (long) (delayUs % 1000000) * 1000 };
+    while(nanosleep(&delay, &delay) != 0 && errno == EINTR) {
+    }
+}
+
+static int map_errno(int error) {
+    switch(error) {
+    case(ENOENT): {
+        return F_ERR_NOTFOUND;
+    }
+    case(EEXIST): {
+        return F_ERR_DUPLICATED;
+    }
+    case(ENOTDIR): {
+        return F_ERR_INVALIDDIR;
+    }
+    case(ENOTEMPTY): {
+        return F_ERR_NOTEMPTY;
+    }
+    case(EACCES):
+    case(EPERM):
+    case(EROFS): {
+        return F_ERR_ACCESSDENIED;
+    }
+    case(ENAMETOOLONG): {
+        return F_ERR_TOOLONGNAME;
+    }
+    case(EMFILE):
+    case(ENFILE): {
+        return F_ERR_NOMOREENTRY;
+    }
+    case(ENOSPC): {
+        return F_ERR_WRITE;
+    }
+    default: {
+        return F_ERR_UNKNOWN;
+    }
+    }
+}
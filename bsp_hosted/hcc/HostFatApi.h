@@ -0,0 +1,58 @@
+#ifndef BSP_HOSTED_HCC_HOSTFATAPI_H_
+#define BSP_HOSTED_HCC_HOSTFATAPI_H_
+
+/**
+ * @brief   Host specific extensions of the POSIX stand-in for the HCC FAT API.
+ * @details
+ * Every SD card is represented by a directory <root>/SD_CARD_<n>. The root directory is taken
+ * from the configuration passed to host_fat_configure, the HCC_HOST_ROOT environment variable
+ * or ./hcc_host_fs, in that order. A volume directory which does not exist yet is reported as
+ * not formatted by f_initvolume and created by f_format, like a fresh SD card on the target.
+ *
+ * File and directory names are looked up case-insensitively and stored with the case they
+ * were created with. Access latency and throughput limits can be injected to get timing
+ * closer to the SD cards of the iOBC when testing time-sliced file operations.
+ */
+#include <hcc/api_fat.h>
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HOST_FAT_MAX_DRIVES             2
+
+typedef struct {
+    /* Directory containing the SD card directories, NULL to use the default */
+    const char* root_path;
+    /* Delay added to every read and write call */
+    uint32_t access_latency_us;
+    /* Throughput limits, 0 for no limit */
+    uint32_t read_bytes_per_second;
+    uint32_t write_bytes_per_second;
+} HostFatConfig;
+
+typedef struct {
+    uint64_t bytes_read;
+    uint64_t bytes_written;
+    uint32_t read_operations;
+    uint32_t write_operations;
+    uint32_t files_opened;
+    uint32_t directory_searches;
+} HostFatStatistics;
+
+/**
+ * Configure the host file system. Should be called before the first volume is initialized.
+ * @param config
+ */
+void host_fat_configure(const HostFatConfig* config);
+
+void host_fat_get_statistics(HostFatStatistics* statistics);
+void host_fat_reset_statistics(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BSP_HOSTED_HCC_HOSTFATAPI_H_ */
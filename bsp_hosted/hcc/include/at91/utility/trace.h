@@ -0,0 +1,21 @@
+#ifndef BSP_HOSTED_AT91_UTILITY_TRACE_H_
+#define BSP_HOSTED_AT91_UTILITY_TRACE_H_
+
+/**
+ * Host stand-in for the AT91 trace macros used by the SD card and virtual FRAM API.
+ * Warnings and errors are printed to stderr, debug and info output is discarded.
+ */
+#include <stdio.h>
+
+#define TRACE_DEBUG(...)
+#define TRACE_INFO(...)
+#define TRACE_WARNING(...)      fprintf(stderr, "-W- " __VA_ARGS__)
+#define TRACE_ERROR(...)        fprintf(stderr, "-E- " __VA_ARGS__)
+#define TRACE_FATAL(...)        fprintf(stderr, "-F- " __VA_ARGS__)
+
+#define TRACE_DEBUG_WP(...)
+#define TRACE_INFO_WP(...)
+#define TRACE_WARNING_WP(...)   fprintf(stderr, __VA_ARGS__)
+#define TRACE_ERROR_WP(...)     fprintf(stderr, __VA_ARGS__)
+
+#endif /* BSP_HOSTED_AT91_UTILITY_TRACE_H_ */
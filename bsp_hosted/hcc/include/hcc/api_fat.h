@@ -0,0 +1,98 @@
+#ifndef BSP_HOSTED_HCC_API_FAT_H_
+#define BSP_HOSTED_HCC_API_FAT_H_
+
+/**
+ * @brief   Host stand-in for the subset of the HCC FAT API used by the OBSW.
+ * @details
+ * The functions are implemented on top of POSIX file operations in HostFatApi.c, with one
+ * directory per SD card. See HostFatApi.h for the host specific configuration.
+ */
+#include "api_fs_err.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define F_MAXPATH           256
+#define F_MAXFILES          32
+
+#define F_ATTR_ARC          0x20
+#define F_ATTR_DIR          0x10
+#define F_ATTR_VOLUME       0x08
+#define F_ATTR_SYSTEM       0x04
+#define F_ATTR_HIDDEN       0x02
+#define F_ATTR_READONLY     0x01
+
+#define F_SEEK_SET          0
+#define F_SEEK_CUR          1
+#define F_SEEK_END          2
+
+#define F_FAT12_MEDIA       1
+#define F_FAT16_MEDIA       2
+#define F_FAT32_MEDIA       3
+
+typedef struct F_FILE F_FILE;
+
+/* Driver handles are not used on the host */
+typedef struct F_DRIVER F_DRIVER;
+typedef F_DRIVER* (*F_DRIVERINIT)(unsigned long driver_param);
+
+typedef struct {
+    char filename[F_MAXPATH];
+    unsigned char attr;
+    unsigned short ctime;
+    unsigned short cdate;
+    unsigned long filesize;
+
+    /* Host search state, do not use */
+    char host_directory[F_MAXPATH + 2];
+    char host_pattern[F_MAXPATH];
+    long host_position;
+} F_FIND;
+
+int fs_init(void);
+int fs_delete(void);
+int f_enterFS(void);
+void f_releaseFS(void);
+int f_getlasterror(void);
+
+int f_initvolume(int drvnumber, F_DRIVERINIT driver_init, unsigned long driver_param);
+int f_delvolume(int drvnumber);
+int f_format(int drvnumber, long fattype);
+int f_chdrive(int drvnumber);
+int f_getdrive(void);
+
+F_FILE* f_open(const char* filename, const char* mode);
+int f_close(F_FILE* filehandle);
+long f_read(void* buf, long size, long size_st, F_FILE* filehandle);
+long f_write(const void* buf, long size, long size_st, F_FILE* filehandle);
+int f_seek(F_FILE* filehandle, long offset, long whence);
+long f_tell(F_FILE* filehandle);
+int f_eof(F_FILE* filehandle);
+int f_flush(F_FILE* filehandle);
+long f_filelength(const char* filename);
+F_FILE* f_truncate(const char* filename, long length);
+
+int f_delete(const char* filename);
+int f_rename(const char* filename, const char* newname);
+int f_move(const char* filename, const char* newname);
+int f_getattr(const char* filename, unsigned char* attr);
+int f_setattr(const char* filename, unsigned char attr);
+int f_gettimedate(const char* filename, unsigned short* pctime, unsigned short* pcdate);
+
+int f_mkdir(const char* dirname);
+int f_rmdir(const char* dirname);
+int f_chdir(const char* dirname);
+int f_getcwd(char* buffer, int maxlen);
+
+int f_findfirst(const char* filename, F_FIND* find);
+int f_findnext(F_FIND* find);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BSP_HOSTED_HCC_API_FAT_H_ */
@@ -0,0 +1,52 @@
+#ifndef BSP_HOSTED_HCC_API_FS_ERR_H_
+#define BSP_HOSTED_HCC_API_FS_ERR_H_
+
+/**
+ * Host stand-in for the HCC error codes. The values are identical to the target library so
+ * error codes in telemetry and log output can be compared directly.
+ */
+enum {
+    F_NO_ERROR = 0,
+    F_ERR_INVALIDDRIVE = 1,
+    F_ERR_NOTFORMATTED = 2,
+    F_ERR_INVALIDDIR = 3,
+    F_ERR_INVALIDNAME = 4,
+    F_ERR_NOTFOUND = 5,
+    F_ERR_DUPLICATED = 6,
+    F_ERR_NOMOREENTRY = 7,
+    F_ERR_NOTOPEN = 8,
+    F_ERR_EOF = 9,
+    F_ERR_RESERVED = 10,
+    F_ERR_NOTUSEABLE = 11,
+    F_ERR_LOCKED = 12,
+    F_ERR_ACCESSDENIED = 13,
+    F_ERR_NOTEMPTY = 14,
+    F_ERR_INITFUNC = 15,
+    F_ERR_CARDREMOVED = 16,
+    F_ERR_ONDRIVE = 17,
+    F_ERR_INVALIDSECTOR = 18,
+    F_ERR_READ = 19,
+    F_ERR_WRITE = 20,
+    F_ERR_INVALIDMEDIA = 21,
+    F_ERR_BUSY = 22,
+    F_ERR_WRITEPROTECT = 23,
+    F_ERR_INVFATTYPE = 24,
+    F_ERR_MEDIATOOSMALL = 25,
+    F_ERR_MEDIATOOLARGE = 26,
+    F_ERR_NOTSUPPSECTORSIZE = 27,
+    F_ERR_UNKNOWN = 28,
+    F_ERR_DRVALREADYMNT = 29,
+    F_ERR_TOOLONGNAME = 30,
+    F_ERR_NOTFORREAD = 31,
+    F_ERR_DELFUNC = 32,
+    F_ERR_ALLOCATION = 33,
+    F_ERR_INVALIDPOS = 34,
+    F_ERR_NOMORETASK = 35,
+    F_ERR_NOTAVAILABLE = 36,
+    F_ERR_TASKNOTFOUND = 37,
+    F_ERR_UNUSABLE = 38,
+    F_ERR_CRCERROR = 39,
+    F_ERR_CARDCHANGED = 40
+};
+
+#endif /* BSP_HOSTED_HCC_API_FS_ERR_H_ */
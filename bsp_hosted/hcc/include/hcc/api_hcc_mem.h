@@ -0,0 +1,16 @@
+#ifndef BSP_HOSTED_HCC_API_HCC_MEM_H_
+#define BSP_HOSTED_HCC_API_HCC_MEM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The host stand-in does not need a dedicated memory pool */
+int hcc_mem_init(void);
+int hcc_mem_delete(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BSP_HOSTED_HCC_API_HCC_MEM_H_ */
@@ -0,0 +1,17 @@
+#ifndef BSP_HOSTED_HCC_API_MDRIVER_ATMEL_MCIPDC_H_
+#define BSP_HOSTED_HCC_API_MDRIVER_ATMEL_MCIPDC_H_
+
+#include "api_fat.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Only provided so the SD card API links, the driver parameter selects the volume directory */
+F_DRIVER* atmel_mcipdc_initfunc(unsigned long driver_param);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BSP_HOSTED_HCC_API_MDRIVER_ATMEL_MCIPDC_H_ */
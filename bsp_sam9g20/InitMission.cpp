@@ -6,6 +6,7 @@
 #include "objects/systemObjectList.h"
 
 #include <mission/utility/InitMission.h>
+#include <mission/utility/TaskMonitor.h>
 #include <bsp_sam9g20/utility/compile_time.h>
 
 #include <fsfw/objectmanager/ObjectManager.h>
@@ -280,6 +281,30 @@ void initTasks(void) {
         initmission::printAddObjectError("internal error reporter",
                 objects::INTERNAL_ERROR_REPORTER);
     }
+#if OBSW_MONITOR_TASK_TIMING == 1
+    result = lowPriorityTask->addComponent(objects::TASK_TIMING_MONITOR);
+    if (result != HasReturnvaluesIF::RETURN_OK) {
+        initmission::printAddObjectError("Task timing monitor", objects::TASK_TIMING_MONITOR);
+    }
+#endif
+#if OBSW_MONITOR_TASK_STACKS == 1
+    result = lowPriorityTask->addComponent(objects::TASK_STACK_MONITOR);
+    if (result != HasReturnvaluesIF::RETURN_OK) {
+        initmission::printAddObjectError("Task stack monitor", objects::TASK_STACK_MONITOR);
+    }
+#endif
+#if OBSW_ENABLE_TRACE == 1
+    result = lowPriorityTask->addComponent(objects::TRACE_BUFFER_HANDLER);
+    if (result != HasReturnvaluesIF::RETURN_OK) {
+        initmission::printAddObjectError("Trace buffer handler", objects::TRACE_BUFFER_HANDLER);
+    }
+#endif
+#if OBSW_DEFERRED_LOGGING == 1
+    result = lowPriorityTask->addComponent(objects::DEFERRED_LOGGER);
+    if (result != HasReturnvaluesIF::RETURN_OK) {
+        initmission::printAddObjectError("Deferred logger", objects::DEFERRED_LOGGER);
+    }
+#endif
 
     /* PUS File Management */
     PeriodicTaskIF* pusFileManagement = taskFactory->
@@ -302,6 +327,23 @@ void initTasks(void) {
     if (result != HasReturnvaluesIF::RETURN_OK) {
         initmission::printAddObjectError("SD Card Handler", objects::SD_CARD_HANDLER);
     }
+    /* Reads, writes and deletions are performed in the background by the I/O worker */
+    PeriodicTaskIF* sdCardIoTask = taskFactory->createPeriodicTask(
+            "SD_IO_WORKER", 2, 2048 * 4, 0.2, genericMissedDeadlineFunc);
+    result = sdCardIoTask->addComponent(objects::SD_CARD_IO_WORKER);
+    if (result != HasReturnvaluesIF::RETURN_OK) {
+        initmission::printAddObjectError("SD Card I/O Worker", objects::SD_CARD_IO_WORKER);
+    }
+
+#ifdef ISIS_OBC_G20
+    /* Keeps the inactive SD card in sync in the background */
+    PeriodicTaskIF* sdCardMirrorTask = taskFactory->createPeriodicTask(
+            "SD_MIRROR", 1, 2048 * 4, 1, genericMissedDeadlineFunc);
+    result = sdCardMirrorTask->addComponent(objects::SD_CARD_MIRROR);
+    if (result != HasReturnvaluesIF::RETURN_OK) {
+        initmission::printAddObjectError("SD Card Mirror", objects::SD_CARD_MIRROR);
+    }
+#endif
 
     /* Software image task */
     PeriodicTaskIF* softwareImageTask = taskFactory->createPeriodicTask(
@@ -355,6 +397,39 @@ void initTasks(void) {
     }
 #endif
 
+#if OBSW_MONITOR_TASK_TIMING == 1 || OBSW_MONITOR_TASK_STACKS == 1
+    /* Tasks watched by the task timing and task stack monitors. Each task is identified by
+    the object ID of one of its components in the housekeeping sets. */
+#if OBSW_ENABLE_ETHERNET == 1 && OBSW_USE_ETHERNET_TMTC_BRIDGE == 1
+    TaskMonitor::insertPeriodicTask(objects::EMAC_POLLING_TASK, tmTcPollingTask);
+    TaskMonitor::insertPeriodicTask(objects::UDP_TMTC_BRIDGE, tmTcBridge);
+#else
+    TaskMonitor::insertPeriodicTask(objects::SERIAL_POLLING_TASK, tmTcPollingTask);
+    TaskMonitor::insertPeriodicTask(objects::SERIAL_TMTC_BRIDGE, tmTcBridge);
+#endif
+    TaskMonitor::insertPeriodicTask(objects::CCSDS_PACKET_DISTRIBUTOR, packetDistributorTask);
+    TaskMonitor::insertFixedTimeslotTask(objects::PCDU_HANDLER, pollingSequenceTableTaskDefault);
+    TaskMonitor::insertPeriodicTask(objects::EVENT_MANAGER, eventManager);
+    TaskMonitor::insertPeriodicTask(objects::PUS_SERVICE_1_VERIFICATION, pusService1);
+    TaskMonitor::insertPeriodicTask(objects::PUS_SERVICE_5_EVENT_REPORTING, pusService05);
+    TaskMonitor::insertPeriodicTask(objects::PUS_SERVICE_2_DEVICE_ACCESS, PusHighPriorityTask);
+    TaskMonitor::insertPeriodicTask(objects::PUS_SERVICE_3_HOUSEKEEPING, pusMediumPriorityTask);
+    TaskMonitor::insertPeriodicTask(objects::PUS_SERVICE_20_PARAMETERS, lowPriorityTask);
+    TaskMonitor::insertPeriodicTask(objects::PUS_SERVICE_23_FILE_MGMT, pusFileManagement);
+    TaskMonitor::insertPeriodicTask(objects::SD_CARD_HANDLER, sdCardTask);
+    TaskMonitor::insertPeriodicTask(objects::SD_CARD_IO_WORKER, sdCardIoTask);
+#ifdef ISIS_OBC_G20
+    TaskMonitor::insertPeriodicTask(objects::SD_CARD_MIRROR, sdCardMirrorTask);
+#endif
+    TaskMonitor::insertPeriodicTask(objects::SOFTWARE_IMAGE_HANDLER, softwareImageTask);
+    TaskMonitor::insertPeriodicTask(objects::CORE_CONTROLLER, coreController);
+    TaskMonitor::insertPeriodicTask(objects::SYSTEM_STATE_TASK, systemStateTask);
+    TaskMonitor::insertPeriodicTask(objects::THERMAL_CONTROLLER, thermalController);
+#if OBSW_ADD_SPI_TEST_TASK == 0
+    TaskMonitor::insertPeriodicTask(objects::SPI_DEVICE_COM_IF, spiComTask);
+#endif
+#endif
+
 #if OBSW_PERFORM_INTERNAL_UNIT_TESTS == 1
     InternalUnitTester unitTestClass;
     InternalUnitTester::TestConfig testConfig;
@@ -398,6 +473,10 @@ void initTasks(void) {
     lowPriorityTask -> startTask();
 
     sdCardTask -> startTask();
+    sdCardIoTask -> startTask();
+#ifdef ISIS_OBC_G20
+    sdCardMirrorTask -> startTask();
+#endif
     softwareImageTask -> startTask();
 
     coreController->startTask();
@@ -31,9 +31,11 @@
 
 /* Mission includes */
 #include "mission/controller/ThermalController.h"
+#include "mission/memory/MonitoredPoolManager.h"
 #include "mission/pus/Service6MemoryManagement.h"
 #include "mission/pus/Service17CustomTest.h"
 #include "mission/pus/Service23FileManagement.h"
+#include "mission/utility/DeferredLogger.h"
 #include "mission/utility/TmFunnel.h"
 #include "mission/devices/PCDUHandler.h"
 #include "mission/devices/GPSHandler.h"
@@ -65,8 +67,13 @@
 #include "bsp_sam9g20/core/CoreController.h"
 #include "bsp_sam9g20/core/SoftwareImageHandler.h"
 #include "bsp_sam9g20/core/SystemStateTask.h"
+#include "bsp_sam9g20/core/TaskStackMonitor.h"
+#include "bsp_sam9g20/core/TaskTimingMonitor.h"
+#include "bsp_sam9g20/core/TraceBufferHandler.h"
 #include "bsp_sam9g20/memory/FRAMHandler.h"
 #include "bsp_sam9g20/memory/SDCardHandler.h"
+#include "bsp_sam9g20/memory/SDCardIoWorker.h"
+#include "bsp_sam9g20/memory/SDCardMirror.h"
 #include "bsp_sam9g20/pus/Service9CustomTimeManagement.h"
 #include "bsp_sam9g20/boardtest/LedTask.h"
 #include "bsp_sam9g20/boardtest/PVCHTestTask.h"
@@ -96,13 +103,14 @@ void Factory::produce(void* args) {
     new HealthTable(objects::HEALTH_TABLE);
     new InternalErrorReporter(objects::INTERNAL_ERROR_REPORTER);
 
-    /* Pool manager handles storage und mutexes */
+    /* Pool manager handles storage und mutexes. The subpool statistics of the stores are
+    reported by the core controller and can be used to size the subpools. */
     {
         LocalPool::LocalPoolConfig poolConfig = {
                 {250, 32}, {120, 64}, {100, 128}, {50, 256},
                 {25, 512}, {10, config::STORE_LARGE_BUCKET_SIZE}, {10, 2048}
         };
-        PoolManager* ipcStore = new PoolManager(objects::IPC_STORE, poolConfig);
+        PoolManager* ipcStore = new MonitoredPoolManager(objects::IPC_STORE, poolConfig);
         size_t additionalSize = 0;
         size_t storeSize = ipcStore->getTotalSize(&additionalSize);
 #if FSFW_CPP_OSTREAM_ENABLED == 1
@@ -119,7 +127,7 @@ void Factory::produce(void* args) {
                 {500, 32}, {250, 64}, {120, 128}, {60, 256},
                 {30, 512}, {15, config::STORE_LARGE_BUCKET_SIZE}, {10, 2048}
         };
-        PoolManager* tmStore = new PoolManager(objects::TM_STORE, poolConfig);
+        PoolManager* tmStore = new MonitoredPoolManager(objects::TM_STORE, poolConfig);
         size_t additionalSize = 0;
         size_t storeSize = tmStore->getTotalSize(&additionalSize);
 #if FSFW_CPP_OSTREAM_ENABLED == 1
@@ -136,7 +144,7 @@ void Factory::produce(void* args) {
                 {500, 32}, {250, 64}, {120, 128},
                 {60, 256}, {30, 512}, {15, config::STORE_LARGE_BUCKET_SIZE}, {10, 2048}
         };
-        PoolManager* tcStore =new PoolManager(objects::TC_STORE, poolConfig);
+        PoolManager* tcStore = new MonitoredPoolManager(objects::TC_STORE, poolConfig);
         size_t additionalSize = 0;
         size_t storeSize = tcStore->getTotalSize(&additionalSize);
 #if FSFW_CPP_OSTREAM_ENABLED == 1
@@ -220,6 +228,18 @@ void Factory::produce(void* args) {
 
     new CoreController(objects::CORE_CONTROLLER, objects::SYSTEM_STATE_TASK);
     new SystemStateTask(objects::SYSTEM_STATE_TASK, objects::CORE_CONTROLLER);
+#if OBSW_MONITOR_TASK_TIMING == 1
+    new TaskTimingMonitor(objects::TASK_TIMING_MONITOR, objects::CORE_CONTROLLER);
+#endif
+#if OBSW_MONITOR_TASK_STACKS == 1
+    new TaskStackMonitor(objects::TASK_STACK_MONITOR, objects::CORE_CONTROLLER);
+#endif
+#if OBSW_ENABLE_TRACE == 1
+    new TraceBufferHandler(objects::TRACE_BUFFER_HANDLER);
+#endif
+#if OBSW_DEFERRED_LOGGING == 1
+    new DeferredLogger(objects::DEFERRED_LOGGER);
+#endif
     new ThermalController(objects::THERMAL_CONTROLLER);
 
     DummyCookie * dummyCookie2 = new DummyCookie(addresses::DUMMY_GPS0, 128);
@@ -247,6 +267,11 @@ void Factory::produce(void* args) {
 
     new SoftwareImageHandler(objects::SOFTWARE_IMAGE_HANDLER);
     new SDCardHandler(objects::SD_CARD_HANDLER);
+    new SDCardIoWorker(objects::SD_CARD_IO_WORKER, objects::SD_CARD_HANDLER);
+#ifdef ISIS_OBC_G20
+    /* Only the iOBC has a redundant SD card */
+    new SDCardMirror(objects::SD_CARD_MIRROR);
+#endif
     new FRAMHandler(objects::FRAM_HANDLER);
 
     /* Communication Interfaces */
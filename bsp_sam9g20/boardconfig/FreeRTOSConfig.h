@@ -169,5 +169,26 @@ extern void vConfigureTimerForRunTimeStats();
 extern uint32_t vGetCurrentTimerCounterValue();
 #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() vConfigureTimerForRunTimeStats()
 #define portGET_RUN_TIME_COUNTER_VALUE() vGetCurrentTimerCounterValue()
+// Frequency of the run time statistics counter
+#define RUN_TIME_COUNTER_FREQUENCY_HZ           10000
+
+#if configGENERATE_RUN_TIME_STATS == 1
+// Records the execution time of the cycles of monitored periodic tasks. The hook is expanded
+// inside tasks.c, the run time of the current slice is not yet added to the counter of the task.
+#include "taskTiming.h"
+#define traceTASK_DELAY_UNTIL( xTimeToWake ) task_timing_cycle_end( pxCurrentTCB, \
+        pxCurrentTCB->ulRunTimeCounter + \
+        ( portGET_RUN_TIME_COUNTER_VALUE() - ulTaskSwitchedInTime ), ( xTimeToWake ) )
+#endif
+
+#if configUSE_TRACE_FACILITY == 1
+#include <OBSWConfig.h>
+#if OBSW_ENABLE_TRACE == 1
+// Tags the records of the trace buffer with the running task and optionally records the
+// task switches. The hook is expanded inside tasks.c.
+#include "traceBuffer.h"
+#define traceTASK_SWITCHED_IN() trace_buffer_task_switched_in( pxCurrentTCB->uxTCBNumber )
+#endif
+#endif
 
 #endif /* SAM9G20_FREERTOS_CONFIG_H */
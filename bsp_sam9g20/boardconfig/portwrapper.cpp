@@ -23,7 +23,7 @@ void vRequestContextSwitchFromISR() {
 void vConfigureTimerForRunTimeStats() {
 	// Tick interrupt has 1000Hz, timer frequency which is 10-100 times larger
 	// recommended. Starting at lower end with 10kHz for now.
-	uint32_t timerFrequency = 10000;
+	uint32_t timerFrequency = RUN_TIME_COUNTER_FREQUENCY_HZ;
 	TCTimerHandler::configureOverflowInterrupt(tcPeripheralSelect,
 			timerFrequency, timerOverflowISR,
 			TCTimerHandler::LOWEST_ISR_PRIORITY, nullptr);
@@ -0,0 +1,141 @@
+#include "taskTiming.h"
+
+#include <FreeRTOSConfig.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+typedef struct {
+    void* task_handle;
+    uint32_t period_ticks;
+    uint32_t period_run_time;
+    //! Set after the first cycle end, which is only used as reference for the following cycles
+    bool started;
+    uint32_t last_run_time_counter;
+    uint32_t last_time_to_wake;
+    TaskTimingStats stats;
+} TaskTimingSlot;
+
+static TaskTimingSlot slots[TASK_TIMING_MAX_TASKS];
+static uint8_t number_of_slots = 0;
+
+static void clear_stats(TaskTimingStats* stats);
+static void record_cycles(TaskTimingSlot* slot, uint32_t execution_time, uint32_t periods);
+
+int task_timing_register(void* task_handle, uint32_t period_ticks, uint32_t period_run_time) {
+    if(task_handle == NULL || period_ticks == 0 || period_run_time == 0) {
+        return -1;
+    }
+    int index = -1;
+    vTaskSuspendAll();
+    for(uint8_t idx = 0; idx < number_of_slots; idx++) {
+        if(slots[idx].task_handle == task_handle) {
+            xTaskResumeAll();
+            return -1;
+        }
+    }
+    if(number_of_slots < TASK_TIMING_MAX_TASKS) {
+        TaskTimingSlot* slot = &slots[number_of_slots];
+        slot->task_handle = task_handle;
+        slot->period_ticks = period_ticks;
+        slot->period_run_time = period_run_time;
+        slot->started = false;
+        clear_stats(&slot->stats);
+        index = number_of_slots;
+        number_of_slots++;
+    }
+    xTaskResumeAll();
+    return index;
+}
+
+int task_timing_get_stats(uint8_t index, TaskTimingStats* stats) {
+    if(stats == NULL) {
+        return -1;
+    }
+    vTaskSuspendAll();
+    if(index >= number_of_slots) {
+        xTaskResumeAll();
+        return -1;
+    }
+    memcpy(stats, &slots[index].stats, sizeof(TaskTimingStats));
+    xTaskResumeAll();
+    return 0;
+}
+
+int task_timing_reset(uint8_t index) {
+    vTaskSuspendAll();
+    if(index >= number_of_slots) {
+        xTaskResumeAll();
+        return -1;
+    }
+    clear_stats(&slots[index].stats);
+    xTaskResumeAll();
+    return 0;
+}
+
+void task_timing_reset_all() {
+    vTaskSuspendAll();
+    for(uint8_t idx = 0; idx < number_of_slots; idx++) {
+        clear_stats(&slots[idx].stats);
+    }
+    xTaskResumeAll();
+}
+
+void task_timing_cycle_end(void* task_handle, uint32_t run_time_counter,
+        uint32_t time_to_wake) {
+    TaskTimingSlot* slot = NULL;
+    for(uint8_t idx = 0; idx < number_of_slots; idx++) {
+        if(slots[idx].task_handle == task_handle) {
+            slot = &slots[idx];
+            break;
+        }
+    }
+    if(slot == NULL) {
+        return;
+    }
+
+    if(slot->started) {
+        /* xTaskDelayUntil does not delay and does not call the trace hook if the release time
+        has already passed, so a larger increment of the release time means that the task
+        missed deadlines and the execution time covers several periods. The unsigned
+        differences also cover overflows of the counters. */
+        uint32_t periods = (time_to_wake - slot->last_time_to_wake) / slot->period_ticks;
+        if(periods == 0) {
+            periods = 1;
+        }
+        record_cycles(slot, run_time_counter - slot->last_run_time_counter, periods);
+    }
+    slot->started = true;
+    slot->last_run_time_counter = run_time_counter;
+    slot->last_time_to_wake = time_to_wake;
+}
+
+static void clear_stats(TaskTimingStats* stats) {
+    memset(stats, 0, sizeof(TaskTimingStats));
+    stats->min_execution_time = UINT32_MAX;
+}
+
+static void record_cycles(TaskTimingSlot* slot, uint32_t execution_time, uint32_t periods) {
+    TaskTimingStats* stats = &slot->stats;
+    stats->cycles += periods;
+    stats->deadline_misses += periods - 1;
+    stats->total_execution_time += execution_time;
+    if(execution_time < stats->min_execution_time) {
+        stats->min_execution_time = execution_time;
+    }
+    if(execution_time > stats->max_execution_time) {
+        stats->max_execution_time = execution_time;
+    }
+    if(execution_time > slot->period_run_time) {
+        stats->overruns++;
+    }
+    uint64_t bucket = (uint64_t) execution_time * TASK_TIMING_HISTOGRAM_BUCKETS /
+            slot->period_run_time;
+    if(bucket >= TASK_TIMING_HISTOGRAM_BUCKETS) {
+        bucket = TASK_TIMING_HISTOGRAM_BUCKETS - 1;
+    }
+    stats->histogram[bucket]++;
+}
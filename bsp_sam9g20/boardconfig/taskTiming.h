@@ -0,0 +1,80 @@
+#ifndef SAM9G20_BOARDCONFIG_TASKTIMING_H_
+#define SAM9G20_BOARDCONFIG_TASKTIMING_H_
+
+/**
+ * Execution time measurement for periodic FreeRTOS tasks.
+ *
+ * The FreeRTOS configuration maps the traceTASK_DELAY_UNTIL hook to task_timing_cycle_end,
+ * which is called every time a periodic task finishes a cycle and is put to sleep by
+ * xTaskDelayUntil. The execution time of the cycle is the increment of the run time counter
+ * of the task since the last cycle, so time spent in other tasks and interrupts preempting the
+ * task is not included. All times are ticks of the 10 kHz run time statistics counter.
+ *
+ * This header is included by FreeRTOSConfig.h, so it must not include FreeRTOS headers.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TASK_TIMING_MAX_TASKS               20
+#define TASK_TIMING_HISTOGRAM_BUCKETS       8
+
+typedef struct {
+    //! Number of periods covered by the recorded cycles, including missed ones
+    uint32_t cycles;
+    uint32_t min_execution_time;
+    uint32_t max_execution_time;
+    uint64_t total_execution_time;
+    //! Bucket n counts the cycles using n/8 to (n+1)/8 of the period, the last bucket also
+    //! counts the overruns
+    uint32_t histogram[TASK_TIMING_HISTOGRAM_BUCKETS];
+    //! Number of periods in which the task did not reach xTaskDelayUntil before the next
+    //! release time
+    uint32_t deadline_misses;
+    //! Number of recorded cycles with an execution time longer than the period
+    uint32_t overruns;
+} TaskTimingStats;
+
+/**
+ * Start recording the cycles of the given task. Should be called before the scheduler is
+ * started or from a task.
+ * @param task_handle
+ * @param period_ticks      Period of the task in FreeRTOS ticks
+ * @param period_run_time   Period of the task in run time counter ticks
+ * @return  Index of the task which is used for the other functions or -1 if the task is already
+ *          registered or all slots are used
+ */
+int task_timing_register(void* task_handle, uint32_t period_ticks, uint32_t period_run_time);
+
+/**
+ * Copy the statistics of the task with the given index.
+ * @return -1 if the index is invalid, 0 otherwise
+ */
+int task_timing_get_stats(uint8_t index, TaskTimingStats* stats);
+
+/**
+ * Clear the statistics of the task with the given index. The cycle which is currently running
+ * is recorded normally.
+ * @return -1 if the index is invalid, 0 otherwise
+ */
+int task_timing_reset(uint8_t index);
+
+void task_timing_reset_all();
+
+/**
+ * Trace hook, called by xTaskDelayUntil with the scheduler suspended.
+ * @param task_handle       Handle of the calling task
+ * @param run_time_counter  Run time counter of the calling task including the current slice
+ * @param time_to_wake      Release time of the next cycle in FreeRTOS ticks
+ */
+void task_timing_cycle_end(void* task_handle, uint32_t run_time_counter,
+        uint32_t time_to_wake);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SAM9G20_BOARDCONFIG_TASKTIMING_H_ */
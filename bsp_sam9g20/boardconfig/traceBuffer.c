@@ -0,0 +1,118 @@
+#include "traceBuffer.h"
+
+#include <OBSWConfig.h>
+#include <FreeRTOSConfig.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <stddef.h>
+#include <string.h>
+
+static TraceBufferImage image = {
+    .header = {
+        .magic = TRACE_BUFFER_MAGIC,
+        .version = TRACE_BUFFER_VERSION,
+        .record_size = sizeof(TraceRecord),
+        .capacity = TRACE_BUFFER_CAPACITY,
+        .counter_frequency = RUN_TIME_COUNTER_FREQUENCY_HZ,
+        .task_name_length = TRACE_BUFFER_TASK_NAME_LENGTH
+    }
+};
+
+static volatile bool enabled = false;
+static volatile bool task_switches_enabled = false;
+static volatile uint16_t current_task_number = 0;
+
+//! Used to extend the 32 bit run time counter, only accessed with the interrupts masked
+static uint32_t last_counter = 0;
+static uint32_t counter_overflows = 0;
+
+//! The run time counter is a 16 bit timer counter extended by its overflow interrupt
+#define TC_COUNTER_RANGE    0x10000
+
+static TaskStatus_t task_status[TRACE_BUFFER_MAX_TASK_NAMES];
+
+static inline uint32_t mask_interrupts();
+static inline void restore_interrupts(uint32_t cpsr);
+
+void trace_buffer_record(uint16_t event_id, uint32_t arg) {
+    if(!enabled) {
+        return;
+    }
+    uint32_t cpsr = mask_interrupts();
+    uint32_t counter = vGetCurrentTimerCounterValue();
+    /* A small step back means that the timer counter wrapped while its overflow interrupt is
+    still pending, because the interrupts are masked. The upper half is one behind then. */
+    if(counter < last_counter && last_counter - counter < TC_COUNTER_RANGE) {
+        counter += TC_COUNTER_RANGE;
+    }
+    if(counter < last_counter) {
+        counter_overflows++;
+    }
+    last_counter = counter;
+    TraceRecord* record = &image.records[image.header.record_count &
+                                         (TRACE_BUFFER_CAPACITY - 1)];
+    image.header.record_count++;
+    record->timestamp = (uint64_t) counter_overflows << 32 | counter;
+    record->task_number = current_task_number;
+    record->event_id = event_id;
+    record->arg = arg;
+    restore_interrupts(cpsr);
+}
+
+#if OBSW_ENABLE_TRACE == 1
+void trace_buffer_task_switched_in(uint32_t task_number) {
+    current_task_number = task_number;
+    if(task_switches_enabled) {
+        trace_buffer_record(TRACE_BUFFER_ID_TASK_SWITCH, 0);
+    }
+}
+#endif
+
+void trace_buffer_enable(bool enable, bool record_task_switches) {
+    task_switches_enabled = record_task_switches;
+    enabled = enable;
+}
+
+bool trace_buffer_is_enabled() {
+    return enabled;
+}
+
+void trace_buffer_clear() {
+    uint32_t cpsr = mask_interrupts();
+    image.header.record_count = 0;
+    restore_interrupts(cpsr);
+}
+
+const TraceBufferImage* trace_buffer_get_image() {
+    /* Returns 0 if there are more tasks than entries, the converter then uses generic names */
+    UBaseType_t number_of_tasks = uxTaskGetSystemState(task_status,
+            TRACE_BUFFER_MAX_TASK_NAMES, NULL);
+    memset(image.task_names, 0, sizeof(image.task_names));
+    for(UBaseType_t idx = 0; idx < number_of_tasks; idx++) {
+        image.task_names[idx].task_number = task_status[idx].xTaskNumber;
+        strncpy(image.task_names[idx].name, task_status[idx].pcTaskName,
+                TRACE_BUFFER_TASK_NAME_LENGTH - 1);
+    }
+    image.header.number_of_tasks = number_of_tasks;
+    image.header.enabled = enabled;
+    image.header.task_switches_enabled = task_switches_enabled;
+    return &image;
+}
+
+/* Same masking as portDISABLE_INTERRUPTS, but the previous state is restored afterwards so
+the functions can be used in interrupts and critical sections as well */
+static inline uint32_t mask_interrupts() {
+    uint32_t cpsr;
+    uint32_t masked;
+    __asm volatile (
+            "MRS %0, CPSR       \n\t"
+            "ORR %1, %0, #0xC0  \n\t"
+            "MSR CPSR_c, %1     \n\t"
+            : "=r" (cpsr), "=r" (masked) : : "memory");
+    return cpsr;
+}
+
+static inline void restore_interrupts(uint32_t cpsr) {
+    __asm volatile ("MSR CPSR_c, %0" : : "r" (cpsr) : "memory");
+}
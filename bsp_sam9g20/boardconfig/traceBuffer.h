@@ -0,0 +1,113 @@
+#ifndef SAM9G20_BOARDCONFIG_TRACEBUFFER_H_
+#define SAM9G20_BOARDCONFIG_TRACEBUFFER_H_
+
+/**
+ * Fixed-size trace buffer in RAM for timestamped records of the hot paths of the OBSW.
+ *
+ * Records are written by the OBSW_TRACE macros in mission/utility/obswTrace.h and by the
+ * traceTASK_SWITCHED_IN hook of FreeRTOS. The ARM926EJ-S has no exclusive load and store
+ * instructions, so a record is claimed and written with the interrupts masked for a few
+ * instructions instead. Recording never blocks and can be done from tasks and interrupts.
+ *
+ * The buffer image consists of a header, a task name table and the record ring and is the
+ * memory which is dumped with Service 6 or written to the SD card. All times are ticks of the
+ * 10 kHz run time statistics counter, extended to 64 bit.
+ *
+ * This header is included by FreeRTOSConfig.h, so it must not include FreeRTOS headers.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//! Must be a power of two
+#define TRACE_BUFFER_CAPACITY               2048
+#define TRACE_BUFFER_MAX_TASK_NAMES         32
+#define TRACE_BUFFER_TASK_NAME_LENGTH       24
+
+#define TRACE_BUFFER_MAGIC                  0x54524345
+#define TRACE_BUFFER_VERSION                1
+
+//! The upper two bits of the event ID specify the phase of the record
+#define TRACE_BUFFER_PHASE_INSTANT          0x0000
+#define TRACE_BUFFER_PHASE_BEGIN            0x4000
+#define TRACE_BUFFER_PHASE_END              0x8000
+#define TRACE_BUFFER_PHASE_MASK             0xC000
+
+//! Event IDs up to 0xff are reserved for the board
+#define TRACE_BUFFER_ID_TASK_SWITCH         0x0001
+
+typedef struct {
+    uint64_t timestamp;
+    //! FreeRTOS TCB number of the task which was running when the record was written
+    uint16_t task_number;
+    uint16_t event_id;
+    uint32_t arg;
+} TraceRecord;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    uint32_t capacity;
+    //! Number of records written since the last clear. The next record is written to the
+    //! index record_count % capacity
+    uint32_t record_count;
+    uint32_t counter_frequency;
+    uint16_t number_of_tasks;
+    uint16_t task_name_length;
+    uint8_t enabled;
+    uint8_t task_switches_enabled;
+    uint8_t spare[6];
+} TraceBufferHeader;
+
+typedef struct {
+    uint32_t task_number;
+    char name[TRACE_BUFFER_TASK_NAME_LENGTH];
+} TraceTaskName;
+
+typedef struct {
+    TraceBufferHeader header;
+    TraceTaskName task_names[TRACE_BUFFER_MAX_TASK_NAMES];
+    TraceRecord records[TRACE_BUFFER_CAPACITY];
+} TraceBufferImage;
+
+/**
+ * Write a record if the trace buffer is enabled. Can be called from interrupts.
+ * @param event_id  Event ID including the phase bits
+ * @param arg
+ */
+void trace_buffer_record(uint16_t event_id, uint32_t arg);
+
+/**
+ * Trace hook, called by the scheduler when a task is switched in. Only installed if
+ * OBSW_ENABLE_TRACE is set to 1.
+ * @param task_number   TCB number of the task
+ */
+void trace_buffer_task_switched_in(uint32_t task_number);
+
+/**
+ * Enable or disable recording. The task switch records are only written if both flags are
+ * set, because they fill the buffer quickly.
+ */
+void trace_buffer_enable(bool enable, bool record_task_switches);
+
+bool trace_buffer_is_enabled();
+
+void trace_buffer_clear();
+
+/**
+ * Update the header and the task name table of the image. Must be called from a task because
+ * the task names are read from the scheduler.
+ * @return Image, which is only consistent while the recording is disabled
+ */
+const TraceBufferImage* trace_buffer_get_image();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SAM9G20_BOARDCONFIG_TRACEBUFFER_H_ */
@@ -32,7 +32,7 @@ int select_sd_card(VolumeId volumeId, bool enterFs) {
         }
     }
     /* Initialize volID as safe */
-    result = f_initvolume(0, atmel_mcipdc_initfunc, volumeId);
+    result = f_initvolume(PRIMARY_DRIVE, atmel_mcipdc_initfunc, volumeId);
 
     if((result != F_NO_ERROR) && (result != F_ERR_NOTFORMATTED)) {
         TRACE_ERROR("select_sd_card: fs_initvolume failed with code %d\n\r", result);
@@ -45,7 +45,7 @@ int select_sd_card(VolumeId volumeId, bool enterFs) {
          *  The file system has not been formatted to safeFat yet
          *  Therefore format filesystem now
          */
-        result = f_format( 0, F_FAT32_MEDIA);
+        result = f_format(PRIMARY_DRIVE, F_FAT32_MEDIA);
         if(result != F_NO_ERROR) {
             TRACE_ERROR("select_sd_card: fs_format failed with code %d\n\r", result);
             return result;
@@ -90,6 +90,32 @@ int switch_sd_card(VolumeId volumeId) {
 	return select_sd_card(volumeId, false);
 }
 
+int mount_mirror_sd_card(VolumeId volumeId) {
+    int result = f_initvolume(MIRROR_DRIVE, atmel_mcipdc_initfunc, volumeId);
+    if((result != F_NO_ERROR) && (result != F_ERR_NOTFORMATTED)) {
+        TRACE_ERROR("mount_mirror_sd_card: fs_initvolume failed with code %d\n\r", result);
+        return result;
+    }
+
+    if(result == F_ERR_NOTFORMATTED) {
+        TRACE_INFO("mount_mirror_sd_card: Formatting SD-Card %d for Safe-FAT\r\n", volumeId);
+        result = f_format(MIRROR_DRIVE, F_FAT32_MEDIA);
+        if(result != F_NO_ERROR) {
+            TRACE_ERROR("mount_mirror_sd_card: fs_format failed with code %d\n\r", result);
+            return result;
+        }
+    }
+    return 0;
+}
+
+int unmount_mirror_sd_card() {
+    int result = f_delvolume(MIRROR_DRIVE);
+    if(result != F_NO_ERROR) {
+        TRACE_WARNING("unmount_mirror_sd_card: f_delvolume failed with code %d\n\r", result);
+    }
+    return result;
+}
+
 int create_directory(const char *repository_path, const char *dirname) {
     int result = 0;
     if(repository_path != NULL) {
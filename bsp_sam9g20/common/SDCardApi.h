@@ -14,6 +14,15 @@ typedef enum {
     SD_CARD_1 = 1
 } VolumeId;
 
+/**
+ * Drive numbers of the file system. The active SD card is always mounted as the primary drive.
+ * The inactive SD card can be mounted as the mirror drive to keep it in sync.
+ */
+typedef enum {
+    PRIMARY_DRIVE = 0,
+    MIRROR_DRIVE = 1
+} DriveNumber;
+
 /**
  * API as a thin abstraction layer for the HCC file API. Written in C
  * to be easily usable by the bootloader as well.
@@ -45,6 +54,20 @@ int close_filesystem(bool releaseFs, bool delVolume, VolumeId volumeId);
 
 int switch_sd_card(VolumeId volumeId);
 
+/**
+ * Mount the given SD card as the mirror drive. The file system needs to be opened already.
+ * Use f_chdrive to switch the current drive of the calling task.
+ * @param volumeId  Should be the inactive SD card
+ * @return
+ */
+int mount_mirror_sd_card(VolumeId volumeId);
+
+/**
+ * Unmount the mirror drive. Needs to be done before the file system is closed.
+ * @return
+ */
+int unmount_mirror_sd_card();
+
 /**
  * Create directory in specified path.
  * @param repository_path   Path where the directory will be created.
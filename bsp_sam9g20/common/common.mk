@@ -8,5 +8,6 @@ endif
 CSRC += $(wildcard $(CURRENTPATH)/SDCardApi.c)
 CSRC += $(wildcard $(CURRENTPATH)/SRAMApi.c)
 CSRC += $(wildcard $(CURRENTPATH)/lowlevel.c)
+CSRC += $(wildcard $(CURRENTPATH)/imageCompression.c)
 
 INCLUDES += $(CURRENTPATH)/config
@@ -26,6 +26,13 @@ static const char* const SW_FLASH_HAMMING_NAME =        "nor_ham.bin";
 static const char* const SW_SLOT_0_HAMMING_NAME =       "sl0_ham.bin";
 static const char* const SW_SLOT_1_HAMMING_NAME =       "sl1_ham.bin";
 
+//! Uploaded delta patch which can be applied to a SD card image
+static const char* const SW_PATCH_NAME =                "obsw.pat";
+//! Image rebuilt from a delta patch before it was verified
+static const char* const SW_PATCH_TARGET_NAME =         "obsw_pat.tmp";
+//! Previous image of the patched slot, kept until the rebuilt image has replaced it
+static const char* const SW_PATCH_BACKUP_NAME =         "obsw_pat.bak";
+
 #ifdef __cplusplus
 }
 #endif
@@ -99,3 +99,23 @@ uint32_t determine_ham_size_address(SlotType slotType) {
     }
     return address;
 }
+
+uint32_t determine_ham_flag_address(SlotType slotType) {
+    uint32_t address = 0;
+    if(slotType == FLASH_SLOT) {
+        address = NOR_FLASH_HAMMING_FLAG_ADDR;
+    }
+    else if(slotType == SDC_0_SL_0) {
+        address = SDC0_SL0_HAMMING_FLAG_ADDR;
+    }
+    else if(slotType == SDC_0_SL_1) {
+        address = SDC0_SL1_HAMMING_FLAG_ADDR;
+    }
+    else if(slotType == SDC_1_SL_0) {
+        address = SDC1_SL0_HAMMING_FLAG_ADDR;
+    }
+    else if(slotType == SDC_1_SL_1) {
+        address = SDC1_SL1_HAMMING_FLAG_ADDR;
+    }
+    return address;
+}
@@ -127,6 +127,19 @@ typedef struct __attribute__((__packed__))  _CriticalDataBlock {
 
 static const uint32_t CRITICAL_BLOCK_START_ADDR = 0x0;
 
+/* Region for rings of persistent counter records behind the critical block,
+see PersistentCounterRing. Defines, so they can be used in static assertions in C. */
+#define COUNTER_RING_REGION_ADDR                        0x100
+#define COUNTER_RING_REGION_SIZE                        0x200
+
+#ifdef __cplusplus
+static_assert(sizeof(CriticalDataBlock) <= COUNTER_RING_REGION_ADDR,
+        "Critical data block overlaps the counter ring region");
+#else
+_Static_assert(sizeof(CriticalDataBlock) <= COUNTER_RING_REGION_ADDR,
+        "Critical data block overlaps the counter ring region");
+#endif
+
 // Software information offsets
 static const uint8_t FRAM_SOFTWARE_VERSION_ADDR =
         offsetof(CriticalDataBlock, software_version);
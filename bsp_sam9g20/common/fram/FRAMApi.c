@@ -7,9 +7,8 @@
 
 /* Private functions */
 int manipulate_sdc_hamming_flag(uint16_t val, VolumeId volume, SdSlots slot);
-uint32_t determine_ham_flag_address(SlotType slotType);
-uint32_t determine_ham_size_address(SlotType slotType);
 /* Defined in common source file */
+extern uint32_t determine_ham_flag_address(SlotType slotType);
 extern uint32_t determine_img_reboot_counter_addr(SlotType slotType);
 extern int determine_ham_code_address_with_sizecheck(SlotType slotType, uint32_t* address,
         size_t size_to_write);
@@ -27,6 +26,36 @@ int fram_read_critical_block(uint8_t* buffer, const size_t max_size) {
     return FRAM_read((unsigned char*) buffer, CRITICAL_BLOCK_START_ADDR, sizeof(CriticalDataBlock));
 }
 
+int fram_read_critical_range(uint32_t address, uint8_t* buffer, size_t size) {
+    if(buffer == NULL || address + size > sizeof(CriticalDataBlock)) {
+        return -3;
+    }
+    return FRAM_read((unsigned char*) buffer, CRITICAL_BLOCK_START_ADDR + address, size);
+}
+
+int fram_write_critical_range(uint32_t address, const uint8_t* buffer, size_t size) {
+    if(buffer == NULL || address + size > sizeof(CriticalDataBlock)) {
+        return -3;
+    }
+    return FRAM_writeAndVerify((unsigned char*) buffer, CRITICAL_BLOCK_START_ADDR + address,
+            size);
+}
+
+int fram_read_counter_ring_range(uint32_t address, uint8_t* buffer, size_t size) {
+    if(buffer == NULL || address + size > COUNTER_RING_REGION_SIZE) {
+        return -3;
+    }
+    return FRAM_read((unsigned char*) buffer, COUNTER_RING_REGION_ADDR + address, size);
+}
+
+int fram_write_counter_ring_range(uint32_t address, const uint8_t* buffer, size_t size) {
+    if(buffer == NULL || address + size > COUNTER_RING_REGION_SIZE) {
+        return -3;
+    }
+    return FRAM_writeAndVerify((unsigned char*) buffer, COUNTER_RING_REGION_ADDR + address,
+            size);
+}
+
 int fram_zero_out_all_fields() {
     uint8_t zeroArray[sizeof(CriticalDataBlock)] = { 0 };
     return FRAM_writeAndVerify(zeroArray, CRITICAL_BLOCK_START_ADDR, sizeof(CriticalDataBlock));
@@ -482,26 +511,6 @@ int fram_get_img_ham_flag(SlotType slotType, bool *flag_set) {
     return result;
 }
 
-uint32_t determine_ham_flag_address(SlotType slotType) {
-    uint32_t address = 0;
-    if(slotType == FLASH_SLOT) {
-        address = NOR_FLASH_HAMMING_FLAG_ADDR;
-    }
-    else if(slotType == SDC_0_SL_0) {
-        address = SDC0_SL0_HAMMING_FLAG_ADDR;
-    }
-    else if(slotType == SDC_0_SL_1) {
-        address = SDC0_SL1_HAMMING_FLAG_ADDR;
-    }
-    else if(slotType == SDC_1_SL_0) {
-        address = SDC1_SL0_HAMMING_FLAG_ADDR;
-    }
-    else if(slotType == SDC_1_SL_1) {
-        address = SDC1_SL1_HAMMING_FLAG_ADDR;
-    }
-    return address;
-}
-
 int fram_read_img_reboot_counter(SlotType slotType, uint16_t *reboot_counter) {
     if(reboot_counter == NULL) {
         return -3;
@@ -573,12 +582,12 @@ int fram_read_ham_size(SlotType slotType, size_t *ham_size, bool *ham_flag_set)
 int fram_write_ham_code(SlotType slotType, uint8_t *buffer, size_t current_offset,
         size_t size_to_write) {
     uint32_t address = 0;
-    int result = determine_ham_code_address_with_sizecheck(slotType, &address, size_to_write);
+    int result = determine_ham_code_address_with_sizecheck(slotType, &address,
+            current_offset + size_to_write);
     if(result != 0) {
         return result;
     }
-    return FRAM_writeAndVerify((unsigned char*) buffer + current_offset,
-            address, size_to_write);
+    return FRAM_writeAndVerify((unsigned char*) buffer, address + current_offset, size_to_write);
 }
 
 int fram_read_ham_code(SlotType slotType, uint8_t *buffer, const size_t max_buffer,
@@ -612,7 +621,7 @@ int fram_read_ham_code(SlotType slotType, uint8_t *buffer, const size_t max_buff
         return -5;
     }
 
-    int result = FRAM_read(buffer + current_offset, address, size_to_read);
+    int result = FRAM_read(buffer, address + current_offset, size_to_read);
     if(result != 0) {
         return result;
     }
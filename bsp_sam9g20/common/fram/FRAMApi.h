@@ -54,6 +54,27 @@ int fram_read_critical_block(uint8_t* buffer, const size_t max_size);
 int fram_read_bootloader_block(BootloaderGroup* bl_info);
 int fram_read_bootloader_block_raw(uint8_t* buff, size_t max_size);
 
+/**
+ * Raw access to a range of the critical block. Can be used to read or write multiple
+ * consecutive fields with one transaction.
+ * @param address   Offset inside the critical block
+ * @param buffer
+ * @param size      address + size must not exceed the size of the critical block
+ * @return 0 on success, -3 for an invalid range
+ */
+int fram_read_critical_range(uint32_t address, uint8_t* buffer, size_t size);
+int fram_write_critical_range(uint32_t address, const uint8_t* buffer, size_t size);
+
+/**
+ * Raw access to the persistent counter ring region.
+ * @param address   Offset inside the region
+ * @param buffer
+ * @param size      address + size must not exceed COUNTER_RING_REGION_SIZE
+ * @return 0 on success, -3 for an invalid range
+ */
+int fram_read_counter_ring_range(uint32_t address, uint8_t* buffer, size_t size);
+int fram_write_counter_ring_range(uint32_t address, const uint8_t* buffer, size_t size);
+
 /**
  * Should be called once after a FRAM reset. Also called by the "Execute Before Flight" Sequence
  * @return
@@ -132,13 +153,21 @@ int fram_increment_img_reboot_counter(SlotType slotType, uint16_t* new_reboot_co
 int fram_read_img_reboot_counter(SlotType slotType, uint16_t* reboot_counter);
 int fram_reset_img_reboot_counter(SlotType slotType);
 
+/**
+ * Write a part of the hamming code of an image.
+ * @param slotType
+ * @param buffer            Part of the hamming code to write
+ * @param current_offset    Offset of the part in the hamming code
+ * @param size_to_write     Size of the part
+ * @return
+ */
 int fram_write_ham_code(SlotType slotType, uint8_t* buffer, size_t current_offset,
         size_t size_to_write);
 /**
  * Shall be used by the to read the hamming codes. Its recommended to supply
  * the reserved size (0xA000 for images, 0x600 for bootloader) as max_buffer.
  * @param slotType
- * @param buffer            Hamming code will be written to this location.
+ * @param buffer            Hamming code will be written to the start of this location.
  * @param max_buffer        Maximum allowed size to store into buffer
  * @param current_offset    Offset of start address to read from.
  * @param size_to_read      Specify bytes to read from the specified offset. Set to 0 to determine
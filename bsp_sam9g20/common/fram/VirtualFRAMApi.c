@@ -2,35 +2,128 @@
 #include "VirtualFRAMApi.h"
 #include "CommonFRAM.h"
 
+#include <bootloader/utility/CRC.h>
+
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <hcc/api_fat.h>
 #include <hcc/api_hcc_mem.h>
 
+/* The host build runs on POSIX threads and bootloaders without an RTOS only have one thread */
+#if defined(__unix__)
+#include <pthread.h>
+static pthread_mutex_t image_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t flush_mutex = PTHREAD_MUTEX_INITIALIZER;
+#elif !defined(NO_RTOS)
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+static SemaphoreHandle_t image_mutex = NULL;
+static SemaphoreHandle_t flush_mutex = NULL;
+#endif
+
+#define VIRT_FRAM_SIZE                  (FRAM_END_ADDR + 1)
+#define VIRT_FRAM_JOURNAL_MAGIC         0x464a524e
+//! Address (4 bytes) and size (2 bytes) preceding the data of each journal record
+#define VIRT_FRAM_RECORD_HEADER_SIZE    6
+//! Larger writes, like hamming codes, bypass the journal
+#define VIRT_FRAM_MAX_RECORD_SIZE       64
+
+/**
+ * Header of the journal file. The journal is only replayed if the magic and the CRC of the
+ * records are valid, so a journal which was not written completely is discarded.
+ */
+typedef struct {
+    uint32_t magic;
+    uint16_t number_of_records;
+    uint16_t records_size;
+    uint16_t records_crc;
+    uint16_t reserved;
+} JournalHeader;
+
+/* The image mutex protects the RAM image and the journal and is never held while the
+SD card is accessed. The flush mutex serializes the SD card accesses and is always taken
+before the image mutex. */
+
+//! Content of the FRAM file, loaded on startup
+static uint8_t* fram_image = NULL;
+//! Writes since the last flush
+static uint8_t journal[VIRT_FRAM_JOURNAL_SIZE];
+static size_t journal_fill = 0;
+static uint16_t journal_records = 0;
+//! Copy of the journal which is currently flushed
+static uint8_t flush_buffer[VIRT_FRAM_JOURNAL_SIZE];
 
 //bool handle_filesystem_opening = false;
 //VolumeId volume_for_filesystem = SD_CARD_0;
 
+/* Address helpers shared with the FRAM API of the iOBC */
+extern uint32_t determine_ham_flag_address(SlotType slotType);
+extern int determine_ham_code_address_with_sizecheck(SlotType slotType, uint32_t* address,
+        size_t size_to_write);
+extern uint32_t determine_ham_code_address(SlotType slotType);
+extern uint32_t determine_ham_size_address(SlotType slotType);
+extern uint32_t determine_binary_size_address(SlotType slotType);
+
 /* Private functions */
 int open_fram_file(F_FILE** file, size_t seek_pos, const char* const access_type);
 int close_fram_file(F_FILE* file);
 
+static void lock_image();
+static void unlock_image();
+static void lock_flush();
+static void unlock_flush();
+static int load_fram_image();
+static int replay_journal();
+static int apply_records(const uint8_t* records, size_t records_size, bool to_image);
+static int read_image(uint32_t address, void* buffer, size_t size);
+static int write_image(uint32_t address, const void* data, size_t size);
+static int write_through(uint32_t address, const void* data, size_t size);
+static int flush_journal();
+
 /* Implementation */
 
 int FRAM_start() {
-    return create_generic_fram_file();
+#if !defined(__unix__) && !defined(NO_RTOS)
+    if(image_mutex == NULL) {
+        image_mutex = xSemaphoreCreateMutex();
+    }
+    if(flush_mutex == NULL) {
+        flush_mutex = xSemaphoreCreateMutex();
+    }
+#endif
+    int result = create_generic_fram_file();
+    if(result != 0) {
+        return result;
+    }
+    lock_flush();
+    lock_image();
+    result = load_fram_image();
+    if(result == 0) {
+        result = replay_journal();
+    }
+    unlock_image();
+    unlock_flush();
+    return result;
 }
 
 int create_generic_fram_file() {
     int result = change_directory(VIRT_FRAM_PATH , true);
     if(result != 0) {
-        if(result == F_ERR_NOTFOUND) {
+        if(result != F_ERR_NOTFOUND && result != F_ERR_INVALIDDIR) {
+            return result;
+        }
 #if OBSW_VERBOSE_LEVEL >= 1
-            printf("Directory %s does not exist, creating it..\n\r", VIRT_FRAM_PATH);
+        printf("Directory %s does not exist, creating it..\n\r", VIRT_FRAM_PATH);
 #endif
-            create_directory(VIRT_FRAM_PATH, "MISC");
+        result = create_directory("/", VIRT_FRAM_PATH);
+        if(result != 0) {
+            return result;
+        }
+        result = change_directory(VIRT_FRAM_PATH , true);
+        if(result != 0) {
+            return result;
         }
-        return result;
     }
 
     F_FILE* file = NULL;
@@ -42,8 +135,9 @@ int create_generic_fram_file() {
         if(result == F_NO_ERROR) {
             // Check correct size as well and extend file if necessary
             size_t filesize = f_filelength(VIRT_FRAM_NAME);
-            if(filesize < FRAM_END_ADDR + 1) {
-                file = f_truncate(VIRT_FRAM_NAME, FRAM_END_ADDR + 1);
+            if(filesize < VIRT_FRAM_SIZE) {
+                f_close(file);
+                file = f_truncate(VIRT_FRAM_NAME, VIRT_FRAM_SIZE);
             }
             return close_fram_file(file);
         }
@@ -65,7 +159,7 @@ int create_generic_fram_file() {
 
     /* We do it like this so we don't have to allocate a buffer just to create an empty file
     with the correct length */
-    file = f_truncate(VIRT_FRAM_NAME, FRAM_END_ADDR + 1);
+    file = f_truncate(VIRT_FRAM_NAME, VIRT_FRAM_SIZE);
     if(file == NULL) {
         // Could not truncate file should not happen!
         return -1;
@@ -74,52 +168,78 @@ int create_generic_fram_file() {
     return close_fram_file(file);
 }
 
+int virt_fram_flush() {
+    lock_flush();
+    int result = flush_journal();
+    unlock_flush();
+    return result;
+}
+
+size_t virt_fram_get_journal_fill() {
+    lock_image();
+    size_t fill = journal_fill;
+    unlock_image();
+    return fill;
+}
 
 int fram_read_critical_block(uint8_t* buffer, const size_t max_size) {
     size_t size_to_read = sizeof(CriticalDataBlock);
     if(max_size < size_to_read) {
         return -3;
     }
+    return read_image(CRITICAL_BLOCK_START_ADDR, buffer, size_to_read);
+}
 
-    F_FILE* file = NULL;
-    int result = open_fram_file(&file, CRITICAL_BLOCK_START_ADDR, "r");
-    if(result != 0) {
-        return result;
+int fram_read_critical_range(uint32_t address, uint8_t* buffer, size_t size) {
+    if(buffer == NULL || address + size > sizeof(CriticalDataBlock)) {
+        return -3;
     }
+    return read_image(CRITICAL_BLOCK_START_ADDR + address, buffer, size);
+}
 
-    size_t readSize = f_read(buffer, 1, size_to_read, file);
-    if(readSize != size_to_read) {
-        close_fram_file(file);
-        return -1;
+int fram_write_critical_range(uint32_t address, const uint8_t* buffer, size_t size) {
+    if(buffer == NULL || address + size > sizeof(CriticalDataBlock)) {
+        return -3;
     }
-    return close_fram_file(file);
+    return write_image(CRITICAL_BLOCK_START_ADDR + address, buffer, size);
+}
+
+int fram_read_counter_ring_range(uint32_t address, uint8_t* buffer, size_t size) {
+    if(buffer == NULL || address + size > COUNTER_RING_REGION_SIZE) {
+        return -3;
+    }
+    return read_image(COUNTER_RING_REGION_ADDR + address, buffer, size);
 }
 
+int fram_write_counter_ring_range(uint32_t address, const uint8_t* buffer, size_t size) {
+    if(buffer == NULL || address + size > COUNTER_RING_REGION_SIZE) {
+        return -3;
+    }
+    return write_image(COUNTER_RING_REGION_ADDR + address, buffer, size);
+}
 
 int delete_generic_fram_file() {
+    lock_flush();
+    lock_image();
+    journal_fill = 0;
+    journal_records = 0;
+    free(fram_image);
+    fram_image = NULL;
+    unlock_image();
+    unlock_flush();
+
     int result = change_directory(VIRT_FRAM_PATH , true);
     if(result != 0) {
         return result;
     }
 
+    f_delete(VIRT_FRAM_JOURNAL_NAME);
     return f_delete(VIRT_FRAM_NAME);
 }
 
 int fram_set_ham_check_flag() {
-    F_FILE* file = NULL;
-    int result = open_fram_file(&file, HAMMING_CHECK_FLAG_ADDR, "r+");
-    if(result != 0) {
-        return result;
-    }
-
     uint8_t value = 1;
-    result = f_write((void *) &value, 1, 1, file);
-    /* Result is bytes written */
-    if(result != 1) {
-        return -1;
-    }
-
-    return close_fram_file(file);
+    return write_image(HAMMING_CHECK_FLAG_ADDR, &value, sizeof(value));
 }
 
 int fram_set_to_load_softwareupdate(bool enable, VolumeId volume) {
@@ -128,20 +248,8 @@ int fram_set_to_load_softwareupdate(bool enable, VolumeId volume) {
 
 int fram_write_software_version(uint8_t software_version, uint8_t software_subversion,
         uint8_t sw_subsubversion) {
-    F_FILE* file = NULL;
-    int result = open_fram_file(&file, FRAM_SOFTWARE_VERSION_ADDR, "r+");
-    if(result != 0) {
-        return result;
-    }
-
     uint8_t write_buffer[3] = {software_version, software_subversion, sw_subsubversion};
-    result = f_write((void *) write_buffer, sizeof(uint8_t), sizeof(write_buffer), file);
-    /* Result is bytes written */
-    if(result != sizeof(write_buffer)) {
-        close_fram_file(file);
-        return -1;
-    }
-    return close_fram_file(file);
+    return write_image(FRAM_SOFTWARE_VERSION_ADDR, write_buffer, sizeof(write_buffer));
 }
 
 int fram_read_software_version(uint8_t *software_version, uint8_t* software_subversion,
@@ -150,23 +258,16 @@ int fram_read_software_version(uint8_t *software_version, uint8_t* software_subv
         return -3;
     }
 
-    F_FILE* file = NULL;
-    int result = open_fram_file(&file, FRAM_SOFTWARE_VERSION_ADDR, "r");
+    uint8_t read_buffer[3];
+    int result = read_image(FRAM_SOFTWARE_VERSION_ADDR, read_buffer, sizeof(read_buffer));
     if(result != 0) {
         return result;
     }
 
-    uint8_t read_buffer[3];
-    result = f_read(read_buffer, 1, sizeof(read_buffer), file);
-    if(result != sizeof(read_buffer)) {
-        close_fram_file(file);
-        return -1;
-    }
-
     *software_version = read_buffer[0];
     *software_subversion = read_buffer[1];
     *sw_subsubversion = read_buffer[2];
-    return close_fram_file(file);
+    return 0;
 }
 
 int open_fram_file(F_FILE** file, size_t seek_pos, const char* const access_type) {
@@ -217,12 +318,137 @@ int fram_get_ham_check_flag() {
     return 0;
 }
 
+int fram_write_binary_size(SlotType slotType, size_t binary_size) {
+    uint32_t address = determine_binary_size_address(slotType);
+    if(address == 0) {
+        return -3;
+    }
+    return write_image(address, &binary_size,
+            sizeof(((CriticalDataBlock*)0)->bl_group.nor_flash_binary_size));
+}
+
+int fram_read_binary_size(SlotType slotType, size_t *binary_size) {
+    if(binary_size == NULL) {
+        return -4;
+    }
+    uint32_t address = determine_binary_size_address(slotType);
+    if(address == 0) {
+        return -4;
+    }
+    return read_image(address, binary_size,
+            sizeof(((CriticalDataBlock*)0)->bl_group.nor_flash_binary_size));
+}
+
 int fram_set_img_ham_flag(SlotType slotType) {
-    return 0;
+    uint32_t address = determine_ham_flag_address(slotType);
+    if(address == 0) {
+        return -3;
+    }
+    uint16_t value = 1;
+    return write_image(address, &value,
+            sizeof(((CriticalDataBlock*)0)->bl_group.nor_flash_hamming_flag));
 }
 
 int fram_clear_img_ham_flag(SlotType slotType) {
-    return 0;
+    uint32_t address = determine_ham_flag_address(slotType);
+    if(address == 0) {
+        return -3;
+    }
+    uint16_t value = 0;
+    return write_image(address, &value,
+            sizeof(((CriticalDataBlock*)0)->bl_group.nor_flash_hamming_flag));
+}
+
+int fram_get_img_ham_flag(SlotType slotType, bool *flag_set) {
+    if(flag_set == NULL) {
+        return -3;
+    }
+    uint32_t address = determine_ham_flag_address(slotType);
+    if(address == 0) {
+        return -4;
+    }
+    uint16_t flag = 0;
+    int result = read_image(address, &flag,
+            sizeof(((CriticalDataBlock*)0)->bl_group.nor_flash_hamming_flag));
+    if(result == 0) {
+        *flag_set = flag;
+    }
+    return result;
+}
+
+int fram_write_ham_size(SlotType slotType, size_t ham_size) {
+    uint32_t address = determine_ham_size_address(slotType);
+    if(address == 0) {
+        return -3;
+    }
+    return write_image(address, &ham_size,
+            sizeof(((CriticalDataBlock*)0)->bl_group.nor_flash_hamming_code_size));
+}
+
+int fram_read_ham_size(SlotType slotType, size_t *ham_size, bool *ham_flag_set) {
+    if(ham_size == NULL) {
+        return -3;
+    }
+    if(ham_flag_set != NULL) {
+        int result = fram_get_img_ham_flag(slotType, ham_flag_set);
+        if(result != 0) {
+            return result;
+        }
+    }
+    uint32_t address = determine_ham_size_address(slotType);
+    if(address == 0) {
+        return -4;
+    }
+    return read_image(address, ham_size,
+            sizeof(((CriticalDataBlock*)0)->bl_group.nor_flash_hamming_code_size));
+}
+
+int fram_write_ham_code(SlotType slotType, uint8_t *buffer, size_t current_offset,
+        size_t size_to_write) {
+    uint32_t address = 0;
+    int result = determine_ham_code_address_with_sizecheck(slotType, &address,
+            current_offset + size_to_write);
+    if(result != 0) {
+        return result;
+    }
+    return write_image(address + current_offset, buffer, size_to_write);
+}
+
+int fram_read_ham_code(SlotType slotType, uint8_t *buffer, const size_t max_buffer,
+        size_t current_offset, size_t size_to_read, size_t *size_read) {
+    uint32_t address = determine_ham_code_address(slotType);
+    if(address == 0 || buffer == NULL) {
+        return -4;
+    }
+
+    /* Auto-determine size of hamming code */
+    if(size_to_read == 0) {
+        int result = fram_read_ham_size(slotType, &size_to_read, NULL);
+        if(result != 0) {
+            return result;
+        }
+    }
+
+    size_t reserved_size = IMAGES_HAMMING_RESERVED_SIZE;
+    if(slotType == BOOTLOADER_0) {
+        reserved_size = BOOTLOADER_HAMMING_RESERVED_SIZE;
+    }
+    if(current_offset > reserved_size) {
+        return -5;
+    }
+    if(size_to_read + current_offset > reserved_size) {
+        /* Set size to read to remaining size */
+        size_to_read = reserved_size - current_offset;
+    }
+    if(size_to_read > max_buffer) {
+        return -5;
+    }
+
+    int result = read_image(address + current_offset, buffer, size_to_read);
+    if(result == 0 && size_read != NULL) {
+        *size_read = size_to_read;
+    }
+    return result;
 }
 
 int fram_reset_img_reboot_counter(SlotType slotType) {
@@ -230,60 +456,385 @@ int fram_reset_img_reboot_counter(SlotType slotType) {
 }
 
 int fram_read_bootloader_block_raw(uint8_t* buff, size_t max_size) {
-    return 0;
+    if(buff == NULL || max_size < sizeof(BootloaderGroup)) {
+        return -3;
+    }
+    return read_image(CRITICAL_BLOCK_START_ADDR + offsetof(CriticalDataBlock, bl_group), buff,
+            sizeof(BootloaderGroup));
 }
 
 int fram_arm_deployment_timer(bool arm) {
-    return 0;
+    uint8_t value_to_write = arm;
+    return write_image(FRAM_DEPLOY_TIMER_ARMED_ADDR, &value_to_write, sizeof(uint8_t));
 }
 
 int fram_is_deployment_timer_armed(bool *armed) {
+    if(armed == NULL) {
+        return -3;
+    }
+    uint8_t value = 0;
+    int result = read_image(FRAM_DEPLOY_TIMER_ARMED_ADDR, &value, sizeof(uint8_t));
+    if(result != 0) {
+        return result;
+    }
+    *armed = value == 1;
     return 0;
 }
 
 int fram_get_seconds_on_deployment_timer(uint32_t* seconds) {
-    return 0;
+    if(seconds == NULL) {
+        return -3;
+    }
+    return read_image(FRAM_SECONDS_SINCE_TIMER_ARMED_ADDR, seconds, sizeof(uint32_t));
 }
 
 int fram_set_seconds_on_deployment_timer(uint32_t seconds) {
-    return 0;
+    return write_image(FRAM_SECONDS_SINCE_TIMER_ARMED_ADDR, &seconds, sizeof(uint32_t));
 }
 
 int fram_increment_seconds_on_deployment_timer(uint32_t incrementSeconds) {
-    return 0;
+    uint32_t new_sec_value = 0;
+    int result = fram_get_seconds_on_deployment_timer(&new_sec_value);
+    if(result != 0) {
+        return result;
+    }
+    new_sec_value += incrementSeconds;
+    return fram_set_seconds_on_deployment_timer(new_sec_value);
 }
 
 int fram_increment_reboot_counter(uint32_t* new_reboot_counter) {
-    return 0;
+    uint32_t reboot_counter = 0;
+    int result = read_image(REBOOT_COUNTER_ADDR, &reboot_counter, sizeof(uint32_t));
+    if(result != 0) {
+        return result;
+    }
+    reboot_counter++;
+    result = write_image(REBOOT_COUNTER_ADDR, &reboot_counter, sizeof(uint32_t));
+    if(result == 0 && new_reboot_counter != NULL) {
+        *new_reboot_counter = reboot_counter;
+    }
+    return result;
 }
 
 int fram_update_seconds_since_epoch(uint32_t secondsSinceEpoch) {
+    return write_image(SEC_SINCE_EPOCH_ADDR, &secondsSinceEpoch, sizeof(uint32_t));
+}
+
+int fram_read_seconds_since_epoch(uint32_t* secondsSinceEpoch) {
+    if(secondsSinceEpoch == NULL) {
+        return -3;
+    }
+    return read_image(SEC_SINCE_EPOCH_ADDR, secondsSinceEpoch, sizeof(uint32_t));
+}
+
+static void lock_image() {
+#if defined(__unix__)
+    pthread_mutex_lock(&image_mutex);
+#elif !defined(NO_RTOS)
+    if(image_mutex != NULL) {
+        xSemaphoreTake(image_mutex, portMAX_DELAY);
+    }
+#endif
+}
+
+static void unlock_image() {
+#if defined(__unix__)
+    pthread_mutex_unlock(&image_mutex);
+#elif !defined(NO_RTOS)
+    if(image_mutex != NULL) {
+        xSemaphoreGive(image_mutex);
+    }
+#endif
+}
+
+static void lock_flush() {
+#if defined(__unix__)
+    pthread_mutex_lock(&flush_mutex);
+#elif !defined(NO_RTOS)
+    if(flush_mutex != NULL) {
+        xSemaphoreTake(flush_mutex, portMAX_DELAY);
+    }
+#endif
+}
+
+static void unlock_flush() {
+#if defined(__unix__)
+    pthread_mutex_unlock(&flush_mutex);
+#elif !defined(NO_RTOS)
+    if(flush_mutex != NULL) {
+        xSemaphoreGive(flush_mutex);
+    }
+#endif
+}
+
+static int load_fram_image() {
+    if(fram_image == NULL) {
+        fram_image = malloc(VIRT_FRAM_SIZE);
+        if(fram_image == NULL) {
+            return -1;
+        }
+    }
+    journal_fill = 0;
+    journal_records = 0;
+
     F_FILE* file = NULL;
-    int result = open_fram_file(&file, SEC_SINCE_EPOCH_ADDR, "r+");
+    int result = open_fram_file(&file, 0, "r");
     if(result != 0) {
         return result;
     }
-    size_t sizeWritten = f_write(&secondsSinceEpoch, sizeof(uint8_t), sizeof(uint32_t), file);
-    if(sizeWritten != sizeof(uint32_t)) {
-        result = -1;
+    long read_size = f_read(fram_image, 1, VIRT_FRAM_SIZE, file);
+    result = close_fram_file(file);
+    if(read_size != VIRT_FRAM_SIZE) {
+        free(fram_image);
+        fram_image = NULL;
+        return -1;
     }
-    close_fram_file(file);
     return result;
 }
 
-int fram_read_seconds_since_epoch(uint32_t* secondsSinceEpoch) {
-    if(secondsSinceEpoch == NULL) {
-        return -3;
+/**
+ * Replay the journal of a flush which was interrupted after writing the journal file.
+ * A journal without valid header or CRC was not written completely, the FRAM file has not
+ * been touched by that flush in this case.
+ */
+static int replay_journal() {
+    int result = change_directory(VIRT_FRAM_PATH , true);
+    if(result != 0) {
+        return result;
+    }
+    F_FILE* file = f_open(VIRT_FRAM_JOURNAL_NAME, "r");
+    if(file == NULL) {
+        change_directory("/" , true);
+        /* No journal, last flush completed */
+        return 0;
+    }
+
+    JournalHeader header;
+    bool valid = false;
+    if(f_read(&header, 1, sizeof(header), file) == sizeof(header) &&
+            header.magic == VIRT_FRAM_JOURNAL_MAGIC &&
+            header.records_size <= VIRT_FRAM_JOURNAL_SIZE) {
+        valid = f_read(journal, 1, header.records_size, file) == header.records_size &&
+                crc16ccitt_default_start_crc(journal, header.records_size) == header.records_crc;
     }
+    f_close(file);
+    change_directory("/" , true);
+
+    if(valid) {
+#if OBSW_VERBOSE_LEVEL >= 1
+        printf("Virtual FRAM: Replaying %d journal records\n\r", header.number_of_records);
+#endif
+        result = apply_records(journal, header.records_size, true);
+        if(result != 0) {
+            return result;
+        }
+        result = apply_records(journal, header.records_size, false);
+        if(result != 0) {
+            return result;
+        }
+    }
+    result = change_directory(VIRT_FRAM_PATH , true);
+    if(result != 0) {
+        return result;
+    }
+    result = f_delete(VIRT_FRAM_JOURNAL_NAME);
+    change_directory("/" , true);
+    return result;
+}
+
+/**
+ * Apply journal records either to the RAM image or to the FRAM file.
+ */
+static int apply_records(const uint8_t* records, size_t records_size, bool to_image) {
     F_FILE* file = NULL;
-    int result = open_fram_file(&file, SEC_SINCE_EPOCH_ADDR, "r");
+    if(!to_image) {
+        int result = open_fram_file(&file, 0, "r+");
+        if(result != 0) {
+            return result;
+        }
+    }
+
+    int result = 0;
+    size_t idx = 0;
+    while(idx + VIRT_FRAM_RECORD_HEADER_SIZE <= records_size) {
+        uint32_t address = 0;
+        uint16_t size = 0;
+        memcpy(&address, records + idx, sizeof(address));
+        memcpy(&size, records + idx + sizeof(address), sizeof(size));
+        idx += VIRT_FRAM_RECORD_HEADER_SIZE;
+        if(idx + size > records_size || address + size > VIRT_FRAM_SIZE) {
+            result = -1;
+            break;
+        }
+        if(to_image) {
+            memcpy(fram_image + address, records + idx, size);
+        }
+        else if(f_seek(file, address, F_SEEK_SET) != F_NO_ERROR ||
+                f_write((void*) (records + idx), 1, size, file) != size) {
+            result = -1;
+            break;
+        }
+        idx += size;
+    }
+
+    if(!to_image) {
+        int close_result = close_fram_file(file);
+        if(result == 0) {
+            result = close_result;
+        }
+    }
+    return result;
+}
+
+static int read_image(uint32_t address, void* buffer, size_t size) {
+    if(buffer == NULL || address + size > VIRT_FRAM_SIZE) {
+        return -3;
+    }
+    lock_image();
+    if(fram_image == NULL) {
+        unlock_image();
+        return -1;
+    }
+    memcpy(buffer, fram_image + address, size);
+    unlock_image();
+    return 0;
+}
+
+static int write_image(uint32_t address, const void* data, size_t size) {
+    if(data == NULL || address + size > VIRT_FRAM_SIZE) {
+        return -3;
+    }
+    if(size > VIRT_FRAM_MAX_RECORD_SIZE) {
+        return write_through(address, data, size);
+    }
+    lock_image();
+    while(fram_image != NULL &&
+            journal_fill + VIRT_FRAM_RECORD_HEADER_SIZE + size > VIRT_FRAM_JOURNAL_SIZE) {
+        /* The SD card is accessed without holding the image mutex */
+        unlock_image();
+        lock_flush();
+        int result = flush_journal();
+        unlock_flush();
+        if(result != 0) {
+            return result;
+        }
+        lock_image();
+    }
+    if(fram_image == NULL) {
+        unlock_image();
+        return -1;
+    }
+    memcpy(fram_image + address, data, size);
+
+    uint16_t record_size = size;
+    memcpy(journal + journal_fill, &address, sizeof(address));
+    memcpy(journal + journal_fill + sizeof(address), &record_size, sizeof(record_size));
+    memcpy(journal + journal_fill + VIRT_FRAM_RECORD_HEADER_SIZE, data, size);
+    journal_fill += VIRT_FRAM_RECORD_HEADER_SIZE + size;
+    journal_records++;
+    unlock_image();
+    return 0;
+}
+
+/**
+ * Write bulk data to the RAM image and directly to the FRAM file. The journal is flushed
+ * first so that earlier writes, for example clearing a hamming code flag, reach the FRAM file
+ * before the data. Unlike journaled writes, the write is not atomic.
+ */
+static int write_through(uint32_t address, const void* data, size_t size) {
+    lock_flush();
+    int result = flush_journal();
     if(result != 0) {
+        unlock_flush();
         return result;
     }
-    size_t sizeRead = f_read(secondsSinceEpoch, sizeof(uint8_t), sizeof(uint32_t), file);
-    if(sizeRead != sizeof(uint32_t)) {
+    lock_image();
+    if(fram_image == NULL) {
+        unlock_image();
+        unlock_flush();
+        return -1;
+    }
+    memcpy(fram_image + address, data, size);
+    unlock_image();
+
+    F_FILE* file = NULL;
+    result = open_fram_file(&file, address, "r+");
+    if(result == 0 && f_write((void*) data, 1, size, file) != (long) size) {
         result = -1;
     }
-    close_fram_file(file);
+    if(file != NULL) {
+        int close_result = close_fram_file(file);
+        if(result == 0) {
+            result = close_result;
+        }
+    }
+    unlock_flush();
     return result;
 }
+
+/**
+ * Write the journal file first and then apply the records to the FRAM file. The journal
+ * file is deleted after the FRAM file was updated successfully. Has to be called with the
+ * flush mutex taken. The journal is copied, so writes can be recorded during the flush.
+ */
+static int flush_journal() {
+    lock_image();
+    size_t flush_size = journal_fill;
+    uint16_t flush_records = journal_records;
+    memcpy(flush_buffer, journal, flush_size);
+    unlock_image();
+    if(flush_size == 0) {
+        return 0;
+    }
+
+    int result = change_directory(VIRT_FRAM_PATH , true);
+    if(result != 0) {
+        return result;
+    }
+    JournalHeader header;
+    header.magic = VIRT_FRAM_JOURNAL_MAGIC;
+    header.number_of_records = flush_records;
+    header.records_size = flush_size;
+    header.records_crc = crc16ccitt_default_start_crc(flush_buffer, flush_size);
+    header.reserved = 0;
+
+    F_FILE* file = f_open(VIRT_FRAM_JOURNAL_NAME, "w");
+    if(file == NULL) {
+        result = f_getlasterror();
+        change_directory("/" , true);
+        return result;
+    }
+    if(f_write(&header, 1, sizeof(header), file) != sizeof(header) ||
+            f_write(flush_buffer, 1, flush_size, file) != (long) flush_size) {
+        result = -1;
+    }
+    int close_result = f_close(file);
+    change_directory("/" , true);
+    if(result != 0 || close_result != F_NO_ERROR) {
+        /* The incomplete journal will be discarded on startup */
+        return -1;
+    }
+
+    result = apply_records(flush_buffer, flush_size, false);
+    if(result != 0) {
+        /* The journal will be replayed on startup */
+        return result;
+    }
+    result = change_directory(VIRT_FRAM_PATH , true);
+    if(result != 0) {
+        return result;
+    }
+    result = f_delete(VIRT_FRAM_JOURNAL_NAME);
+    change_directory("/" , true);
+    if(result != F_NO_ERROR) {
+        return result;
+    }
+
+    /* Writes which were recorded during the flush stay in the journal */
+    lock_image();
+    memmove(journal, journal + flush_size, journal_fill - flush_size);
+    journal_fill -= flush_size;
+    journal_records -= flush_records;
+    unlock_image();
+    return 0;
+}
@@ -2,6 +2,14 @@
  * Contains virtualized FRAM module, using the SD card to emulate the FRAM for the AT91 board.
  * It is assumed that the file system has been set up before calling these functions!
  * Also see SDCardApi or the SDCardAccess class.
+ *
+ * The content of the FRAM file is loaded into RAM by FRAM_start and all reads and writes
+ * are memory accesses. Writes are also recorded in a journal which is written to the FRAM
+ * file by virt_fram_flush or when the journal is full, so only writes can access the
+ * SD card. A flush first stores the journal in a separate file and then updates the
+ * FRAM file. If the update is interrupted, the journal is replayed by FRAM_start.
+ * Bulk writes like hamming codes are written to the FRAM file directly after flushing the
+ * journal and are not atomic.
  */
 #ifndef SAM9G20_COMMON_VIRTUALFRAMAPI_H_
 #define SAM9G20_COMMON_VIRTUALFRAMAPI_H_
@@ -15,6 +23,10 @@ extern "C" {
 
 static const char* const VIRT_FRAM_NAME = "FRAM.BIN";
 static const char* const VIRT_FRAM_PATH = "MISC";
+static const char* const VIRT_FRAM_JOURNAL_NAME = "FRAMJRNL.BIN";
+
+//! Size of the journal in RAM. Each write requires 6 bytes in addition to its data.
+#define VIRT_FRAM_JOURNAL_SIZE      1024
 
 /**
  * Start the virtualized FRAM by creating a FRAM file on the SD-Card. This function will
@@ -24,6 +36,17 @@ static const char* const VIRT_FRAM_PATH = "MISC";
  */
 int FRAM_start();
 
+/**
+ * Write the journaled writes to the FRAM file. Should be called periodically.
+ * @return
+ */
+int virt_fram_flush();
+
+/**
+ * @return Number of journal bytes which have not been flushed yet
+ */
+size_t virt_fram_get_journal_fill();
+
 int fram_read_critical_block(uint8_t* buffer, const size_t max_size);
 
 /**
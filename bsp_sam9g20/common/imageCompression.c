@@ -0,0 +1,170 @@
+#include "imageCompression.h"
+
+#define WINDOW_MASK         (IMAGE_COMPRESSION_WINDOW_SIZE - 1)
+#define MIN_MATCH_LENGTH    4
+#define EXTENDED_LENGTH     15
+
+typedef enum {
+    STATE_TOKEN,
+    STATE_LITERAL_LENGTH,
+    STATE_LITERALS,
+    STATE_OFFSET_LOW,
+    STATE_OFFSET_HIGH,
+    STATE_MATCH_LENGTH,
+    STATE_MATCH,
+    //! Errors are sticky, the decompressor has to be initialized again
+    STATE_ERROR
+} DecompressorState;
+
+static uint32_t read_big_endian(const uint8_t* data, size_t size);
+
+static inline void produce_byte(ImageDecompressor* decompressor, uint8_t byte,
+        uint8_t** output) {
+    decompressor->window[decompressor->output_count & WINDOW_MASK] = byte;
+    decompressor->output_count++;
+    **output = byte;
+    (*output)++;
+}
+
+int image_compression_read_header(const uint8_t* data, size_t size,
+        ImageCompressionHeader* header) {
+    if(data == NULL || header == NULL || size < IMAGE_COMPRESSION_HEADER_SIZE) {
+        return IMAGE_COMPRESSION_NO_HEADER;
+    }
+    if(read_big_endian(data, 4) != IMAGE_COMPRESSION_MAGIC) {
+        return IMAGE_COMPRESSION_NO_HEADER;
+    }
+    header->image_size = read_big_endian(data + 4, 4);
+    header->image_crc = (uint16_t) read_big_endian(data + 8, 2);
+    header->compressed_size = read_big_endian(data + 12, 4);
+    return IMAGE_COMPRESSION_OK;
+}
+
+void image_decompressor_init(ImageDecompressor* decompressor) {
+    decompressor->state = STATE_TOKEN;
+    decompressor->token = 0;
+    decompressor->literal_length = 0;
+    decompressor->match_length = 0;
+    decompressor->match_offset = 0;
+    decompressor->output_count = 0;
+}
+
+int image_decompress(ImageDecompressor* decompressor, const uint8_t** input,
+        size_t* input_size, uint8_t** output, size_t* output_size) {
+    const uint8_t* in = *input;
+    const uint8_t* in_end = in + *input_size;
+    uint8_t* out = *output;
+    uint8_t* out_end = out + *output_size;
+    int result = IMAGE_COMPRESSION_OK;
+
+    /* Each state only continues if there is enough input or output space, so the data can be
+    split at any position */
+    while(result == IMAGE_COMPRESSION_OK) {
+        if(decompressor->state == STATE_TOKEN) {
+            if(in == in_end) {
+                break;
+            }
+            decompressor->token = *in++;
+            decompressor->literal_length = decompressor->token >> 4;
+            if(decompressor->literal_length == EXTENDED_LENGTH) {
+                decompressor->state = STATE_LITERAL_LENGTH;
+            }
+            else {
+                decompressor->state = STATE_LITERALS;
+            }
+        }
+        else if(decompressor->state == STATE_LITERAL_LENGTH) {
+            if(in == in_end) {
+                break;
+            }
+            uint8_t length_byte = *in++;
+            decompressor->literal_length += length_byte;
+            if(length_byte != 255) {
+                decompressor->state = STATE_LITERALS;
+            }
+        }
+        else if(decompressor->state == STATE_LITERALS) {
+            while(decompressor->literal_length > 0 && in < in_end && out < out_end) {
+                produce_byte(decompressor, *in++, &out);
+                decompressor->literal_length--;
+            }
+            if(decompressor->literal_length > 0) {
+                break;
+            }
+            decompressor->state = STATE_OFFSET_LOW;
+        }
+        else if(decompressor->state == STATE_OFFSET_LOW) {
+            /* The last sequence only consists of literals, so the data can end here */
+            if(in == in_end) {
+                break;
+            }
+            decompressor->match_offset = *in++;
+            decompressor->state = STATE_OFFSET_HIGH;
+        }
+        else if(decompressor->state == STATE_OFFSET_HIGH) {
+            if(in == in_end) {
+                break;
+            }
+            decompressor->match_offset |= (uint16_t) (*in++) << 8;
+            uint16_t offset = decompressor->match_offset;
+            if(offset == 0 || offset > IMAGE_COMPRESSION_WINDOW_SIZE ||
+                    offset > decompressor->output_count) {
+                decompressor->state = STATE_ERROR;
+                result = IMAGE_COMPRESSION_INVALID;
+                break;
+            }
+            decompressor->match_length = (decompressor->token & 0x0f) + MIN_MATCH_LENGTH;
+            if((decompressor->token & 0x0f) == EXTENDED_LENGTH) {
+                decompressor->state = STATE_MATCH_LENGTH;
+            }
+            else {
+                decompressor->state = STATE_MATCH;
+            }
+        }
+        else if(decompressor->state == STATE_MATCH_LENGTH) {
+            if(in == in_end) {
+                break;
+            }
+            uint8_t length_byte = *in++;
+            decompressor->match_length += length_byte;
+            if(length_byte != 255) {
+                decompressor->state = STATE_MATCH;
+            }
+        }
+        else if(decompressor->state == STATE_MATCH) {
+            /* Overlapping matches are resolved correctly because the copy is done bytewise */
+            while(decompressor->match_length > 0 && out < out_end) {
+                uint8_t byte = decompressor->window[(decompressor->output_count -
+                        decompressor->match_offset) & WINDOW_MASK];
+                produce_byte(decompressor, byte, &out);
+                decompressor->match_length--;
+            }
+            if(decompressor->match_length > 0) {
+                break;
+            }
+            decompressor->state = STATE_TOKEN;
+        }
+        else {
+            decompressor->state = STATE_ERROR;
+            result = IMAGE_COMPRESSION_INVALID;
+        }
+    }
+
+    *input_size -= in - *input;
+    *input = in;
+    *output_size -= out - *output;
+    *output = out;
+    return result;
+}
+
+bool image_decompressor_finished(const ImageDecompressor* decompressor) {
+    return decompressor->state == STATE_TOKEN || decompressor->state == STATE_OFFSET_LOW;
+}
+
+static uint32_t read_big_endian(const uint8_t* data, size_t size) {
+    uint32_t value = 0;
+    for(size_t idx = 0; idx < size; idx++) {
+        value = (value << 8) | data[idx];
+    }
+    return value;
+}
@@ -0,0 +1,98 @@
+#ifndef SAM9G20_COMMON_IMAGECOMPRESSION_H_
+#define SAM9G20_COMMON_IMAGECOMPRESSION_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief   Common API to decompress compressed software images.
+ * @details
+ * Image slots on the SD card can contain a compressed image instead of the raw binary.
+ * A compressed image starts with a header, followed by a sequence of LZ4 block format
+ * sequences. The back references are limited to the last IMAGE_COMPRESSION_WINDOW_SIZE bytes,
+ * so the image can be decompressed in a streaming way with a small window buffer, for example
+ * while the image is read from the SD card.
+ *
+ * Header (all fields big endian):
+ *  - Magic (4 bytes)
+ *  - Uncompressed image size (4)
+ *  - CRC16-CCITT of the uncompressed image (2)
+ *  - Reserved (2)
+ *  - Size of the compressed data following the header (4)
+ *
+ * Compressed images can be created with misc/create_compressed_image.py
+ */
+
+static const uint32_t IMAGE_COMPRESSION_MAGIC = 0x4C5A494D;
+#define IMAGE_COMPRESSION_HEADER_SIZE   16
+//! Maximum distance of a back reference
+#define IMAGE_COMPRESSION_WINDOW_SIZE   8192
+
+static const int IMAGE_COMPRESSION_OK = 0;
+//! The data is not a compressed image
+static const int IMAGE_COMPRESSION_NO_HEADER = 1;
+//! The compressed data is corrupted
+static const int IMAGE_COMPRESSION_INVALID = -1;
+
+typedef struct {
+    uint32_t image_size;
+    uint16_t image_crc;
+    uint32_t compressed_size;
+} ImageCompressionHeader;
+
+typedef struct {
+    uint8_t state;
+    uint8_t token;
+    uint32_t literal_length;
+    uint32_t match_length;
+    uint16_t match_offset;
+    //! Total number of bytes produced
+    uint32_t output_count;
+    //! The last bytes which were produced, used to resolve back references
+    uint8_t window[IMAGE_COMPRESSION_WINDOW_SIZE];
+} ImageDecompressor;
+
+/**
+ * Parse the header at the start of an image slot.
+ * @param data      At least IMAGE_COMPRESSION_HEADER_SIZE bytes
+ * @param header    Will be filled if the data starts with a valid header
+ * @return
+ *  - IMAGE_COMPRESSION_OK if the image is compressed
+ *  - IMAGE_COMPRESSION_NO_HEADER for raw images
+ */
+int image_compression_read_header(const uint8_t* data, size_t size,
+        ImageCompressionHeader* header);
+
+void image_decompressor_init(ImageDecompressor* decompressor);
+
+/**
+ * Decompress the next part of the compressed data. Can be called repeatedly with consecutive
+ * parts of the compressed data, which can be split at any position.
+ * @param decompressor
+ * @param input         Compressed data, will be advanced by the number of bytes consumed
+ * @param input_size    Remaining compressed data, will be decremented accordingly
+ * @param output        Destination, will be advanced by the number of bytes produced
+ * @param output_size   Space left in the destination, will be decremented accordingly
+ * @return
+ *  - IMAGE_COMPRESSION_OK if all input was consumed or the output is full
+ *  - IMAGE_COMPRESSION_INVALID if the data is corrupted
+ */
+int image_decompress(ImageDecompressor* decompressor, const uint8_t** input,
+        size_t* input_size, uint8_t** output, size_t* output_size);
+
+/**
+ * Can be used after all compressed data was passed to the decompressor.
+ * @return True if the compressed data ended at the end of a sequence
+ */
+bool image_decompressor_finished(const ImageDecompressor* decompressor);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SAM9G20_COMMON_IMAGECOMPRESSION_H_ */
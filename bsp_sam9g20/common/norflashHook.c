@@ -1,14 +1,32 @@
 #ifndef BSP_SAM9G20_COMMON_NORFLASHHOOK_C_
 #define BSP_SAM9G20_COMMON_NORFLASHHOOK_C_
 
+#include "norflashHook.h"
+
+#include <stddef.h>
+
 #ifndef NO_RTOS
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #endif
 
+static norflash_wait_callback_t waitCallback = NULL;
+static void* waitCallbackArgs = NULL;
+
+void norflash_set_wait_callback(norflash_wait_callback_t callback, void* args) {
+    waitCallbackArgs = args;
+    waitCallback = callback;
+}
+
 /* This implementation is required for the ISIS solution in the AT91 Nor-Flash library if
 the AT91 library is not linked against the HAL library */
 void NorFlash_Hook(void) {
+    if(waitCallback != NULL) {
+        if(waitCallback(waitCallbackArgs) != 0) {
+            /* Work was done while the NOR-Flash was busy, poll the status again */
+            return;
+        }
+    }
 #ifndef NO_RTOS
     if(xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
         vTaskDelay(100);
@@ -0,0 +1,28 @@
+#ifndef SAM9G20_COMMON_NORFLASHHOOK_H_
+#define SAM9G20_COMMON_NORFLASHHOOK_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Callback which is called while the NOR-Flash is busy with an erase operation.
+ * @return 1 if work was done and the erase status should be polled again immediately,
+ * 0 if the task should be delayed before polling again
+ */
+typedef int (*norflash_wait_callback_t)(void* args);
+
+/**
+ * Set a callback which is called while waiting for a NOR-Flash erase operation to complete.
+ * The NOR-Flash can not be read while it is erasing, but other work like reading the next
+ * data to program from the SD card can be done in the meantime.
+ * @param callback  Callback function or NULL to remove the callback
+ * @param args      Arguments passed to the callback
+ */
+void norflash_set_wait_callback(norflash_wait_callback_t callback, void* args);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SAM9G20_COMMON_NORFLASHHOOK_H_ */
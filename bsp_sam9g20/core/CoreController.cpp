@@ -6,13 +6,18 @@
 
 #include "bsp_sam9g20/memory/FRAMHandler.h"
 #include "bsp_sam9g20/common/fram/FRAMApi.h"
+#ifdef AT91SAM9G20_EK
+#include "bsp_sam9g20/common/fram/VirtualFRAMApi.h"
+#endif
 #include "bsp_sam9g20/memory/SDCardAccess.h"
 #include "bsp_sam9g20/common/SRAMApi.h"
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
+#include "fsfw/datapool/PoolReadGuard.h"
 #include "fsfw/ipc/QueueFactory.h"
+#include "fsfw/serialize/SerializeAdapter.h"
 #include "fsfw/tasks/TaskFactory.h"
 #include "fsfw/timemanager/Clock.h"
 #include "fsfw/timemanager/Stopwatch.h"
@@ -41,6 +46,8 @@ MutexIF* CoreController::timeMutex = nullptr;
 CoreController::CoreController(object_id_t objectId,
         object_id_t systemStateTaskId):
                         ExtendedControllerBase(objectId, objects::NO_OBJECT),
+                        cpuStatsSet(this), taskTimingSet(this), stackSet(this),
+                        storeStatsSet(this),
                         systemStateTaskId(systemStateTaskId) {
     timeMutex = MutexFactory::instance()->createMutex();
 #ifdef ISIS_OBC_G20
@@ -58,6 +65,10 @@ void CoreController::performControlOperation() {
     performSupervisorHandling();
     // Second task: All time related handling
     performPeriodicTimeHandling();
+    // Third task: CPU statistics housekeeping
+    performCpuStatsSampling();
+    // Fourth task: Store usage housekeeping
+    performStoreStatsSampling();
 }
 
 ReturnValue_t CoreController::handleCommandMessage(CommandMessage *message) {
@@ -148,6 +159,23 @@ ReturnValue_t CoreController::executeAction(ActionId_t actionId,
         }
         return getFillCountCommand(static_cast<Stores>(data[STORE_TYPE]), commandedBy, actionId);
     }
+    case(RECOMMEND_STORE_CONFIG): {
+        return recommendStoreConfigCommand(data, size, commandedBy, actionId);
+    }
+    case(RESET_STORE_STATS): {
+        if (size != 1) {
+            return HasActionsIF::INVALID_PARAMETERS;
+        }
+        MonitoredPoolManager* store = getMonitoredStore(static_cast<Stores>(data[STORE_TYPE]));
+        if(store == nullptr) {
+            return HasActionsIF::INVALID_PARAMETERS;
+        }
+        ReturnValue_t result = store->resetStats();
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
+        }
+        return HasActionsIF::EXECUTION_FINISHED;
+    }
     case(RESET_REBOOT_COUNTER): {
         return resetRebootCounter(actionId, commandedBy, data, size);
     }
@@ -164,6 +192,16 @@ ReturnValue_t CoreController::executeAction(ActionId_t actionId,
         return manipulateLocalHammingFlag(false, actionId, commandedBy, data, size);
     }
     case(ARM_DEPLOYMENT_TIMER): {
+#ifdef ISIS_OBC_G20
+        if(framHandler != nullptr) {
+            CriticalDataCache& cache = framHandler->getCriticalDataCache();
+            cache.write(CriticalDataCache::DEPLOY_TIMER_ARMED, static_cast<uint8_t>(true));
+            if(cache.flush() == HasReturnvaluesIF::RETURN_OK) {
+                return HasActionsIF::EXECUTION_FINISHED;
+            }
+            return HasReturnvaluesIF::RETURN_FAILED;
+        }
+#endif
         int result = fram_arm_deployment_timer(true);
         if(result == 0) {
             return HasActionsIF::EXECUTION_FINISHED;
@@ -199,6 +237,12 @@ ReturnValue_t CoreController::executeAction(ActionId_t actionId,
             actionHelper.finish(false, commandedBy, actionId, errorVal);
             return result;
         }
+#ifdef ISIS_OBC_G20
+        if(framHandler != nullptr) {
+            /* Owned fields like the reboot counter were written without the cache */
+            framHandler->getCriticalDataCache().load();
+        }
+#endif
         return HasActionsIF::EXECUTION_FINISHED;
     }
     default:
@@ -232,6 +276,11 @@ ReturnValue_t CoreController::initializeAfterTaskCreation() {
                 " counter!\n");
 #endif
     }
+#ifdef ISIS_OBC_G20
+    if(framHandler != nullptr) {
+        framHandler->getCriticalDataCache().invalidate(CriticalDataCache::REBOOT_COUNTER);
+    }
+#endif
     triggerEvent(BOOT_EVENT, new_reboot_counter, 0);
 
     result = initializeTimerDrivers();
@@ -337,6 +386,58 @@ ReturnValue_t CoreController::getFillCountCommand(Stores storeType, MessageQueue
     return HasActionsIF::EXECUTION_FINISHED;
 }
 
+ReturnValue_t CoreController::recommendStoreConfigCommand(const uint8_t* data, size_t size,
+        MessageQueueId_t commandedBy, ActionId_t replyId) {
+    if(size < 1 or size > 2) {
+        return HasActionsIF::INVALID_PARAMETERS;
+    }
+    MonitoredPoolManager* store = getMonitoredStore(static_cast<Stores>(data[STORE_TYPE]));
+    if(store == nullptr) {
+        return HasActionsIF::INVALID_PARAMETERS;
+    }
+    uint8_t marginPercent = storestats::DEFAULT_MARGIN_PERCENT;
+    if(size == 2) {
+        marginPercent = data[1];
+    }
+    LocalPool::LocalPoolConfig recommendedConfig;
+    ReturnValue_t result = store->getRecommendedConfig(marginPercent, &recommendedConfig);
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        return result;
+    }
+
+    /* Store type and number of subpools, followed by the number of elements (2 bytes) and
+    the element size (4 bytes) of each subpool */
+    uint8_t buffer[2 + storestats::MAX_NUMBER_OF_SUBPOOLS * 6];
+    buffer[0] = data[STORE_TYPE];
+    buffer[1] = recommendedConfig.size();
+    uint8_t* bufferPtr = buffer + 2;
+    size_t serializedSize = 2;
+    for(auto const& subpoolConfig: recommendedConfig) {
+        SerializeAdapter::serialize(&subpoolConfig.first, &bufferPtr, &serializedSize,
+                sizeof(buffer), SerializeIF::Endianness::BIG);
+        SerializeAdapter::serialize(&subpoolConfig.second, &bufferPtr, &serializedSize,
+                sizeof(buffer), SerializeIF::Endianness::BIG);
+#if OBSW_VERBOSE_LEVEL >= 1
+        sif::printInfo("CoreController: Recommended subpool for store %d: {%u, %lu}\n",
+                data[STORE_TYPE], static_cast<unsigned int>(subpoolConfig.first),
+                static_cast<unsigned long>(subpoolConfig.second));
+#endif
+    }
+    result = actionHelper.reportData(commandedBy, replyId, buffer, serializedSize);
+    if (result != HasReturnvaluesIF::RETURN_OK) {
+        return result;
+    }
+    return HasActionsIF::EXECUTION_FINISHED;
+}
+
+MonitoredPoolManager* CoreController::getMonitoredStore(Stores storeType) {
+    StorageManagerIF* store = nullptr;
+    if(storeSelect(&store, storeType) != HasReturnvaluesIF::RETURN_OK) {
+        return nullptr;
+    }
+    return dynamic_cast<MonitoredPoolManager*>(store);
+}
+
 ReturnValue_t CoreController::handleClearStoreCommand(Stores storeType, ActionId_t pageOrWholeStore,
         StorageManagerIF::max_subpools_t poolIndex) {
 
@@ -365,13 +466,120 @@ ReturnValue_t CoreController::handleClearStoreCommand(Stores storeType, ActionId
 
 ReturnValue_t CoreController::initializeLocalDataPool(localpool::DataPool &localDataPoolMap,
         LocalDataPoolManager &poolManager) {
+    localDataPoolMap.emplace(cpustats::PoolIds::SAMPLE_COUNT, new PoolEntry<uint32_t>({0}));
+    localDataPoolMap.emplace(cpustats::PoolIds::TOTAL_RUN_TIME_DELTA,
+            new PoolEntry<uint32_t>({0}));
+    localDataPoolMap.emplace(cpustats::PoolIds::NUMBER_OF_TASKS, new PoolEntry<uint8_t>({0}));
+    localDataPoolMap.emplace(cpustats::PoolIds::TASK_NUMBERS,
+            new PoolEntry<uint16_t>(nullptr, cpustats::MAX_NUMBER_OF_TASKS));
+    localDataPoolMap.emplace(cpustats::PoolIds::TASK_STATES,
+            new PoolEntry<uint8_t>(nullptr, cpustats::MAX_NUMBER_OF_TASKS));
+    localDataPoolMap.emplace(cpustats::PoolIds::STACK_HIGH_WATER_MARKS,
+            new PoolEntry<uint16_t>(nullptr, cpustats::MAX_NUMBER_OF_TASKS));
+    localDataPoolMap.emplace(cpustats::PoolIds::RUN_TIME_DELTAS,
+            new PoolEntry<uint32_t>(nullptr, cpustats::MAX_NUMBER_OF_TASKS));
+    /* Sampled continuously, so the packets are enabled by default */
+    poolManager.subscribeForPeriodicPacket(cpuStatsSet.getSid(), true,
+            cpustats::SAMPLE_INTERVAL_SECONDS, false);
+
+    localDataPoolMap.emplace(tasktiming::PoolIds::NUMBER_OF_TASKS, new PoolEntry<uint8_t>({0}));
+    localDataPoolMap.emplace(tasktiming::PoolIds::TASK_OBJECT_IDS,
+            new PoolEntry<uint32_t>(nullptr, tasktiming::MAX_NUMBER_OF_TASKS));
+    localDataPoolMap.emplace(tasktiming::PoolIds::CYCLE_COUNTS,
+            new PoolEntry<uint32_t>(nullptr, tasktiming::MAX_NUMBER_OF_TASKS));
+    localDataPoolMap.emplace(tasktiming::PoolIds::MIN_EXECUTION_TIMES,
+            new PoolEntry<uint32_t>(nullptr, tasktiming::MAX_NUMBER_OF_TASKS));
+    localDataPoolMap.emplace(tasktiming::PoolIds::MEAN_EXECUTION_TIMES,
+            new PoolEntry<uint32_t>(nullptr, tasktiming::MAX_NUMBER_OF_TASKS));
+    localDataPoolMap.emplace(tasktiming::PoolIds::MAX_EXECUTION_TIMES,
+            new PoolEntry<uint32_t>(nullptr, tasktiming::MAX_NUMBER_OF_TASKS));
+    localDataPoolMap.emplace(tasktiming::PoolIds::HISTOGRAMS,
+            new PoolEntry<uint32_t>(nullptr, tasktiming::HISTOGRAM_SIZE));
+    localDataPoolMap.emplace(tasktiming::PoolIds::DEADLINE_MISSES,
+            new PoolEntry<uint32_t>(nullptr, tasktiming::MAX_NUMBER_OF_TASKS));
+    localDataPoolMap.emplace(tasktiming::PoolIds::OVERRUNS,
+            new PoolEntry<uint32_t>(nullptr, tasktiming::MAX_NUMBER_OF_TASKS));
+    /* Only needed while sizing the task periods, enabled by ground */
+    poolManager.subscribeForPeriodicPacket(taskTimingSet.getSid(), false, 60.0, false);
+
+    localDataPoolMap.emplace(stackmon::PoolIds::SAMPLE_COUNT, new PoolEntry<uint32_t>({0}));
+    localDataPoolMap.emplace(stackmon::PoolIds::NUMBER_OF_TASKS, new PoolEntry<uint8_t>({0}));
+    localDataPoolMap.emplace(stackmon::PoolIds::TASK_OBJECT_IDS,
+            new PoolEntry<uint32_t>(nullptr, stackmon::MAX_NUMBER_OF_TASKS));
+    localDataPoolMap.emplace(stackmon::PoolIds::MIN_REMAINING_STACKS,
+            new PoolEntry<uint32_t>(nullptr, stackmon::MAX_NUMBER_OF_TASKS));
+    poolManager.subscribeForPeriodicPacket(stackSet.getSid(), false, 300.0, false);
+
+    localDataPoolMap.emplace(storestats::PoolIds::NUMBER_OF_ELEMENTS,
+            new PoolEntry<uint16_t>(nullptr, storestats::NUMBER_OF_ENTRIES));
+    localDataPoolMap.emplace(storestats::PoolIds::ELEMENT_SIZES,
+            new PoolEntry<uint32_t>(nullptr, storestats::NUMBER_OF_ENTRIES));
+    localDataPoolMap.emplace(storestats::PoolIds::USED_ELEMENTS,
+            new PoolEntry<uint16_t>(nullptr, storestats::NUMBER_OF_ENTRIES));
+    localDataPoolMap.emplace(storestats::PoolIds::HIGH_WATER_MARKS,
+            new PoolEntry<uint16_t>(nullptr, storestats::NUMBER_OF_ENTRIES));
+    localDataPoolMap.emplace(storestats::PoolIds::ALLOCATION_FAILURES,
+            new PoolEntry<uint32_t>(nullptr, storestats::NUMBER_OF_ENTRIES));
+    poolManager.subscribeForPeriodicPacket(storeStatsSet.getSid(), true, 60.0, false);
     return HasReturnvaluesIF::RETURN_OK;
 }
 
 LocalPoolDataSetBase* CoreController::getDataSetHandle(sid_t sid) {
+    if(sid == cpuStatsSet.getSid()) {
+        return &cpuStatsSet;
+    }
+    if(sid == taskTimingSet.getSid()) {
+        return &taskTimingSet;
+    }
+    if(sid == stackSet.getSid()) {
+        return &stackSet;
+    }
+    if(sid == storeStatsSet.getSid()) {
+        return &storeStatsSet;
+    }
     return nullptr;
 }
 
+void CoreController::performCpuStatsSampling() {
+    uint32_t currentUptimeSeconds = getUptimeSeconds();
+    if(systemStateTask == nullptr or
+            currentUptimeSeconds - lastCpuStatsSample < cpustats::SAMPLE_INTERVAL_SECONDS) {
+        return;
+    }
+    /* Retried in the next cycle if the system state task is still busy */
+    if(systemStateTask->generateStatsSample()) {
+        lastCpuStatsSample = currentUptimeSeconds;
+    }
+}
+
+void CoreController::performStoreStatsSampling() {
+    uint32_t currentUptimeSeconds = getUptimeSeconds();
+    if(currentUptimeSeconds - lastStoreStatsSample < storestats::SAMPLE_INTERVAL_SECONDS) {
+        return;
+    }
+    lastStoreStatsSample = currentUptimeSeconds;
+    PoolReadGuard readHelper(&storeStatsSet);
+    if(readHelper.getReadResult() != HasReturnvaluesIF::RETURN_OK) {
+        return;
+    }
+    for(uint8_t storeIdx = 0; storeIdx < storestats::NUMBER_OF_STORES; storeIdx++) {
+        MonitoredPoolManager* store = getMonitoredStore(static_cast<Stores>(storeIdx));
+        for(uint8_t subpool = 0; subpool < storestats::MAX_NUMBER_OF_SUBPOOLS; subpool++) {
+            MonitoredPoolManager::SubpoolStats stats;
+            if(store != nullptr) {
+                /* Not existing subpools leave the statistics zero */
+                store->getSubpoolStats(subpool, &stats);
+            }
+            size_t idx = storeIdx * storestats::MAX_NUMBER_OF_SUBPOOLS + subpool;
+            storeStatsSet.numberOfElements[idx] = stats.numberOfElements;
+            storeStatsSet.elementSizes[idx] = stats.elementSize;
+            storeStatsSet.usedElements[idx] = stats.usedElements;
+            storeStatsSet.highWaterMarks[idx] = stats.highWaterMark;
+            storeStatsSet.allocationFailures[idx] = stats.allocationFailures;
+        }
+    }
+    storeStatsSet.setValidity(true, true);
+}
 
 void CoreController::performPeriodicTimeHandling() {
     // Stopwatch stopwatch;
@@ -401,10 +609,17 @@ void CoreController::performPeriodicTimeHandling() {
     int result = 0;
 #ifdef ISIS_OBC_G20
     Time_getUnixEpoch(reinterpret_cast<unsigned int*>(&epochTime));
-    result = fram_update_seconds_since_epoch(static_cast<uint32_t>(epochTime));
-    if(result != 0) {
-        sif::printWarning("CoreController::performPeriodicTimeHandling: "
-                "FRAM deployment timer read failure with code %d\n", result);
+    if(framHandler != nullptr) {
+        /* Written to the FRAM together with the deployment timer further below */
+        framHandler->getCriticalDataCache().write(CriticalDataCache::SECONDS_SINCE_EPOCH,
+                static_cast<uint32_t>(epochTime));
+    }
+    else {
+        result = fram_update_seconds_since_epoch(static_cast<uint32_t>(epochTime));
+        if(result != 0) {
+            sif::printWarning("CoreController::performPeriodicTimeHandling: "
+                    "FRAM deployment timer read failure with code %d\n", result);
+        }
     }
 #elif defined(AT91SAM9G20_EK)
     /* For the AT91, we can add elapsed time since last check onto the time
@@ -437,7 +652,14 @@ void CoreController::performPeriodicTimeHandling() {
     // occasionally because the filesystem is really slow.
 #ifdef ISIS_OBC_G20
     bool deploymentTimerArmed = false;
-    result = fram_is_deployment_timer_armed(&deploymentTimerArmed);
+    if(framHandler != nullptr) {
+        uint8_t armed = 0;
+        framHandler->getCriticalDataCache().read(CriticalDataCache::DEPLOY_TIMER_ARMED, &armed);
+        deploymentTimerArmed = armed;
+    }
+    else {
+        result = fram_is_deployment_timer_armed(&deploymentTimerArmed);
+    }
 #endif
     if(deploymentTimerArmed) {
         if(currentUptimeSeconds - lastDeploymentTimerIncrement > 2) {
@@ -447,14 +669,38 @@ void CoreController::performPeriodicTimeHandling() {
 #else
 #if OBSW_SD_CARD_PRESENT == 1
             // Update FRAM value immediately
-            fram_increment_seconds_on_deployment_timer(
-                    currentUptimeSeconds - lastDeploymentTimerIncrement);
+            if(framHandler != nullptr) {
+                CriticalDataCache& cache = framHandler->getCriticalDataCache();
+                uint32_t secondsSinceArmed = 0;
+                if(cache.read(CriticalDataCache::SECONDS_SINCE_TIMER_ARMED,
+                        &secondsSinceArmed) == HasReturnvaluesIF::RETURN_OK) {
+                    cache.write(CriticalDataCache::SECONDS_SINCE_TIMER_ARMED, secondsSinceArmed +
+                            currentUptimeSeconds - lastDeploymentTimerIncrement);
+                }
+            }
+            else {
+                fram_increment_seconds_on_deployment_timer(
+                        currentUptimeSeconds - lastDeploymentTimerIncrement);
+            }
 #endif
 #endif
             lastDeploymentTimerIncrement = currentUptimeSeconds;
         }
     }
 
+#ifdef ISIS_OBC_G20
+    /* Write the time fields updated in this cycle with as few transactions as possible */
+    if(framHandler != nullptr) {
+        bool flushFailed = framHandler->getCriticalDataCache().flush() !=
+                HasReturnvaluesIF::RETURN_OK;
+        /* The flush is retried every cycle, the event is only raised when it starts failing */
+        if(flushFailed and not framFlushFailed) {
+            triggerEvent(FRAM_FAILURE, 0);
+        }
+        framFlushFailed = flushFailed;
+    }
+#endif
+
 #if defined(AT91SAM9G20_EK) && OBSW_SD_CARD_PRESENT == 1
     // Only perform this every 10 seconds, file system is slow.
     if(currentUptimeSeconds - lastSdCardUpdate > 10) {
@@ -465,17 +711,34 @@ void CoreController::performPeriodicTimeHandling() {
             sif::printWarning("CoreController::performPeriodicTimeHandling: "
                     "FRAM deployment timer read failure with code %d\n", result);
         }
-        result = fram_update_seconds_since_epoch(static_cast<uint32_t>(epochTime));
-        if(result != 0) {
+        deploymentTimerSeconds += deploymentTimerIncrement;
+        PersistentCounterRing::Counters counters = {};
+        counters[EPOCH_SECONDS_COUNTER] = static_cast<uint32_t>(epochTime);
+        counters[DEPLOYMENT_TIMER_COUNTER] = deploymentTimerSeconds;
+        if(timeCounterRing.append(counters) == HasReturnvaluesIF::RETURN_OK) {
+            deploymentTimerIncrement = 0;
+            /* The critical block fields are still read by other components, for example for
+            FRAM printouts and dumps. The ring stays the source used for the recovery. */
+            result = fram_update_seconds_since_epoch(static_cast<uint32_t>(epochTime));
+            if(result == 0) {
+                result = fram_set_seconds_on_deployment_timer(deploymentTimerSeconds);
+            }
+            if(result != 0) {
+                sif::printWarning("CoreController::performPeriodicTimeHandling: "
+                        "FRAM time field write failure with code %d\n", result);
+            }
+        }
+        else {
+            deploymentTimerSeconds -= deploymentTimerIncrement;
             sif::printWarning("CoreController::performPeriodicTimeHandling: "
-                    "FRAM update seconds read failure with code %d\n", result);
+                    "FRAM time counter write failure\n");
         }
-        result = fram_increment_seconds_on_deployment_timer(deploymentTimerIncrement);
+        /* The virtualized FRAM only writes the file on the SD card when flushing */
+        result = virt_fram_flush();
         if(result != 0) {
             sif::printWarning("CoreController::performPeriodicTimeHandling: "
-                    "FRAM increment seconds write failure with code %d\n", result);
+                    "Virtual FRAM flush failure with code %d\n", result);
         }
-        deploymentTimerIncrement = 0;
     }
 #endif
 }
@@ -716,6 +979,9 @@ ReturnValue_t CoreController::initializeIobcTimerDrivers() {
         if(retval != 0) {
             /* FRAM issues */
         }
+        if(framHandler != nullptr) {
+            framHandler->getCriticalDataCache().invalidate(CriticalDataCache::SECONDS_SINCE_EPOCH);
+        }
     }
 
     timeval currentTime;
@@ -745,6 +1011,15 @@ ReturnValue_t CoreController::initializeAt91TimerDrivers() {
     if(retval != 0) {
         return HasReturnvaluesIF::RETURN_FAILED;
     }
+    retval = fram_get_seconds_on_deployment_timer(&deploymentTimerSeconds);
+    if(retval != 0) {
+        deploymentTimerSeconds = 0;
+    }
+    /* The counter ring holds the newest values unless it was never written */
+    if(timeCounterRing.recover() == HasReturnvaluesIF::RETURN_OK) {
+        epochTime = timeCounterRing.getCounter(EPOCH_SECONDS_COUNTER);
+        deploymentTimerSeconds = timeCounterRing.getCounter(DEPLOYMENT_TIMER_COUNTER);
+    }
     uint32_t timeStampCompiledTime = UNIX_TIMESTAMP;
     if(epochTime < timeStampCompiledTime) {
         // Timer has not been updated in a long time, so just take more accurate time in this case
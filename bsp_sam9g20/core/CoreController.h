@@ -5,6 +5,11 @@
 #include <fsfw/serviceinterface/ServiceInterface.h>
 #include <bsp_sam9g20/common/fram/CommonFRAM.h>
 #include <OBSWConfig.h>
+#include <bsp_sam9g20/memory/PersistentCounterRing.h>
+#include "cpuStatsDefinitions.h"
+#include "taskTimingDefinitions.h"
+#include "stackMonitorDefinitions.h"
+#include "storeStatsDefinitions.h"
 
 #ifdef ISIS_OBC_G20
 extern "C" {
@@ -77,6 +82,8 @@ public:
 	            ActionId_t replyId);
 	ReturnValue_t handleClearStoreCommand(Stores storeType, ActionId_t pageOrWholeStore,
 	            StorageManagerIF::max_subpools_t pageIndex);
+	ReturnValue_t recommendStoreConfigCommand(const uint8_t* data, size_t size,
+	            MessageQueueId_t commandedBy, ActionId_t replyId);
 
 	/**
 	 * This function can be used by other software components as well
@@ -109,6 +116,14 @@ public:
 	static constexpr ActionId_t CLEAR_STORE_PAGE = 12;
 	static constexpr ActionId_t CLEAR_WHOLE_STORE = 13;
 	static constexpr ActionId_t GET_FILL_COUNT = 14;
+	/**
+	 * Report a subpool configuration for the store given as first parameter byte, derived
+	 * from the recorded subpool statistics. An optional second byte specifies the margin in
+	 * percent which is added to the high water marks.
+	 */
+	static constexpr ActionId_t RECOMMEND_STORE_CONFIG = 15;
+	//! Reset the subpool statistics of the store given as parameter byte
+	static constexpr ActionId_t RESET_STORE_STATS = 17;
 
 	static constexpr ActionId_t ARM_DEPLOYMENT_TIMER = 16;
 
@@ -131,6 +146,14 @@ private:
 	static uint32_t idleCounterOverflows;
 
 	SystemStateTask* systemStateTask = nullptr;
+	cpustats::CpuStatsSet cpuStatsSet;
+	uint32_t lastCpuStatsSample = 0;
+	//! Filled by the task timing monitor
+	tasktiming::TaskTimingSet taskTimingSet;
+	//! Filled by the task stack monitor
+	stackmon::StackSet stackSet;
+	storestats::StoreStatsSet storeStatsSet;
+	uint32_t lastStoreStatsSample = 0;
 	static MutexIF* timeMutex;
 
     /* If the FSFW clock seconds and the ISIS clock seconds difference is higher than this value,
@@ -140,6 +163,8 @@ private:
     uint32_t epochTime = 0;
 #ifdef ISIS_OBC_G20
 	FRAMHandler* framHandler = nullptr;
+	//! Set while flushing the critical data cache fails, the event is only raised once
+	bool framFlushFailed = false;
 	supervisor_housekeeping_t supervisorHk;
 	int16_t adcValues[SUPERVISOR_NUMBER_OF_ADC_CHANNELS] = {0};
 
@@ -153,6 +178,19 @@ private:
     uint32_t uptimeIncrement = 0;
     //! Increment for deployment timer will be cached for periodic SD card updates
     uint32_t deploymentTimerIncrement = 0;
+    uint32_t deploymentTimerSeconds = 0;
+
+    enum PersistentCounters: uint8_t {
+        EPOCH_SECONDS_COUNTER,
+        DEPLOYMENT_TIMER_COUNTER
+    };
+    static constexpr uint32_t TIME_COUNTER_RING_ADDRESS = 0;
+    static constexpr size_t TIME_COUNTER_RING_SIZE = COUNTER_RING_REGION_SIZE;
+    static_assert(TIME_COUNTER_RING_ADDRESS + TIME_COUNTER_RING_SIZE <= COUNTER_RING_REGION_SIZE,
+            "Time counter ring does not fit into the counter ring region");
+    //! Time counters are appended to this ring instead of updating the critical block fields
+    PersistentCounterRing timeCounterRing = PersistentCounterRing(TIME_COUNTER_RING_ADDRESS,
+            TIME_COUNTER_RING_SIZE);
 #endif
 
     uint32_t lastDeploymentTimerIncrement = 0;
@@ -160,6 +198,10 @@ private:
 	object_id_t systemStateTaskId = objects::NO_OBJECT;
 
 	void performSupervisorHandling();
+	void performCpuStatsSampling();
+	void performStoreStatsSampling();
+	//! Returns nullptr if the store does not keep subpool statistics
+	MonitoredPoolManager* getMonitoredStore(Stores storeType);
 	void performPeriodicTimeHandling();
 	uint32_t updateSecondsCounter();
 
@@ -2,10 +2,17 @@
 
 #include <fsfw/serviceinterface/ServiceInterface.h>
 #include <fsfw/timemanager/Countdown.h>
+#include <fsfw/globalfunctions/CRC.h>
+#include <fsfw/events/EventManagerIF.h>
+#include <fsfw/serialize/SerializeAdapter.h>
 #include <bsp_sam9g20/core/SoftwareImageHandler.h>
 #include <bsp_sam9g20/memory/SDCardAccess.h>
 #include <bsp_sam9g20/memory/HCCFileGuard.h>
 
+#ifdef ISIS_OBC_G20
+#include <bsp_sam9g20/common/fram/FRAMApi.h>
+#endif
+
 
 ImageCopyingEngine::ImageCopyingEngine(SoftwareImageHandler *owner,
         Countdown *countdown, image::ImageBuffer *imgBuffer):
@@ -44,6 +51,21 @@ ReturnValue_t ImageCopyingEngine::startSdcToSdcOperation(
     return HasReturnvaluesIF::RETURN_OK;
 }
 
+ReturnValue_t ImageCopyingEngine::startPatchOperation(image::ImageSlot sourceSlot) {
+    if(sourceSlot != image::ImageSlot::SDC_SLOT_0 and sourceSlot != image::ImageSlot::SDC_SLOT_1) {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    imageHandlerState = ImageHandlerStates::APPLY_PATCH_SDC_TO_SDC;
+    this->sourceSlot = sourceSlot;
+    if(sourceSlot == image::ImageSlot::SDC_SLOT_0) {
+        targetSlot = image::ImageSlot::SDC_SLOT_1;
+    }
+    else {
+        targetSlot = image::ImageSlot::SDC_SLOT_0;
+    }
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
 ReturnValue_t ImageCopyingEngine::startFlashToSdcOperation(
         image::ImageSlot targetSlot) {
     if(targetSlot == image::ImageSlot::FLASH or targetSlot == image::ImageSlot::NONE) {
@@ -84,6 +106,18 @@ void ImageCopyingEngine::reset() {
     helperCounter1 = 0;
     helperCounter2 = 0;
     hammingCode = false;
+    patchFileSize = 0;
+    patchOffset = 0;
+    patchOpcode = image::patch::COPY;
+    patchOpRemaining = 0;
+    patchSourceOffset = 0;
+    patchSourceSize = 0;
+    patchSourceCrc = 0;
+    patchTargetSize = 0;
+    patchTargetCrc = 0;
+    runningCrc = 0;
+    compressedImage = false;
+    compressionHeader = {};
 }
 
 
@@ -249,7 +283,7 @@ ReturnValue_t ImageCopyingEngine::prepareGenericFileInformation(
 
 ReturnValue_t ImageCopyingEngine::readFile(uint8_t *buffer, size_t sizeToRead,
         size_t *sizeRead, F_FILE** file) {
-    ssize_t bytesRead = f_read(imgBuffer->data(), sizeof(uint8_t), sizeToRead, *file);
+    ssize_t bytesRead = f_read(buffer, sizeof(uint8_t), sizeToRead, *file);
     if(bytesRead <= 0) {
         errorCount++;
         /* If reading a file failed 3 times, exit. */
@@ -334,6 +368,397 @@ ReturnValue_t ImageCopyingEngine::copySdcImgToSdc() {
     return HasReturnvaluesIF::RETURN_OK;
 }
 
+ReturnValue_t ImageCopyingEngine::applyPatch() {
+    SDCardAccess sdCardAccess;
+    if(sdCardAccess.getAccessResult() == SDCardAccess::SD_CARD_CHANGE_ONGOING) {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    int retval = change_directory(config::SW_REPOSITORY, true);
+    if(retval != F_NO_ERROR) {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+
+    ReturnValue_t result = HasReturnvaluesIF::RETURN_OK;
+    if(internalState == GenericInternalState::IDLE) {
+        result = readPatchHeader();
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
+        }
+        internalState = GenericInternalState::STEP_1;
+    }
+
+    if(internalState == GenericInternalState::STEP_1) {
+        /* Applying the patch to another image would produce garbage, so the source image is
+        checked first */
+        result = verifyFileCrc(getSlotFileName(sourceSlot), patchSourceSize, patchSourceCrc,
+                image::PATCH_SOURCE_MISMATCH);
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
+        }
+        internalState = GenericInternalState::STEP_2;
+        if(countdown->hasTimedOut()) {
+            return image::TASK_PERIOD_OVER_SOON;
+        }
+    }
+
+    if(internalState == GenericInternalState::STEP_2) {
+        result = applyPatchOperations();
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
+        }
+        internalState = GenericInternalState::STEP_3;
+        if(countdown->hasTimedOut()) {
+            return image::TASK_PERIOD_OVER_SOON;
+        }
+    }
+
+    if(internalState == GenericInternalState::STEP_3) {
+        /* The image is read back, so write errors on the SD card are detected as well */
+        result = verifyFileCrc(config::SW_PATCH_TARGET_NAME, patchTargetSize, patchTargetCrc,
+                image::PATCH_TARGET_CRC_MISMATCH);
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
+        }
+    }
+    return finishPatchOperation(sdCardAccess.getActiveVolume());
+}
+
+ReturnValue_t ImageCopyingEngine::readPatchHeader() {
+    F_FILE* patchFile = f_open(config::SW_PATCH_NAME, "r");
+    if(patchFile == nullptr) {
+#if OBSW_VERBOSE_LEVEL >= 1
+        sif::printWarning("ImageCopyingEngine::readPatchHeader: Patch file not found!\n");
+#endif
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    HCCFileGuard fileGuard(&patchFile);
+    long fileLength = f_filelength(config::SW_PATCH_NAME);
+    if(fileLength < static_cast<long>(image::patch::HEADER_SIZE)) {
+        return image::PATCH_INVALID;
+    }
+    patchFileSize = fileLength;
+
+    std::array<uint8_t, image::patch::HEADER_SIZE> header;
+    long bytesRead = f_read(header.data(), sizeof(uint8_t), header.size(), patchFile);
+    if(bytesRead != static_cast<long>(header.size())) {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+
+    const uint8_t* headerPtr = header.data();
+    size_t remainingSize = header.size();
+    uint32_t magic = 0;
+    uint32_t sourceSize = 0;
+    uint32_t targetSize = 0;
+    SerializeAdapter::deSerialize(&magic, &headerPtr, &remainingSize,
+            SerializeIF::Endianness::BIG);
+    SerializeAdapter::deSerialize(&sourceSize, &headerPtr, &remainingSize,
+            SerializeIF::Endianness::BIG);
+    SerializeAdapter::deSerialize(&patchSourceCrc, &headerPtr, &remainingSize,
+            SerializeIF::Endianness::BIG);
+    SerializeAdapter::deSerialize(&targetSize, &headerPtr, &remainingSize,
+            SerializeIF::Endianness::BIG);
+    SerializeAdapter::deSerialize(&patchTargetCrc, &headerPtr, &remainingSize,
+            SerializeIF::Endianness::BIG);
+    if(magic != image::patch::MAGIC or targetSize == 0) {
+        return image::PATCH_INVALID;
+    }
+    if(targetSize > MAX_IMAGE_SIZE) {
+#if OBSW_VERBOSE_LEVEL >= 1
+        sif::printWarning("ImageCopyingEngine::readPatchHeader: Target size %lu exceeds the "
+                "reserved image size %lu\n", static_cast<unsigned long>(targetSize),
+                static_cast<unsigned long>(MAX_IMAGE_SIZE));
+#endif
+        return image::PATCH_INVALID;
+    }
+    patchSourceSize = sourceSize;
+    patchTargetSize = targetSize;
+
+    long sourceLength = f_filelength(getSlotFileName(sourceSlot));
+    if(sourceLength < 0 or static_cast<size_t>(sourceLength) != patchSourceSize) {
+#if OBSW_VERBOSE_LEVEL >= 1
+        sif::printWarning("ImageCopyingEngine::readPatchHeader: Source image size %ld does not "
+                "match the patch source size %lu\n", sourceLength,
+                static_cast<unsigned long>(patchSourceSize));
+#endif
+        return image::PATCH_SOURCE_MISMATCH;
+    }
+
+    /* A temporary file left over from a failed attempt is discarded */
+    f_delete(config::SW_PATCH_TARGET_NAME);
+    patchOffset = image::patch::HEADER_SIZE;
+    currentByteIdx = 0;
+    runningCrc = 0xffff;
+#if OBSW_VERBOSE_LEVEL >= 1
+    sif::printInfo("Applying %lu byte patch to SD card slot %d, rebuilding %lu bytes\n",
+            static_cast<unsigned long>(patchFileSize),
+            sourceSlot == image::ImageSlot::SDC_SLOT_0 ? 0 : 1,
+            static_cast<unsigned long>(patchTargetSize));
+#endif
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t ImageCopyingEngine::applyPatchOperations() {
+    F_FILE* patchFile = f_open(config::SW_PATCH_NAME, "r");
+    HCCFileGuard patchGuard(&patchFile);
+    F_FILE* sourceFile = f_open(getSlotFileName(sourceSlot), "r");
+    HCCFileGuard sourceGuard(&sourceFile);
+    /* "appending" opens file or creates it if it doesn't exist */
+    F_FILE* targetFile = f_open(config::SW_PATCH_TARGET_NAME, "a");
+    HCCFileGuard targetGuard(&targetFile);
+    if(patchFile == nullptr or sourceFile == nullptr or targetFile == nullptr) {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+
+    while(true) {
+        if(patchOpRemaining == 0) {
+            if(patchOffset >= patchFileSize) {
+                break;
+            }
+            ReturnValue_t result = readPatchOperation(patchFile);
+            if(result != HasReturnvaluesIF::RETURN_OK) {
+                return result;
+            }
+        }
+
+        size_t sizeToRead = patchOpRemaining;
+        if(sizeToRead > imgBuffer->size()) {
+            sizeToRead = imgBuffer->size();
+        }
+        F_FILE** readFrom = &sourceFile;
+        size_t readOffset = patchSourceOffset;
+        if(patchOpcode == image::patch::INSERT) {
+            readFrom = &patchFile;
+            readOffset = patchOffset;
+        }
+        if(f_seek(*readFrom, readOffset, F_SEEK_SET) != F_NO_ERROR) {
+            return HasReturnvaluesIF::RETURN_FAILED;
+        }
+        size_t sizeRead = 0;
+        ReturnValue_t result = readFile(imgBuffer->data(), sizeToRead, &sizeRead, readFrom);
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
+        }
+        if(sizeRead != sizeToRead) {
+            return image::PATCH_INVALID;
+        }
+
+        long bytesWritten = f_write(imgBuffer->data(), sizeof(uint8_t), sizeToRead, targetFile);
+        if(bytesWritten != static_cast<long>(sizeToRead)) {
+#if OBSW_VERBOSE_LEVEL >= 1
+            sif::printWarning("ImageCopyingEngine::applyPatchOperations: Writing target "
+                    "failed!\n");
+#endif
+            return HasReturnvaluesIF::RETURN_FAILED;
+        }
+        if(patchOpcode == image::patch::INSERT) {
+            patchOffset += sizeToRead;
+        }
+        else {
+            patchSourceOffset += sizeToRead;
+        }
+        patchOpRemaining -= sizeToRead;
+        currentByteIdx += sizeToRead;
+        stepCounter++;
+
+        if(countdown->hasTimedOut()) {
+            return image::TASK_PERIOD_OVER_SOON;
+        }
+    }
+
+    if(currentByteIdx != patchTargetSize) {
+        return image::PATCH_INVALID;
+    }
+    currentByteIdx = 0;
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t ImageCopyingEngine::readPatchOperation(F_FILE* patchFile) {
+    std::array<uint8_t, image::patch::COPY_HEADER_SIZE> opHeader;
+    size_t sizeToRead = patchFileSize - patchOffset;
+    if(sizeToRead > opHeader.size()) {
+        sizeToRead = opHeader.size();
+    }
+    if(f_seek(patchFile, patchOffset, F_SEEK_SET) != F_NO_ERROR) {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    long bytesRead = f_read(opHeader.data(), sizeof(uint8_t), sizeToRead, patchFile);
+    if(bytesRead != static_cast<long>(sizeToRead) or
+            sizeToRead < image::patch::INSERT_HEADER_SIZE) {
+        return image::PATCH_INVALID;
+    }
+
+    const uint8_t* opPtr = opHeader.data() + 1;
+    size_t remainingSize = sizeToRead - 1;
+    uint32_t length = 0;
+    SerializeAdapter::deSerialize(&length, &opPtr, &remainingSize, SerializeIF::Endianness::BIG);
+    if(length == 0 or length > patchTargetSize - currentByteIdx) {
+        return image::PATCH_INVALID;
+    }
+    patchOpcode = opHeader[0];
+    if(patchOpcode == image::patch::COPY) {
+        uint32_t sourceOffset = 0;
+        if(SerializeAdapter::deSerialize(&sourceOffset, &opPtr, &remainingSize,
+                SerializeIF::Endianness::BIG) != HasReturnvaluesIF::RETURN_OK) {
+            return image::PATCH_INVALID;
+        }
+        if(sourceOffset > patchSourceSize or length > patchSourceSize - sourceOffset) {
+            return image::PATCH_INVALID;
+        }
+        patchSourceOffset = sourceOffset;
+        patchOffset += image::patch::COPY_HEADER_SIZE;
+    }
+    else if(patchOpcode == image::patch::INSERT) {
+        patchOffset += image::patch::INSERT_HEADER_SIZE;
+        if(length > patchFileSize - patchOffset) {
+            return image::PATCH_INVALID;
+        }
+    }
+    else {
+        return image::PATCH_INVALID;
+    }
+    patchOpRemaining = length;
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t ImageCopyingEngine::verifyFileCrc(const char* fileName, size_t fileSize,
+        uint16_t expectedCrc, ReturnValue_t mismatchCode) {
+    if(currentByteIdx == 0) {
+        long fileLength = f_filelength(fileName);
+        if(fileLength < 0 or static_cast<size_t>(fileLength) != fileSize) {
+            return mismatchCode;
+        }
+        runningCrc = 0xffff;
+    }
+    F_FILE* file = f_open(fileName, "r");
+    if(file == nullptr) {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    HCCFileGuard fileGuard(&file);
+    if(f_seek(file, currentByteIdx, F_SEEK_SET) != F_NO_ERROR) {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+
+    while(currentByteIdx < fileSize) {
+        size_t sizeToRead = fileSize - currentByteIdx;
+        if(sizeToRead > imgBuffer->size()) {
+            sizeToRead = imgBuffer->size();
+        }
+        size_t sizeRead = 0;
+        ReturnValue_t result = readFile(imgBuffer->data(), sizeToRead, &sizeRead, &file);
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
+        }
+        runningCrc = CRC::crc16ccitt(imgBuffer->data(), sizeRead, runningCrc);
+        currentByteIdx += sizeRead;
+        if(currentByteIdx < fileSize and countdown->hasTimedOut()) {
+            return image::TASK_PERIOD_OVER_SOON;
+        }
+    }
+
+    currentByteIdx = 0;
+    if(runningCrc != expectedCrc) {
+#if OBSW_VERBOSE_LEVEL >= 1
+        sif::printWarning("ImageCopyingEngine::verifyFileCrc: CRC of %s is 0x%04x, expected "
+                "0x%04x\n", fileName, runningCrc, expectedCrc);
+#endif
+        return mismatchCode;
+    }
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t ImageCopyingEngine::finishPatchOperation(VolumeId activeVolume) {
+#ifdef ISIS_OBC_G20
+    /* The hamming code of the old image does not belong to the new image */
+    SlotType framSlot = SDC_0_SL_0;
+    if(activeVolume == SD_CARD_0) {
+        framSlot = targetSlot == image::ImageSlot::SDC_SLOT_0 ? SDC_0_SL_0 : SDC_0_SL_1;
+    }
+    else {
+        framSlot = targetSlot == image::ImageSlot::SDC_SLOT_0 ? SDC_1_SL_0 : SDC_1_SL_1;
+    }
+    int retval = fram_clear_img_ham_flag(framSlot);
+    if(retval != 0) {
+        return image::FRAM_ISSUE;
+    }
+#else
+    (void) activeVolume;
+#endif
+    /* f_move and f_rename can not overwrite existing files. The old image is renamed to a
+    backup first, so the slot or the backup always contains a complete image. */
+    const char* targetName = getSlotFileName(targetSlot);
+    if(f_rename(config::SW_PATCH_BACKUP_NAME, targetName) != F_NO_ERROR) {
+        /* The backup of a previous attempt is only restored if the slot is empty */
+        f_delete(config::SW_PATCH_BACKUP_NAME);
+    }
+    bool backupCreated = f_rename(targetName, config::SW_PATCH_BACKUP_NAME) == F_NO_ERROR;
+    if(f_rename(config::SW_PATCH_TARGET_NAME, targetName) != F_NO_ERROR) {
+        if(backupCreated) {
+            f_rename(config::SW_PATCH_BACKUP_NAME, targetName);
+        }
+#if OBSW_VERBOSE_LEVEL >= 1
+        sif::printWarning("ImageCopyingEngine::finishPatchOperation: Renaming the rebuilt "
+                "image failed!\n");
+#endif
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    f_delete(config::SW_PATCH_BACKUP_NAME);
+
+    EventManagerIF::triggerEvent(objects::SOFTWARE_IMAGE_HANDLER, image::PATCH_APPLIED,
+            targetSlot, patchTargetSize);
+#if OBSW_VERBOSE_LEVEL >= 1
+    sif::printInfo("Patch applied, %s verified with %hu steps\n", targetName, stepCounter);
+#endif
+    lastFinishedState = imageHandlerState;
+    reset();
+    return image::OPERATION_FINISHED;
+}
+
+ReturnValue_t ImageCopyingEngine::readCompressionHeader(F_FILE* file) {
+    compressedImage = false;
+    if(currentFileSize < IMAGE_COMPRESSION_HEADER_SIZE) {
+        return HasReturnvaluesIF::RETURN_OK;
+    }
+    if(f_seek(file, 0, F_SEEK_SET) != F_NO_ERROR) {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    std::array<uint8_t, IMAGE_COMPRESSION_HEADER_SIZE> headerBuffer;
+    long bytesRead = f_read(headerBuffer.data(), sizeof(uint8_t), headerBuffer.size(), file);
+    if(bytesRead != static_cast<long>(headerBuffer.size())) {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    if(image_compression_read_header(headerBuffer.data(), headerBuffer.size(),
+            &compressionHeader) != IMAGE_COMPRESSION_OK) {
+        /* Raw image */
+        if(f_seek(file, 0, F_SEEK_SET) != F_NO_ERROR) {
+            return HasReturnvaluesIF::RETURN_FAILED;
+        }
+        return HasReturnvaluesIF::RETURN_OK;
+    }
+
+    if(compressionHeader.image_size == 0 or compressionHeader.compressed_size !=
+            currentFileSize - IMAGE_COMPRESSION_HEADER_SIZE) {
+#if OBSW_VERBOSE_LEVEL >= 1
+        sif::printWarning("ImageCopyingEngine::readCompressionHeader: Header does not match the "
+                "file size %lu\n", static_cast<unsigned long>(currentFileSize));
+#endif
+        return image::COMPRESSED_IMAGE_INVALID;
+    }
+    compressedImage = true;
+#if OBSW_VERBOSE_LEVEL >= 1
+    sif::printInfo("Compressed image with %lu bytes, decompressed size %lu bytes\n",
+            static_cast<unsigned long>(currentFileSize),
+            static_cast<unsigned long>(compressionHeader.image_size));
+#endif
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+const char* ImageCopyingEngine::getSlotFileName(image::ImageSlot slot) {
+    if(slot == image::ImageSlot::SDC_SLOT_1) {
+        return config::SW_SLOT_1_NAME;
+    }
+    return config::SW_SLOT_0_NAME;
+}
+
 void ImageCopyingEngine::handleGenericInfoPrintout(const char * const board, char const* typePrint,
         char const* sourcePrint, char const* targetPrint) {
     if(board == nullptr) {
@@ -6,13 +6,19 @@
 
 #include "hcc/api_fat.h"
 #include "bsp_sam9g20/common/SDCardApi.h"
+#include "bsp_sam9g20/common/imageCompression.h"
 
 #ifdef AT91SAM9G20_EK
 #include "commonAt91Config.h"
 #else /* iOBC */
 #include "commonIOBCConfig.h"
+#include "bsp_sam9g20/common/fram/CommonFRAM.h"
 #endif
 
+#include <fsfw/serialize/SerialLinkedListAdapter.h>
+
+#include <array>
+
 class SoftwareImageHandler;
 class Countdown;
 
@@ -45,6 +51,10 @@ public:
         COPY_IMG_SDC_TO_SDC,
         //! Copy image hamming code (of NOR-Flash or SDC image) to FRAM
         COPY_IMG_HAMMING_SDC_TO_FRAM,
+        //! Generate the hamming code of an image (NOR-Flash or SDC image) and write it to FRAM
+        GENERATE_IMG_HAMMING_TO_FRAM,
+        //! Rebuild an image from a SD-Card image and a delta patch into the other slot
+        APPLY_PATCH_SDC_TO_SDC,
 
         //! Copy bootloader in FRAM to NOR-Flash
         COPY_BL_FRAM_TO_FLASH,
@@ -56,6 +66,29 @@ public:
         COPY_BL_SDC_TO_FRAM
     };
 
+#ifdef ISIS_OBC_G20
+    /**
+     * Timing counters of the last copy operation to the NOR-Flash. All durations are
+     * in milliseconds.
+     */
+    struct NorCopyTimings {
+        //! Time from the start of the first erase until the whole image was written
+        uint32_t criticalWindowMs = 0;
+        uint32_t totalDurationMs = 0;
+        //! Time spent in erase operations, including SD card reads done while erasing
+        uint32_t eraseMs = 0;
+        uint32_t programMs = 0;
+        //! Time spent reading from the SD card outside of erase operations
+        uint32_t sdReadMs = 0;
+        //! Time spent reading from the SD card while a sector was being erased
+        uint32_t overlappedSdReadMs = 0;
+        uint16_t bucketsRead = 0;
+        uint16_t bucketsReadDuringErase = 0;
+        uint16_t sectorsErased = 0;
+        uint16_t cycles = 0;
+    };
+#endif
+
     ImageCopyingEngine(SoftwareImageHandler* owner, Countdown* countdown,
             image::ImageBuffer* imgBuffer);
 
@@ -102,6 +135,17 @@ public:
     */
     ReturnValue_t startSdcToSdcOperation(image::ImageSlot sourceSlot);
 
+    /**
+     * Rebuild a new image from the image in the given slot and the delta patch in the software
+     * repository. The new image is written to the other slot on the same SD card.
+     * The new image is first written to a temporary file and only replaces the image in the
+     * other slot after its CRC was verified. On the iOBC, the hamming flag of the other slot
+     * is cleared because the hamming code does not belong to the new image.
+     * @param sourceSlot    SDC_SLOT_0 or SDC_SLOT_1
+     * @return
+     */
+    ReturnValue_t startPatchOperation(image::ImageSlot sourceSlot);
+
     /**
      * Starts to copy the bootloader to the flash. Use with care! Parts of this operation might
      * be performed in a special high priority task which can not be preempted and interrupted
@@ -129,6 +173,15 @@ public:
      */
     ReturnValue_t startHammingCodeToFramOperation(image::ImageSlot respectiveSlot);
 
+    /**
+     * Generate the hamming code of an image on board and write it to the FRAM. The hamming flag
+     * of the image is cleared at the start and set again when the whole hamming code
+     * was written. Only works on the iOBC.
+     * @param respectiveSlot    FLASH, SDC_SLOT_0 or SDC_SLOT_1 on the active SD card
+     * @return
+     */
+    ReturnValue_t startHammingCodeGenerationOperation(image::ImageSlot respectiveSlot);
+
     /**
      * Continue the current operation.
      * @return
@@ -144,6 +197,14 @@ public:
      */
     void reset();
 
+#ifdef ISIS_OBC_G20
+    /**
+     * The timings are kept until the next copy operation to the NOR-Flash is started.
+     * @return
+     */
+    NorCopyTimings getNorCopyTimings() const;
+#endif
+
 private:
     SoftwareImageHandler* owner = nullptr;
     Countdown* countdown = nullptr;
@@ -167,6 +228,28 @@ private:
 
     ImageHandlerStates lastFinishedState = ImageHandlerStates::IDLE;
 
+    size_t patchFileSize = 0;
+    //! Offset of the next byte to process in the patch file
+    size_t patchOffset = 0;
+    uint8_t patchOpcode = image::patch::COPY;
+    size_t patchOpRemaining = 0;
+    size_t patchSourceOffset = 0;
+    size_t patchSourceSize = 0;
+    uint16_t patchSourceCrc = 0;
+    size_t patchTargetSize = 0;
+    uint16_t patchTargetCrc = 0;
+    uint16_t runningCrc = 0;
+#ifdef AT91SAM9G20_EK
+    //! The second-stage bootloader reserves the first MB of the SDRAM for the primary image
+    static constexpr size_t MAX_IMAGE_SIZE = 0x100000;
+#else
+    static constexpr size_t MAX_IMAGE_SIZE = PRIMARY_IMAGE_RESERVED_SIZE;
+#endif
+
+    //! Set if the source image on the SD card is a compressed image
+    bool compressedImage = false;
+    ImageCompressionHeader compressionHeader = {};
+
 #ifdef AT91SAM9G20_EK
     bool nandConfigured = false;
     static constexpr size_t NAND_PAGE_SIZE = NandCommon_MAXPAGEDATASIZE;
@@ -192,21 +275,93 @@ private:
     static constexpr size_t NORFLASH_TOTAL_SMALL_SECTOR_MEM_OBSW =
             RESERVED_OBSW_SMALL_SECTORS * NORFLASH_SMALL_SECTOR_SIZE;
     static constexpr size_t COPYING_BUCKET_SIZE = NORFLASH_SMALL_SECTOR_SIZE;
+    static constexpr size_t HAMMING_BLOCK_SIZE = 256;
+    static constexpr size_t HAMMING_CODE_BYTES_PER_BLOCK = 3;
+
+    //! FRAM slot of the hamming code which is currently generated
+    SlotType hammingFramSlot = FLASH_SLOT;
+
     ReturnValue_t copyImgHammingSdcToFram();
+    /**
+     * Generates the hamming code in chunks of the image buffer size, so one 8192 byte chunk
+     * results in 96 bytes of hamming code written to the FRAM.
+     * @return
+     */
+    ReturnValue_t generateImgHammingToFram();
+    ReturnValue_t generateHammingCodeChunk(size_t chunkSize);
+    SlotType getFramSlot(VolumeId activeVolume) const;
     ReturnValue_t copySdCardImageToNorFlash();
 
     /**
-     * For the bootloader, all small sectors (8192 * 8 = 65536 bytes) will
-     * be erased. For the primary image, all the remaining sectors will
-     * be deleted.
-     * @param bootloader
-     * @return
+     * The image is copied in buckets with two bucket buffers. A sector is only erased just
+     * before the first bucket is programmed to it, and the next buckets are read from the
+     * SD card while the NOR-Flash is busy erasing. Programming is polled by the CPU, so
+     * reading and programming can not overlap.
      */
-    ReturnValue_t handleNorflashErasure();
-    ReturnValue_t handleObswErasure();
-    uint32_t getBaseAddress(uint8_t stepCounter, size_t* offset);
+    image::ImageBuffer secondaryBuffer;
+    std::array<size_t, 2> bucketSizes = {};
+    uint8_t programBucketIdx = 0;
+    uint8_t filledBuckets = 0;
+    //! Number of image bytes which were read into the bucket buffers
+    size_t readByteIdx = 0;
+    //! NOR-Flash write address up to which the sectors were erased
+    uint32_t erasedAddress = 0;
+    //! Only set while a sector is being erased, used by the erase wait callback
+    F_FILE* pipelineFile = nullptr;
+    bool pipelineReadFailed = false;
+
+    /**
+     * Compressed images are decompressed into the buckets. The compressed data is read from
+     * the SD card in smaller chunks.
+     */
+    ImageDecompressor decompressor;
+    std::array<uint8_t, 2048> compressedBuffer;
+    size_t compressedBufferIdx = 0;
+    size_t compressedBufferSize = 0;
+    //! Offset in the image file of the next compressed chunk
+    size_t compressedReadIdx = 0;
+    //! Bytes already decompressed into the bucket which is currently filled
+    size_t partialBucketSize = 0;
+    uint16_t decompressedCrc = 0;
+    //! Set after the compressed image was decompressed once without programming it
+    bool compressedImageVerified = false;
+
+    NorCopyTimings norCopyTimings;
+    uint32_t norCopyStartMs = 0;
+    uint32_t criticalWindowStartMs = 0;
+
     ReturnValue_t performNorCopyOperation(F_FILE** binaryFile);
     ReturnValue_t handleSdToNorCopyOperation();
+    ReturnValue_t readNextBucket(F_FILE** binaryFile, bool duringErase);
+    /**
+     * Fill a bucket with the next part of a compressed image. Can be called again with the same
+     * bucket if reading the file failed.
+     */
+    ReturnValue_t decompressBucket(uint8_t* bucket, size_t bucketSize, F_FILE** binaryFile);
+    //! Check the decompressed image against the header after the last bucket.
+    ReturnValue_t verifyDecompressedImage();
+    /**
+     * Decompress the whole compressed image and check its CRC before the first sector is
+     * erased, so a corrupted image does not destroy the current NOR-Flash image.
+     * Can span multiple cycles.
+     */
+    ReturnValue_t verifyCompressedImage(F_FILE** binaryFile);
+    void resetDecompression();
+    /**
+     * Erase the next sector of the reserved area.
+     * @param binaryFile    Opened image file to read the next buckets from while erasing,
+     *                      or nullptr
+     * @return
+     */
+    ReturnValue_t eraseNextSector(F_FILE* binaryFile);
+    //! Erase the sectors of the reserved area which were not used by the image.
+    ReturnValue_t handleRemainingErasure();
+    static int eraseWaitCallback(void* args);
+    void resetNorCopyPipeline();
+    uint8_t* getBucketBuffer(uint8_t bucketIdx);
+    uint32_t getNorRegionStart() const;
+    uint32_t getNorRegionEnd() const;
+    static uint32_t getNorSectorSize(uint32_t sectorAddress);
     void writeBootloaderSizeAndCrc();
 #endif /* AT91SAM9G20_EK */
 
@@ -222,6 +377,32 @@ private:
 
     ReturnValue_t copySdcImgToSdc();
 
+    ReturnValue_t applyPatch();
+    ReturnValue_t readPatchHeader();
+    ReturnValue_t readPatchOperation(F_FILE* patchFile);
+    ReturnValue_t applyPatchOperations();
+    /**
+     * Calculate the CRC16 of a file in the software repository in chunks.
+     * @return
+     *  - RETURN_OK if the CRC matches
+     *  - TASK_PERIOD_OVER_SOON if the calculation is continued in the next cycle
+     *  - mismatchCode if the file size or the CRC does not match
+     */
+    ReturnValue_t verifyFileCrc(const char* fileName, size_t fileSize, uint16_t expectedCrc,
+            ReturnValue_t mismatchCode);
+    ReturnValue_t finishPatchOperation(VolumeId activeVolume);
+
+    /**
+     * Check whether the opened image file is a compressed image and cache the header.
+     * For raw images, the file position is reset to the start of the file, otherwise it is
+     * set to the start of the compressed data.
+     * @return
+     *  - RETURN_OK for raw images and for valid compressed images
+     *  - image::COMPRESSED_IMAGE_INVALID if the header does not match the file
+     */
+    ReturnValue_t readCompressionHeader(F_FILE* file);
+    static const char* getSlotFileName(image::ImageSlot slot);
+
     /**
      * Generic function to read file which also simplfies error handling.
      * Plese note that this only works if the file already has been opened.
@@ -245,4 +426,43 @@ private:
 
 };
 
+#ifdef ISIS_OBC_G20
+/**
+ * @brief   Reply containing the timing counters of the last NOR-Flash copy operation.
+ */
+class NorCopyTimingsReply: public SerialLinkedListAdapter<SerializeIF> {
+public:
+    NorCopyTimingsReply(const ImageCopyingEngine::NorCopyTimings& timings):
+            criticalWindowMs(timings.criticalWindowMs),
+            totalDurationMs(timings.totalDurationMs), eraseMs(timings.eraseMs),
+            programMs(timings.programMs), sdReadMs(timings.sdReadMs),
+            overlappedSdReadMs(timings.overlappedSdReadMs),
+            bucketsRead(timings.bucketsRead),
+            bucketsReadDuringErase(timings.bucketsReadDuringErase),
+            sectorsErased(timings.sectorsErased), cycles(timings.cycles) {
+        setStart(&this->criticalWindowMs);
+        this->criticalWindowMs.setNext(&this->totalDurationMs);
+        this->totalDurationMs.setNext(&this->eraseMs);
+        this->eraseMs.setNext(&this->programMs);
+        this->programMs.setNext(&this->sdReadMs);
+        this->sdReadMs.setNext(&this->overlappedSdReadMs);
+        this->overlappedSdReadMs.setNext(&this->bucketsRead);
+        this->bucketsRead.setNext(&this->bucketsReadDuringErase);
+        this->bucketsReadDuringErase.setNext(&this->sectorsErased);
+        this->sectorsErased.setNext(&this->cycles);
+    }
+private:
+    SerializeElement<uint32_t> criticalWindowMs;
+    SerializeElement<uint32_t> totalDurationMs;
+    SerializeElement<uint32_t> eraseMs;
+    SerializeElement<uint32_t> programMs;
+    SerializeElement<uint32_t> sdReadMs;
+    SerializeElement<uint32_t> overlappedSdReadMs;
+    SerializeElement<uint16_t> bucketsRead;
+    SerializeElement<uint16_t> bucketsReadDuringErase;
+    SerializeElement<uint16_t> sectorsErased;
+    SerializeElement<uint16_t> cycles;
+};
+#endif
+
 #endif /* SAM9G20_CORE_IMAGECOPYINGENGINE_H_ */
@@ -1,5 +1,585 @@
 #include "ScrubbingEngine.h"
 #include "SoftwareImageHandler.h"
 
-ScrubbingEngine::ScrubbingEngine(SoftwareImageHandler *owner): owner(owner) {
+#include <fsfw/timemanager/Clock.h>
+#include <fsfw/timemanager/Countdown.h>
+#include <fsfw/events/EventManagerIF.h>
+#include <fsfw/serviceinterface/ServiceInterface.h>
+#include <objects/systemObjectList.h>
+
+#include <bsp_sam9g20/memory/SDCardAccess.h>
+#include <bsp_sam9g20/memory/HCCFileGuard.h>
+
+extern "C" {
+#include <at91/utility/hamming.h>
+}
+
+#ifdef ISIS_OBC_G20
+#include "commonIOBCConfig.h"
+#include <bsp_sam9g20/common/fram/FRAMApi.h>
+#include <hal/Storage/NORflash.h>
+#endif
+
+#include <cstring>
+
+static_assert(sizeof(image::ImageBuffer) % 256 == 0,
+        "Image buffer size has to be a multiple of the hamming block size!");
+static_assert(sizeof(image::ImageBuffer) / 256 <= 32,
+        "Corrected blocks of one chunk are tracked in a 32 bit mask!");
+
+ScrubbingEngine::ScrubbingEngine(SoftwareImageHandler *owner, Countdown* countdown,
+        image::ImageBuffer* imgBuffer, uint32_t cycleBudgetMs): owner(owner),
+        countdown(countdown), imgBuffer(imgBuffer), cycleBudgetMs(cycleBudgetMs) {
+}
+
+ReturnValue_t ScrubbingEngine::startScrubbingOperation(image::ImageSlot targetSlot) {
+    if(getIsOperationOngoing()) {
+        return image::BUSY;
+    }
+#ifdef ISIS_OBC_G20
+    if(targetSlot != image::ImageSlot::FLASH and targetSlot != image::ImageSlot::SDC_SLOT_0 and
+            targetSlot != image::ImageSlot::SDC_SLOT_1) {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+#else
+    /* The NAND-Flash of the AT91 uses its own ECC, so only the SD card images are scrubbed */
+    if(targetSlot != image::ImageSlot::SDC_SLOT_0 and
+            targetSlot != image::ImageSlot::SDC_SLOT_1) {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+#endif
+    this->targetSlot = targetSlot;
+    status.currentSlot = targetSlot;
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+bool ScrubbingEngine::getIsOperationOngoing() const {
+    return targetSlot != image::ImageSlot::NONE;
+}
+
+ReturnValue_t ScrubbingEngine::continueCurrentOperation() {
+    if(targetSlot == image::ImageSlot::NONE) {
+        return HasReturnvaluesIF::RETURN_OK;
+    }
+
+    ReturnValue_t result = HasReturnvaluesIF::RETURN_OK;
+#ifdef ISIS_OBC_G20
+    /* The NOR-Flash can be scrubbed without accessing the SD card if the hamming code is
+    stored in the FRAM */
+    if(targetSlot == image::ImageSlot::FLASH and not hammingCodeOnSdCard) {
+        if(not prepared) {
+            result = prepareOperation(SD_CARD_0);
+            if(result != HasReturnvaluesIF::RETURN_OK) {
+                return result;
+            }
+        }
+        return scrubChunks(nullptr, nullptr);
+    }
+#endif
+
+    SDCardAccess access;
+    if(access.getAccessResult() == SDCardAccess::SD_CARD_CHANGE_ONGOING) {
+        /* Continue once the SD card change is complete */
+        return image::TASK_PERIOD_OVER_SOON;
+    }
+    else if(access.getAccessResult() != HasReturnvaluesIF::RETURN_OK) {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+
+    if(prepared and access.getActiveVolume() != scrubbedVolume) {
+        /* The active SD card was changed, start again with the image on the new SD card */
+        prepared = false;
+    }
+    if(not prepared) {
+        result = prepareOperation(access.getActiveVolume());
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
+        }
+    }
+
+    F_FILE* imageFile = nullptr;
+    F_FILE* hammingFile = nullptr;
+    result = openSdCardFiles(&imageFile, &hammingFile);
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        return result;
+    }
+    /* Will take care of closing the files on destruction */
+    HCCFileGuard imageGuard(&imageFile);
+    HCCFileGuard hammingGuard(&hammingFile);
+    return scrubChunks(imageFile, hammingFile);
+}
+
+ReturnValue_t ScrubbingEngine::prepareOperation(VolumeId activeVolume) {
+    scrubbedVolume = activeVolume;
+    currentByteIdx = 0;
+    errorCount = 0;
+    errorEventCount = 0;
+    operationCorrectedErrors = 0;
+    operationUncorrectableErrors = 0;
+
+    if(targetSlot == image::ImageSlot::FLASH) {
+        framSlot = FLASH_SLOT;
+    }
+    else if(activeVolume == SD_CARD_0) {
+        framSlot = (targetSlot == image::ImageSlot::SDC_SLOT_0)? SDC_0_SL_0 : SDC_0_SL_1;
+    }
+    else {
+        framSlot = (targetSlot == image::ImageSlot::SDC_SLOT_0)? SDC_1_SL_0 : SDC_1_SL_1;
+    }
+
+    bool hammingFromSdCard = true;
+#ifdef ISIS_OBC_G20
+    hammingFromSdCard = hammingCodeOnSdCard;
+#endif
+
+    if(hammingFromSdCard or targetSlot != image::ImageSlot::FLASH) {
+        int retval = change_directory(config::SW_REPOSITORY, true);
+        if(retval != F_NO_ERROR) {
+            return HasReturnvaluesIF::RETURN_FAILED;
+        }
+    }
+
+    long fileLength = 0;
+    if(targetSlot == image::ImageSlot::FLASH) {
+#ifdef ISIS_OBC_G20
+        int retval = fram_read_binary_size(FLASH_SLOT, &imageSize);
+        if(retval != 0) {
+            return image::FRAM_ISSUE;
+        }
+#endif
+    }
+    else {
+        if(targetSlot == image::ImageSlot::SDC_SLOT_0) {
+            fileLength = f_filelength(config::SW_SLOT_0_NAME);
+        }
+        else {
+            fileLength = f_filelength(config::SW_SLOT_1_NAME);
+        }
+        if(fileLength <= 0) {
+            return HasReturnvaluesIF::RETURN_FAILED;
+        }
+        imageSize = fileLength;
+    }
+    if(imageSize == 0) {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+
+    size_t hammingCodeSize = 0;
+    if(hammingFromSdCard) {
+        if(targetSlot == image::ImageSlot::FLASH) {
+            fileLength = f_filelength(config::SW_FLASH_HAMMING_NAME);
+        }
+        else if(targetSlot == image::ImageSlot::SDC_SLOT_0) {
+            fileLength = f_filelength(config::SW_SLOT_0_HAMMING_NAME);
+        }
+        else {
+            fileLength = f_filelength(config::SW_SLOT_1_HAMMING_NAME);
+        }
+        if(fileLength > 0) {
+            hammingCodeSize = fileLength;
+        }
+    }
+#ifdef ISIS_OBC_G20
+    else {
+        /* The flag is cleared when the image is updated and set again when the fitting
+        hamming code was uploaded */
+        bool hammingFlagSet = false;
+        int retval = fram_read_ham_size(framSlot, &hammingCodeSize, &hammingFlagSet);
+        if(retval != 0) {
+            return image::FRAM_ISSUE;
+        }
+        if(not hammingFlagSet) {
+            hammingCodeSize = 0;
+        }
+    }
+#endif
+
+    size_t requiredHammingCodeSize = (imageSize + HAMMING_BLOCK_SIZE - 1) / HAMMING_BLOCK_SIZE *
+            HAMMING_CODE_BYTES_PER_BLOCK;
+    if(hammingCodeSize < requiredHammingCodeSize) {
+        return image::HAMMING_CODE_UNAVAILABLE;
+    }
+
+    Clock::getUptime(&operationStartMs);
+    status.currentSlot = targetSlot;
+    status.bytesScrubbed = 0;
+    status.imageSize = imageSize;
+    status.bytesPerSecond = 0;
+    prepared = true;
+
+#if OBSW_VERBOSE_LEVEL >= 1
+    sif::printInfo("ScrubbingEngine: Scrubbing %lu bytes of image slot %d..\n",
+            static_cast<unsigned long>(imageSize), static_cast<int>(targetSlot));
+#endif
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t ScrubbingEngine::openSdCardFiles(F_FILE **imageFile, F_FILE **hammingFile) {
+    int retval = change_directory(config::SW_REPOSITORY, true);
+    if(retval != F_NO_ERROR) {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+
+    if(targetSlot != image::ImageSlot::FLASH) {
+        /* Opened for reading and writing so corrected blocks can be written back */
+        if(targetSlot == image::ImageSlot::SDC_SLOT_0) {
+            *imageFile = f_open(config::SW_SLOT_0_NAME, "r+");
+        }
+        else {
+            *imageFile = f_open(config::SW_SLOT_1_NAME, "r+");
+        }
+        if(*imageFile == nullptr) {
+            return HasReturnvaluesIF::RETURN_FAILED;
+        }
+        /* Seek correct position in file. This needs to be done every time the file
+        is reopened! */
+        retval = f_seek(*imageFile, currentByteIdx, F_SEEK_SET);
+        if(retval != F_NO_ERROR) {
+            f_close(*imageFile);
+            *imageFile = nullptr;
+            return HasReturnvaluesIF::RETURN_FAILED;
+        }
+    }
+
+    bool hammingFromSdCard = true;
+#ifdef ISIS_OBC_G20
+    hammingFromSdCard = hammingCodeOnSdCard;
+#endif
+    if(not hammingFromSdCard) {
+        return HasReturnvaluesIF::RETURN_OK;
+    }
+
+    if(targetSlot == image::ImageSlot::FLASH) {
+        *hammingFile = f_open(config::SW_FLASH_HAMMING_NAME, "r");
+    }
+    else if(targetSlot == image::ImageSlot::SDC_SLOT_0) {
+        *hammingFile = f_open(config::SW_SLOT_0_HAMMING_NAME, "r");
+    }
+    else {
+        *hammingFile = f_open(config::SW_SLOT_1_HAMMING_NAME, "r");
+    }
+    if(*hammingFile != nullptr) {
+        retval = f_seek(*hammingFile, currentByteIdx / HAMMING_BLOCK_SIZE *
+                HAMMING_CODE_BYTES_PER_BLOCK, F_SEEK_SET);
+        if(retval == F_NO_ERROR) {
+            return HasReturnvaluesIF::RETURN_OK;
+        }
+        f_close(*hammingFile);
+        *hammingFile = nullptr;
+    }
+    if(*imageFile != nullptr) {
+        f_close(*imageFile);
+        *imageFile = nullptr;
+    }
+    return HasReturnvaluesIF::RETURN_FAILED;
+}
+
+ReturnValue_t ScrubbingEngine::scrubChunks(F_FILE* imageFile, F_FILE* hammingFile) {
+    uint32_t cycleStartMs = 0;
+    Clock::getUptime(&cycleStartMs);
+    bool firstChunk = true;
+
+    while(currentByteIdx < imageSize) {
+        size_t chunkSize = getNextChunkSize(cycleStartMs, firstChunk);
+        if(chunkSize == 0) {
+            return image::TASK_PERIOD_OVER_SOON;
+        }
+        firstChunk = false;
+        if(imageSize - currentByteIdx < chunkSize) {
+            chunkSize = imageSize - currentByteIdx;
+        }
+
+        uint32_t chunkStartMs = 0;
+        Clock::getUptime(&chunkStartMs);
+        if(imageFile != nullptr) {
+            long bytesRead = f_read(imgBuffer->data(), sizeof(uint8_t), chunkSize, imageFile);
+            if(bytesRead != static_cast<long>(chunkSize)) {
+                errorCount++;
+                /* If reading the image failed 3 times, exit. */
+                if(errorCount >= 3) {
+                    return HasReturnvaluesIF::RETURN_FAILED;
+                }
+                /* The file position is restored when the file is reopened next cycle */
+                return image::TASK_PERIOD_OVER_SOON;
+            }
+        }
+#ifdef ISIS_OBC_G20
+        else {
+            std::memcpy(imgBuffer->data(), reinterpret_cast<const uint8_t*>(
+                    BINARY_BASE_ADDRESS_READ + currentByteIdx), chunkSize);
+        }
+#endif
+
+        ReturnValue_t result = readHammingCode(hammingFile, chunkSize);
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
+        }
+
+        uint32_t correctedBlocks = 0;
+        verifyChunk(chunkSize, &correctedBlocks);
+        bool blocksWritten = correctedBlocks != 0;
+
+        for(uint8_t blockIdx = 0; correctedBlocks != 0; blockIdx++, correctedBlocks >>= 1) {
+            if((correctedBlocks & 0x01) == 0) {
+                continue;
+            }
+            size_t blockOffset = blockIdx * HAMMING_BLOCK_SIZE;
+            size_t blockSize = HAMMING_BLOCK_SIZE;
+            if(chunkSize - blockOffset < blockSize) {
+                blockSize = chunkSize - blockOffset;
+            }
+            const uint8_t* correctedBlock = imgBuffer->data() + blockOffset;
+            result = HasReturnvaluesIF::RETURN_FAILED;
+            if(imageFile != nullptr) {
+                if(f_seek(imageFile, currentByteIdx + blockOffset, F_SEEK_SET) == F_NO_ERROR and
+                        f_write(correctedBlock, sizeof(uint8_t), blockSize, imageFile) ==
+                        static_cast<long>(blockSize)) {
+                    result = HasReturnvaluesIF::RETURN_OK;
+                }
+            }
+#ifdef ISIS_OBC_G20
+            else {
+                result = correctNorFlashBlock(currentByteIdx + blockOffset, correctedBlock,
+                        blockSize);
+            }
+#endif
+            if(result == HasReturnvaluesIF::RETURN_OK) {
+                operationCorrectedErrors++;
+                status.correctedErrors++;
+                handleErrorEvent(image::SCRUB_SINGLE_BIT_ERROR_CORRECTED,
+                        currentByteIdx + blockOffset);
+            }
+            else {
+                operationUncorrectableErrors++;
+                status.uncorrectableErrors++;
+                handleErrorEvent(image::SCRUB_CORRECTION_FAILED, currentByteIdx + blockOffset);
+            }
+        }
+        if(imageFile != nullptr and blocksWritten) {
+            /* Restore the read position after writing back corrected blocks */
+            f_seek(imageFile, currentByteIdx + chunkSize, F_SEEK_SET);
+        }
+
+        currentByteIdx += chunkSize;
+        updateThroughput(chunkSize, chunkStartMs);
+
+        if(currentByteIdx < imageSize and countdown->hasTimedOut()) {
+            return image::TASK_PERIOD_OVER_SOON;
+        }
+    }
+
+    finishOperation();
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t ScrubbingEngine::readHammingCode(F_FILE* hammingFile, size_t chunkSize) {
+    size_t blocks = (chunkSize + HAMMING_BLOCK_SIZE - 1) / HAMMING_BLOCK_SIZE;
+    size_t hammingSize = blocks * HAMMING_CODE_BYTES_PER_BLOCK;
+    if(hammingFile != nullptr) {
+        long bytesRead = f_read(hammingBuffer.data(), sizeof(uint8_t), hammingSize,
+                hammingFile);
+        if(bytesRead != static_cast<long>(hammingSize)) {
+            return HasReturnvaluesIF::RETURN_FAILED;
+        }
+    }
+#ifdef ISIS_OBC_G20
+    else {
+        size_t sizeRead = 0;
+        int retval = fram_read_ham_code(framSlot, hammingBuffer.data(), hammingBuffer.size(),
+                currentByteIdx / HAMMING_BLOCK_SIZE * HAMMING_CODE_BYTES_PER_BLOCK, hammingSize,
+                &sizeRead);
+        if(retval != 0 or sizeRead != hammingSize) {
+            return image::FRAM_ISSUE;
+        }
+    }
+#endif
+
+    /* The hamming code was generated with the image padded with zeros to a multiple of
+    256 bytes, so the last block needs to be padded as well */
+    size_t paddedSize = blocks * HAMMING_BLOCK_SIZE;
+    if(paddedSize > chunkSize) {
+        std::memset(imgBuffer->data() + chunkSize, 0, paddedSize - chunkSize);
+    }
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+void ScrubbingEngine::verifyChunk(size_t chunkSize, uint32_t* correctedBlocks) {
+    size_t blocks = (chunkSize + HAMMING_BLOCK_SIZE - 1) / HAMMING_BLOCK_SIZE;
+    for(size_t blockIdx = 0; blockIdx < blocks; blockIdx++) {
+        size_t blockOffset = blockIdx * HAMMING_BLOCK_SIZE;
+        /* Verified block by block to find the location of all errors */
+        unsigned char result = Hamming_Verify256x(imgBuffer->data() + blockOffset,
+                HAMMING_BLOCK_SIZE, hammingBuffer.data() +
+                blockIdx * HAMMING_CODE_BYTES_PER_BLOCK);
+        if(result == Hamming_ERROR_SINGLEBIT) {
+            *correctedBlocks |= 1 << blockIdx;
+        }
+        else if(result == Hamming_ERROR_ECC) {
+            /* The data is still valid, only the stored hamming code is corrupted */
+            status.hammingCodeErrors++;
+            handleErrorEvent(image::SCRUB_HAMMING_CODE_ERROR, currentByteIdx + blockOffset);
+        }
+        else if(result == Hamming_ERROR_MULTIPLEBITS) {
+            operationUncorrectableErrors++;
+            status.uncorrectableErrors++;
+            handleErrorEvent(image::SCRUB_MULTI_BIT_ERROR, currentByteIdx + blockOffset);
+        }
+    }
+}
+
+#ifdef ISIS_OBC_G20
+
+ReturnValue_t ScrubbingEngine::correctNorFlashBlock(size_t blockOffset,
+        const uint8_t* correctedBlock, size_t blockSize) {
+    const uint8_t* flashBlock = reinterpret_cast<const uint8_t*>(
+            BINARY_BASE_ADDRESS_READ + blockOffset);
+    for(size_t idx = 0; idx < blockSize; idx++) {
+        if(flashBlock[idx] == correctedBlock[idx]) {
+            continue;
+        }
+        /* Programming can only clear bits. Setting a bit requires erasing the whole sector,
+        which is left to a copy operation */
+        if((flashBlock[idx] & correctedBlock[idx]) != correctedBlock[idx]) {
+            return HasReturnvaluesIF::RETURN_FAILED;
+        }
+        /* The NOR-Flash is programmed in 16 bit words */
+        size_t wordIdx = idx & ~static_cast<size_t>(0x01);
+        int retval = NORFLASH_WriteData(&NORFlash, BINARY_BASE_ADDRESS_WRITE + blockOffset +
+                wordIdx, const_cast<uint8_t*>(correctedBlock + wordIdx), 2);
+        if(retval != 0) {
+            return HasReturnvaluesIF::RETURN_FAILED;
+        }
+        return HasReturnvaluesIF::RETURN_OK;
+    }
+    /* Should not happen, the flash content was already correct */
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+#endif /* ISIS_OBC_G20 */
+
+size_t ScrubbingEngine::getNextChunkSize(uint32_t cycleStartMs, bool firstChunk) {
+    /* At least one block is checked per cycle so the scrubbing operation always progresses */
+    if(firstChunk and bytesPerMs == 0) {
+        return HAMMING_BLOCK_SIZE;
+    }
+    if(not firstChunk and countdown->hasTimedOut()) {
+        return 0;
+    }
+    uint32_t currentMs = 0;
+    Clock::getUptime(&currentMs);
+    uint32_t elapsedMs = currentMs - cycleStartMs;
+    size_t affordableSize = 0;
+    if(elapsedMs < cycleBudgetMs) {
+        affordableSize = static_cast<size_t>(cycleBudgetMs - elapsedMs) * bytesPerMs;
+    }
+    if(affordableSize > imgBuffer->size()) {
+        affordableSize = imgBuffer->size();
+    }
+    affordableSize -= affordableSize % HAMMING_BLOCK_SIZE;
+    if(affordableSize == 0 and firstChunk) {
+        return HAMMING_BLOCK_SIZE;
+    }
+    return affordableSize;
+}
+
+void ScrubbingEngine::updateThroughput(size_t bytesChecked, uint32_t chunkStartMs) {
+    uint32_t currentMs = 0;
+    Clock::getUptime(&currentMs);
+    uint32_t chunkDurationMs = currentMs - chunkStartMs;
+    if(chunkDurationMs == 0) {
+        /* Below the clock resolution */
+        chunkDurationMs = 1;
+    }
+    uint32_t measuredBytesPerMs = bytesChecked / chunkDurationMs;
+    if(measuredBytesPerMs == 0) {
+        measuredBytesPerMs = 1;
+    }
+    if(bytesPerMs == 0) {
+        bytesPerMs = measuredBytesPerMs;
+    }
+    else {
+        /* Smoothed so single slow accesses do not shrink the chunks too much */
+        bytesPerMs = (3 * bytesPerMs + measuredBytesPerMs) / 4;
+        if(bytesPerMs == 0) {
+            bytesPerMs = 1;
+        }
+    }
+
+    status.bytesScrubbed = currentByteIdx;
+    uint32_t operationDurationMs = currentMs - operationStartMs;
+    if(operationDurationMs > 0) {
+        status.bytesPerSecond = static_cast<uint64_t>(currentByteIdx) * 1000 /
+                operationDurationMs;
+    }
+}
+
+void ScrubbingEngine::handleErrorEvent(Event event, size_t blockOffset) {
+    /* Limit the number of events so a heavily corrupted image does not flood the
+    event manager. The finish event contains the total error counts. */
+    if(errorEventCount >= MAX_ERROR_EVENTS_PER_OPERATION) {
+        return;
+    }
+    errorEventCount++;
+    EventManagerIF::triggerEvent(objects::SOFTWARE_IMAGE_HANDLER, event, targetSlot,
+            blockOffset);
+}
+
+void ScrubbingEngine::finishOperation() {
+    uint32_t currentMs = 0;
+    Clock::getUptime(&currentMs);
+    status.lastOperationDurationMs = currentMs - operationStartMs;
+    status.lastFinishedSlot = targetSlot;
+    status.finishedOperations++;
+    EventManagerIF::triggerEvent(objects::SOFTWARE_IMAGE_HANDLER, image::SCRUBBING_FINISHED,
+            targetSlot, (operationCorrectedErrors << 16) | operationUncorrectableErrors);
+#if OBSW_VERBOSE_LEVEL >= 1
+    sif::printInfo("ScrubbingEngine: Scrubbing of image slot %d finished after %lu ms. "
+            "%d errors corrected, %d uncorrectable errors\n", static_cast<int>(targetSlot),
+            static_cast<unsigned long>(status.lastOperationDurationMs),
+            operationCorrectedErrors, operationUncorrectableErrors);
+#endif
+    reset();
+}
+
+bool ScrubbingEngine::periodicScrubbingDue(image::ImageSlot* nextSlot) {
+    if(not periodicScrubbing or getIsOperationOngoing() or nextSlot == nullptr) {
+        return false;
+    }
+    uint32_t currentMs = 0;
+    Clock::getUptime(&currentMs);
+    if(currentMs - lastPeriodicScrubMs < scrubbingIntervalSeconds * 1000) {
+        return false;
+    }
+    lastPeriodicScrubMs = currentMs;
+
+#ifdef ISIS_OBC_G20
+    /* The NOR-Flash image is booted from, so it is checked every second interval */
+    static constexpr image::ImageSlot PERIODIC_SLOTS[] = {image::ImageSlot::FLASH,
+            image::ImageSlot::SDC_SLOT_0, image::ImageSlot::FLASH, image::ImageSlot::SDC_SLOT_1};
+#else
+    static constexpr image::ImageSlot PERIODIC_SLOTS[] = {image::ImageSlot::SDC_SLOT_0,
+            image::ImageSlot::SDC_SLOT_1};
+#endif
+    *nextSlot = PERIODIC_SLOTS[periodicScrubIdx];
+    periodicScrubIdx = (periodicScrubIdx + 1) % (sizeof(PERIODIC_SLOTS) /
+            sizeof(PERIODIC_SLOTS[0]));
+    return true;
+}
+
+ScrubbingEngine::ScrubbingStatus ScrubbingEngine::getScrubbingStatus() const {
+    return status;
+}
+
+void ScrubbingEngine::reset() {
+    targetSlot = image::ImageSlot::NONE;
+    prepared = false;
+    currentByteIdx = 0;
+    imageSize = 0;
+    errorCount = 0;
+    errorEventCount = 0;
+    operationCorrectedErrors = 0;
+    operationUncorrectableErrors = 0;
+    status.currentSlot = image::ImageSlot::NONE;
+    status.bytesScrubbed = 0;
+    status.imageSize = 0;
 }
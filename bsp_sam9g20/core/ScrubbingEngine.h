@@ -1,13 +1,99 @@
 #ifndef SAM9G20_CORE_SCRUBBINGENGINE_H_
 #define SAM9G20_CORE_SCRUBBINGENGINE_H_
 
+#include "OBSWConfig.h"
+#include "imageHandlerDefintions.h"
+
+#include "hcc/api_fat.h"
+#include "bsp_sam9g20/common/SDCardApi.h"
+#include "bsp_sam9g20/common/fram/CommonFRAM.h"
+
+#include <fsfw/serialize/SerialLinkedListAdapter.h>
+
 #include <cstdint>
 
 class SoftwareImageHandler;
+class Countdown;
 
+/**
+ * @brief   This class encapsulates the scrubbing operations of the SoftwareImageHandler.
+ * @details
+ * The images are checked against their hamming codes in blocks of 256 bytes, with 3 bytes of
+ * hamming code per block. The image is processed in chunks which are sized so the remaining
+ * part of the task period is not exceeded, so a scrubbing operation will usually span a lot
+ * of task cycles.
+ *
+ * Single bit errors are corrected in place. On the SD card, the corrected block is simply
+ * written back. On the NOR-Flash, bits can only be cleared without erasing a whole sector,
+ * so single bit errors which flipped a bit from 1 to 0 can not be corrected in place and are
+ * reported instead. The image should then be copied to the NOR-Flash again.
+ * Multi bit errors can not be corrected and are reported with an event as well.
+ *
+ * @author  R. Mueller
+ */
 class ScrubbingEngine {
 public:
-    ScrubbingEngine(SoftwareImageHandler* owner);
+    //! Default interval for periodic scrubbing. One image is checked in each interval.
+    static constexpr uint32_t DEFAULT_SCRUBBING_INTERVAL_SECONDS = 600;
+    //! Maximum number of error events triggered for one scrubbing operation.
+    static constexpr uint8_t MAX_ERROR_EVENTS_PER_OPERATION = 5;
+
+    struct ScrubbingStatus {
+        uint8_t currentSlot = image::ImageSlot::NONE;
+        //! Progress of the current operation in bytes
+        uint32_t bytesScrubbed = 0;
+        uint32_t imageSize = 0;
+        //! Throughput of the current or last operation over the elapsed time
+        uint32_t bytesPerSecond = 0;
+        uint32_t lastOperationDurationMs = 0;
+        uint8_t lastFinishedSlot = image::ImageSlot::NONE;
+        uint32_t finishedOperations = 0;
+        uint32_t correctedErrors = 0;
+        uint32_t uncorrectableErrors = 0;
+        uint32_t hammingCodeErrors = 0;
+    };
+
+    ScrubbingEngine(SoftwareImageHandler* owner, Countdown* countdown,
+            image::ImageBuffer* imgBuffer, uint32_t cycleBudgetMs);
+
+    /**
+     * Start scrubbing the given image.
+     * @param targetSlot    FLASH (iOBC only), SDC_SLOT_0 or SDC_SLOT_1 on the active SD card
+     * @return
+     *  - RETURN_OK if the operation was started
+     *  - image::BUSY if an operation is already ongoing
+     *  - RETURN_FAILED for invalid slots
+     */
+    ReturnValue_t startScrubbingOperation(image::ImageSlot targetSlot);
+
+    /**
+     * Continue the current operation.
+     * @return
+     *      -@c RETURN_OK if the operation was finished
+     *      -@c TASK_PERIOD_OVER_SOON if the operation was continued but not finished
+     *          and the task period is over soon.
+     *      -@c HAMMING_CODE_UNAVAILABLE if there is no valid hamming code for the image
+     *      -@c RETURN_FAILED if the operation has failed.
+     */
+    ReturnValue_t continueCurrentOperation();
+
+    bool getIsOperationOngoing() const;
+
+    /**
+     * Can be used by the SoftwareImageHandler to check whether a periodic scrubbing operation
+     * should be started.
+     * @param nextSlot  Slot to scrub next. The NOR-Flash image is scrubbed more often
+     *                  than the SD card images.
+     * @return True if periodic scrubbing is enabled and the interval has passed
+     */
+    bool periodicScrubbingDue(image::ImageSlot* nextSlot);
+
+    ScrubbingStatus getScrubbingStatus() const;
+
+    /**
+     * Reset the state of the helper class. The counters of the status will be kept.
+     */
+    void reset();
 
     /**
      * The hamming code can be stored on FRAM or on the SD card.
@@ -16,11 +102,113 @@ public:
      * This will be the  default setting.
      */
     uint8_t hammingCodeOnSdCard = false;
+
+    uint8_t periodicScrubbing = false;
+    uint32_t scrubbingIntervalSeconds = DEFAULT_SCRUBBING_INTERVAL_SECONDS;
 private:
+    static constexpr size_t HAMMING_BLOCK_SIZE = 256;
+    static constexpr size_t HAMMING_CODE_BYTES_PER_BLOCK = 3;
+
     SoftwareImageHandler* owner;
+    Countdown* countdown = nullptr;
+    image::ImageBuffer* imgBuffer = nullptr;
+    std::array<uint8_t, sizeof(image::ImageBuffer) / HAMMING_BLOCK_SIZE *
+            HAMMING_CODE_BYTES_PER_BLOCK> hammingBuffer = {};
 
-};
+    uint32_t cycleBudgetMs = 0;
+    //! Measured scrubbing throughput, used to size the chunks
+    uint32_t bytesPerMs = 0;
+
+    image::ImageSlot targetSlot = image::ImageSlot::NONE;
+    VolumeId scrubbedVolume = SD_CARD_0;
+    bool prepared = false;
+    size_t currentByteIdx = 0;
+    size_t imageSize = 0;
+    SlotType framSlot = FLASH_SLOT;
+    uint8_t errorCount = 0;
+    uint8_t errorEventCount = 0;
+    uint16_t operationCorrectedErrors = 0;
+    uint16_t operationUncorrectableErrors = 0;
+    uint32_t operationStartMs = 0;
+
+    uint32_t lastPeriodicScrubMs = 0;
+    uint8_t periodicScrubIdx = 0;
+
+    ScrubbingStatus status;
 
+    ReturnValue_t prepareOperation(VolumeId activeVolume);
+    ReturnValue_t openSdCardFiles(F_FILE** imageFile, F_FILE** hammingFile);
+    /**
+     * Scrub the image chunk by chunk until it is finished or the task period is over soon.
+     * @param imageFile     Image on the SD card or nullptr for the NOR-Flash image
+     * @param hammingFile   Hamming code on the SD card or nullptr if it is read from the FRAM
+     * @return
+     */
+    ReturnValue_t scrubChunks(F_FILE* imageFile, F_FILE* hammingFile);
+#ifdef ISIS_OBC_G20
+    /**
+     * Programs the corrected block to the NOR-Flash if this only requires clearing bits.
+     */
+    ReturnValue_t correctNorFlashBlock(size_t blockOffset, const uint8_t* correctedBlock,
+            size_t blockSize);
+#endif
 
+    /**
+     * Determine the size of the next chunk from the measured throughput and the
+     * remaining time in the current cycle.
+     * @return Size of the next chunk, which is a multiple of the hamming block size, or 0 if
+     * the task period is over soon
+     */
+    size_t getNextChunkSize(uint32_t cycleStartMs, bool firstChunk);
+    void updateThroughput(size_t bytesChecked, uint32_t chunkStartMs);
+
+    ReturnValue_t readHammingCode(F_FILE* hammingFile, size_t chunkSize);
+    /**
+     * Verify the chunk in the image buffer block by block.
+     * @param correctedBlocks   Will be set to a bitmask of the blocks which were corrected
+     */
+    void verifyChunk(size_t chunkSize, uint32_t* correctedBlocks);
+    void handleErrorEvent(Event event, size_t blockOffset);
+    void finishOperation();
+};
+
+/**
+ * @brief   Reply containing the progress, throughput and error counters of the
+ *          scrubbing engine.
+ */
+class ScrubbingStatusReply: public SerialLinkedListAdapter<SerializeIF> {
+public:
+    ScrubbingStatusReply(const ScrubbingEngine::ScrubbingStatus& status):
+            currentSlot(status.currentSlot), bytesScrubbed(status.bytesScrubbed),
+            imageSize(status.imageSize), bytesPerSecond(status.bytesPerSecond),
+            lastOperationDurationMs(status.lastOperationDurationMs),
+            lastFinishedSlot(status.lastFinishedSlot),
+            finishedOperations(status.finishedOperations),
+            correctedErrors(status.correctedErrors),
+            uncorrectableErrors(status.uncorrectableErrors),
+            hammingCodeErrors(status.hammingCodeErrors) {
+        setStart(&this->currentSlot);
+        this->currentSlot.setNext(&this->bytesScrubbed);
+        this->bytesScrubbed.setNext(&this->imageSize);
+        this->imageSize.setNext(&this->bytesPerSecond);
+        this->bytesPerSecond.setNext(&this->lastOperationDurationMs);
+        this->lastOperationDurationMs.setNext(&this->lastFinishedSlot);
+        this->lastFinishedSlot.setNext(&this->finishedOperations);
+        this->finishedOperations.setNext(&this->correctedErrors);
+        this->correctedErrors.setNext(&this->uncorrectableErrors);
+        this->uncorrectableErrors.setNext(&this->hammingCodeErrors);
+    }
+private:
+    SerializeElement<uint8_t> currentSlot;
+    SerializeElement<uint32_t> bytesScrubbed;
+    SerializeElement<uint32_t> imageSize;
+    SerializeElement<uint32_t> bytesPerSecond;
+    SerializeElement<uint32_t> lastOperationDurationMs;
+    SerializeElement<uint8_t> lastFinishedSlot;
+    SerializeElement<uint32_t> finishedOperations;
+    SerializeElement<uint32_t> correctedErrors;
+    SerializeElement<uint32_t> uncorrectableErrors;
+    SerializeElement<uint32_t> hammingCodeErrors;
+};
 
 #endif /* SAM9G20_CORE_SCRUBBINGENGINE_H_ */
@@ -2,13 +2,13 @@
 #include "ImageCopyingEngine.h"
 #include "ScrubbingEngine.h"
 
-#include <bsp_sam9g20/memory/SDCardHandler.h>
 #include <bsp_sam9g20/memory/SDCardAccess.h>
 
 #include <fsfw/tasks/PeriodicTaskIF.h>
 #include <fsfw/timemanager/Countdown.h>
 #include <fsfw/timemanager/Stopwatch.h>
 #include <fsfw/ipc/QueueFactory.h>
+#include <fsfw/serialize/SerializeAdapter.h>
 #include <fsfw/serviceinterface/ServiceInterface.h>
 
 #ifdef ISIS_OBC_G20
@@ -64,8 +64,14 @@ void SoftwareImageHandler::performStateMachine() {
     while(countdown->isBusy()) {
         switch(handlerState) {
         case(HandlerState::IDLE): {
-            /* Check whether periodic scrubbing is necessary otherwise, return.
-            Periodic scrubbing not implemented yet. */
+            /* Check whether periodic scrubbing is necessary otherwise, return. */
+            image::ImageSlot nextSlot = image::ImageSlot::NONE;
+            if(scrubbingEngine->periodicScrubbingDue(&nextSlot) and
+                    scrubbingEngine->startScrubbingOperation(nextSlot) ==
+                    HasReturnvaluesIF::RETURN_OK) {
+                handlerState = HandlerState::SCRUBBING;
+                break;
+            }
             return;
         }
         case(HandlerState::COPYING): {
@@ -75,22 +81,43 @@ void SoftwareImageHandler::performStateMachine() {
             if(result == image::TASK_PERIOD_OVER_SOON) {
                 return;
             }
-            else if(result == HasReturnvaluesIF::RETURN_FAILED) {
-                imgCpHelper->reset();
-                handlerState = HandlerState::IDLE;
+            else if(result == HasReturnvaluesIF::RETURN_OK or
+                    result == image::OPERATION_FINISHED) {
+                actionHelper.finish(true, recipient, currentAction, HasReturnvaluesIF::RETURN_OK);
             }
             else {
-                actionHelper.finish(true, recipient, currentAction, HasReturnvaluesIF::RETURN_OK);
-                currentAction = 0xffffffff;
-                recipient = MessageQueueIF::NO_QUEUE;
-                imgCpHelper->reset();
-                handlerState = HandlerState::IDLE;
+                /* Report the specific failure, for example a CRC mismatch of a patched image */
+                actionHelper.finish(false, recipient, currentAction, result);
             }
+            currentAction = 0xffffffff;
+            recipient = MessageQueueIF::NO_QUEUE;
+            imgCpHelper->reset();
+            handlerState = HandlerState::IDLE;
             break;
         }
         case(HandlerState::SCRUBBING): {
             /* Continue current scrubbing operation. */
-            break;
+            ReturnValue_t result = scrubbingEngine->continueCurrentOperation();
+            if(result == image::TASK_PERIOD_OVER_SOON) {
+                return;
+            }
+            else if(result != HasReturnvaluesIF::RETURN_OK) {
+#if OBSW_VERBOSE_LEVEL >= 1
+                sif::printWarning("SoftwareImageHandler::performStateMachine: Scrubbing failed "
+                        "with code 0x%04x\n", result);
+#endif
+            }
+            /* Periodic scrubbing operations have no recipient */
+            if(recipient != MessageQueueIF::NO_QUEUE) {
+                actionHelper.finish(result == HasReturnvaluesIF::RETURN_OK, recipient,
+                        currentAction, result);
+                currentAction = 0xffffffff;
+                recipient = MessageQueueIF::NO_QUEUE;
+            }
+            scrubbingEngine->reset();
+            handlerState = HandlerState::IDLE;
+            /* Leave the rest of the cycle to other tasks */
+            return;
         }
 
         default: {
@@ -130,6 +157,41 @@ ReturnValue_t SoftwareImageHandler::executeAction(ActionId_t actionId,
         result = handleCopyingHammingToStorage(actionId, commandedBy, data, size);
         break;
     }
+    case(GENERATE_HAMMING_CODE): {
+        result = handleHammingCodeGeneration(actionId, commandedBy, data, size);
+        break;
+    }
+    case(APPLY_PATCH): {
+        result = handlePatchCommand(actionId, commandedBy, data, size);
+        break;
+    }
+#ifdef ISIS_OBC_G20
+    case(REPORT_NOR_COPY_TIMINGS): {
+        NorCopyTimingsReply reply(imgCpHelper->getNorCopyTimings());
+        result = actionHelper.reportData(commandedBy, actionId, &reply);
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
+        }
+        return HasActionsIF::EXECUTION_FINISHED;
+    }
+#endif
+    case(SCRUB_OBSW_ON_SDC):
+    case(SCRUB_OBSW_ON_FLASH): {
+        result = handleScrubbingCommand(actionId, commandedBy, data, size);
+        break;
+    }
+    case(SET_PERIODIC_SCRUBBING): {
+        result = handlePeriodicScrubbingCommand(data, size);
+        break;
+    }
+    case(REPORT_SCRUBBING_STATUS): {
+        ScrubbingStatusReply reply(scrubbingEngine->getScrubbingStatus());
+        result = actionHelper.reportData(commandedBy, actionId, &reply);
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
+        }
+        return HasActionsIF::EXECUTION_FINISHED;
+    }
     default: {
         return HasActionsIF::INVALID_ACTION_ID;
     }
@@ -176,7 +238,8 @@ ReturnValue_t SoftwareImageHandler::initializeAfterTaskCreation() {
     if(imgCpHelper == nullptr) {
         return HasReturnvaluesIF::RETURN_FAILED;
     }
-    scrubbingEngine = new ScrubbingEngine(this);
+    scrubbingEngine = new ScrubbingEngine(this, countdown, &imgBuffer, static_cast<uint32_t>(
+            this->executingTask->getPeriodMs() * 0.75));
     if(scrubbingEngine == nullptr) {
         return HasReturnvaluesIF::RETURN_FAILED;
     }
@@ -222,6 +285,7 @@ ReturnValue_t SoftwareImageHandler::handleCopyingSdcBlToFlash(ActionId_t actionI
     imgCpHelper->startBootloaderToFlashOperation(image::ImageSlot::BOOTLOADER_0, fromFram);
 #endif
 
+    abortScrubbingOperation();
     currentAction = actionId;
     recipient = commandedBy;
     handlerState = HandlerState::COPYING;
@@ -250,6 +314,7 @@ ReturnValue_t SoftwareImageHandler::handleCopyingSdcImgToFlash(ActionId_t action
         return HasActionsIF::INVALID_PARAMETERS;
     }
 
+    abortScrubbingOperation();
     currentAction = actionId;
     recipient = commandedBy;
     handlerState = HandlerState::COPYING;
@@ -276,6 +341,14 @@ ReturnValue_t SoftwareImageHandler::getParameter(uint8_t domainId,
         parameterWrapper->set(scrubbingEngine->hammingCodeOnSdCard);
         return HasReturnvaluesIF::RETURN_OK;
     }
+    case(ParameterIds::PERIODIC_SCRUBBING): {
+        parameterWrapper->set(scrubbingEngine->periodicScrubbing);
+        return HasReturnvaluesIF::RETURN_OK;
+    }
+    case(ParameterIds::SCRUBBING_INTERVAL_SECONDS): {
+        parameterWrapper->set(scrubbingEngine->scrubbingIntervalSeconds);
+        return HasReturnvaluesIF::RETURN_OK;
+    }
     default:
         return HasParametersIF::INVALID_IDENTIFIER_ID;
     }
@@ -363,12 +436,84 @@ ReturnValue_t SoftwareImageHandler::handleCopyingHammingToStorage(ActionId_t act
     }
 #endif
     ReturnValue_t result = imgCpHelper->startHammingCodeToFramOperation(respectiveSlot);
+    abortScrubbingOperation();
     handlerState = HandlerState::COPYING;
     recipient = commandedBy;
     actionHelper.step(1, commandedBy, actionId, result);
     return result;
 }
 
+ReturnValue_t SoftwareImageHandler::handleHammingCodeGeneration(ActionId_t actionId,
+        MessageQueueId_t commandedBy, const uint8_t *data, size_t size) {
+    if(handlerState == HandlerState::COPYING) {
+        return HasActionsIF::IS_BUSY;
+    }
+    if(size != 1) {
+        return HasActionsIF::INVALID_PARAMETERS;
+    }
+
+    image::ImageSlot respectiveSlot = image::ImageSlot::NONE;
+    if(data[0] == 0) {
+        respectiveSlot = image::ImageSlot::FLASH;
+    }
+    else if(data[0] == 1) {
+        respectiveSlot = image::ImageSlot::SDC_SLOT_0;
+    }
+    else if(data[0] == 2) {
+        respectiveSlot = image::ImageSlot::SDC_SLOT_1;
+    }
+    else {
+        return HasActionsIF::INVALID_PARAMETERS;
+    }
+
+    ReturnValue_t result = imgCpHelper->startHammingCodeGenerationOperation(respectiveSlot);
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        return result;
+    }
+#if OBSW_VERBOSE_LEVEL >= 1
+    sif::printInfo("Received command to generate the hamming code for image slot %d\n",
+            static_cast<int>(data[0]));
+#endif
+    abortScrubbingOperation();
+    handlerState = HandlerState::COPYING;
+    recipient = commandedBy;
+    currentAction = actionId;
+    actionHelper.step(1, commandedBy, actionId, result);
+    return result;
+}
+
+ReturnValue_t SoftwareImageHandler::handlePatchCommand(ActionId_t actionId,
+        MessageQueueId_t commandedBy, const uint8_t *data, size_t size) {
+    if(handlerState == HandlerState::COPYING) {
+        return HasActionsIF::IS_BUSY;
+    }
+    if(size != 1) {
+        return HasActionsIF::INVALID_PARAMETERS;
+    }
+
+    image::ImageSlot sourceSlot = image::ImageSlot::NONE;
+    if(data[0] == 0) {
+        sourceSlot = image::ImageSlot::SDC_SLOT_0;
+    }
+    else if(data[0] == 1) {
+        sourceSlot = image::ImageSlot::SDC_SLOT_1;
+    }
+    else {
+        return HasActionsIF::INVALID_PARAMETERS;
+    }
+
+    ReturnValue_t result = imgCpHelper->startPatchOperation(sourceSlot);
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        return result;
+    }
+    abortScrubbingOperation();
+    handlerState = HandlerState::COPYING;
+    recipient = commandedBy;
+    currentAction = actionId;
+    actionHelper.step(1, commandedBy, actionId, result);
+    return result;
+}
+
 ReturnValue_t SoftwareImageHandler::handleCopyingSdcToSdc(ActionId_t actionId,
         MessageQueueId_t commandedBy, const uint8_t *data, size_t size) {
     if(handlerState == HandlerState::COPYING) {
@@ -389,9 +534,87 @@ ReturnValue_t SoftwareImageHandler::handleCopyingSdcToSdc(ActionId_t actionId,
         return HasActionsIF::INVALID_PARAMETERS;
     }
 
+    abortScrubbingOperation();
     currentAction = actionId;
     recipient = commandedBy;
     handlerState = HandlerState::COPYING;
     actionHelper.step(1, commandedBy, actionId, HasReturnvaluesIF::RETURN_OK);
     return HasReturnvaluesIF::RETURN_OK;
 }
+
+ReturnValue_t SoftwareImageHandler::handleScrubbingCommand(ActionId_t actionId,
+        MessageQueueId_t commandedBy, const uint8_t *data, size_t size) {
+    /* Copy operations and other scrubbing operations, including periodic ones,
+    need to finish first */
+    if(handlerState != HandlerState::IDLE) {
+        return image::BUSY;
+    }
+
+    image::ImageSlot targetSlot = image::ImageSlot::NONE;
+    if(actionId == SCRUB_OBSW_ON_FLASH) {
+        targetSlot = image::ImageSlot::FLASH;
+    }
+    else {
+        if(size != 1) {
+            return HasActionsIF::INVALID_PARAMETERS;
+        }
+        if(data[0] == 0) {
+            targetSlot = image::ImageSlot::SDC_SLOT_0;
+        }
+        else if(data[0] == 1) {
+            targetSlot = image::ImageSlot::SDC_SLOT_1;
+        }
+        else {
+            return HasActionsIF::INVALID_PARAMETERS;
+        }
+    }
+
+    ReturnValue_t result = scrubbingEngine->startScrubbingOperation(targetSlot);
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        return HasActionsIF::INVALID_PARAMETERS;
+    }
+
+    currentAction = actionId;
+    recipient = commandedBy;
+    handlerState = HandlerState::SCRUBBING;
+    actionHelper.step(1, commandedBy, actionId, HasReturnvaluesIF::RETURN_OK);
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t SoftwareImageHandler::handlePeriodicScrubbingCommand(const uint8_t *data,
+        size_t size) {
+    if(size != 1 and size != 5) {
+        return HasActionsIF::INVALID_PARAMETERS;
+    }
+    if(size == 5) {
+        uint32_t intervalSeconds = 0;
+        const uint8_t* intervalPtr = data + 1;
+        size_t remainingSize = size - 1;
+        ReturnValue_t result = SerializeAdapter::deSerialize(&intervalSeconds, &intervalPtr,
+                &remainingSize, SerializeIF::Endianness::BIG);
+        if(result != HasReturnvaluesIF::RETURN_OK or intervalSeconds == 0) {
+            return HasActionsIF::INVALID_PARAMETERS;
+        }
+        scrubbingEngine->scrubbingIntervalSeconds = intervalSeconds;
+    }
+    scrubbingEngine->periodicScrubbing = data[0];
+#if OBSW_VERBOSE_LEVEL >= 1
+    sif::printInfo("SoftwareImageHandler: Periodic scrubbing %s, interval %lu seconds\n",
+            data[0]? "enabled" : "disabled",
+            static_cast<unsigned long>(scrubbingEngine->scrubbingIntervalSeconds));
+#endif
+    return HasActionsIF::EXECUTION_FINISHED;
+}
+
+void SoftwareImageHandler::abortScrubbingOperation() {
+    if(handlerState != HandlerState::SCRUBBING) {
+        return;
+    }
+    if(recipient != MessageQueueIF::NO_QUEUE) {
+        actionHelper.finish(false, recipient, currentAction, image::BUSY);
+        currentAction = 0xffffffff;
+        recipient = MessageQueueIF::NO_QUEUE;
+    }
+    scrubbingEngine->reset();
+    handlerState = HandlerState::IDLE;
+}
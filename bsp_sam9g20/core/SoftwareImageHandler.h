@@ -96,6 +96,8 @@ private:
 
     enum ParameterIds {
         HAMMING_CODE_FROM_SDC = 0,
+        PERIODIC_SCRUBBING = 1,
+        SCRUBBING_INTERVAL_SECONDS = 2
     };
 
     /* HasActionIF (Service 8) definitions */
@@ -146,6 +148,32 @@ private:
      *  - 4 for bootloader 2 (AT91
      */
     static constexpr ActionId_t COPY_HAMMING_SDC_TO_STORAGE = 7;
+    /**
+     * Generates the hamming code of an image on board and writes it to the FRAM, so it does not
+     * have to be uploaded separately. The hamming flag of the image is set when the code
+     * was written completely. Only available on the iOBC.
+     * One uint8_t field should be supplied which has the following meaning:
+     *
+     * First byte:  Image to generate the hamming code for.
+     *  - 0 for NOR-Flash
+     *  - 1 for SD slot 0
+     *  - 2 for SD slot 1 (update slot)
+     */
+    static constexpr ActionId_t GENERATE_HAMMING_CODE = 8;
+    /**
+     * Report the timing counters of the last copy operation to the NOR-Flash, including
+     * the duration of the critical window in which no valid image is on the NOR-Flash.
+     * Only available on the iOBC.
+     */
+    static constexpr ActionId_t REPORT_NOR_COPY_TIMINGS = 9;
+    /**
+     * Rebuild an image from an image on the active SD card and the uploaded delta patch
+     * (see image::patch). The new image is written to the other slot after its CRC was
+     * verified. One uint8_t field should be supplied which has the following meaning:
+     *
+     * First byte:  Source image slot, 0 for slot 0, 1 for slot 1. The other slot is the target.
+     */
+    static constexpr ActionId_t APPLY_PATCH = 10;
     /**
      * Copy bootloader backup to flash, will be performed in uninterruptible
      * task with highest priority. One byte of data should be provided which
@@ -169,23 +197,14 @@ private:
 
     /* Scrubbing operation IDs */
 
-    //! TODO: make manual scrubbing work first.
-    //static constexpr ActionId_t SET_PERIODIC_SCRUBBING = 33;
     /**
-     * Report the status of the scrubbing engine
-     * First byte: Number of scrubbing operations ongoing.
-     * Second, third and fourth byte: ID of any ongoing scrubbing operations.
-     */
-    //static constexpr ActionId_t REPORT_SCRUBBING_STATUS = 2;
-
-    /**
-     * Scrub the OBSW on the active SDC manually.
+     * Scrub the OBSW on the active SDC manually. Copy operations have priority and will
+     * abort an ongoing scrubbing operation.
      * One uint8_t field has to be provided which has the following meaning:
-     * First byte:    Target binary slot, 0 for slot 1, 1 for slot 2,
-     *                2 for the software update slot
+     * First byte:    Target binary slot, 0 for slot 0, 1 for slot 1 (software update slot)
      */
     static constexpr ActionId_t SCRUB_OBSW_ON_SDC = 33;
-    //! Scrub the OBSW on the boot flash memory manually.
+    //! Scrub the OBSW on the boot flash memory manually. Only available on the iOBC.
     static constexpr ActionId_t SCRUB_OBSW_ON_FLASH = 34;
     /**
      * Scrub the backup bootloader. One uint8_t data field should be supplied
@@ -198,6 +217,15 @@ private:
     static constexpr ActionId_t SCRUB_BACKUP_BOOTLOADER = 35;
     //! Scrub the primary bootloader
     static constexpr ActionId_t SCRUB_BOOTLOADER_ON_FLASH = 36;
+    /**
+     * Enable or disable periodic scrubbing. One image is scrubbed in each interval,
+     * with the NOR-Flash image being scrubbed every second interval on the iOBC.
+     * First byte: 1 to enable, 0 to disable periodic scrubbing
+     * Optional uint32_t field: Interval in seconds
+     */
+    static constexpr ActionId_t SET_PERIODIC_SCRUBBING = 37;
+    //! Report the progress, throughput and error counters of the scrubbing engine.
+    static constexpr ActionId_t REPORT_SCRUBBING_STATUS = 38;
 
 
     MessageQueueIF* receptionQueue = nullptr;
@@ -256,6 +284,18 @@ private:
             const uint8_t *data, size_t size);
     ReturnValue_t handleCopyingHammingToStorage(ActionId_t actionId, MessageQueueId_t commandedBy,
             const uint8_t *data, size_t size);
+    ReturnValue_t handleHammingCodeGeneration(ActionId_t actionId, MessageQueueId_t commandedBy,
+            const uint8_t *data, size_t size);
+    ReturnValue_t handlePatchCommand(ActionId_t actionId, MessageQueueId_t commandedBy,
+            const uint8_t *data, size_t size);
+    ReturnValue_t handleScrubbingCommand(ActionId_t actionId, MessageQueueId_t commandedBy,
+            const uint8_t *data, size_t size);
+    ReturnValue_t handlePeriodicScrubbingCommand(const uint8_t *data, size_t size);
+    /**
+     * Copy operations have priority over scrubbing operations, so an ongoing scrubbing
+     * operation is aborted before a copy operation is started.
+     */
+    void abortScrubbingOperation();
     void checkSdCardImage(SdCard sdCard, image::ImageSlot imageSlot);
 
 };
@@ -12,6 +12,7 @@
 #include <fsfw/tasks/TaskFactory.h>
 #include <bsp_sam9g20/core/CoreController.h>
 #include <fsfw/storagemanager/StorageManagerIF.h>
+#include <fsfw/datapool/PoolReadGuard.h>
 
 
 #include <inttypes.h>
@@ -23,7 +24,7 @@
 SystemStateTask::SystemStateTask(object_id_t objectId,
         object_id_t coreControllerId): SystemObject(objectId),
         internalState(InternalState::IDLE), coreControllerId(coreControllerId),
-        statsVector(0), taskStatArray(0)  {
+        statsVector(0), taskStatArray(0), cpuStatsSet(coreControllerId) {
 }
 
 ReturnValue_t SystemStateTask::performOperation(uint8_t opCode) {
@@ -60,6 +61,15 @@ ReturnValue_t SystemStateTask::performOperation(uint8_t opCode) {
 
             break;
         }
+        case(InternalState::GENERATING_STATS_SAMPLE): {
+#if configGENERATE_RUN_TIME_STATS == 1
+            size_t tasksRead = uxTaskGetSystemState(taskStatArray.data(),
+                    taskStatArray.size(), nullptr);
+            performStatsSample(tasksRead);
+#endif
+            internalState = InternalState::IDLE;
+            break;
+        }
         }
     }
     return HasReturnvaluesIF::RETURN_OK;
@@ -86,6 +96,16 @@ bool SystemStateTask::generateStatsPrint() {
     return true;
 }
 
+bool SystemStateTask::generateStatsSample() {
+    if(internalState != InternalState::IDLE or coreController == nullptr) {
+        return false;
+    }
+
+    internalState = InternalState::GENERATING_STATS_SAMPLE;
+    semaphore->release();
+    return true;
+}
+
 ReturnValue_t SystemStateTask::initializeAfterTaskCreation() {
     ipcStore = ObjectManager::instance()->get<StorageManagerIF>(objects::IPC_STORE);
     if (ipcStore == nullptr) {
@@ -97,7 +117,7 @@ ReturnValue_t SystemStateTask::initializeAfterTaskCreation() {
     taskStatArray.resize(numberOfTasks + 3);
 
 
-    size_t sizeToReserve = (numberOfTasks + 3) * 75;
+    size_t sizeToReserve = STATS_HEADER_SIZE + (numberOfTasks + 3) * MAX_STAT_LINE_SIZE;
     statsVector.reserve(sizeToReserve);
     statsVector.resize(sizeToReserve);
 
@@ -115,6 +135,7 @@ ReturnValue_t SystemStateTask::initializeAfterTaskCreation() {
                 "Core Controller does not exist\n");
         return HasReturnvaluesIF::RETURN_FAILED;
     }
+    lastSampleUptimeTicks = coreController->getTotalRunTimeCounter();
     /* To prevent mangled output */
     TaskFactory::delayTask(5);
 #if FSFW_CPP_OSTREAM_ENABLED == 1
@@ -136,8 +157,8 @@ void SystemStateTask::performStatsGeneration(InternalState csvOrPrint) {
     Clock::TimeOfDay_t loggerTime;
     Clock::getDateAndTime(&loggerTime);
     size_t statsIdx = 0;
-    statsIdx += std::sprintf(reinterpret_cast<char*>(statsVector.data()),
-            "Time: %02" SCNu32 ".%02" SCNu32  ".%02" SCNu32 " %02" SCNu32
+    int written = std::snprintf(reinterpret_cast<char*>(statsVector.data()),
+            statsVector.size(), "Time: %02" SCNu32 ".%02" SCNu32  ".%02" SCNu32 " %02" SCNu32
             ":%02" SCNu32 ":%02" SCNu32 "\n\r",
             loggerTime.day,
             loggerTime.month,
@@ -145,22 +166,15 @@ void SystemStateTask::performStatsGeneration(InternalState csvOrPrint) {
             loggerTime.hour,
             loggerTime.minute,
             loggerTime.second);
+    advanceStatsIdx(statsIdx, written, statsVector.size());
     const char* const infoColumn = "10 kHz time base used for CPU statistics\n\r";
-    size_t infoSize = strlen(infoColumn);
-    if(infoSize > 50) {
-        infoSize = 50;
-    }
+    /* The task number maps the tasks in the CPU statistics set to their names */
     const char* const headerColumn = "Task Name\tAbsTime [Ticks]\tRelTime [%]\t"
-            "LstRemStack [bytes]\n\r";
-    size_t headerSize = strlen(headerColumn);
-    if(headerSize > 70) {
-        headerSize = 70;
-    }
-
-    std::memcpy(statsVector.data() + statsIdx, infoColumn, infoSize);
-    statsIdx += infoSize;
-    std::memcpy(statsVector.data() + statsIdx, headerColumn, headerSize);
-    statsIdx += headerSize;
+            "LstRemStack [bytes]\tTask Number\n\r";
+    size_t remainingSize = statsVector.size() - statsIdx;
+    written = std::snprintf(reinterpret_cast<char*>(statsVector.data() + statsIdx),
+            remainingSize, "%s%s", infoColumn, headerColumn);
+    advanceStatsIdx(statsIdx, written, remainingSize);
 
     /* For percentage calculations. */
     uptimeTicks /= 100UL;
@@ -181,7 +195,12 @@ void SystemStateTask::performStatsGeneration(InternalState csvOrPrint) {
         }
 
         if(task.pcTaskName != nullptr) {
-
+            /* Only start a line if it fits completely, including the line break */
+            if(statsVector.size() - statsIdx <= MAX_STAT_LINE_SIZE) {
+                sif::printWarning("SystemStateTask::performStatsGeneration: "
+                        "Statistics truncated\n");
+                break;
+            }
             if (csvOrPrint == InternalState::GENERATING_STATS_CSV) {
                 writeCsvStatLine(task, statsIdx, idleTicks, uptimeTicks);
             }
@@ -277,54 +296,126 @@ void SystemStateTask::performStatsGeneration(InternalState csvOrPrint) {
 
 }
 
+void SystemStateTask::performStatsSample(size_t tasksRead) {
+    uint64_t uptimeTicks = coreController->getTotalRunTimeCounter();
+    std::array<uint16_t, cpustats::MAX_NUMBER_OF_TASKS> taskNumbers = {};
+    std::array<uint32_t, cpustats::MAX_NUMBER_OF_TASKS> runTimeCounters = {};
+    uint8_t sampledTasks = 0;
+
+    PoolReadGuard readHelper(&cpuStatsSet);
+    if(readHelper.getReadResult() != HasReturnvaluesIF::RETURN_OK) {
+        return;
+    }
+    for(size_t idx = 0; idx < tasksRead and sampledTasks < cpustats::MAX_NUMBER_OF_TASKS;
+            idx++) {
+        const TaskStatus_t& task = taskStatArray[idx];
+        if(task.xHandle == nullptr) {
+            continue;
+        }
+        uint16_t taskNumber = static_cast<uint16_t>(task.xTaskNumber);
+        cpuStatsSet.taskNumbers[sampledTasks] = taskNumber;
+        cpuStatsSet.taskStates[sampledTasks] = static_cast<uint8_t>(task.eCurrentState);
+        cpuStatsSet.stackHighWaterMarks[sampledTasks] = task.usStackHighWaterMark;
+        cpuStatsSet.runTimeDeltas[sampledTasks] = getRunTimeDelta(taskNumber,
+                task.ulRunTimeCounter);
+        taskNumbers[sampledTasks] = taskNumber;
+        runTimeCounters[sampledTasks] = task.ulRunTimeCounter;
+        sampledTasks++;
+    }
+    for(size_t idx = sampledTasks; idx < cpustats::MAX_NUMBER_OF_TASKS; idx++) {
+        cpuStatsSet.taskNumbers[idx] = 0;
+        cpuStatsSet.taskStates[idx] = 0;
+        cpuStatsSet.stackHighWaterMarks[idx] = 0;
+        cpuStatsSet.runTimeDeltas[idx] = 0;
+    }
+    cpuStatsSet.sampleCount = ++sampleCount;
+    cpuStatsSet.totalRunTimeDelta = static_cast<uint32_t>(uptimeTicks - lastSampleUptimeTicks);
+    cpuStatsSet.numberOfTasks = sampledTasks;
+    cpuStatsSet.setValidity(true, true);
+
+    lastSampleUptimeTicks = uptimeTicks;
+    lastNumberOfSampledTasks = sampledTasks;
+    lastTaskNumbers = taskNumbers;
+    lastRunTimeCounters = runTimeCounters;
+}
+
+uint32_t SystemStateTask::getRunTimeDelta(uint16_t taskNumber, uint32_t runTimeCounter) const {
+    for(size_t idx = 0; idx < lastNumberOfSampledTasks; idx++) {
+        if(lastTaskNumbers[idx] == taskNumber) {
+            /* The unsigned difference also covers one overflow of the 32 bit counter */
+            return runTimeCounter - lastRunTimeCounters[idx];
+        }
+    }
+    return runTimeCounter;
+}
+
+void SystemStateTask::advanceStatsIdx(size_t& statsIdx, int written,
+        size_t bufferSize) const {
+    if(written < 0 or bufferSize == 0) {
+        return;
+    }
+    /* snprintf returns the untruncated length, skip only what was actually written */
+    if(static_cast<size_t>(written) >= bufferSize) {
+        written = bufferSize - 1;
+    }
+    statsIdx += written;
+}
+
 void SystemStateTask::writeDebugStatLine(const TaskStatus_t& task,
         size_t& statsIdx, uint64_t idleTicks, uint64_t uptimeTicks) {
     writePaddedName(static_cast<uint8_t*>(statsVector.data() + statsIdx),
             static_cast<const char*>(task.pcTaskName));
     statsIdx += configMAX_TASK_NAME_LEN;
+    int written = 0;
     // newlib nano does not support 64 bit print, so eventually the printout
     // will become invalid.
     if(std::strcmp(task.pcTaskName, "IDLE") == 0) {
-        statsIdx += std::snprintf((char*)(statsVector.data() + statsIdx),
-                configMAX_TASK_NAME_LEN + 64,
-                "%lu\t\t\%lu\t\t%lu", static_cast<uint32_t>(idleTicks & 0xFFFF),
+        written = std::snprintf((char*)(statsVector.data() + statsIdx),
+                DEBUG_STAT_SIZE,
+                "%lu\t\t\%lu\t\t%lu\t\t%lu", static_cast<uint32_t>(idleTicks & 0xFFFF),
                 static_cast<uint32_t>(idleTicks / uptimeTicks),
-                task.usStackHighWaterMark * sizeof(configSTACK_DEPTH_TYPE));
+                task.usStackHighWaterMark * sizeof(configSTACK_DEPTH_TYPE),
+                task.xTaskNumber);
     }
     else {
-        statsIdx += std::snprintf((char*)(statsVector.data() + statsIdx),
-                configMAX_TASK_NAME_LEN + 64,
-                "%lu\t\t%lu\t\t%lu", task.ulRunTimeCounter,
+        written = std::snprintf((char*)(statsVector.data() + statsIdx),
+                DEBUG_STAT_SIZE,
+                "%lu\t\t%lu\t\t%lu\t\t%lu", task.ulRunTimeCounter,
                 static_cast<uint32_t>(task.ulRunTimeCounter / uptimeTicks),
-                task.usStackHighWaterMark * sizeof(configSTACK_DEPTH_TYPE));
+                task.usStackHighWaterMark * sizeof(configSTACK_DEPTH_TYPE),
+                task.xTaskNumber);
     }
+    advanceStatsIdx(statsIdx, written, DEBUG_STAT_SIZE);
 }
 
 void SystemStateTask::writeCsvStatLine(const TaskStatus_t& task,
         size_t& statsIdx, uint64_t idleTicks, uint64_t uptimeTicks) {
-
+    int written = 0;
     if(std::strcmp(task.pcTaskName, "IDLE") == 0) {
-        statsIdx += std::snprintf((char*)(statsVector.data() + statsIdx),
-                configMAX_TASK_NAME_LEN + 64,
-                "%s,%lu,%lu,%lu", task.pcTaskName,
+        written = std::snprintf((char*)(statsVector.data() + statsIdx),
+                CSV_STAT_SIZE,
+                "%s,%lu,%lu,%lu,%lu", task.pcTaskName,
                 static_cast<uint32_t>(idleTicks & 0xFFFF),
                 static_cast<uint32_t>(idleTicks / uptimeTicks),
-                task.usStackHighWaterMark * sizeof(configSTACK_DEPTH_TYPE));
+                task.usStackHighWaterMark * sizeof(configSTACK_DEPTH_TYPE),
+                task.xTaskNumber);
     }
     else {
-        statsIdx += std::snprintf((char*)(statsVector.data() + statsIdx),
-                configMAX_TASK_NAME_LEN + 64,
-                "%s,%lu,%lu,%lu", task.pcTaskName, task.ulRunTimeCounter,
+        written = std::snprintf((char*)(statsVector.data() + statsIdx),
+                CSV_STAT_SIZE,
+                "%s,%lu,%lu,%lu,%lu", task.pcTaskName, task.ulRunTimeCounter,
                 static_cast<uint32_t>(task.ulRunTimeCounter / uptimeTicks),
-                task.usStackHighWaterMark * sizeof(configSTACK_DEPTH_TYPE));
+                task.usStackHighWaterMark * sizeof(configSTACK_DEPTH_TYPE),
+                task.xTaskNumber);
     }
+    advanceStatsIdx(statsIdx, written, CSV_STAT_SIZE);
 }
 
 void SystemStateTask::writePaddedName(uint8_t* buffer,
         const char *pcTaskName) {
     /* Start by copying the entire string. */
     size_t bytesWritten = std::snprintf((char*) buffer,
-            configMAX_TASK_NAME_LEN, pcTaskName);
+            configMAX_TASK_NAME_LEN, "%s", pcTaskName);
 
     //buffer[bytesWritten++] = ',';
 
@@ -10,6 +10,8 @@
 #include <freertos/task.h>
 #include <fsfw/ipc/MessageQueueIF.h>
 
+#include "cpuStatsDefinitions.h"
+
 #include <vector>
 #include <array>
 
@@ -36,6 +38,13 @@ public:
     bool generateStatsCsv();
     bool generateStatsPrint();
 
+    /**
+     * Sample the task statistics into the CPU statistics housekeeping set of the
+     * core controller.
+     * @return false if the task is busy
+     */
+    bool generateStatsSample();
+
     /**
      * Called manually.
      * @return
@@ -44,11 +53,20 @@ public:
 
     uint16_t numberOfTasks = 0;
 private:
+    //! Time, info and header column of the statistics output
+    static constexpr size_t STATS_HEADER_SIZE = 160;
+    //! Formatted task values of one line, without the task name
+    static constexpr size_t DEBUG_STAT_SIZE = 64;
+    static constexpr size_t CSV_STAT_SIZE = configMAX_TASK_NAME_LEN + DEBUG_STAT_SIZE;
+    //! Longest statistics line including the line break
+    static constexpr size_t MAX_STAT_LINE_SIZE = CSV_STAT_SIZE + 2;
+
     uint8_t csvCounter = 0;
     enum class InternalState {
     	IDLE,
         GENERATING_STATS_CSV,
-        GENERATING_STATS_PRINT
+        GENERATING_STATS_PRINT,
+        GENERATING_STATS_SAMPLE
     };
     InternalState internalState;
     bool dataRead = false;
@@ -65,7 +83,19 @@ private:
 
     MessageQueueId_t queueId = MessageQueueIF::NO_QUEUE;
 
+    //! External handle of the set owned by the core controller
+    cpustats::CpuStatsSet cpuStatsSet;
+    uint32_t sampleCount = 0;
+    uint64_t lastSampleUptimeTicks = 0;
+    //! Run time counters of the previous sample for the delta encoding
+    uint8_t lastNumberOfSampledTasks = 0;
+    std::array<uint16_t, cpustats::MAX_NUMBER_OF_TASKS> lastTaskNumbers = {};
+    std::array<uint32_t, cpustats::MAX_NUMBER_OF_TASKS> lastRunTimeCounters = {};
+
     void performStatsGeneration(InternalState csvOrPrint);
+    void performStatsSample(size_t tasksRead);
+    uint32_t getRunTimeDelta(uint16_t taskNumber, uint32_t runTimeCounter) const;
+    void advanceStatsIdx(size_t& statsIdx, int written, size_t bufferSize) const;
     void writePaddedName(uint8_t* buffer,
             const char *pcTaskName);
     void writeDebugStatLine(const TaskStatus_t& task,
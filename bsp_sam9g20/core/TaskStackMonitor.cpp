@@ -0,0 +1,134 @@
+#include "TaskStackMonitor.h"
+#include "OBSWConfig.h"
+
+#include <fsfw/datapool/PoolReadGuard.h>
+#include <fsfw/osal/freertos/FreeRTOSTaskIF.h>
+#include <fsfw/osal/freertos/TaskManagement.h>
+#include <fsfw/serviceinterface/ServiceInterface.h>
+#include <fsfw/tasks/FixedTimeslotTaskIF.h>
+
+TaskStackMonitor::TaskStackMonitor(object_id_t objectId, object_id_t hkOwnerId):
+        TaskMonitor(objectId), hkOwnerId(hkOwnerId) {
+    setPeriodicOperation(stackmon::UPDATE_INTERVAL_SECONDS);
+}
+
+TaskStackMonitor::~TaskStackMonitor() {
+}
+
+ReturnValue_t TaskStackMonitor::initializeAfterTaskCreation() {
+    ReturnValue_t result = TaskMonitor::initializeAfterTaskCreation();
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        return result;
+    }
+    /* The pool entries of the housekeeping owner only exist after its initialization */
+    stackSet = new stackmon::StackSet(hkOwnerId);
+    monitoredTasks.reserve(stackmon::MAX_NUMBER_OF_TASKS);
+    performOperationOnEachPeriodicTask();
+    performOperationOnEachFixedTimeslotTask();
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t TaskStackMonitor::performOperation(uint8_t opCode) {
+    sampleNextTask();
+    return TaskMonitor::performOperation(opCode);
+}
+
+ReturnValue_t TaskStackMonitor::executeOneShotOperation() {
+    return updateHousekeeping();
+}
+
+ReturnValue_t TaskStackMonitor::executePeriodicOperation() {
+    return updateHousekeeping();
+}
+
+ReturnValue_t TaskStackMonitor::executeTimepointOperation(timeval timepoint) {
+    return updateHousekeeping();
+}
+
+void TaskStackMonitor::performOperationOnPeriodicTask(object_id_t objectId,
+        PeriodicTaskIF *periodicTask) {
+    FreeRTOSTaskIF* freeRTOSTask = dynamic_cast<FreeRTOSTaskIF*>(periodicTask);
+    if(freeRTOSTask == nullptr) {
+        return;
+    }
+    addTask(objectId, freeRTOSTask->getTaskHandle());
+}
+
+void TaskStackMonitor::performOperationOnFixedTimeslotTask(object_id_t objectId,
+        FixedTimeslotTaskIF *fixedTimeslotTask) {
+    FreeRTOSTaskIF* freeRTOSTask = dynamic_cast<FreeRTOSTaskIF*>(fixedTimeslotTask);
+    if(freeRTOSTask == nullptr) {
+        return;
+    }
+    addTask(objectId, freeRTOSTask->getTaskHandle());
+}
+
+void TaskStackMonitor::addTask(object_id_t objectId, TaskHandle_t handle) {
+    if(monitoredTasks.size() >= stackmon::MAX_NUMBER_OF_TASKS) {
+#if OBSW_VERBOSE_LEVEL >= 1
+        sif::printWarning("TaskStackMonitor::addTask: Task of object 0x%08lx can not be "
+                "monitored\n", static_cast<unsigned long>(objectId));
+#endif
+        return;
+    }
+    monitoredTasks.push_back({objectId, handle, 0xffffffff, StackLevel::NOMINAL});
+}
+
+void TaskStackMonitor::sampleNextTask() {
+    if(monitoredTasks.empty()) {
+        return;
+    }
+    if(nextTaskIdx >= monitoredTasks.size()) {
+        nextTaskIdx = 0;
+    }
+    MonitoredTask& task = monitoredTasks[nextTaskIdx++];
+    sampleCount++;
+    uint32_t remainingStack = TaskManagement::getTaskStackHighWatermark(task.handle);
+    if(remainingStack >= task.minRemainingStack) {
+        return;
+    }
+    task.minRemainingStack = remainingStack;
+
+    if(remainingStack < stackmon::CRITICAL_STACK_THRESHOLD and
+            task.reportedLevel != StackLevel::CRITICAL) {
+        task.reportedLevel = StackLevel::CRITICAL;
+        triggerEvent(stackmon::STACK_CRITICAL, task.objectId, remainingStack);
+    }
+    else if(remainingStack < stackmon::LOW_STACK_THRESHOLD and
+            task.reportedLevel == StackLevel::NOMINAL) {
+        task.reportedLevel = StackLevel::LOW;
+        triggerEvent(stackmon::STACK_LOW, task.objectId, remainingStack);
+    }
+    else {
+        return;
+    }
+#if OBSW_VERBOSE_LEVEL >= 1
+    sif::printWarning("TaskStackMonitor: Task %s has %lu bytes of stack left\n",
+            pcTaskGetName(task.handle), static_cast<unsigned long>(remainingStack));
+#endif
+}
+
+ReturnValue_t TaskStackMonitor::updateHousekeeping() {
+    if(stackSet == nullptr) {
+        return HasReturnvaluesIF::RETURN_OK;
+    }
+    PoolReadGuard readHelper(stackSet);
+    if(readHelper.getReadResult() != HasReturnvaluesIF::RETURN_OK) {
+        /* Errors are not passed on, they would stop the generic operation */
+        return HasReturnvaluesIF::RETURN_OK;
+    }
+    for(size_t idx = 0; idx < stackmon::MAX_NUMBER_OF_TASKS; idx++) {
+        if(idx < monitoredTasks.size()) {
+            stackSet->taskObjectIds[idx] = monitoredTasks[idx].objectId;
+            stackSet->minRemainingStacks[idx] = monitoredTasks[idx].minRemainingStack;
+        }
+        else {
+            stackSet->taskObjectIds[idx] = 0;
+            stackSet->minRemainingStacks[idx] = 0;
+        }
+    }
+    stackSet->sampleCount = sampleCount;
+    stackSet->numberOfTasks = monitoredTasks.size();
+    stackSet->setValidity(true, true);
+    return HasReturnvaluesIF::RETURN_OK;
+}
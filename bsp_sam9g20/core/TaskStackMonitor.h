@@ -0,0 +1,72 @@
+#ifndef SAM9G20_CORE_TASKSTACKMONITOR_H_
+#define SAM9G20_CORE_TASKSTACKMONITOR_H_
+
+#include "stackMonitorDefinitions.h"
+
+#include <mission/utility/TaskMonitor.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <vector>
+
+/**
+ * @brief   Keeps track of the lowest remaining stack of the tasks in the task monitor maps.
+ * @details
+ * Determining the stack high water mark requires scanning the unused part of the stack, so
+ * only one task is sampled per cycle of the monitor, in a round-robin fashion. The minimum
+ * remaining stack of all tasks is periodically written to the stack set of the housekeeping
+ * owner, which is the core controller. The STACK_LOW and STACK_CRITICAL events are triggered
+ * once per task when the remaining stack falls below the respective threshold.
+ *
+ * Replaces the FreeRTOSStackMonitor in misc/archive, which only printed the high water marks.
+ */
+class TaskStackMonitor: public TaskMonitor {
+public:
+    TaskStackMonitor(object_id_t objectId, object_id_t hkOwnerId);
+    virtual ~TaskStackMonitor();
+
+    ReturnValue_t performOperation(uint8_t opCode) override;
+
+    /** TaskMonitor overrides */
+    ReturnValue_t executeOneShotOperation() override;
+    ReturnValue_t executePeriodicOperation() override;
+    ReturnValue_t executeTimepointOperation(timeval timepoint) override;
+    void performOperationOnPeriodicTask(object_id_t objectId,
+            PeriodicTaskIF* periodicTask) override;
+    void performOperationOnFixedTimeslotTask(object_id_t objectId,
+            FixedTimeslotTaskIF* fixedTimeslotTask) override;
+
+protected:
+    ReturnValue_t initializeAfterTaskCreation() override;
+
+private:
+    enum class StackLevel: uint8_t {
+        NOMINAL,
+        LOW,
+        CRITICAL
+    };
+
+    struct MonitoredTask {
+        object_id_t objectId;
+        TaskHandle_t handle;
+        //! Remaining stack in bytes, 0xffffffff if not sampled yet
+        uint32_t minRemainingStack;
+        //! Level for which an event was already triggered
+        StackLevel reportedLevel;
+    };
+
+    object_id_t hkOwnerId;
+    stackmon::StackSet* stackSet = nullptr;
+
+    //! Filled once after task creation, so no reallocation takes place afterwards
+    std::vector<MonitoredTask> monitoredTasks;
+    size_t nextTaskIdx = 0;
+    uint32_t sampleCount = 0;
+
+    void addTask(object_id_t objectId, TaskHandle_t handle);
+    void sampleNextTask();
+    ReturnValue_t updateHousekeeping();
+};
+
+#endif /* SAM9G20_CORE_TASKSTACKMONITOR_H_ */
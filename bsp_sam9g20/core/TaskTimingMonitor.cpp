@@ -0,0 +1,188 @@
+#include "TaskTimingMonitor.h"
+#include "OBSWConfig.h"
+
+#include <FreeRTOSConfig.h>
+#include <freertos/FreeRTOS.h>
+
+#include <fsfw/datapool/PoolReadGuard.h>
+#include <fsfw/ipc/CommandMessage.h>
+#include <fsfw/ipc/QueueFactory.h>
+#include <fsfw/osal/freertos/FreeRTOSTaskIF.h>
+#include <fsfw/serialize/SerializeAdapter.h>
+#include <fsfw/serviceinterface/ServiceInterface.h>
+
+TaskTimingMonitor::TaskTimingMonitor(object_id_t objectId, object_id_t hkOwnerId):
+        TaskMonitor(objectId),
+        commandQueue(QueueFactory::instance()->createMessageQueue(MAX_MESSAGE_QUEUE_DEPTH)),
+        actionHelper(this, commandQueue), hkOwnerId(hkOwnerId) {
+    setPeriodicOperation(tasktiming::UPDATE_INTERVAL_SECONDS);
+}
+
+TaskTimingMonitor::~TaskTimingMonitor() {
+    QueueFactory::instance()->deleteMessageQueue(commandQueue);
+}
+
+ReturnValue_t TaskTimingMonitor::initialize() {
+    ReturnValue_t result = TaskMonitor::initialize();
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        return result;
+    }
+    return actionHelper.initialize(commandQueue);
+}
+
+ReturnValue_t TaskTimingMonitor::initializeAfterTaskCreation() {
+    ReturnValue_t result = TaskMonitor::initializeAfterTaskCreation();
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        return result;
+    }
+    /* The pool entries of the housekeeping owner only exist after its initialization */
+    taskTimingSet = new tasktiming::TaskTimingSet(hkOwnerId);
+    for(auto const& periodicTask: TaskMonitor::periodicTaskMap) {
+        registerPeriodicTask(periodicTask.first, periodicTask.second);
+    }
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t TaskTimingMonitor::performOperation(uint8_t opCode) {
+    CommandMessage message;
+    for(ReturnValue_t result = commandQueue->receiveMessage(&message);
+            result == HasReturnvaluesIF::RETURN_OK;
+            result = commandQueue->receiveMessage(&message)) {
+        result = actionHelper.handleActionMessage(&message);
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            message.setToUnknownCommand();
+            commandQueue->reply(&message);
+        }
+    }
+    return TaskMonitor::performOperation(opCode);
+}
+
+MessageQueueId_t TaskTimingMonitor::getCommandQueue() const {
+    return commandQueue->getId();
+}
+
+ReturnValue_t TaskTimingMonitor::executeAction(ActionId_t actionId,
+        MessageQueueId_t commandedBy, const uint8_t *data, size_t size) {
+    switch(actionId) {
+    case(RESET_TASK_TIMING): {
+        if(size == 0) {
+            task_timing_reset_all();
+            break;
+        }
+        object_id_t objectId = 0;
+        ReturnValue_t result = SerializeAdapter::deSerialize(&objectId, &data, &size,
+                SerializeIF::Endianness::BIG);
+        if(result != HasReturnvaluesIF::RETURN_OK or size != 0) {
+            return HasActionsIF::INVALID_PARAMETERS;
+        }
+        auto iter = timingIndexes.find(objectId);
+        if(iter == timingIndexes.end()) {
+            return HasActionsIF::INVALID_PARAMETERS;
+        }
+        task_timing_reset(iter->second);
+        break;
+    }
+    case(UPDATE_TASK_TIMING): {
+        performOneShotOperation = true;
+        break;
+    }
+    default: {
+        return HasActionsIF::INVALID_ACTION_ID;
+    }
+    }
+    actionHelper.finish(true, commandedBy, actionId, HasReturnvaluesIF::RETURN_OK);
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t TaskTimingMonitor::executeOneShotOperation() {
+    return updateHousekeeping();
+}
+
+ReturnValue_t TaskTimingMonitor::executePeriodicOperation() {
+    return updateHousekeeping();
+}
+
+ReturnValue_t TaskTimingMonitor::executeTimepointOperation(timeval timepoint) {
+    return updateHousekeeping();
+}
+
+void TaskTimingMonitor::performOperationOnPeriodicTask(object_id_t objectId,
+        PeriodicTaskIF *periodicTask) {
+    auto iter = timingIndexes.find(objectId);
+    if(iter == timingIndexes.end() or nextSetRow >= tasktiming::MAX_NUMBER_OF_TASKS) {
+        return;
+    }
+    TaskTimingStats stats;
+    if(task_timing_get_stats(iter->second, &stats) != 0) {
+        return;
+    }
+    uint8_t row = nextSetRow++;
+    taskTimingSet->taskObjectIds[row] = objectId;
+    taskTimingSet->cycleCounts[row] = stats.cycles;
+    if(stats.cycles == 0) {
+        taskTimingSet->minExecutionTimes[row] = 0;
+        taskTimingSet->meanExecutionTimes[row] = 0;
+    }
+    else {
+        taskTimingSet->minExecutionTimes[row] = stats.min_execution_time;
+        taskTimingSet->meanExecutionTimes[row] = stats.total_execution_time / stats.cycles;
+    }
+    taskTimingSet->maxExecutionTimes[row] = stats.max_execution_time;
+    for(uint8_t bucket = 0; bucket < tasktiming::NUMBER_OF_BUCKETS; bucket++) {
+        taskTimingSet->histograms[row * tasktiming::NUMBER_OF_BUCKETS + bucket] =
+                stats.histogram[bucket];
+    }
+    taskTimingSet->deadlineMisses[row] = stats.deadline_misses;
+    taskTimingSet->overruns[row] = stats.overruns;
+}
+
+void TaskTimingMonitor::performOperationOnFixedTimeslotTask(object_id_t objectId,
+        FixedTimeslotTaskIF *fixedTimeslotTask) {
+}
+
+void TaskTimingMonitor::registerPeriodicTask(object_id_t objectId,
+        PeriodicTaskIF *periodicTask) {
+    FreeRTOSTaskIF* freeRTOSTask = dynamic_cast<FreeRTOSTaskIF*>(periodicTask);
+    uint32_t periodMs = periodicTask->getPeriodMs();
+    int index = -1;
+    if(freeRTOSTask != nullptr) {
+        index = task_timing_register(freeRTOSTask->getTaskHandle(), pdMS_TO_TICKS(periodMs),
+                periodMs * (RUN_TIME_COUNTER_FREQUENCY_HZ / 1000));
+    }
+    if(index < 0) {
+#if OBSW_VERBOSE_LEVEL >= 1
+        sif::printWarning("TaskTimingMonitor::registerPeriodicTask: Task of object 0x%08lx "
+                "can not be monitored\n", static_cast<unsigned long>(objectId));
+#endif
+        return;
+    }
+    timingIndexes.emplace(objectId, static_cast<uint8_t>(index));
+}
+
+ReturnValue_t TaskTimingMonitor::updateHousekeeping() {
+    if(taskTimingSet == nullptr) {
+        return HasReturnvaluesIF::RETURN_OK;
+    }
+    PoolReadGuard readHelper(taskTimingSet);
+    if(readHelper.getReadResult() != HasReturnvaluesIF::RETURN_OK) {
+        /* Errors are not passed on, they would stop the generic operation */
+        return HasReturnvaluesIF::RETURN_OK;
+    }
+    nextSetRow = 0;
+    performOperationOnEachPeriodicTask();
+    taskTimingSet->numberOfTasks = nextSetRow;
+    for(uint8_t row = nextSetRow; row < tasktiming::MAX_NUMBER_OF_TASKS; row++) {
+        taskTimingSet->taskObjectIds[row] = 0;
+        taskTimingSet->cycleCounts[row] = 0;
+        taskTimingSet->minExecutionTimes[row] = 0;
+        taskTimingSet->meanExecutionTimes[row] = 0;
+        taskTimingSet->maxExecutionTimes[row] = 0;
+        for(uint8_t bucket = 0; bucket < tasktiming::NUMBER_OF_BUCKETS; bucket++) {
+            taskTimingSet->histograms[row * tasktiming::NUMBER_OF_BUCKETS + bucket] = 0;
+        }
+        taskTimingSet->deadlineMisses[row] = 0;
+        taskTimingSet->overruns[row] = 0;
+    }
+    taskTimingSet->setValidity(true, true);
+    return HasReturnvaluesIF::RETURN_OK;
+}
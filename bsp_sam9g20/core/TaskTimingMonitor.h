@@ -0,0 +1,76 @@
+#ifndef SAM9G20_CORE_TASKTIMINGMONITOR_H_
+#define SAM9G20_CORE_TASKTIMINGMONITOR_H_
+
+#include "taskTimingDefinitions.h"
+
+#include <mission/utility/TaskMonitor.h>
+
+#include <fsfw/action/ActionHelper.h>
+#include <fsfw/action/HasActionsIF.h>
+#include <fsfw/ipc/MessageQueueIF.h>
+
+#include <map>
+
+/**
+ * @brief   Records the execution time of every cycle of the periodic tasks inserted with
+ *          insertPeriodicTask.
+ * @details
+ * The cycles are measured by the traceTASK_DELAY_UNTIL hook of FreeRTOS, see taskTiming.h.
+ * The monitor periodically copies the minimum, mean and maximum execution time, the execution
+ * time histogram and the numbers of deadline misses and overruns of each task to the
+ * task timing set of the housekeeping owner, which is the core controller.
+ *
+ * Fixed timeslot tasks are not monitored because they delay once per slot instead of once
+ * per period.
+ */
+class TaskTimingMonitor: public TaskMonitor,
+        public HasActionsIF {
+public:
+    //! [EXPORT] : [COMMAND] Reset the statistics of all tasks or of the task registered with
+    //! the object ID given as optional 4 byte parameter
+    static constexpr ActionId_t RESET_TASK_TIMING = 0;
+    //! [EXPORT] : [COMMAND] Update the housekeeping set in the next cycle
+    static constexpr ActionId_t UPDATE_TASK_TIMING = 1;
+
+    TaskTimingMonitor(object_id_t objectId, object_id_t hkOwnerId);
+    virtual ~TaskTimingMonitor();
+
+    ReturnValue_t performOperation(uint8_t opCode) override;
+    ReturnValue_t initialize() override;
+
+    /** HasActionsIF overrides */
+    MessageQueueId_t getCommandQueue() const override;
+    ReturnValue_t executeAction(ActionId_t actionId, MessageQueueId_t commandedBy,
+            const uint8_t* data, size_t size) override;
+
+    /** TaskMonitor overrides */
+    ReturnValue_t executeOneShotOperation() override;
+    ReturnValue_t executePeriodicOperation() override;
+    ReturnValue_t executeTimepointOperation(timeval timepoint) override;
+    void performOperationOnPeriodicTask(object_id_t objectId,
+            PeriodicTaskIF* periodicTask) override;
+    void performOperationOnFixedTimeslotTask(object_id_t objectId,
+            FixedTimeslotTaskIF* fixedTimeslotTask) override;
+
+protected:
+    ReturnValue_t initializeAfterTaskCreation() override;
+
+private:
+    static constexpr uint8_t MAX_MESSAGE_QUEUE_DEPTH = 3;
+
+    MessageQueueIF* commandQueue = nullptr;
+    ActionHelper actionHelper;
+
+    object_id_t hkOwnerId;
+    tasktiming::TaskTimingSet* taskTimingSet = nullptr;
+
+    //! Maps the object ID of a task to its index in the task timing module
+    std::map<object_id_t, uint8_t> timingIndexes;
+    //! Next row of the housekeeping set vectors written while updating the set
+    uint8_t nextSetRow = 0;
+
+    void registerPeriodicTask(object_id_t objectId, PeriodicTaskIF* periodicTask);
+    ReturnValue_t updateHousekeeping();
+};
+
+#endif /* SAM9G20_CORE_TASKTIMINGMONITOR_H_ */
@@ -0,0 +1,168 @@
+#include "TraceBufferHandler.h"
+#include "OBSWConfig.h"
+
+#include <bsp_sam9g20/common/SDCardApi.h>
+#include <bsp_sam9g20/memory/HCCFileGuard.h>
+#include <bsp_sam9g20/memory/SDCardAccess.h>
+#include <traceBuffer.h>
+
+#include <fsfw/ipc/CommandMessage.h>
+#include <fsfw/ipc/QueueFactory.h>
+#include <fsfw/serviceinterface/ServiceInterface.h>
+
+#include <hcc/api_fat.h>
+
+TraceBufferHandler::TraceBufferHandler(object_id_t objectId): SystemObject(objectId),
+        commandQueue(QueueFactory::instance()->createMessageQueue(MAX_MESSAGE_QUEUE_DEPTH)),
+        actionHelper(this, commandQueue), memoryHelper(this, commandQueue) {
+}
+
+TraceBufferHandler::~TraceBufferHandler() {
+    QueueFactory::instance()->deleteMessageQueue(commandQueue);
+}
+
+ReturnValue_t TraceBufferHandler::initialize() {
+    ReturnValue_t result = SystemObject::initialize();
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        return result;
+    }
+    result = actionHelper.initialize(commandQueue);
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        return result;
+    }
+    result = memoryHelper.initialize(commandQueue);
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        return result;
+    }
+    /* Recording costs time in every traced section, so it is only started with START_TRACE */
+    trace_buffer_enable(false, recordTaskSwitches);
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t TraceBufferHandler::performOperation(uint8_t opCode) {
+    CommandMessage message;
+    for(ReturnValue_t result = commandQueue->receiveMessage(&message);
+            result == HasReturnvaluesIF::RETURN_OK;
+            result = commandQueue->receiveMessage(&message)) {
+        result = actionHelper.handleActionMessage(&message);
+        if(result == HasReturnvaluesIF::RETURN_OK) {
+            continue;
+        }
+        result = memoryHelper.handleMemoryCommand(&message);
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            message.setToUnknownCommand();
+            commandQueue->reply(&message);
+        }
+    }
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+MessageQueueId_t TraceBufferHandler::getCommandQueue() const {
+    return commandQueue->getId();
+}
+
+ReturnValue_t TraceBufferHandler::executeAction(ActionId_t actionId,
+        MessageQueueId_t commandedBy, const uint8_t *data, size_t size) {
+    switch(actionId) {
+    case(START_TRACE): {
+        if(size > 1) {
+            return HasActionsIF::INVALID_PARAMETERS;
+        }
+        recordTaskSwitches = size == 1 and data[0] != 0;
+        trace_buffer_enable(true, recordTaskSwitches);
+        break;
+    }
+    case(STOP_TRACE): {
+        trace_buffer_enable(false, recordTaskSwitches);
+        break;
+    }
+    case(CLEAR_TRACE): {
+        trace_buffer_clear();
+        break;
+    }
+    case(WRITE_TRACE_FILE): {
+        ReturnValue_t result = writeTraceFile();
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
+        }
+        break;
+    }
+    default: {
+        return HasActionsIF::INVALID_ACTION_ID;
+    }
+    }
+    actionHelper.finish(true, commandedBy, actionId, HasReturnvaluesIF::RETURN_OK);
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t TraceBufferHandler::handleMemoryLoad(uint32_t address, const uint8_t *data,
+        uint32_t size, uint8_t **dataPointer) {
+    /* The trace buffer is read-only for the ground */
+    return HasReturnvaluesIF::RETURN_FAILED;
+}
+
+ReturnValue_t TraceBufferHandler::handleMemoryDump(uint32_t address, uint32_t size,
+        uint8_t **dataPointer, uint8_t *dumpTarget) {
+    if(address >= sizeof(TraceBufferImage)) {
+        return HasMemoryIF::INVALID_ADDRESS;
+    }
+    if(size > sizeof(TraceBufferImage) - address) {
+        return HasMemoryIF::INVALID_SIZE;
+    }
+    /* The memory helper copies the data to the IPC store after this call, so the records
+    could still change while being copied. Recording has to be stopped with STOP_TRACE first */
+    if(trace_buffer_is_enabled()) {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    const TraceBufferImage* image = trace_buffer_get_image();
+    *dataPointer = const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>(image)) + address;
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t TraceBufferHandler::setAddress(uint32_t *startAddress) {
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t TraceBufferHandler::writeTraceFile() {
+    SDCardAccess sdCardAccess;
+    ReturnValue_t result = sdCardAccess.getAccessResult();
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        return result;
+    }
+
+    int retval = change_directory(config::TRACE_REPOSITORY, true);
+    if(retval != F_NO_ERROR) {
+        /* The repository is created on the first write */
+        retval = create_directory(nullptr, config::TRACE_REPOSITORY);
+        if(retval == F_NO_ERROR) {
+            retval = change_directory(config::TRACE_REPOSITORY, true);
+        }
+    }
+    if(retval != F_NO_ERROR) {
+#if OBSW_VERBOSE_LEVEL >= 1
+        sif::printWarning("TraceBufferHandler::writeTraceFile: Could not change to "
+                "repository %s, error code %d\n", config::TRACE_REPOSITORY, retval);
+#endif
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+
+    F_FILE* traceFile = f_open(config::TRACE_FILE_NAME, "w");
+    if(traceFile == nullptr) {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    HCCFileGuard fileGuard(&traceFile);
+
+    bool enabled = trace_buffer_is_enabled();
+    trace_buffer_enable(false, recordTaskSwitches);
+    const TraceBufferImage* image = trace_buffer_get_image();
+    long bytesWritten = f_write(image, 1, sizeof(TraceBufferImage), traceFile);
+    trace_buffer_enable(enabled, recordTaskSwitches);
+    if(bytesWritten != static_cast<long>(sizeof(TraceBufferImage))) {
+#if OBSW_VERBOSE_LEVEL >= 1
+        sif::printWarning("TraceBufferHandler::writeTraceFile: Writing %s failed, error "
+                "code %d\n", config::TRACE_FILE_NAME, f_getlasterror());
+#endif
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    return HasReturnvaluesIF::RETURN_OK;
+}
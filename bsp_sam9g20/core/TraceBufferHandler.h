@@ -0,0 +1,69 @@
+#ifndef SAM9G20_CORE_TRACEBUFFERHANDLER_H_
+#define SAM9G20_CORE_TRACEBUFFERHANDLER_H_
+
+#include <fsfw/action/ActionHelper.h>
+#include <fsfw/action/HasActionsIF.h>
+#include <fsfw/ipc/MessageQueueIF.h>
+#include <fsfw/memory/AcceptsMemoryMessagesIF.h>
+#include <fsfw/memory/MemoryHelper.h>
+#include <fsfw/objectmanager/SystemObject.h>
+#include <fsfw/tasks/ExecutableObjectIF.h>
+
+/**
+ * @brief   Makes the trace buffer of the board available on ground.
+ * @details
+ * The trace buffer image, consisting of a header, the task name table and the record ring
+ * (see traceBuffer.h), can be dumped with Service 6 using this object as memory ID. The address
+ * is the offset inside the image. Alternatively, the image can be written to the SD card as a
+ * file. Dumps are refused while recording so the image is consistent.
+ * misc/trace_to_chrome.py converts the image to the Chrome trace format.
+ *
+ * Recording is disabled after initialization and has to be started with START_TRACE.
+ */
+class TraceBufferHandler: public SystemObject,
+        public ExecutableObjectIF,
+        public HasActionsIF,
+        public AcceptsMemoryMessagesIF {
+public:
+    //! [EXPORT] : [COMMAND] Start recording. The task switches are recorded as well if the
+    //! optional 1 byte parameter is not 0
+    static constexpr ActionId_t START_TRACE = 0;
+    //! [EXPORT] : [COMMAND] Stop recording
+    static constexpr ActionId_t STOP_TRACE = 1;
+    //! [EXPORT] : [COMMAND] Discard all records
+    static constexpr ActionId_t CLEAR_TRACE = 2;
+    //! [EXPORT] : [COMMAND] Write the trace buffer image to the SD card. Recording is paused
+    //! while writing
+    static constexpr ActionId_t WRITE_TRACE_FILE = 3;
+
+    TraceBufferHandler(object_id_t objectId);
+    virtual ~TraceBufferHandler();
+
+    ReturnValue_t performOperation(uint8_t opCode) override;
+    ReturnValue_t initialize() override;
+
+    /** HasActionsIF and AcceptsMemoryMessagesIF overrides */
+    MessageQueueId_t getCommandQueue() const override;
+    ReturnValue_t executeAction(ActionId_t actionId, MessageQueueId_t commandedBy,
+            const uint8_t* data, size_t size) override;
+
+    /** HasMemoryIF overrides */
+    ReturnValue_t handleMemoryLoad(uint32_t address, const uint8_t* data, uint32_t size,
+            uint8_t** dataPointer) override;
+    ReturnValue_t handleMemoryDump(uint32_t address, uint32_t size, uint8_t** dataPointer,
+            uint8_t* dumpTarget) override;
+    ReturnValue_t setAddress(uint32_t* startAddress) override;
+
+private:
+    static constexpr uint8_t MAX_MESSAGE_QUEUE_DEPTH = 3;
+
+    MessageQueueIF* commandQueue = nullptr;
+    ActionHelper actionHelper;
+    MemoryHelper memoryHelper;
+
+    bool recordTaskSwitches = false;
+
+    ReturnValue_t writeTraceFile();
+};
+
+#endif /* SAM9G20_CORE_TRACEBUFFERHANDLER_H_ */
@@ -12,6 +12,7 @@ extern "C" {
 }
 
 #include <bsp_sam9g20/memory/SDCardAccess.h>
+#include <bsp_sam9g20/memory/HCCFileGuard.h>
 
 #include <cinttypes>
 #include <cmath>
@@ -35,6 +36,9 @@ ReturnValue_t ImageCopyingEngine::continueCurrentOperation() {
     case(ImageHandlerStates::COPY_IMG_SDC_TO_SDC): {
         return copySdcImgToSdc();
     }
+    case(ImageHandlerStates::APPLY_PATCH_SDC_TO_SDC): {
+        return applyPatch();
+    }
     case(ImageHandlerStates::COPY_IMG_FLASH_TO_SDC): {
         break;
     }
@@ -61,6 +65,9 @@ ReturnValue_t ImageCopyingEngine::continueCurrentOperation() {
     case(ImageHandlerStates::COPY_IMG_HAMMING_SDC_TO_FRAM): {
         return HasReturnvaluesIF::RETURN_FAILED;
     }
+    case(ImageHandlerStates::GENERATE_IMG_HAMMING_TO_FRAM): {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
     }
     return HasReturnvaluesIF::RETURN_OK;
 }
@@ -106,6 +113,12 @@ ReturnValue_t ImageCopyingEngine::startHammingCodeToFramOperation(image::ImageSl
     return HasReturnvaluesIF::RETURN_OK;
 }
 
+ReturnValue_t ImageCopyingEngine::startHammingCodeGenerationOperation(
+        image::ImageSlot respectiveSlot) {
+    /* The hamming codes are only stored in the FRAM of the iOBC */
+    return HasReturnvaluesIF::RETURN_FAILED;
+}
+
 /// Nandflash memory size.
 static unsigned int memSize;
 /// Size of one block in the nandflash, in bytes.
@@ -139,6 +152,25 @@ ReturnValue_t ImageCopyingEngine::copySdCardImageToNandFlash() {
     ReturnValue_t result = HasReturnvaluesIF::RETURN_OK;
 
     if(internalState == GenericInternalState::IDLE) {
+        if(sourceSlot != image::ImageSlot::BOOTLOADER_0 and
+                sourceSlot != image::ImageSlot::BOOTLOADER_1) {
+            /* The first stage bootloader copies the NAND-Flash image to the SDRAM as it is,
+            so compressed images are rejected before anything is erased */
+            SDCardAccess sdCardAccess;
+            F_FILE* binaryFile = nullptr;
+            result = prepareGenericFileInformation(sdCardAccess.getActiveVolume(), &binaryFile);
+            if(result != HasReturnvaluesIF::RETURN_OK) {
+                return result;
+            }
+            HCCFileGuard fileGuard(&binaryFile);
+            result = readCompressionHeader(binaryFile);
+            if(result != HasReturnvaluesIF::RETURN_OK) {
+                return result;
+            }
+            if(compressedImage) {
+                return image::COMPRESSED_IMAGE_UNSUPPORTED;
+            }
+        }
         internalState = GenericInternalState::STEP_1;
     }
 
@@ -0,0 +1,72 @@
+#ifndef SAM9G20_CORE_CPUSTATSDEFINITIONS_H_
+#define SAM9G20_CORE_CPUSTATSDEFINITIONS_H_
+
+#include <fsfw/datapoollocal/StaticLocalDataSet.h>
+#include <fsfw/datapoollocal/LocalPoolVariable.h>
+#include <fsfw/datapoollocal/LocalPoolVector.h>
+#include <cstdint>
+
+namespace cpustats {
+
+//! Tasks exceeding this number are not contained in the housekeeping set
+static constexpr uint8_t MAX_NUMBER_OF_TASKS = 32;
+
+//! Interval in which the core controller requests a new sample
+static constexpr uint32_t SAMPLE_INTERVAL_SECONDS = 10;
+
+static constexpr uint32_t CPU_STATS_SET_ID = 0;
+
+enum PoolIds: lp_id_t {
+    SAMPLE_COUNT,
+    TOTAL_RUN_TIME_DELTA,
+    NUMBER_OF_TASKS,
+    TASK_NUMBERS,
+    TASK_STATES,
+    STACK_HIGH_WATER_MARKS,
+    RUN_TIME_DELTAS
+};
+
+/**
+ * @brief   CPU statistics housekeeping set of the core controller, filled by the
+ *          system state task.
+ * @details
+ * Contains one entry per task in each of the task vectors, the remaining entries are zero.
+ * The run times of the tasks in ticks of the 10 kHz counter are delta-encoded against the
+ * previous sample, so the CPU load of a task is its run time delta divided by the total run
+ * time delta. A task appearing for the first time reports its whole run time counter.
+ * The task names belonging to the FreeRTOS task numbers are contained in the CSV file
+ * generated on request.
+ */
+class CpuStatsSet: public StaticLocalDataSet<7> {
+public:
+    CpuStatsSet(HasLocalDataPoolIF* owner):
+        StaticLocalDataSet(owner, CPU_STATS_SET_ID) {
+    }
+
+    CpuStatsSet(object_id_t objectId):
+        StaticLocalDataSet(sid_t(objectId, CPU_STATS_SET_ID)) {
+    }
+
+    lp_var_t<uint32_t> sampleCount = lp_var_t<uint32_t>(sid.objectId,
+            PoolIds::SAMPLE_COUNT, this);
+    lp_var_t<uint32_t> totalRunTimeDelta = lp_var_t<uint32_t>(sid.objectId,
+            PoolIds::TOTAL_RUN_TIME_DELTA, this);
+    lp_var_t<uint8_t> numberOfTasks = lp_var_t<uint8_t>(sid.objectId,
+            PoolIds::NUMBER_OF_TASKS, this);
+    lp_vec_t<uint16_t, MAX_NUMBER_OF_TASKS> taskNumbers =
+            lp_vec_t<uint16_t, MAX_NUMBER_OF_TASKS>(sid.objectId, PoolIds::TASK_NUMBERS, this);
+    //! eTaskState values
+    lp_vec_t<uint8_t, MAX_NUMBER_OF_TASKS> taskStates =
+            lp_vec_t<uint8_t, MAX_NUMBER_OF_TASKS>(sid.objectId, PoolIds::TASK_STATES, this);
+    //! Minimum remaining stack in words
+    lp_vec_t<uint16_t, MAX_NUMBER_OF_TASKS> stackHighWaterMarks =
+            lp_vec_t<uint16_t, MAX_NUMBER_OF_TASKS>(sid.objectId,
+            PoolIds::STACK_HIGH_WATER_MARKS, this);
+    lp_vec_t<uint32_t, MAX_NUMBER_OF_TASKS> runTimeDeltas =
+            lp_vec_t<uint32_t, MAX_NUMBER_OF_TASKS>(sid.objectId, PoolIds::RUN_TIME_DELTAS,
+            this);
+};
+
+}
+
+#endif /* SAM9G20_CORE_CPUSTATSDEFINITIONS_H_ */
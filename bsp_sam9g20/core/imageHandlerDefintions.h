@@ -22,10 +22,42 @@ static constexpr ReturnValue_t OPERATION_FINISHED = MAKE_RETURN_CODE(0);
 static constexpr ReturnValue_t TASK_PERIOD_OVER_SOON = MAKE_RETURN_CODE(1);
 static constexpr ReturnValue_t BUSY = MAKE_RETURN_CODE(2);
 static constexpr ReturnValue_t FRAM_ISSUE = MAKE_RETURN_CODE(3);
+//! No valid hamming code is available for the image which should be scrubbed
+static constexpr ReturnValue_t HAMMING_CODE_UNAVAILABLE = MAKE_RETURN_CODE(4);
+//! The delta patch is malformed or does not fit the image sizes in its header
+static constexpr ReturnValue_t PATCH_INVALID = MAKE_RETURN_CODE(5);
+//! The source image does not match the image the delta patch was created for
+static constexpr ReturnValue_t PATCH_SOURCE_MISMATCH = MAKE_RETURN_CODE(6);
+//! The CRC of the rebuilt image does not match the CRC in the delta patch
+static constexpr ReturnValue_t PATCH_TARGET_CRC_MISMATCH = MAKE_RETURN_CODE(7);
+//! The compressed image is corrupted or its CRC does not match the header
+static constexpr ReturnValue_t COMPRESSED_IMAGE_INVALID = MAKE_RETURN_CODE(8);
+//! Compressed images can not be copied to this target
+static constexpr ReturnValue_t COMPRESSED_IMAGE_UNSUPPORTED = MAKE_RETURN_CODE(9);
+//! The active SD card changed during an operation spanning multiple cycles
+static constexpr ReturnValue_t SD_CARD_CHANGED = MAKE_RETURN_CODE(10);
 
 static constexpr uint8_t subsystemId = SUBSYSTEM_ID::IMAGE_HANDLER;
 
 static constexpr Event FRAM_ISSUE_EVENT = event::makeEvent(subsystemId, 0, severity::MEDIUM);
+//! Single bit error found and corrected by the scrubbing engine. P1: Image slot, P2: Image offset
+static constexpr Event SCRUB_SINGLE_BIT_ERROR_CORRECTED = event::makeEvent(subsystemId, 1,
+        severity::INFO);
+//! Uncorrectable multi bit error found by the scrubbing engine. P1: Image slot, P2: Image offset
+static constexpr Event SCRUB_MULTI_BIT_ERROR = event::makeEvent(subsystemId, 2, severity::HIGH);
+//! The hamming code itself is corrupted. P1: Image slot, P2: Image offset
+static constexpr Event SCRUB_HAMMING_CODE_ERROR = event::makeEvent(subsystemId, 3,
+        severity::LOW);
+//! Single bit error could not be corrected in place. P1: Image slot, P2: Image offset
+static constexpr Event SCRUB_CORRECTION_FAILED = event::makeEvent(subsystemId, 4,
+        severity::MEDIUM);
+//! Scrubbing operation finished. P1: Image slot, P2: Corrected errors (upper 16 bits) and
+//! uncorrectable errors (lower 16 bits)
+static constexpr Event SCRUBBING_FINISHED = event::makeEvent(subsystemId, 5, severity::INFO);
+//! Hamming code generated on board and written to FRAM. P1: Image slot, P2: Hamming code size
+static constexpr Event HAMMING_CODE_GENERATED = event::makeEvent(subsystemId, 6, severity::INFO);
+//! Image rebuilt from a delta patch and verified. P1: Target image slot, P2: Image size
+static constexpr Event PATCH_APPLIED = event::makeEvent(subsystemId, 7, severity::INFO);
 
 #ifdef AT91SAM9G20_EK
 using ImageBuffer = std::array<uint8_t, NandCommon_MAXPAGEDATASIZE>;
@@ -33,6 +65,34 @@ using ImageBuffer = std::array<uint8_t, NandCommon_MAXPAGEDATASIZE>;
 using ImageBuffer = std::array<uint8_t, NORFLASH_SMALL_SECTOR_SIZE>;
 #endif
 
+/**
+ * Delta patches are used to rebuild a new image from an image on the SD card, so only the
+ * differences have to be uploaded. A patch consists of a header followed by a sequence of
+ * operations. All fields are big endian.
+ *
+ * Header: Magic (4 bytes), source size (4), source CRC16 (2), target size (4), target CRC16 (2)
+ * Operation: Opcode (1), length (4), followed by the source offset (4) for COPY or by
+ * the literal bytes for INSERT.
+ *
+ * The CRC16 is the CCITT CRC used for the bootloader as well. Patches can be created with
+ * misc/create_image_patch.py.
+ */
+namespace patch {
+
+static constexpr uint32_t MAGIC = 0x44504154;
+static constexpr size_t HEADER_SIZE = 16;
+static constexpr size_t INSERT_HEADER_SIZE = 5;
+static constexpr size_t COPY_HEADER_SIZE = 9;
+
+enum Opcode: uint8_t {
+    //! Copy bytes from the source image
+    COPY = 0,
+    //! Insert the bytes following the operation
+    INSERT = 1
+};
+
+}
+
 /* Image slots available */
 enum ImageSlot: uint8_t {
     NONE,
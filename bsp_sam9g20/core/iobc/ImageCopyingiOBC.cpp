@@ -1,6 +1,7 @@
 #include "../ImageCopyingEngine.h"
 
 #include <fsfw/timemanager/Countdown.h>
+#include <fsfw/timemanager/Clock.h>
 #include <fsfw/serviceinterface/ServiceInterface.h>
 #include <fsfw/globalfunctions/CRC.h>
 #include <fsfw/events/EventManagerIF.h>
@@ -9,9 +10,15 @@
 #include <bsp_sam9g20/memory/HCCFileGuard.h>
 #include <bsp_sam9g20/common/fram/CommonFRAM.h>
 #include <bsp_sam9g20/common/fram/FRAMApi.h>
+#include <bsp_sam9g20/common/norflashHook.h>
 #include <hal/Storage/NORflash.h>
 
+extern "C" {
+#include <at91/utility/hamming.h>
+}
+
 #include <array>
+#include <cstring>
 
 ReturnValue_t ImageCopyingEngine::continueCurrentOperation() {
     switch(imageHandlerState) {
@@ -24,9 +31,15 @@ ReturnValue_t ImageCopyingEngine::continueCurrentOperation() {
     case(ImageHandlerStates::COPY_IMG_SDC_TO_SDC): {
         return copySdcImgToSdc();
     }
+    case(ImageHandlerStates::APPLY_PATCH_SDC_TO_SDC): {
+        return applyPatch();
+    }
     case(ImageHandlerStates::COPY_IMG_HAMMING_SDC_TO_FRAM): {
         return copyImgHammingSdcToFram();
     }
+    case(ImageHandlerStates::GENERATE_IMG_HAMMING_TO_FRAM): {
+        return generateImgHammingToFram();
+    }
     case(ImageHandlerStates::COPY_IMG_FLASH_TO_SDC): {
         return HasReturnvaluesIF::RETURN_FAILED;
     }
@@ -78,39 +91,75 @@ ReturnValue_t ImageCopyingEngine::startHammingCodeToFramOperation(image::ImageSl
     return HasReturnvaluesIF::RETURN_OK;
 }
 
+ReturnValue_t ImageCopyingEngine::startHammingCodeGenerationOperation(
+        image::ImageSlot respectiveSlot) {
+    if(respectiveSlot != image::ImageSlot::FLASH and
+            respectiveSlot != image::ImageSlot::SDC_SLOT_0 and
+            respectiveSlot != image::ImageSlot::SDC_SLOT_1) {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    sourceSlot = respectiveSlot;
+    imageHandlerState = ImageHandlerStates::GENERATE_IMG_HAMMING_TO_FRAM;
+    return HasReturnvaluesIF::RETURN_OK;
+}
 
 ReturnValue_t ImageCopyingEngine::copySdCardImageToNorFlash() {
     ReturnValue_t result = HasReturnvaluesIF::RETURN_OK;
     if(internalState == GenericInternalState::IDLE) {
+        resetNorCopyPipeline();
         internalState = GenericInternalState::STEP_1;
     }
+    norCopyTimings.cycles++;
 
     if(internalState == GenericInternalState::STEP_1) {
-        result = handleNorflashErasure();
-        if(result == image::TASK_PERIOD_OVER_SOON) {
+        /* Sectors are erased just ahead of the buckets which are programmed to them and the
+        next buckets are read from the SD card while a sector is being erased */
+        result = handleSdToNorCopyOperation();
+        if(result != image::OPERATION_FINISHED) {
             return result;
         }
-        else if(result != HasReturnvaluesIF::RETURN_OK) {
-            return result;
+        /* The new image is complete, so the critical window is over. */
+        uint32_t currentMs = 0;
+        Clock::getUptime(&currentMs);
+        norCopyTimings.criticalWindowMs = currentMs - criticalWindowStartMs;
+        internalState = GenericInternalState::STEP_2;
+        if(countdown->hasTimedOut()) {
+            return image::TASK_PERIOD_OVER_SOON;
         }
     }
 
-    internalState = GenericInternalState::STEP_2;
-    if(countdown->hasTimedOut()) {
-        return image::TASK_PERIOD_OVER_SOON;
-    }
-
     if(internalState == GenericInternalState::STEP_2) {
-        result = handleSdToNorCopyOperation();
-        if(result == image::TASK_PERIOD_OVER_SOON) {
-            return result;
-        }
-        else if(result != HasReturnvaluesIF::RETURN_OK) {
+        /* Erase the remaining sectors of the reserved area after the image was written */
+        result = handleRemainingErasure();
+        if(result != HasReturnvaluesIF::RETURN_OK) {
             return result;
         }
     }
 
-    return HasReturnvaluesIF::RETURN_OK;
+    if(sourceSlot == image::ImageSlot::BOOTLOADER_0) {
+        /* The size and the CRC are written to the end of the reserved area, which might only
+        have been erased in the previous step */
+        writeBootloaderSizeAndCrc();
+    }
+
+    uint32_t currentMs = 0;
+    Clock::getUptime(&currentMs);
+    norCopyTimings.totalDurationMs = currentMs - norCopyStartMs;
+    handleFinishPrintout();
+#if OBSW_VERBOSE_LEVEL >= 1
+    sif::printInfo("NOR-Flash copy timings: Critical window %lu ms, total %lu ms, erase %lu ms, "
+            "program %lu ms, SD read %lu ms, SD read during erase %lu ms\n",
+            static_cast<unsigned long>(norCopyTimings.criticalWindowMs),
+            static_cast<unsigned long>(norCopyTimings.totalDurationMs),
+            static_cast<unsigned long>(norCopyTimings.eraseMs),
+            static_cast<unsigned long>(norCopyTimings.programMs),
+            static_cast<unsigned long>(norCopyTimings.sdReadMs),
+            static_cast<unsigned long>(norCopyTimings.overlappedSdReadMs));
+#endif
+    /* Cache last finished state. */
+    lastFinishedState = imageHandlerState;
+    reset();
+    return image::OPERATION_FINISHED;
 }
 
 ReturnValue_t ImageCopyingEngine::copyImgHammingSdcToFram() {
@@ -127,28 +176,7 @@ ReturnValue_t ImageCopyingEngine::copyImgHammingSdcToFram() {
             return HasReturnvaluesIF::RETURN_FAILED;
         }
         F_FILE* file = nullptr;
-        SlotType framSlot = SDC_0_SL_0;
-        if(sourceSlot == image::ImageSlot::FLASH) {
-            framSlot = FLASH_SLOT;
-        }
-        else {
-            if(access.getActiveVolume() == SD_CARD_0) {
-                if(sourceSlot == image::ImageSlot::SDC_SLOT_0) {
-                    framSlot = SDC_0_SL_0;
-                }
-                else if(sourceSlot == image::ImageSlot::SDC_SLOT_1) {
-                    framSlot = SDC_0_SL_1;
-                }
-            }
-            else if(access.getActiveVolume() == SD_CARD_1) {
-                if(sourceSlot == image::ImageSlot::SDC_SLOT_0) {
-                    framSlot = SDC_1_SL_0;
-                }
-                else if(sourceSlot == image::ImageSlot::SDC_SLOT_1) {
-                    framSlot = SDC_1_SL_1;
-                }
-            }
-        }
+        SlotType framSlot = getFramSlot(access.getActiveVolume());
 
         ReturnValue_t result = prepareGenericFileInformation(access.getActiveVolume(), &file);
         if(result != HasReturnvaluesIF::RETURN_OK) {
@@ -245,102 +273,185 @@ ReturnValue_t ImageCopyingEngine::copyImgHammingSdcToFram() {
 
 }
 
-ReturnValue_t ImageCopyingEngine::handleNorflashErasure() {
+ReturnValue_t ImageCopyingEngine::generateImgHammingToFram() {
+    if(internalState == GenericInternalState::IDLE) {
+        internalState = GenericInternalState::STEP_1;
+    }
     ReturnValue_t result = HasReturnvaluesIF::RETURN_OK;
-    if(sourceSlot == image::ImageSlot::BOOTLOADER_0) {
-        /* We only want to print this once. */
-        if(not helperFlag1) {
-#if FSFW_CPP_OSTREAM_ENABLED == 1
-            sif::info << "ImageCopyingEngine::handleNorflashErasure: Deleting old "
-                    "bootloader!" << std::endl;
-#else
-            sif::printInfo("ImageCopyingEngine::handleNorflashErasure: Deleting old"
-                    " bootloader!\n");
+    if(sourceSlot == image::ImageSlot::FLASH) {
+        if(stepCounter == 0) {
+            hammingFramSlot = FLASH_SLOT;
+            int retval = fram_read_binary_size(FLASH_SLOT, &currentFileSize);
+            if(retval != 0) {
+                return image::FRAM_ISSUE;
+            }
+            if(currentFileSize == 0 or currentFileSize > PRIMARY_IMAGE_RESERVED_SIZE) {
+#if OBSW_VERBOSE_LEVEL >= 1
+                sif::printWarning("ImageCopyingEngine::generateImgHammingToFram: Invalid "
+                        "NOR-Flash image size %lu\n", static_cast<unsigned long>(currentFileSize));
 #endif
-            helperFlag1 = true;
-        }
-
-        while(stepCounter < RESERVED_BL_SECTORS) {
-            result = NORFLASH_EraseSector(&NORFlash,
-                    getBaseAddress(stepCounter, nullptr));
-            if(result != 0) {
                 return HasReturnvaluesIF::RETURN_FAILED;
             }
-            stepCounter++;
-            if(countdown->hasTimedOut()) {
+        }
+        while(currentByteIdx < currentFileSize) {
+            size_t chunkSize = currentFileSize - currentByteIdx;
+            if(chunkSize > imgBuffer->size()) {
+                chunkSize = imgBuffer->size();
+            }
+            std::memcpy(imgBuffer->data(), reinterpret_cast<const uint8_t*>(
+                    BINARY_BASE_ADDRESS_READ + currentByteIdx), chunkSize);
+            result = generateHammingCodeChunk(chunkSize);
+            if(result != HasReturnvaluesIF::RETURN_OK) {
+                return result;
+            }
+            if(currentByteIdx < currentFileSize and countdown->hasTimedOut()) {
                 return image::TASK_PERIOD_OVER_SOON;
             }
         }
-        if(stepCounter == RESERVED_BL_SECTORS) {
-            stepCounter = 0;
-            helperFlag1 = false;
-        }
     }
     else {
-        result = handleObswErasure();
-    }
-
-    return result;
-}
-
-ReturnValue_t ImageCopyingEngine::handleObswErasure() {
-    if(not helperFlag1) {
-#if FSFW_CPP_OSTREAM_ENABLED == 1
-        sif::info << "ImageCopyingEngine::handleNorflashErasure: Deleting old binary!" << std::endl;
-#else
-        sif::printInfo("ImageCopyingEngine::handleNorflashErasure: Deleting old binary!\n");
-#endif
-        SDCardAccess sdCardAccess;
-        int result = change_directory(config::SW_REPOSITORY, true);
-        if(result != F_NO_ERROR) {
-            /* The hardcoded repository does not exist. Exit */
-#if FSFW_CPP_OSTREAM_ENABLED == 1
-            sif::error << "ImageCopyingHelper::handleErasingForObsw: Software repository does "
-                    "not exist. Cancelling erase operation!" << std::endl;
-#else
-            sif::printError("ImageCopyingHelper::handleErasingForObsw: Software repository does "
-                    "not exist. Cancelling erase operation!\n");
+        SDCardAccess access;
+        if(access.getAccessResult() == SDCardAccess::SD_CARD_CHANGE_ONGOING) {
+#if OBSW_VERBOSE_LEVEL >= 1
+            sif::printWarning("ImageCopyingEngine::generateImgHammingToFram: "
+                    "SDC change ongoing!\n");
 #endif
             return HasReturnvaluesIF::RETURN_FAILED;
         }
-        if(sourceSlot == image::ImageSlot::SDC_SLOT_0) {
-            currentFileSize = f_filelength(config::SW_SLOT_0_NAME);
+        /* The SD card is accessed anew in each cycle, so the active SD card might have
+        changed in the meantime. The code written so far belongs to the previous card. */
+        SlotType framSlot = getFramSlot(access.getActiveVolume());
+        if(stepCounter == 0) {
+            hammingFramSlot = framSlot;
         }
-        else if(sourceSlot == image::ImageSlot::SDC_SLOT_1) {
-            currentFileSize = f_filelength(config::SW_SLOT_1_NAME);
+        else if(framSlot != hammingFramSlot) {
+#if OBSW_VERBOSE_LEVEL >= 1
+            sif::printWarning("ImageCopyingEngine::generateImgHammingToFram: Active SD card "
+                    "changed during the generation\n");
+#endif
+            return image::SD_CARD_CHANGED;
         }
+        F_FILE* file = nullptr;
+        result = prepareGenericFileInformation(access.getActiveVolume(), &file);
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
+        }
+        HCCFileGuard fileGuard(&file);
+        if(currentFileSize == 0) {
+            return HasReturnvaluesIF::RETURN_FAILED;
+        }
+        while(currentByteIdx < currentFileSize) {
+            size_t chunkSize = currentFileSize - currentByteIdx;
+            if(chunkSize > imgBuffer->size()) {
+                chunkSize = imgBuffer->size();
+            }
+            size_t sizeRead = 0;
+            result = readFile(imgBuffer->data(), chunkSize, &sizeRead, &file);
+            if(result != HasReturnvaluesIF::RETURN_OK) {
+                return result;
+            }
+            if(sizeRead != chunkSize) {
+                return HasReturnvaluesIF::RETURN_FAILED;
+            }
+            result = generateHammingCodeChunk(chunkSize);
+            if(result != HasReturnvaluesIF::RETURN_OK) {
+                return result;
+            }
+            if(currentByteIdx < currentFileSize and countdown->hasTimedOut()) {
+                return image::TASK_PERIOD_OVER_SOON;
+            }
+        }
+    }
 
-        helperFlag1 = true;
-        uint8_t requiredBlocks = RESERVED_OBSW_SECTORS;
-        helperCounter1 = requiredBlocks;
+    /* The hamming code size and the flag are only written when the whole code is in the FRAM,
+    so the bootloader will never use a partially written code */
+    size_t hammingCodeSize = (currentFileSize + HAMMING_BLOCK_SIZE - 1) / HAMMING_BLOCK_SIZE *
+            HAMMING_CODE_BYTES_PER_BLOCK;
+    int retval = fram_write_ham_size(hammingFramSlot, hammingCodeSize);
+    if(retval == 0) {
+        retval = fram_set_img_ham_flag(hammingFramSlot);
     }
+    if(retval != 0) {
+        EventManagerIF::triggerEvent(objects::SOFTWARE_IMAGE_HANDLER,
+                image::FRAM_ISSUE_EVENT, retval);
+        return image::FRAM_ISSUE;
+    }
+    EventManagerIF::triggerEvent(objects::SOFTWARE_IMAGE_HANDLER,
+            image::HAMMING_CODE_GENERATED, sourceSlot, hammingCodeSize);
+#if OBSW_VERBOSE_LEVEL >= 1
+    sif::printInfo("Generated %lu bytes of hamming code for %lu bytes with %hu steps\n",
+            static_cast<unsigned long>(hammingCodeSize),
+            static_cast<unsigned long>(currentFileSize), stepCounter);
+#endif
+    lastFinishedState = imageHandlerState;
+    reset();
+    return image::OPERATION_FINISHED;
+}
 
-    while(stepCounter < helperCounter1) {
-        int result = NORFLASH_EraseSector(&NORFlash,
-                getBaseAddress(stepCounter, nullptr));
-        if(result != 0) {
+ReturnValue_t ImageCopyingEngine::generateHammingCodeChunk(size_t chunkSize) {
+    if(stepCounter == 0) {
+        size_t requiredSize = (currentFileSize + HAMMING_BLOCK_SIZE - 1) / HAMMING_BLOCK_SIZE *
+                HAMMING_CODE_BYTES_PER_BLOCK;
+        if(requiredSize > IMAGES_HAMMING_RESERVED_SIZE) {
+#if OBSW_VERBOSE_LEVEL >= 1
+            sif::printWarning("ImageCopyingEngine::generateHammingCodeChunk: Image too large "
+                    "for the reserved hamming code space\n");
+#endif
             return HasReturnvaluesIF::RETURN_FAILED;
         }
-        stepCounter++;
-        if(countdown->hasTimedOut()) {
-            return image::TASK_PERIOD_OVER_SOON;
+        /* The old hamming code is invalid from now on */
+        int retval = fram_clear_img_ham_flag(hammingFramSlot);
+        if(retval != 0) {
+            return image::FRAM_ISSUE;
         }
     }
-    if(stepCounter == helperCounter1) {
-        /* Reset counter and helper members. */
-        stepCounter = 0;
-        helperFlag1 = false;
-        helperCounter1 = 0;
+
+    /* The hamming code is generated for the image padded with zeros to a multiple of the
+    block size, which is expected by the bootloader and the scrubbing engine */
+    size_t paddedSize = chunkSize;
+    if(chunkSize % HAMMING_BLOCK_SIZE != 0) {
+        paddedSize += HAMMING_BLOCK_SIZE - chunkSize % HAMMING_BLOCK_SIZE;
+        std::memset(imgBuffer->data() + chunkSize, 0, paddedSize - chunkSize);
     }
+    std::array<uint8_t, sizeof(image::ImageBuffer) / HAMMING_BLOCK_SIZE *
+            HAMMING_CODE_BYTES_PER_BLOCK> codeBuffer;
+    Hamming_Compute256x(imgBuffer->data(), paddedSize, codeBuffer.data());
+
+    size_t codeSize = paddedSize / HAMMING_BLOCK_SIZE * HAMMING_CODE_BYTES_PER_BLOCK;
+    size_t codeOffset = currentByteIdx / HAMMING_BLOCK_SIZE * HAMMING_CODE_BYTES_PER_BLOCK;
+    int retval = fram_write_ham_code(hammingFramSlot, codeBuffer.data(), codeOffset, codeSize);
+    if(retval != 0) {
+        EventManagerIF::triggerEvent(objects::SOFTWARE_IMAGE_HANDLER,
+                image::FRAM_ISSUE_EVENT, retval);
+        return image::FRAM_ISSUE;
+    }
+    currentByteIdx += chunkSize;
+    stepCounter++;
     return HasReturnvaluesIF::RETURN_OK;
 }
 
+SlotType ImageCopyingEngine::getFramSlot(VolumeId activeVolume) const {
+    if(sourceSlot == image::ImageSlot::FLASH) {
+        return FLASH_SLOT;
+    }
+    if(activeVolume == SD_CARD_1) {
+        if(sourceSlot == image::ImageSlot::SDC_SLOT_1) {
+            return SDC_1_SL_1;
+        }
+        return SDC_1_SL_0;
+    }
+    if(sourceSlot == image::ImageSlot::SDC_SLOT_1) {
+        return SDC_0_SL_1;
+    }
+    return SDC_0_SL_0;
+}
+
 ReturnValue_t ImageCopyingEngine::handleSdToNorCopyOperation() {
     SDCardAccess sdCardAccess;
     if(sdCardAccess.getAccessResult() == SDCardAccess::SD_CARD_CHANGE_ONGOING) {
         return HasReturnvaluesIF::RETURN_FAILED;
     }
-    F_FILE* binaryFile;
+    F_FILE* binaryFile = nullptr;
 
     ReturnValue_t result = prepareGenericFileInformation(
             sdCardAccess.getActiveVolume(), &binaryFile);
@@ -350,33 +461,45 @@ ReturnValue_t ImageCopyingEngine::handleSdToNorCopyOperation() {
         return result;
     }
 
-    while(true) {
-        result = performNorCopyOperation(&binaryFile);
+    /* Nothing was erased yet, so the image can still be rejected without damage. The header
+    is only read once, the check of a compressed image might span multiple cycles. */
+    bool nothingErased = erasedAddress == getNorRegionStart();
+    if(nothingErased and sourceSlot != image::ImageSlot::BOOTLOADER_0 and
+            readByteIdx == 0 and not compressedImageVerified) {
+        result = readCompressionHeader(binaryFile);
         if(result != HasReturnvaluesIF::RETURN_OK) {
             return result;
         }
+        if(compressedImage) {
+            resetDecompression();
+        }
+    }
+    if(compressedImage) {
+        /* The NOR-Flash image is stored decompressed. The file size is cached by
+        prepareGenericFileInformation until the first bucket was programmed. */
+        currentFileSize = compressionHeader.image_size;
     }
-    return HasReturnvaluesIF::RETURN_OK;
-}
-
-ReturnValue_t ImageCopyingEngine::performNorCopyOperation(F_FILE** binaryFile) {
-    ReturnValue_t result = HasReturnvaluesIF::RETURN_OK;
-
-    /* We will always copy in small buckets (8192 bytes) */
-    size_t sizeToRead = NORFLASH_SMALL_SECTOR_SIZE;
 
-    if(currentFileSize == 0) {
-#if FSFW_CPP_OSTREAM_ENABLED == 0
-        sif::printWarning("ImageCopyingEngine::performNorCopyOperation: Current file size is 0!\n");
+    if(nothingErased) {
+        size_t maxImageSize = PRIMARY_IMAGE_RESERVED_SIZE;
+        if(sourceSlot == image::ImageSlot::BOOTLOADER_0) {
+            maxImageSize = NORFLASH_BL_SIZE_START - BOOTLOADER_BASE_ADDRESS_WRITE;
+        }
+        if(currentFileSize == 0 or currentFileSize > maxImageSize) {
+#if OBSW_VERBOSE_LEVEL >= 1
+            sif::printWarning("ImageCopyingEngine::handleSdToNorCopyOperation: Invalid "
+                    "image size %lu\n", static_cast<unsigned long>(currentFileSize));
 #endif
-        return HasReturnvaluesIF::RETURN_FAILED;
-    }
+            return HasReturnvaluesIF::RETURN_FAILED;
+        }
 
-    if(currentFileSize - currentByteIdx < NORFLASH_SMALL_SECTOR_SIZE) {
-        sizeToRead = currentFileSize - currentByteIdx;
-    }
+        if(compressedImage and not compressedImageVerified) {
+            result = verifyCompressedImage(&binaryFile);
+            if(result != HasReturnvaluesIF::RETURN_OK) {
+                return result;
+            }
+        }
 
-    if(stepCounter == 0) {
         int retval = 0;
         /* We store the size of the image in the FRAM */
         if(sourceSlot == image::ImageSlot::BOOTLOADER_0) {
@@ -393,76 +516,90 @@ ReturnValue_t ImageCopyingEngine::performNorCopyOperation(F_FILE** binaryFile) {
         }
     }
 
-    /* If data has been read but still needs to be copied, don't read. */
-    if(not helperFlag1) {
-        size_t bytesRead = 0;
-        /* Read length of NOR-Flash small section */
-        result = readFile(imgBuffer->data(), sizeToRead, &bytesRead,
-                binaryFile);
+    /* The buckets which are still buffered were already read, so continue after them */
+    if(compressedImage) {
+        int retval = f_seek(binaryFile, compressedReadIdx, F_SEEK_SET);
+        if(retval != F_NO_ERROR) {
+            return HasReturnvaluesIF::RETURN_FAILED;
+        }
+    }
+    else if(readByteIdx != currentByteIdx) {
+        int retval = f_seek(binaryFile, readByteIdx, F_SEEK_SET);
+        if(retval != F_NO_ERROR) {
+            return HasReturnvaluesIF::RETURN_FAILED;
+        }
+    }
+
+    while(true) {
+        result = performNorCopyOperation(&binaryFile);
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
+        }
+    }
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t ImageCopyingEngine::performNorCopyOperation(F_FILE** binaryFile) {
+    ReturnValue_t result = HasReturnvaluesIF::RETURN_OK;
+    uint32_t programAddress = getNorRegionStart() + currentByteIdx;
+
+    /* The buckets are aligned to the sectors, so a bucket never spans two sectors. The sector
+    is erased before the bucket is read if possible, so the bucket buffers can be filled while
+    the NOR-Flash is busy erasing. */
+    if(programAddress >= erasedAddress) {
+        result = eraseNextSector(*binaryFile);
         if(result != HasReturnvaluesIF::RETURN_OK) {
             return result;
         }
-        if(bytesRead < sizeToRead) {
-            /* Should not happen.. */
-#if FSFW_CPP_OSTREAM_ENABLED == 1
-            sif::error << "SoftwareImageHandler::performNorCopyOperation:"
-                    << " Bytes read smaller than size to read!" << std::endl;
-#else
-            sif::printError("SoftwareImageHandler::performNorCopyOperation:"
-                    " Bytes read smaller than size to read!\n");
-#endif
-            return HasReturnvaluesIF::RETURN_FAILED;
+        if(countdown->hasTimedOut()) {
+            return image::TASK_PERIOD_OVER_SOON;
+        }
+    }
+
+    if(filledBuckets == 0) {
+        result = readNextBucket(binaryFile, false);
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
         }
     }
 
-    helperFlag1 = true;
     /* we should consider a critical section here and extracting this function to a special task
     with the highest priority so it can not be interrupted. */
-    size_t offset = 0;
-    size_t baseAddress = getBaseAddress(stepCounter, &offset);
-    // sif::debug << "Base Address: " << baseAddress << ", Offset: "
-    //        << offset << std::endl;
-    int retval = NORFLASH_WriteData(&NORFlash,  baseAddress + offset,
-            imgBuffer->data(), sizeToRead);
+    size_t bucketSize = bucketSizes[programBucketIdx];
+    uint32_t programStartMs = 0;
+    Clock::getUptime(&programStartMs);
+    int retval = NORFLASH_WriteData(&NORFlash, programAddress,
+            getBucketBuffer(programBucketIdx), bucketSize);
+    uint32_t programEndMs = 0;
+    Clock::getUptime(&programEndMs);
+    norCopyTimings.programMs += programEndMs - programStartMs;
     if(retval != 0) {
         errorCount++;
         if(errorCount >= 3) {
-            /* If writing to NAND failed 5 times, exit. */
+            /* If writing to NOR-Flash failed 3 times, exit. */
 #if FSFW_CPP_OSTREAM_ENABLED == 1
-            sif::error << "SoftwareImageHandler::copyBootloaderToNor"
-                    << "Flash: Write error!" << std::endl;
+            sif::error << "ImageCopyingEngine::performNorCopyOperation: "
+                    << "Write error!" << std::endl;
 #else
-            sif::printError("SoftwareImageHandler::copyBootloaderToNor"
-                    "Flash: Write error!\n");
+            sif::printError("ImageCopyingEngine::performNorCopyOperation: "
+                    "Write error!\n");
 #endif
             return HasReturnvaluesIF::RETURN_FAILED;
         }
-        /* Maybe SD card is busy, so try in next cycle.. */
+        /* The bucket stays buffered, so try again in next cycle.. */
         return image::TASK_PERIOD_OVER_SOON;
     }
-    else {
-        result = HasReturnvaluesIF::RETURN_OK;
-    }
 
     /* Bucket write success */
-    currentByteIdx += sizeToRead;
-    //sif::debug << "ImageCopyingEngine::performNorCopyOperation:
-    //      << "Current Byte Index: " << currentByteIdx << std::endl;
-    stepCounter ++;
-    /* Set this flag to false so that the next bucket can be read from the SD card.*/
-    helperFlag1 = false;
+    currentByteIdx += bucketSize;
+    stepCounter++;
+    programBucketIdx = (programBucketIdx + 1) % bucketSizes.size();
+    filledBuckets--;
 
     if(currentByteIdx >= currentFileSize) {
-        /* Operation finished. */
-        handleFinishPrintout();
-
-        if(sourceSlot == image::ImageSlot::BOOTLOADER_0) {
-            writeBootloaderSizeAndCrc();
+        if(compressedImage) {
+            return verifyDecompressedImage();
         }
-
-        /* Cache last finished state. */
-        lastFinishedState = imageHandlerState;
-        reset();
         return image::OPERATION_FINISHED;
     }
     if(countdown->hasTimedOut()) {
@@ -471,6 +608,284 @@ ReturnValue_t ImageCopyingEngine::performNorCopyOperation(F_FILE** binaryFile) {
     return result;
 }
 
+ReturnValue_t ImageCopyingEngine::readNextBucket(F_FILE** binaryFile, bool duringErase) {
+    uint8_t fillIdx = (programBucketIdx + filledBuckets) % bucketSizes.size();
+    size_t sizeToRead = currentFileSize - readByteIdx;
+    if(sizeToRead > COPYING_BUCKET_SIZE) {
+        sizeToRead = COPYING_BUCKET_SIZE;
+    }
+
+    uint32_t readStartMs = 0;
+    Clock::getUptime(&readStartMs);
+    size_t bytesRead = 0;
+    ReturnValue_t result = HasReturnvaluesIF::RETURN_OK;
+    if(compressedImage) {
+        result = decompressBucket(getBucketBuffer(fillIdx), sizeToRead, binaryFile);
+        bytesRead = sizeToRead;
+    }
+    else {
+        result = readFile(getBucketBuffer(fillIdx), sizeToRead, &bytesRead, binaryFile);
+    }
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        return result;
+    }
+    if(bytesRead < sizeToRead) {
+        /* Should not happen.. */
+#if FSFW_CPP_OSTREAM_ENABLED == 1
+        sif::error << "ImageCopyingEngine::readNextBucket:"
+                << " Bytes read smaller than size to read!" << std::endl;
+#else
+        sif::printError("ImageCopyingEngine::readNextBucket:"
+                " Bytes read smaller than size to read!\n");
+#endif
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    uint32_t readEndMs = 0;
+    Clock::getUptime(&readEndMs);
+
+    bucketSizes[fillIdx] = bytesRead;
+    filledBuckets++;
+    readByteIdx += bytesRead;
+    norCopyTimings.bucketsRead++;
+    if(duringErase) {
+        norCopyTimings.overlappedSdReadMs += readEndMs - readStartMs;
+        norCopyTimings.bucketsReadDuringErase++;
+    }
+    else {
+        norCopyTimings.sdReadMs += readEndMs - readStartMs;
+    }
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t ImageCopyingEngine::decompressBucket(uint8_t* bucket, size_t bucketSize,
+        F_FILE** binaryFile) {
+    size_t compressedEnd = IMAGE_COMPRESSION_HEADER_SIZE + compressionHeader.compressed_size;
+    while(partialBucketSize < bucketSize) {
+        if(compressedBufferIdx == compressedBufferSize) {
+            size_t sizeToRead = compressedEnd - compressedReadIdx;
+            if(sizeToRead == 0) {
+                /* The compressed data ended before the image was complete */
+                return image::COMPRESSED_IMAGE_INVALID;
+            }
+            if(sizeToRead > compressedBuffer.size()) {
+                sizeToRead = compressedBuffer.size();
+            }
+            size_t sizeRead = 0;
+            ReturnValue_t result = readFile(compressedBuffer.data(), sizeToRead, &sizeRead,
+                    binaryFile);
+            if(result != HasReturnvaluesIF::RETURN_OK) {
+                return result;
+            }
+            compressedReadIdx += sizeRead;
+            compressedBufferIdx = 0;
+            compressedBufferSize = sizeRead;
+        }
+
+        const uint8_t* input = compressedBuffer.data() + compressedBufferIdx;
+        size_t inputSize = compressedBufferSize - compressedBufferIdx;
+        uint8_t* output = bucket + partialBucketSize;
+        size_t outputSize = bucketSize - partialBucketSize;
+        int retval = image_decompress(&decompressor, &input, &inputSize, &output, &outputSize);
+        compressedBufferIdx = compressedBufferSize - inputSize;
+        partialBucketSize = bucketSize - outputSize;
+        if(retval != IMAGE_COMPRESSION_OK) {
+#if OBSW_VERBOSE_LEVEL >= 1
+            sif::printWarning("ImageCopyingEngine::decompressBucket: Compressed image "
+                    "corrupted at offset %lu\n", static_cast<unsigned long>(
+                    compressedReadIdx - compressedBufferSize + compressedBufferIdx));
+#endif
+            return image::COMPRESSED_IMAGE_INVALID;
+        }
+    }
+    decompressedCrc = CRC::crc16ccitt(bucket, bucketSize, decompressedCrc);
+    partialBucketSize = 0;
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t ImageCopyingEngine::verifyCompressedImage(F_FILE** binaryFile) {
+    int retval = f_seek(*binaryFile, compressedReadIdx, F_SEEK_SET);
+    if(retval != F_NO_ERROR) {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    /* The decompressed data is discarded, only the CRC is calculated */
+    while(readByteIdx < currentFileSize) {
+        size_t sizeToCheck = currentFileSize - readByteIdx;
+        if(sizeToCheck > COPYING_BUCKET_SIZE) {
+            sizeToCheck = COPYING_BUCKET_SIZE;
+        }
+        ReturnValue_t result = decompressBucket(imgBuffer->data(), sizeToCheck, binaryFile);
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
+        }
+        readByteIdx += sizeToCheck;
+        if(readByteIdx < currentFileSize and countdown->hasTimedOut()) {
+            return image::TASK_PERIOD_OVER_SOON;
+        }
+    }
+    ReturnValue_t result = verifyDecompressedImage();
+    if(result != image::OPERATION_FINISHED) {
+        return result;
+    }
+
+    /* Decompress again from the start for the copy operation */
+    resetDecompression();
+    readByteIdx = 0;
+    compressedImageVerified = true;
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+void ImageCopyingEngine::resetDecompression() {
+    image_decompressor_init(&decompressor);
+    compressedReadIdx = IMAGE_COMPRESSION_HEADER_SIZE;
+    compressedBufferIdx = 0;
+    compressedBufferSize = 0;
+    partialBucketSize = 0;
+    decompressedCrc = 0xffff;
+}
+
+ReturnValue_t ImageCopyingEngine::verifyDecompressedImage() {
+    size_t compressedEnd = IMAGE_COMPRESSION_HEADER_SIZE + compressionHeader.compressed_size;
+    if(not image_decompressor_finished(&decompressor) or compressedReadIdx != compressedEnd or
+            compressedBufferIdx != compressedBufferSize or
+            decompressedCrc != compressionHeader.image_crc) {
+#if OBSW_VERBOSE_LEVEL >= 1
+        sif::printWarning("ImageCopyingEngine::verifyDecompressedImage: Decompressed image "
+                "invalid, CRC16 0x%04x, expected 0x%04x\n", decompressedCrc,
+                compressionHeader.image_crc);
+#endif
+        return image::COMPRESSED_IMAGE_INVALID;
+    }
+    return image::OPERATION_FINISHED;
+}
+
+ReturnValue_t ImageCopyingEngine::eraseNextSector(F_FILE* binaryFile) {
+    uint32_t eraseStartMs = 0;
+    Clock::getUptime(&eraseStartMs);
+    if(norCopyTimings.sectorsErased == 0) {
+        criticalWindowStartMs = eraseStartMs;
+#if OBSW_VERBOSE_LEVEL >= 1
+        sif::printInfo("ImageCopyingEngine::eraseNextSector: Deleting old %s!\n",
+                sourceSlot == image::ImageSlot::BOOTLOADER_0 ? "bootloader" : "binary");
+#endif
+    }
+
+    /* The erase wait callback reads the next buckets while the sector is being erased */
+    pipelineFile = binaryFile;
+    pipelineReadFailed = false;
+    norflash_set_wait_callback(&ImageCopyingEngine::eraseWaitCallback, this);
+    int retval = NORFLASH_EraseSector(&NORFlash, erasedAddress);
+    norflash_set_wait_callback(nullptr, nullptr);
+    pipelineFile = nullptr;
+
+    uint32_t eraseEndMs = 0;
+    Clock::getUptime(&eraseEndMs);
+    norCopyTimings.eraseMs += eraseEndMs - eraseStartMs;
+    if(retval != 0) {
+#if FSFW_CPP_OSTREAM_ENABLED == 1
+        sif::error << "ImageCopyingEngine::eraseNextSector: Erasing sector at 0x" << std::hex <<
+                erasedAddress << std::dec << " failed!" << std::endl;
+#else
+        sif::printError("ImageCopyingEngine::eraseNextSector: Erasing sector at 0x%08lx "
+                "failed!\n", static_cast<unsigned long>(erasedAddress));
+#endif
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    erasedAddress += getNorSectorSize(erasedAddress);
+    norCopyTimings.sectorsErased++;
+
+    if(pipelineReadFailed) {
+        /* The file is reopened in the next cycle before reading is tried again */
+        return image::TASK_PERIOD_OVER_SOON;
+    }
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t ImageCopyingEngine::handleRemainingErasure() {
+    while(erasedAddress < getNorRegionEnd()) {
+        ReturnValue_t result = eraseNextSector(nullptr);
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
+        }
+        if(erasedAddress < getNorRegionEnd() and countdown->hasTimedOut()) {
+            return image::TASK_PERIOD_OVER_SOON;
+        }
+    }
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+int ImageCopyingEngine::eraseWaitCallback(void *args) {
+    ImageCopyingEngine* engine = static_cast<ImageCopyingEngine*>(args);
+    if(engine == nullptr or engine->pipelineFile == nullptr or engine->pipelineReadFailed) {
+        return 0;
+    }
+    if(engine->filledBuckets >= engine->bucketSizes.size() or
+            engine->readByteIdx >= engine->currentFileSize) {
+        /* Nothing left to do, the task can be delayed */
+        return 0;
+    }
+    ReturnValue_t result = engine->readNextBucket(&engine->pipelineFile, true);
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        engine->pipelineReadFailed = true;
+        return 0;
+    }
+    return 1;
+}
+
+void ImageCopyingEngine::resetNorCopyPipeline() {
+    bucketSizes = {};
+    programBucketIdx = 0;
+    filledBuckets = 0;
+    readByteIdx = 0;
+    erasedAddress = getNorRegionStart();
+    pipelineFile = nullptr;
+    pipelineReadFailed = false;
+    compressedBufferIdx = 0;
+    compressedBufferSize = 0;
+    compressedReadIdx = 0;
+    partialBucketSize = 0;
+    decompressedCrc = 0xffff;
+    compressedImageVerified = false;
+    norCopyTimings = NorCopyTimings();
+    criticalWindowStartMs = 0;
+    Clock::getUptime(&norCopyStartMs);
+}
+
+uint8_t* ImageCopyingEngine::getBucketBuffer(uint8_t bucketIdx) {
+    if(bucketIdx == 0) {
+        return imgBuffer->data();
+    }
+    return secondaryBuffer.data();
+}
+
+uint32_t ImageCopyingEngine::getNorRegionStart() const {
+    if(sourceSlot == image::ImageSlot::BOOTLOADER_0) {
+        return BOOTLOADER_BASE_ADDRESS_WRITE;
+    }
+    return BINARY_BASE_ADDRESS_WRITE;
+}
+
+uint32_t ImageCopyingEngine::getNorRegionEnd() const {
+    if(sourceSlot == image::ImageSlot::BOOTLOADER_0) {
+        return BOOTLOADER_END_ADDRESS_WRITE;
+    }
+    return BINARY_BASE_ADDRESS_WRITE + PRIMARY_IMAGE_RESERVED_SIZE;
+}
+
+uint32_t ImageCopyingEngine::getNorSectorSize(uint32_t sectorAddress) {
+    static_assert(NORFLASH_SMALL_SECTORS_NUMBER * NORFLASH_SMALL_SECTOR_SIZE +
+            NORFLASH_LARGE_SECTORS_NUMBER * NORFLASH_LARGE_SECTOR_SIZE == IOBC_NORFLASH_SIZE,
+            "Sector layout does not match the NOR-Flash size");
+    /* The small sectors are located at the start of the NOR-Flash */
+    if(sectorAddress < NORFLASH_SMALL_SECTORS_NUMBER * NORFLASH_SMALL_SECTOR_SIZE) {
+        return NORFLASH_SMALL_SECTOR_SIZE;
+    }
+    return NORFLASH_LARGE_SECTOR_SIZE;
+}
+
+ImageCopyingEngine::NorCopyTimings ImageCopyingEngine::getNorCopyTimings() const {
+    return norCopyTimings;
+}
+
 void ImageCopyingEngine::writeBootloaderSizeAndCrc() {
     int retval = NORFLASH_WriteData(&NORFlash, NORFLASH_BL_SIZE_START,
             reinterpret_cast<unsigned char *>(&currentFileSize), 4);
@@ -509,241 +924,6 @@ void ImageCopyingEngine::writeBootloaderSizeAndCrc() {
 #endif
 }
 
-/**
- * This is the core function to translate algorithmic steps to the memory locations
- * read, erased or written. Perform changes with care!
- * Currently, the algorithm assumes that all small sectors are reserved for the bootloader.
- */
-#if IOBC_BOOTLOADER_SIZE == IOBC_SMALL_BOOTLOADER_65KB
-
-uint32_t ImageCopyingEngine::getBaseAddress(uint8_t stepCounter,
-        size_t* offset) {
-    if(bootloader) {
-        /* Deletion steps, performed per-sector */
-        if(internalState == GenericInternalState::STEP_1) {
-            switch(stepCounter) {
-            case(0): return NORFLASH_SA0_ADDRESS;
-            case(1): return NORFLASH_SA1_ADDRESS;
-            case(2): return NORFLASH_SA2_ADDRESS;
-            case(3): return NORFLASH_SA3_ADDRESS;
-            case(4): return NORFLASH_SA4_ADDRESS;
-            case(5): return NORFLASH_SA5_ADDRESS;
-            case(6): return NORFLASH_SA6_ADDRESS;
-            case(7): return NORFLASH_SA7_ADDRESS;
-            }
-        }
-        /* Now we write in small sector buckets, so the offset is actually important. */
-        else if(internalState == GenericInternalState::STEP_2) {
-            uint8_t baseIdx = currentByteIdx / NORFLASH_SMALL_SECTOR_SIZE;
-            if(offset != nullptr) {
-                *offset = currentByteIdx % NORFLASH_SMALL_SECTOR_SIZE;
-            }
-            switch(baseIdx) {
-            case(0): return NORFLASH_SA0_ADDRESS;
-            case(1): return NORFLASH_SA1_ADDRESS;
-            case(2): return NORFLASH_SA2_ADDRESS;
-            case(3): return NORFLASH_SA3_ADDRESS;
-            case(4): return NORFLASH_SA4_ADDRESS;
-            case(5): return NORFLASH_SA5_ADDRESS;
-            case(6): return NORFLASH_SA6_ADDRESS;
-            case(7): return NORFLASH_SA7_ADDRESS;
-            }
-        }
-    }
-    else {
-        if(internalState == GenericInternalState::STEP_1) {
-            switch(stepCounter) {
-            case(0): return NORFLASH_SA8_ADDRESS;
-            case(1): return NORFLASH_SA9_ADDRESS;
-            case(2): return NORFLASH_SA10_ADDRESS;
-            case(3): return NORFLASH_SA11_ADDRESS;
-            case(4): return NORFLASH_SA12_ADDRESS;
-            case(5): return NORFLASH_SA13_ADDRESS;
-            case(6): return NORFLASH_SA14_ADDRESS;
-            case(7): return NORFLASH_SA15_ADDRESS;
-            case(8): return NORFLASH_SA16_ADDRESS;
-            case(9): return NORFLASH_SA17_ADDRESS;
-            case(10): return NORFLASH_SA18_ADDRESS;
-            case(11): return NORFLASH_SA19_ADDRESS;
-            case(12): return NORFLASH_SA20_ADDRESS;
-            case(13): return NORFLASH_SA21_ADDRESS;
-            case(14): return NORFLASH_SA22_ADDRESS;
-
-            default: return NORFLASH_SA22_ADDRESS;
-            }
-        }
-        else if(internalState == GenericInternalState::STEP_2) {
-            switch(stepCounter) {
-            case(0): return NORFLASH_SA8_ADDRESS;
-            case(8): return NORFLASH_SA9_ADDRESS;
-            case(16): return NORFLASH_SA10_ADDRESS;
-            case(24): return NORFLASH_SA11_ADDRESS;
-            case(32): return NORFLASH_SA12_ADDRESS;
-            case(40): return NORFLASH_SA13_ADDRESS;
-            case(48): return NORFLASH_SA14_ADDRESS;
-            case(56): return NORFLASH_SA15_ADDRESS;
-            case(64): return NORFLASH_SA16_ADDRESS;
-            case(72): return NORFLASH_SA17_ADDRESS;
-            case(80): return NORFLASH_SA18_ADDRESS;
-            case(88): return NORFLASH_SA19_ADDRESS;
-            case(96): return NORFLASH_SA20_ADDRESS;
-            case(104): return NORFLASH_SA21_ADDRESS;
-            case(112): return NORFLASH_SA22_ADDRESS;
-            default:
-                if(stepCounter < 112 + 8) {
-                    *offset = (stepCounter % 8) * NORFLASH_SMALL_SECTOR_SIZE;
-                }
-                if(stepCounter < 8) return NORFLASH_SA8_ADDRESS;
-                if(stepCounter < 16) return NORFLASH_SA9_ADDRESS;
-                if(stepCounter < 24) return NORFLASH_SA10_ADDRESS;
-                if(stepCounter < 32) return NORFLASH_SA11_ADDRESS;
-                if(stepCounter < 40) return NORFLASH_SA12_ADDRESS;
-                if(stepCounter < 48) return NORFLASH_SA13_ADDRESS;
-                if(stepCounter < 56) return NORFLASH_SA14_ADDRESS;
-                if(stepCounter < 64) return NORFLASH_SA15_ADDRESS;
-                if(stepCounter < 72) return NORFLASH_SA16_ADDRESS;
-                if(stepCounter < 80) return NORFLASH_SA17_ADDRESS;
-                if(stepCounter < 88) return NORFLASH_SA18_ADDRESS;
-                if(stepCounter < 96) return NORFLASH_SA19_ADDRESS;
-                if(stepCounter < 104) return NORFLASH_SA20_ADDRESS;
-                if(stepCounter < 112) return NORFLASH_SA21_ADDRESS;
-                if(stepCounter < 120) return NORFLASH_SA22_ADDRESS;
-            }
-        }
-    }
-    return 0xffffffff;
-}
-
-#elif IOBC_BOOTLOADER_SIZE == IOBC_LARGE_BOOTLOADER_128KB
-
-uint32_t ImageCopyingEngine::getBaseAddress(uint8_t stepCounter,
-        size_t* offset) {
-    if(sourceSlot == image::ImageSlot::BOOTLOADER_0) {
-        /* Deletion steps, performed per-sector */
-        if(internalState == GenericInternalState::STEP_1) {
-            switch(stepCounter) {
-            case(0): return NORFLASH_SA0_ADDRESS;
-            case(1): return NORFLASH_SA1_ADDRESS;
-            case(2): return NORFLASH_SA2_ADDRESS;
-            case(3): return NORFLASH_SA3_ADDRESS;
-            case(4): return NORFLASH_SA4_ADDRESS;
-            case(5): return NORFLASH_SA5_ADDRESS;
-            case(6): return NORFLASH_SA6_ADDRESS;
-            case(7): return NORFLASH_SA7_ADDRESS;
-            case(8): return NORFLASH_SA8_ADDRESS;
-            }
-        }
-        /* Now we write in small sector buckets, so the offset is actually important. */
-        else if(internalState == GenericInternalState::STEP_2) {
-            uint8_t baseIdx = currentByteIdx / NORFLASH_SMALL_SECTOR_SIZE;
-            if(offset != nullptr) {
-                *offset = currentByteIdx % NORFLASH_SMALL_SECTOR_SIZE;
-            }
-            switch(baseIdx) {
-            case(0): return NORFLASH_SA0_ADDRESS;
-            case(1): return NORFLASH_SA1_ADDRESS;
-            case(2): return NORFLASH_SA2_ADDRESS;
-            case(3): return NORFLASH_SA3_ADDRESS;
-            case(4): return NORFLASH_SA4_ADDRESS;
-            case(5): return NORFLASH_SA5_ADDRESS;
-            case(6): return NORFLASH_SA6_ADDRESS;
-            case(7): return NORFLASH_SA7_ADDRESS;
-            case(8): return NORFLASH_SA8_ADDRESS;
-            /* This sector is a large sector, so we need to set the offset here. */
-            case(9): {
-                *offset = NORFLASH_SMALL_SECTOR_SIZE;
-                return NORFLASH_SA8_ADDRESS;
-            }
-            case(10): {
-                *offset = NORFLASH_SMALL_SECTOR_SIZE * 2;
-                return NORFLASH_SA8_ADDRESS;
-            }
-            case(11): {
-                *offset = NORFLASH_SMALL_SECTOR_SIZE * 3;
-                return NORFLASH_SA8_ADDRESS;
-            }
-            case(12): {
-                *offset = NORFLASH_SMALL_SECTOR_SIZE * 4;
-                return NORFLASH_SA8_ADDRESS;
-            }
-            case(13): {
-                *offset = NORFLASH_SMALL_SECTOR_SIZE * 5;
-                return NORFLASH_SA8_ADDRESS;
-            }
-            case(14): {
-                *offset = NORFLASH_SMALL_SECTOR_SIZE * 6;
-                return NORFLASH_SA8_ADDRESS;
-            }
-            case(15): {
-                *offset = NORFLASH_SMALL_SECTOR_SIZE * 7;
-                return NORFLASH_SA8_ADDRESS;
-            }
-            }
-        }
-    }
-    else {
-        if(internalState == GenericInternalState::STEP_1) {
-            switch(stepCounter) {
-            case(0): return NORFLASH_SA9_ADDRESS;
-            case(1): return NORFLASH_SA10_ADDRESS;
-            case(2): return NORFLASH_SA11_ADDRESS;
-            case(3): return NORFLASH_SA12_ADDRESS;
-            case(4): return NORFLASH_SA13_ADDRESS;
-            case(5): return NORFLASH_SA14_ADDRESS;
-            case(6): return NORFLASH_SA15_ADDRESS;
-            case(7): return NORFLASH_SA16_ADDRESS;
-            case(8): return NORFLASH_SA17_ADDRESS;
-            case(9): return NORFLASH_SA18_ADDRESS;
-            case(10): return NORFLASH_SA19_ADDRESS;
-            case(11): return NORFLASH_SA20_ADDRESS;
-            case(12): return NORFLASH_SA21_ADDRESS;
-            case(13): return NORFLASH_SA21_ADDRESS;
-            case(14): return NORFLASH_SA22_ADDRESS;
-            default: return NORFLASH_SA22_ADDRESS;
-            }
-        }
-        else if(internalState == GenericInternalState::STEP_2) {
-            switch(stepCounter) {
-            case(0): return NORFLASH_SA9_ADDRESS;
-            case(8): return NORFLASH_SA10_ADDRESS;
-            case(16): return NORFLASH_SA11_ADDRESS;
-            case(24): return NORFLASH_SA12_ADDRESS;
-            case(32): return NORFLASH_SA13_ADDRESS;
-            case(40): return NORFLASH_SA14_ADDRESS;
-            case(48): return NORFLASH_SA15_ADDRESS;
-            case(56): return NORFLASH_SA16_ADDRESS;
-            case(64): return NORFLASH_SA17_ADDRESS;
-            case(72): return NORFLASH_SA18_ADDRESS;
-            case(80): return NORFLASH_SA19_ADDRESS;
-            case(88): return NORFLASH_SA20_ADDRESS;
-            case(96): return NORFLASH_SA21_ADDRESS;
-            case(104): return NORFLASH_SA22_ADDRESS;
-            default:
-                if(stepCounter < 104 + 8) {
-                    *offset = (stepCounter % 8) * NORFLASH_SMALL_SECTOR_SIZE;
-                }
-                if(stepCounter < 8) return NORFLASH_SA9_ADDRESS;
-                if(stepCounter < 16) return NORFLASH_SA10_ADDRESS;
-                if(stepCounter < 24) return NORFLASH_SA11_ADDRESS;
-                if(stepCounter < 32) return NORFLASH_SA12_ADDRESS;
-                if(stepCounter < 40) return NORFLASH_SA13_ADDRESS;
-                if(stepCounter < 48) return NORFLASH_SA14_ADDRESS;
-                if(stepCounter < 56) return NORFLASH_SA15_ADDRESS;
-                if(stepCounter < 64) return NORFLASH_SA16_ADDRESS;
-                if(stepCounter < 72) return NORFLASH_SA17_ADDRESS;
-                if(stepCounter < 80) return NORFLASH_SA18_ADDRESS;
-                if(stepCounter < 88) return NORFLASH_SA19_ADDRESS;
-                if(stepCounter < 96) return NORFLASH_SA20_ADDRESS;
-                if(stepCounter < 104) return NORFLASH_SA21_ADDRESS;
-                if(stepCounter < 112) return NORFLASH_SA22_ADDRESS;
-            }
-        }
-    }
-    return 0xffffffff;
-}
-
-#endif /* IOBC_BOOTLOADER_SIZE == IOBC_LARGE_BOOTLOADER_128KB */
-
 void ImageCopyingEngine::handleFinishPrintout() {
 #if OBSW_VERBOSE_LEVEL >= 1
     if(sourceSlot == image::ImageSlot::BOOTLOADER_0) {
@@ -853,8 +1033,14 @@ void ImageCopyingEngine::handleInfoPrintout(VolumeId currentVolume) {
         }
         sprintf(typePrint, "primary image");
     }
-    else if(imageHandlerState == ImageHandlerStates::COPY_IMG_HAMMING_SDC_TO_FRAM) {
-        sprintf(typePrint, "hamming code");
+    else if(imageHandlerState == ImageHandlerStates::COPY_IMG_HAMMING_SDC_TO_FRAM or
+            imageHandlerState == ImageHandlerStates::GENERATE_IMG_HAMMING_TO_FRAM) {
+        if(imageHandlerState == ImageHandlerStates::GENERATE_IMG_HAMMING_TO_FRAM) {
+            sprintf(typePrint, "generated ham. code");
+        }
+        else {
+            sprintf(typePrint, "hamming code");
+        }
         sprintf(targetPrint, "FRAM");
         if(sourceSlot == image::ImageSlot::FLASH) {
             sprintf(sourcePrint, "NOR-Flash");
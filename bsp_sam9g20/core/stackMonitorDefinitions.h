@@ -0,0 +1,76 @@
+#ifndef SAM9G20_CORE_STACKMONITORDEFINITIONS_H_
+#define SAM9G20_CORE_STACKMONITORDEFINITIONS_H_
+
+#include <events/subsystemIdRanges.h>
+
+#include <fsfw/datapoollocal/StaticLocalDataSet.h>
+#include <fsfw/datapoollocal/LocalPoolVariable.h>
+#include <fsfw/datapoollocal/LocalPoolVector.h>
+#include <fsfw/events/Event.h>
+#include <cstdint>
+
+namespace stackmon {
+
+//! Tasks exceeding this number are not monitored
+static constexpr uint8_t MAX_NUMBER_OF_TASKS = 24;
+
+//! Interval in which the stack monitor updates the housekeeping set
+static constexpr float UPDATE_INTERVAL_SECONDS = 30.0;
+
+//! Remaining stack in bytes below which the low and critical events are triggered
+static constexpr uint32_t LOW_STACK_THRESHOLD = 1024;
+static constexpr uint32_t CRITICAL_STACK_THRESHOLD = 256;
+
+static constexpr uint8_t SUBSYSTEM_ID = SUBSYSTEM_ID::TASK_MONITOR;
+//! Remaining stack of a task fell below the low threshold.
+//! P1: Object ID the task was registered with. P2: Remaining stack in bytes
+static constexpr Event STACK_LOW = MAKE_EVENT(0x00, severity::LOW);
+//! Remaining stack of a task fell below the critical threshold.
+//! P1: Object ID the task was registered with. P2: Remaining stack in bytes
+static constexpr Event STACK_CRITICAL = MAKE_EVENT(0x01, severity::MEDIUM);
+
+//! The set is stored in the local pool of the core controller, next to the CPU statistics
+static constexpr uint32_t STACK_SET_ID = 2;
+
+enum PoolIds: lp_id_t {
+    SAMPLE_COUNT = 120,
+    NUMBER_OF_TASKS,
+    TASK_OBJECT_IDS,
+    MIN_REMAINING_STACKS
+};
+
+/**
+ * @brief   Lowest remaining stack of the tasks monitored by the stack monitor, stored in the
+ *          local pool of the core controller.
+ * @details
+ * Contains one entry per monitored task in each of the task vectors, identified by the object
+ * ID the task was registered with. The remaining stack is the FreeRTOS stack high water mark
+ * in bytes, which is the minimum since the task was started. A task which was not sampled
+ * yet has a remaining stack of 0xffffffff.
+ */
+class StackSet: public StaticLocalDataSet<4> {
+public:
+    StackSet(HasLocalDataPoolIF* owner):
+        StaticLocalDataSet(owner, STACK_SET_ID) {
+    }
+
+    StackSet(object_id_t objectId):
+        StaticLocalDataSet(sid_t(objectId, STACK_SET_ID)) {
+    }
+
+    //! Number of tasks sampled since the start, one task is sampled per monitor cycle
+    lp_var_t<uint32_t> sampleCount = lp_var_t<uint32_t>(sid.objectId,
+            PoolIds::SAMPLE_COUNT, this);
+    lp_var_t<uint8_t> numberOfTasks = lp_var_t<uint8_t>(sid.objectId,
+            PoolIds::NUMBER_OF_TASKS, this);
+    lp_vec_t<uint32_t, MAX_NUMBER_OF_TASKS> taskObjectIds =
+            lp_vec_t<uint32_t, MAX_NUMBER_OF_TASKS>(sid.objectId, PoolIds::TASK_OBJECT_IDS,
+            this);
+    lp_vec_t<uint32_t, MAX_NUMBER_OF_TASKS> minRemainingStacks =
+            lp_vec_t<uint32_t, MAX_NUMBER_OF_TASKS>(sid.objectId,
+            PoolIds::MIN_REMAINING_STACKS, this);
+};
+
+}
+
+#endif /* SAM9G20_CORE_STACKMONITORDEFINITIONS_H_ */
@@ -0,0 +1,69 @@
+#ifndef SAM9G20_CORE_STORESTATSDEFINITIONS_H_
+#define SAM9G20_CORE_STORESTATSDEFINITIONS_H_
+
+#include <mission/memory/MonitoredPoolManager.h>
+
+#include <fsfw/datapoollocal/StaticLocalDataSet.h>
+#include <fsfw/datapoollocal/LocalPoolVariable.h>
+#include <fsfw/datapoollocal/LocalPoolVector.h>
+#include <cstdint>
+
+namespace storestats {
+
+//! TM, TC and IPC store, in the order of the CoreController::Stores enumeration
+static constexpr uint8_t NUMBER_OF_STORES = 3;
+static constexpr uint8_t MAX_NUMBER_OF_SUBPOOLS = MonitoredPoolManager::MAX_NUMBER_OF_SUBPOOLS;
+static constexpr uint8_t NUMBER_OF_ENTRIES = NUMBER_OF_STORES * MAX_NUMBER_OF_SUBPOOLS;
+
+//! Interval in which the core controller copies the store statistics to the set
+static constexpr uint32_t SAMPLE_INTERVAL_SECONDS = 10;
+
+//! Default margin in percent added to the high water marks for the recommended configuration
+static constexpr uint8_t DEFAULT_MARGIN_PERCENT = 25;
+
+static constexpr uint32_t STORE_STATS_SET_ID = 3;
+
+enum PoolIds: lp_id_t {
+    NUMBER_OF_ELEMENTS = 140,
+    ELEMENT_SIZES,
+    USED_ELEMENTS,
+    HIGH_WATER_MARKS,
+    ALLOCATION_FAILURES
+};
+
+/**
+ * @brief   Subpool usage of the TM, TC and IPC store, stored in the local pool of the core
+ *          controller.
+ * @details
+ * Each vector contains MAX_NUMBER_OF_SUBPOOLS entries per store, starting with the TM store.
+ * Entries of subpools which do not exist are zero. The high water mark is the highest number
+ * of concurrently used elements since the start or the last reset of the statistics.
+ */
+class StoreStatsSet: public StaticLocalDataSet<5> {
+public:
+    StoreStatsSet(HasLocalDataPoolIF* owner):
+        StaticLocalDataSet(owner, STORE_STATS_SET_ID) {
+    }
+
+    StoreStatsSet(object_id_t objectId):
+        StaticLocalDataSet(sid_t(objectId, STORE_STATS_SET_ID)) {
+    }
+
+    lp_vec_t<uint16_t, NUMBER_OF_ENTRIES> numberOfElements =
+            lp_vec_t<uint16_t, NUMBER_OF_ENTRIES>(sid.objectId, PoolIds::NUMBER_OF_ELEMENTS,
+            this);
+    lp_vec_t<uint32_t, NUMBER_OF_ENTRIES> elementSizes =
+            lp_vec_t<uint32_t, NUMBER_OF_ENTRIES>(sid.objectId, PoolIds::ELEMENT_SIZES, this);
+    lp_vec_t<uint16_t, NUMBER_OF_ENTRIES> usedElements =
+            lp_vec_t<uint16_t, NUMBER_OF_ENTRIES>(sid.objectId, PoolIds::USED_ELEMENTS, this);
+    lp_vec_t<uint16_t, NUMBER_OF_ENTRIES> highWaterMarks =
+            lp_vec_t<uint16_t, NUMBER_OF_ENTRIES>(sid.objectId, PoolIds::HIGH_WATER_MARKS,
+            this);
+    lp_vec_t<uint32_t, NUMBER_OF_ENTRIES> allocationFailures =
+            lp_vec_t<uint32_t, NUMBER_OF_ENTRIES>(sid.objectId, PoolIds::ALLOCATION_FAILURES,
+            this);
+};
+
+}
+
+#endif /* SAM9G20_CORE_STORESTATSDEFINITIONS_H_ */
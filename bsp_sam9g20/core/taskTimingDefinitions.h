@@ -0,0 +1,84 @@
+#ifndef SAM9G20_CORE_TASKTIMINGDEFINITIONS_H_
+#define SAM9G20_CORE_TASKTIMINGDEFINITIONS_H_
+
+#include <bsp_sam9g20/boardconfig/taskTiming.h>
+
+#include <fsfw/datapoollocal/StaticLocalDataSet.h>
+#include <fsfw/datapoollocal/LocalPoolVariable.h>
+#include <fsfw/datapoollocal/LocalPoolVector.h>
+#include <cstdint>
+
+namespace tasktiming {
+
+static constexpr uint8_t MAX_NUMBER_OF_TASKS = TASK_TIMING_MAX_TASKS;
+static constexpr uint8_t NUMBER_OF_BUCKETS = TASK_TIMING_HISTOGRAM_BUCKETS;
+static constexpr uint8_t HISTOGRAM_SIZE = MAX_NUMBER_OF_TASKS * NUMBER_OF_BUCKETS;
+
+//! Interval in which the task timing monitor updates the housekeeping set
+static constexpr float UPDATE_INTERVAL_SECONDS = 10.0;
+
+//! The set is stored in the local pool of the core controller, next to the CPU statistics
+static constexpr uint32_t TASK_TIMING_SET_ID = 1;
+
+enum PoolIds: lp_id_t {
+    NUMBER_OF_TASKS = 100,
+    TASK_OBJECT_IDS,
+    CYCLE_COUNTS,
+    MIN_EXECUTION_TIMES,
+    MEAN_EXECUTION_TIMES,
+    MAX_EXECUTION_TIMES,
+    HISTOGRAMS,
+    DEADLINE_MISSES,
+    OVERRUNS
+};
+
+/**
+ * @brief   Execution time statistics of the periodic tasks monitored by the task timing
+ *          monitor, stored in the local pool of the core controller.
+ * @details
+ * Contains one entry per monitored task in each of the task vectors, identified by the object
+ * ID the task was registered with. Execution times are ticks of the 10 kHz run time counter.
+ * The histogram vector contains NUMBER_OF_BUCKETS consecutive entries for each task. The
+ * statistics accumulate until they are reset with an action command to the monitor.
+ */
+class TaskTimingSet: public StaticLocalDataSet<9> {
+public:
+    TaskTimingSet(HasLocalDataPoolIF* owner):
+        StaticLocalDataSet(owner, TASK_TIMING_SET_ID) {
+    }
+
+    TaskTimingSet(object_id_t objectId):
+        StaticLocalDataSet(sid_t(objectId, TASK_TIMING_SET_ID)) {
+    }
+
+    lp_var_t<uint8_t> numberOfTasks = lp_var_t<uint8_t>(sid.objectId,
+            PoolIds::NUMBER_OF_TASKS, this);
+    lp_vec_t<uint32_t, MAX_NUMBER_OF_TASKS> taskObjectIds =
+            lp_vec_t<uint32_t, MAX_NUMBER_OF_TASKS>(sid.objectId, PoolIds::TASK_OBJECT_IDS,
+            this);
+    //! Number of periods since the last reset, including missed ones
+    lp_vec_t<uint32_t, MAX_NUMBER_OF_TASKS> cycleCounts =
+            lp_vec_t<uint32_t, MAX_NUMBER_OF_TASKS>(sid.objectId, PoolIds::CYCLE_COUNTS, this);
+    lp_vec_t<uint32_t, MAX_NUMBER_OF_TASKS> minExecutionTimes =
+            lp_vec_t<uint32_t, MAX_NUMBER_OF_TASKS>(sid.objectId,
+            PoolIds::MIN_EXECUTION_TIMES, this);
+    lp_vec_t<uint32_t, MAX_NUMBER_OF_TASKS> meanExecutionTimes =
+            lp_vec_t<uint32_t, MAX_NUMBER_OF_TASKS>(sid.objectId,
+            PoolIds::MEAN_EXECUTION_TIMES, this);
+    lp_vec_t<uint32_t, MAX_NUMBER_OF_TASKS> maxExecutionTimes =
+            lp_vec_t<uint32_t, MAX_NUMBER_OF_TASKS>(sid.objectId,
+            PoolIds::MAX_EXECUTION_TIMES, this);
+    //! Bucket n counts the cycles using n/8 to (n+1)/8 of the period
+    lp_vec_t<uint32_t, HISTOGRAM_SIZE> histograms =
+            lp_vec_t<uint32_t, HISTOGRAM_SIZE>(sid.objectId, PoolIds::HISTOGRAMS, this);
+    lp_vec_t<uint32_t, MAX_NUMBER_OF_TASKS> deadlineMisses =
+            lp_vec_t<uint32_t, MAX_NUMBER_OF_TASKS>(sid.objectId, PoolIds::DEADLINE_MISSES,
+            this);
+    //! Cycles with an execution time longer than the period
+    lp_vec_t<uint32_t, MAX_NUMBER_OF_TASKS> overruns =
+            lp_vec_t<uint32_t, MAX_NUMBER_OF_TASKS>(sid.objectId, PoolIds::OVERRUNS, this);
+};
+
+}
+
+#endif /* SAM9G20_CORE_TASKTIMINGDEFINITIONS_H_ */
@@ -21,6 +21,7 @@ enum: uint8_t {
 
 	SD_CARD_HANDLER = 180,
 	IMAGE_HANDLER = 181,
+	SD_CARD_MIRROR = 182,
 };
 }
 
@@ -18,6 +18,10 @@ enum sourceObjects: object_id_t {
     /* 0x43 ('C') for Controllers */
     CORE_CONTROLLER = 0x43001000,
     SYSTEM_STATE_TASK = 0x43001005,
+    TASK_TIMING_MONITOR = 0x43001010,
+    TASK_STACK_MONITOR = 0x43001011,
+    TRACE_BUFFER_HANDLER = 0x43001012,
+    DEFERRED_LOGGER = 0x43001013,
     RS485_CONTROLLER = 0x43005000,
 
     /* 0x49 ('I') for Communication Interfaces **/
@@ -31,6 +35,8 @@ enum sourceObjects: object_id_t {
 
     /* 0x4d ('M') for Memory Handlers **/
     SD_CARD_HANDLER = 0x4D0073AD,
+    SD_CARD_IO_WORKER = 0x4D0073AE,
+    SD_CARD_MIRROR = 0x4D0073AF,
     FRAM_HANDLER = 0x4D008000,
     SOFTWARE_IMAGE_HANDLER = 0x4D009000,
 
@@ -0,0 +1,232 @@
+#include "CriticalDataCache.h"
+#include "OBSWConfig.h"
+
+#include <bsp_sam9g20/common/fram/FRAMApi.h>
+
+#include <fsfw/ipc/MutexFactory.h>
+#include <fsfw/ipc/MutexGuard.h>
+#include <fsfw/serviceinterface/ServiceInterface.h>
+
+#include <cstring>
+
+#define FIELD_SIZE(member) sizeof(((CriticalDataBlock*) nullptr)->member)
+
+const CriticalDataCache::FieldInfo CriticalDataCache::FIELDS[NUMBER_OF_FIELDS] = {
+        {FRAM_SOFTWARE_VERSION_ADDR, 3, false},
+        {REBOOT_COUNTER_ADDR, FIELD_SIZE(reboot_counter), false},
+        {SEC_SINCE_EPOCH_ADDR, FIELD_SIZE(seconds_since_epoch), false},
+        {PREFERRED_SD_CARD_ADDR, FIELD_SIZE(bl_group.preferred_sd_card), true},
+        {HAMMING_CHECK_FLAG_ADDR, FIELD_SIZE(bl_group.global_hamming_flag), true},
+        {NOR_FLASH_HAMMING_FLAG_ADDR, FIELD_SIZE(bl_group.nor_flash_hamming_flag), true},
+        {SDC0_SL0_HAMMING_FLAG_ADDR, FIELD_SIZE(bl_group.sdc0_image_slot0_hamming_flag), true},
+        {SDC0_SL1_HAMMING_FLAG_ADDR, FIELD_SIZE(bl_group.sdc0_image_slot1_hamming_flag), true},
+        {SDC1_SL0_HAMMING_FLAG_ADDR, FIELD_SIZE(bl_group.sdc1_image_slot0_hamming_flag), true},
+        {SDC1_SL1_HAMMING_FLAG_ADDR, FIELD_SIZE(bl_group.sdc1_image_slot1_hamming_flag), true},
+        {NOR_FLASH_REBOOT_COUNTER_ADDRESS, FIELD_SIZE(bl_group.nor_flash_reboot_counter), true},
+        {SDC0_SL0_REBOOT_COUNTER_ADDR, FIELD_SIZE(bl_group.sdc0_image_slot0_reboot_counter),
+                true},
+        {SDC0_SL1_REBOOT_COUNTER_ADDR, FIELD_SIZE(bl_group.sdc0_image_slot1_reboot_counter),
+                true},
+        {SDC1_SL0_REBOOT_COUNTER_ADDR, FIELD_SIZE(bl_group.sdc1_image_slot0_reboot_counter),
+                true},
+        {SDC1_SL1_REBOOT_COUNTER_ADDR, FIELD_SIZE(bl_group.sdc1_image_slot1_reboot_counter),
+                true},
+        {NOR_FLASH_BINARY_SIZE_ADDR, FIELD_SIZE(bl_group.nor_flash_binary_size), true},
+        {NOR_FLASH_HAMMING_CODE_SIZE_ADDR, FIELD_SIZE(bl_group.nor_flash_hamming_code_size),
+                true},
+        {SDC0_SL0_HAMMING_SIZE_ADDR, FIELD_SIZE(bl_group.sdc0_image_slot0_hamming_size), true},
+        {SDC0_SL1_HAMMING_SIZE_ADDR, FIELD_SIZE(bl_group.sdc0_image_slot1_hamming_size), true},
+        {SDC1_SL0_HAMMING_SIZE_ADDR, FIELD_SIZE(bl_group.sdc1_image_slot0_hamming_size), true},
+        {SDC1_SL1_HAMMING_SIZE_ADDR, FIELD_SIZE(bl_group.sdc1_image_slot1_hamming_size), true},
+        {SOFTWARE_UPDATE_BOOL_ADDR, 3, true},
+        {FRAM_DEPLOY_TIMER_ARMED_ADDR, FIELD_SIZE(deploy_timer_armed), false},
+        {FRAM_SECONDS_SINCE_TIMER_ARMED_ADDR, FIELD_SIZE(seconds_since_timer_armed), false},
+        {BOOTLOADER_FAULTY_ADDRESS, FIELD_SIZE(bootloader_faulty), true},
+        {BOOTLOADER_SIZE_ADDR, FIELD_SIZE(bootloader_size), true},
+        {BOOTLOADER_HAMMING_SIZE_ADDR, FIELD_SIZE(bootloader_hamming_code_size), true},
+        {NUMBER_OF_ACTIVE_TASKS_ADDRESS, FIELD_SIZE(number_of_active_tasks), true}
+};
+
+CriticalDataCache::CriticalDataCache() {
+    mutex = MutexFactory::instance()->createMutex();
+}
+
+CriticalDataCache::~CriticalDataCache() {
+    MutexFactory::instance()->deleteMutex(mutex);
+}
+
+ReturnValue_t CriticalDataCache::load() {
+    MutexGuard mg(mutex);
+    std::array<uint8_t, sizeof(CriticalDataBlock)> loadedBlock;
+    int result = fram_read_critical_range(0, loadedBlock.data(), loadedBlock.size());
+    statistics.readTransactions++;
+    if(result != 0) {
+#if OBSW_VERBOSE_LEVEL >= 1
+        sif::printWarning("CriticalDataCache::load: Reading critical block failed with "
+                "code %d\n", result);
+#endif
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    /* Pending writes are newer than the FRAM content */
+    for(size_t field = 0; field < NUMBER_OF_FIELDS; field++) {
+        if(isSet(dirtyFields, field)) {
+            std::memcpy(loadedBlock.data() + FIELDS[field].address,
+                    block.data() + FIELDS[field].address, FIELDS[field].size);
+        }
+    }
+    block = loadedBlock;
+    validFields = (1ul << NUMBER_OF_FIELDS) - 1;
+    blockLoaded = true;
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t CriticalDataCache::read(Field field, uint8_t* value, size_t size) {
+    if(field >= NUMBER_OF_FIELDS or value == nullptr or size != FIELDS[field].size) {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    MutexGuard mg(mutex);
+    const FieldInfo& info = FIELDS[field];
+    if(not isSet(dirtyFields, field) and (info.readThrough or
+            not isSet(validFields, field))) {
+        int result = fram_read_critical_range(info.address, block.data() + info.address,
+                info.size);
+        statistics.readTransactions++;
+        if(result != 0) {
+            validFields &= ~(1ul << field);
+            return HasReturnvaluesIF::RETURN_FAILED;
+        }
+        validFields |= 1ul << field;
+    }
+    std::memcpy(value, block.data() + info.address, info.size);
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t CriticalDataCache::write(Field field, const uint8_t* value, size_t size) {
+    if(field >= NUMBER_OF_FIELDS or value == nullptr or size != FIELDS[field].size) {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    MutexGuard mg(mutex);
+    const FieldInfo& info = FIELDS[field];
+    statistics.fieldWrites++;
+    /* The cached value of read-through fields may be outdated, so they are always written */
+    if(not info.readThrough and isSet(validFields, field) and
+            std::memcmp(block.data() + info.address, value, info.size) == 0) {
+        statistics.unchangedFieldWrites++;
+        return HasReturnvaluesIF::RETURN_OK;
+    }
+    std::memcpy(block.data() + info.address, value, info.size);
+    dirtyFields |= 1ul << field;
+    validFields |= 1ul << field;
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t CriticalDataCache::flush() {
+    MutexGuard mg(mutex);
+    ReturnValue_t result = HasReturnvaluesIF::RETURN_OK;
+    size_t field = 0;
+    while(field < NUMBER_OF_FIELDS) {
+        if(not isSet(dirtyFields, field)) {
+            field++;
+            continue;
+        }
+        /* Extend the range to the following dirty fields as long as the gaps can be bridged */
+        size_t firstField = field;
+        size_t lastField = field;
+        for(size_t nextField = field + 1; nextField < NUMBER_OF_FIELDS; nextField++) {
+            if(not isSet(dirtyFields, nextField)) {
+                continue;
+            }
+            size_t rangeEnd = FIELDS[lastField].address + FIELDS[lastField].size;
+            if(not canBridge(lastField, nextField, FIELDS[nextField].address - rangeEnd)) {
+                break;
+            }
+            lastField = nextField;
+        }
+        if(writeRange(firstField, lastField) != HasReturnvaluesIF::RETURN_OK) {
+            result = HasReturnvaluesIF::RETURN_FAILED;
+        }
+        field = lastField + 1;
+    }
+    return result;
+}
+
+bool CriticalDataCache::isDirty() {
+    MutexGuard mg(mutex);
+    return dirtyFields != 0;
+}
+
+void CriticalDataCache::invalidate(Field field) {
+    if(field >= NUMBER_OF_FIELDS) {
+        return;
+    }
+    MutexGuard mg(mutex);
+    if(not isSet(dirtyFields, field)) {
+        validFields &= ~(1ul << field);
+    }
+}
+
+void CriticalDataCache::invalidateAll() {
+    MutexGuard mg(mutex);
+    validFields &= dirtyFields;
+    blockLoaded = false;
+}
+
+void CriticalDataCache::getStatistics(Statistics* statisticsCopy) {
+    if(statisticsCopy == nullptr) {
+        return;
+    }
+    MutexGuard mg(mutex);
+    *statisticsCopy = statistics;
+}
+
+void CriticalDataCache::resetStatistics() {
+    MutexGuard mg(mutex);
+    statistics = Statistics();
+}
+
+size_t CriticalDataCache::getFieldSize(Field field) {
+    if(field >= NUMBER_OF_FIELDS) {
+        return 0;
+    }
+    return FIELDS[field].size;
+}
+
+bool CriticalDataCache::isSet(uint32_t mask, size_t field) const {
+    return (mask & (1ul << field)) != 0;
+}
+
+bool CriticalDataCache::canBridge(size_t firstField, size_t lastField, size_t gapSize) const {
+    if(gapSize == 0) {
+        return true;
+    }
+    /* Filler bytes are only known after the whole block was loaded */
+    if(gapSize > MAX_BRIDGED_GAP or not blockLoaded) {
+        return false;
+    }
+    for(size_t field = firstField + 1; field < lastField; field++) {
+        if(FIELDS[field].readThrough or not isSet(validFields, field)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+ReturnValue_t CriticalDataCache::writeRange(size_t firstField, size_t lastField) {
+    uint32_t address = FIELDS[firstField].address;
+    size_t size = FIELDS[lastField].address + FIELDS[lastField].size - address;
+    int result = fram_write_critical_range(address, block.data() + address, size);
+    statistics.writeTransactions++;
+    if(result != 0) {
+#if OBSW_VERBOSE_LEVEL >= 1
+        sif::printWarning("CriticalDataCache::writeRange: Writing %lu bytes at 0x%02lx "
+                "failed with code %d\n", static_cast<unsigned long>(size),
+                static_cast<unsigned long>(address), result);
+#endif
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    statistics.bytesWritten += size;
+    for(size_t field = firstField; field <= lastField; field++) {
+        dirtyFields &= ~(1ul << field);
+    }
+    return HasReturnvaluesIF::RETURN_OK;
+}
@@ -0,0 +1,169 @@
+#ifndef SAM9G20_MEMORY_CRITICALDATACACHE_H_
+#define SAM9G20_MEMORY_CRITICALDATACACHE_H_
+
+#include <bsp_sam9g20/common/fram/CommonFRAM.h>
+
+#include <fsfw/returnvalues/HasReturnvaluesIF.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+class MutexIF;
+
+/**
+ * @brief   Write-back cache for the critical data block stored in FRAM.
+ * @details
+ * Every access to the FRAM is a SPI transaction, and written fields are read back for
+ * verification. Updating the critical data field by field, for example the seconds counter
+ * and the deployment timer in every cycle of the core controller, therefore occupies the SPI
+ * bus which is shared with the SPI device handlers.
+ *
+ * The cache keeps a copy of the critical block. Writes only update the copy and set the
+ * dirty bit of the field, writes which do not change the value of a field are dropped.
+ * flush writes the dirty fields, where consecutive dirty fields are written with one
+ * transaction. Small gaps of clean fields between dirty fields are written as well if the
+ * cached value of the gap is known to be up to date.
+ *
+ * Some fields are also written by other components with the FRAM API, for example the
+ * hamming code flags and sizes written by the software image handler. These fields are
+ * read-through fields: they are always read from the FRAM unless a write is pending and
+ * are never used to fill gaps.
+ *
+ * The FRAM has to be accessible when calling functions which access it, which requires an
+ * SD card access token for the virtualized FRAM of the AT91 board.
+ */
+class CriticalDataCache {
+public:
+    //! Fields of the critical block, in the order of their addresses
+    enum Field: uint8_t {
+        //! Version, subversion and subsubversion
+        SOFTWARE_VERSION,
+        REBOOT_COUNTER,
+        SECONDS_SINCE_EPOCH,
+        PREFERRED_SD_CARD,
+        GLOBAL_HAMMING_FLAG,
+        NOR_FLASH_HAMMING_FLAG,
+        SDC0_SL0_HAMMING_FLAG,
+        SDC0_SL1_HAMMING_FLAG,
+        SDC1_SL0_HAMMING_FLAG,
+        SDC1_SL1_HAMMING_FLAG,
+        NOR_FLASH_REBOOT_COUNTER,
+        SDC0_SL0_REBOOT_COUNTER,
+        SDC0_SL1_REBOOT_COUNTER,
+        SDC1_SL0_REBOOT_COUNTER,
+        SDC1_SL1_REBOOT_COUNTER,
+        NOR_FLASH_BINARY_SIZE,
+        NOR_FLASH_HAMMING_SIZE,
+        SDC0_SL0_HAMMING_SIZE,
+        SDC0_SL1_HAMMING_SIZE,
+        SDC1_SL0_HAMMING_SIZE,
+        SDC1_SL1_HAMMING_SIZE,
+        //! Update available flag and the flags for both volumes
+        SOFTWARE_UPDATE,
+        DEPLOY_TIMER_ARMED,
+        SECONDS_SINCE_TIMER_ARMED,
+        BOOTLOADER_FAULTY,
+        BOOTLOADER_SIZE,
+        BOOTLOADER_HAMMING_SIZE,
+        NUMBER_OF_ACTIVE_TASKS,
+        NUMBER_OF_FIELDS
+    };
+
+    //! Clean fields between dirty fields are written along if the gap is not larger than this
+    static constexpr size_t MAX_BRIDGED_GAP = 8;
+
+    struct Statistics {
+        uint32_t readTransactions = 0;
+        uint32_t writeTransactions = 0;
+        uint32_t bytesWritten = 0;
+        uint32_t fieldWrites = 0;
+        //! Writes which were dropped because the value did not change
+        uint32_t unchangedFieldWrites = 0;
+    };
+
+    CriticalDataCache();
+    virtual ~CriticalDataCache();
+
+    /**
+     * Read the whole critical block with one transaction. Pending writes are kept.
+     * @return
+     */
+    ReturnValue_t load();
+
+    /**
+     * Read a field. Served from the cache unless the field is a read-through field or
+     * was not loaded yet.
+     * @param field
+     * @param value
+     * @param size      Has to match the size of the field
+     * @return
+     */
+    ReturnValue_t read(Field field, uint8_t* value, size_t size);
+
+    /**
+     * Update a field in the cache. The FRAM is only written on the next flush.
+     * @param field
+     * @param value
+     * @param size      Has to match the size of the field
+     * @return
+     */
+    ReturnValue_t write(Field field, const uint8_t* value, size_t size);
+
+    template <typename T>
+    ReturnValue_t read(Field field, T* value) {
+        return read(field, reinterpret_cast<uint8_t*>(value), sizeof(T));
+    }
+
+    template <typename T>
+    ReturnValue_t write(Field field, T value) {
+        return write(field, reinterpret_cast<const uint8_t*>(&value), sizeof(T));
+    }
+
+    /**
+     * Write all dirty fields, coalescing consecutive fields into one transaction.
+     * Fields which could not be written stay dirty.
+     * @return
+     */
+    ReturnValue_t flush();
+
+    bool isDirty();
+
+    /**
+     * Drop the cached value of a field, so it is read from the FRAM on the next access.
+     * Pending writes are kept.
+     * @param field
+     */
+    void invalidate(Field field);
+    void invalidateAll();
+
+    void getStatistics(Statistics* statistics);
+    void resetStatistics();
+
+    static size_t getFieldSize(Field field);
+
+private:
+    struct FieldInfo {
+        uint8_t address;
+        uint8_t size;
+        bool readThrough;
+    };
+
+    static const FieldInfo FIELDS[NUMBER_OF_FIELDS];
+
+    MutexIF* mutex = nullptr;
+    std::array<uint8_t, sizeof(CriticalDataBlock)> block = {};
+    uint32_t dirtyFields = 0;
+    uint32_t validFields = 0;
+    //! Set if the whole block including the filler bytes has been loaded
+    bool blockLoaded = false;
+    Statistics statistics;
+
+    static_assert(NUMBER_OF_FIELDS <= 32, "Dirty and valid bits do not fit into 32 bits");
+
+    bool isSet(uint32_t mask, size_t field) const;
+    bool canBridge(size_t firstField, size_t lastField, size_t gapSize) const;
+    ReturnValue_t writeRange(size_t firstField, size_t lastField);
+};
+
+#endif /* SAM9G20_MEMORY_CRITICALDATACACHE_H_ */
@@ -0,0 +1,246 @@
+#include "DirectoryListingCache.h"
+#include "SDCAccessManager.h"
+
+#include <fsfw/ipc/MutexFactory.h>
+#include <fsfw/ipc/MutexGuard.h>
+#include <fsfw/memory/HasFileSystemIF.h>
+#include <fsfw/timemanager/Clock.h>
+
+#include <hcc/api_fat.h>
+
+#include <cctype>
+#include <cstring>
+
+DirectoryListingCache::DirectoryListingCache() {
+    mutex = MutexFactory::instance()->createMutex();
+}
+
+DirectoryListingCache::~DirectoryListingCache() {
+    MutexFactory::instance()->deleteMutex(mutex);
+}
+
+ReturnValue_t DirectoryListingCache::getEntries(const char *repositoryPath, const char *pattern,
+        size_t startIndex, Entry *entries, size_t maxEntries, size_t *numberOfEntries,
+        size_t *totalMatches) {
+    if(repositoryPath == nullptr or numberOfEntries == nullptr or totalMatches == nullptr) {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    *numberOfEntries = 0;
+    *totalMatches = 0;
+
+    uint32_t currentTimeMs = 0;
+    Clock::getUptime(&currentTimeMs);
+    VolumeId activeVolume = SDCardAccessManager::instance()->getActiveSdCard();
+
+    Slot* slot = nullptr;
+    uint32_t generation = 0;
+    {
+        MutexGuard mg(mutex);
+        Slot* cachedSlot = findSlot(repositoryPath, activeVolume, currentTimeMs);
+        if(cachedSlot != nullptr) {
+            cachedSlot->lastUseMs = currentTimeMs;
+            for(size_t idx = 0; idx < cachedSlot->numberOfEntries; idx++) {
+                collectEntry(cachedSlot->entries[idx], pattern, startIndex, entries,
+                        maxEntries, numberOfEntries, totalMatches);
+            }
+            return HasReturnvaluesIF::RETURN_OK;
+        }
+        /* Reserve a slot, it is not used by other tasks until the scan is finished. If all
+        slots are being scanned, the listing is not cached */
+        slot = getLeastRecentlyUsedSlot();
+        if(slot != nullptr) {
+            slot->valid = false;
+            slot->scanning = true;
+            slot->repositoryPath = repositoryPath;
+            generation = slot->generation;
+        }
+    }
+
+    /* The lock is not held while scanning, an invalidation during the scan changes the
+    generation of the slot so the result is discarded */
+    bool fitsIntoSlot = false;
+    ReturnValue_t result = scanRepository(repositoryPath, pattern, startIndex, entries,
+            maxEntries, numberOfEntries, totalMatches, slot, &fitsIntoSlot);
+    if(slot == nullptr) {
+        return result;
+    }
+
+    MutexGuard mg(mutex);
+    slot->scanning = false;
+    if(result == HasReturnvaluesIF::RETURN_OK and fitsIntoSlot and
+            slot->generation == generation) {
+        slot->valid = true;
+        slot->volume = activeVolume;
+        slot->creationTimeMs = currentTimeMs;
+        slot->lastUseMs = currentTimeMs;
+    }
+    return result;
+}
+
+void DirectoryListingCache::invalidate(const char *repositoryPath) {
+    if(repositoryPath == nullptr) {
+        return;
+    }
+    MutexGuard mg(mutex);
+    for(auto& slot: slots) {
+        if((slot.valid or slot.scanning) and
+                pathsEqual(slot.repositoryPath.c_str(), repositoryPath)) {
+            slot.valid = false;
+            slot.generation++;
+        }
+    }
+}
+
+void DirectoryListingCache::invalidateAll() {
+    MutexGuard mg(mutex);
+    for(auto& slot: slots) {
+        slot.valid = false;
+        slot.generation++;
+    }
+}
+
+bool DirectoryListingCache::matchesPattern(const char *pattern, const char *name) {
+    if(pattern == nullptr or pattern[0] == '\0' or std::strcmp(pattern, "*.*") == 0) {
+        return true;
+    }
+
+    /* Position after the last '*' in the pattern and the name position it was matched to,
+    used to backtrack on a mismatch */
+    const char* lastStarPattern = nullptr;
+    const char* lastStarName = nullptr;
+    while(*name != '\0') {
+        if(*pattern == '*') {
+            lastStarPattern = ++pattern;
+            lastStarName = name;
+        }
+        else if(*pattern == '?' or std::toupper(static_cast<unsigned char>(*pattern)) ==
+                std::toupper(static_cast<unsigned char>(*name))) {
+            pattern++;
+            name++;
+        }
+        else if(lastStarPattern != nullptr) {
+            pattern = lastStarPattern;
+            name = ++lastStarName;
+        }
+        else {
+            return false;
+        }
+    }
+
+    while(*pattern == '*') {
+        pattern++;
+    }
+    return *pattern == '\0';
+}
+
+DirectoryListingCache::Slot* DirectoryListingCache::findSlot(const char *repositoryPath,
+        VolumeId volume, uint32_t currentTimeMs) {
+    for(auto& slot: slots) {
+        if(not slot.valid) {
+            continue;
+        }
+        if(volume != slot.volume or currentTimeMs - slot.creationTimeMs > MAX_AGE_MS) {
+            /* Stale */
+            slot.valid = false;
+            continue;
+        }
+        if(pathsEqual(slot.repositoryPath.c_str(), repositoryPath)) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+DirectoryListingCache::Slot* DirectoryListingCache::getLeastRecentlyUsedSlot() {
+    Slot* replacedSlot = nullptr;
+    for(auto& slot: slots) {
+        if(slot.scanning) {
+            continue;
+        }
+        if(not slot.valid) {
+            return &slot;
+        }
+        if(replacedSlot == nullptr or slot.lastUseMs < replacedSlot->lastUseMs) {
+            replacedSlot = &slot;
+        }
+    }
+    return replacedSlot;
+}
+
+ReturnValue_t DirectoryListingCache::scanRepository(const char *repositoryPath,
+        const char *pattern, size_t startIndex, Entry *entries, size_t maxEntries,
+        size_t *numberOfEntries, size_t *totalMatches, Slot* slot, bool* fitsIntoSlot) {
+    int retval = change_directory(repositoryPath, true);
+    if(retval != F_NO_ERROR) {
+        return HasFileSystemIF::DIRECTORY_DOES_NOT_EXIST;
+    }
+
+    *fitsIntoSlot = slot != nullptr;
+    if(slot != nullptr) {
+        slot->numberOfEntries = 0;
+    }
+
+    F_FIND findResult;
+    int fileFound = f_findfirst("*.*", &findResult);
+    while(fileFound == F_NO_ERROR) {
+        if(std::strcmp(findResult.filename, ".") != 0 and
+                std::strcmp(findResult.filename, "..") != 0) {
+            Entry entry;
+            std::strncpy(entry.name, findResult.filename, sizeof(entry.name) - 1);
+            entry.size = findResult.filesize;
+            entry.isDirectory = (findResult.attr & F_ATTR_DIR) == F_ATTR_DIR;
+            collectEntry(entry, pattern, startIndex, entries, maxEntries, numberOfEntries,
+                    totalMatches);
+            if(*fitsIntoSlot) {
+                if(slot->numberOfEntries < slot->entries.size()) {
+                    slot->entries[slot->numberOfEntries++] = entry;
+                }
+                else {
+                    /* Too large to be cached, will be scanned again for the next request */
+                    *fitsIntoSlot = false;
+                }
+            }
+        }
+        fileFound = f_findnext(&findResult);
+    }
+
+    f_chdir("/");
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+void DirectoryListingCache::collectEntry(const Entry &entry, const char *pattern,
+        size_t startIndex, Entry *entries, size_t maxEntries, size_t *numberOfEntries,
+        size_t *totalMatches) {
+    if(not matchesPattern(pattern, entry.name)) {
+        return;
+    }
+    if(*totalMatches >= startIndex and *numberOfEntries < maxEntries and entries != nullptr) {
+        entries[(*numberOfEntries)++] = entry;
+    }
+    (*totalMatches)++;
+}
+
+bool DirectoryListingCache::pathsEqual(const char *firstPath, const char *secondPath) {
+    /* Leading and trailing slashes are ignored, FAT names are case insensitive */
+    while(*firstPath == '/') {
+        firstPath++;
+    }
+    while(*secondPath == '/') {
+        secondPath++;
+    }
+    while(*firstPath != '\0' and *secondPath != '\0') {
+        if(std::toupper(static_cast<unsigned char>(*firstPath)) !=
+                std::toupper(static_cast<unsigned char>(*secondPath))) {
+            return false;
+        }
+        firstPath++;
+        secondPath++;
+    }
+    while(*firstPath == '/') {
+        firstPath++;
+    }
+    while(*secondPath == '/') {
+        secondPath++;
+    }
+    return *firstPath == '\0' and *secondPath == '\0';
+}
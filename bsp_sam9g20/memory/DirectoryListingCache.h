@@ -0,0 +1,108 @@
+#ifndef SAM9G20_MEMORY_DIRECTORYLISTINGCACHE_H_
+#define SAM9G20_MEMORY_DIRECTORYLISTINGCACHE_H_
+
+#include "OBSWConfig.h"
+#include "sdcardDefinitions.h"
+
+#include <bsp_sam9g20/common/SDCardApi.h>
+
+#include <fsfw/returnvalues/HasReturnvaluesIF.h>
+
+#include <array>
+
+class MutexIF;
+
+/**
+ * @brief   Small cache of recently listed directories of the active SD card.
+ * @details
+ * Listing a large directory requires iterating through all of its entries, even if only
+ * a page of it is requested. Therefore, the complete listing of a directory is cached if it
+ * fits into a cache slot, so that consecutive page requests and find requests on the same
+ * directory can be served from RAM. Directories with more entries are scanned for each
+ * request.
+ *
+ * The SD card handler invalidates cached directories when files or directories are created,
+ * deleted or renamed. Other components may write to the SD card directly, so cached listings
+ * also expire after a fixed time. The cache can be used from the handler and the I/O worker
+ * task. The slots are protected by a mutex, but the SD card is scanned without holding it, so
+ * that invalidations are not blocked by a scan on another task. A slot is reserved for the
+ * duration of a scan and is only filled if it was not invalidated in the meantime.
+ */
+class DirectoryListingCache {
+public:
+    static constexpr uint8_t NUMBER_OF_SLOTS = config::SD_CARD_LISTING_CACHE_SLOTS;
+    static constexpr size_t MAX_ENTRIES_PER_SLOT = config::SD_CARD_LISTING_CACHE_ENTRIES;
+    static constexpr uint32_t MAX_AGE_MS = config::SD_CARD_LISTING_CACHE_MAX_AGE_MS;
+
+    struct Entry {
+        char name[MAX_FILENAME_LENGTH + 1] = {};
+        uint32_t size = 0;
+        bool isDirectory = false;
+    };
+
+    DirectoryListingCache();
+    virtual ~DirectoryListingCache();
+
+    /**
+     * Get the entries of a repository which match a pattern. The SD card needs to be
+     * accessible if the repository is not cached.
+     * @param repositoryPath
+     * @param pattern           Wildcard pattern, see matchesPattern. nullptr matches all entries
+     * @param startIndex        Index of the first matching entry to copy
+     * @param entries           Destination for the matching entries
+     * @param maxEntries        Capacity of the destination
+     * @param numberOfEntries   Number of copied entries
+     * @param totalMatches      Number of all matching entries in the repository
+     * @return
+     *  - RETURN_OK on success
+     *  - HasFileSystemIF::DIRECTORY_DOES_NOT_EXIST if the repository does not exist
+     */
+    ReturnValue_t getEntries(const char* repositoryPath, const char* pattern, size_t startIndex,
+            Entry* entries, size_t maxEntries, size_t* numberOfEntries, size_t* totalMatches);
+
+    /**
+     * Invalidate the cached listing of a repository.
+     * @param repositoryPath
+     */
+    void invalidate(const char* repositoryPath);
+    void invalidateAll();
+
+    /**
+     * Case insensitive wildcard matching. '*' matches any sequence of characters and '?'
+     * matches a single character. Like on the FAT file system, "*.*" matches all names,
+     * including names without extension.
+     * @param pattern
+     * @param name
+     * @return
+     */
+    static bool matchesPattern(const char* pattern, const char* name);
+
+private:
+    struct Slot {
+        RepositoryPath repositoryPath;
+        VolumeId volume = SD_CARD_0;
+        uint32_t creationTimeMs = 0;
+        uint32_t lastUseMs = 0;
+        size_t numberOfEntries = 0;
+        bool valid = false;
+        //! Reserved by a task which is scanning the repository into the slot
+        bool scanning = false;
+        //! Incremented on each invalidation of the repository
+        uint32_t generation = 0;
+        std::array<Entry, MAX_ENTRIES_PER_SLOT> entries;
+    };
+
+    MutexIF* mutex = nullptr;
+    std::array<Slot, NUMBER_OF_SLOTS> slots;
+
+    Slot* findSlot(const char* repositoryPath, VolumeId volume, uint32_t currentTimeMs);
+    Slot* getLeastRecentlyUsedSlot();
+    ReturnValue_t scanRepository(const char* repositoryPath, const char* pattern,
+            size_t startIndex, Entry* entries, size_t maxEntries, size_t* numberOfEntries,
+            size_t* totalMatches, Slot* slot, bool* fitsIntoSlot);
+    static void collectEntry(const Entry& entry, const char* pattern, size_t startIndex,
+            Entry* entries, size_t maxEntries, size_t* numberOfEntries, size_t* totalMatches);
+    static bool pathsEqual(const char* firstPath, const char* secondPath);
+};
+
+#endif /* SAM9G20_MEMORY_DIRECTORYLISTINGCACHE_H_ */
@@ -131,6 +131,15 @@ ReturnValue_t FRAMHandler::initialize() {
 #endif
     }
 
+    if(criticalDataCache.load() != HasReturnvaluesIF::RETURN_OK) {
+#if FSFW_CPP_OSTREAM_ENABLED == 1
+        sif::warning << "FRAMHandler::initialize: Loading critical data cache failed"
+                << std::endl;
+#else
+        sif::printWarning("FRAMHandler::initialize: Loading critical data cache failed\n");
+#endif
+    }
+
     // sif::printInfo("FRAM maximum address: %d\n\r", FRAM_getMaxAddress());
     return HasReturnvaluesIF::RETURN_OK;
 }
@@ -138,6 +147,10 @@ ReturnValue_t FRAMHandler::initialize() {
 void FRAMHandler::dumpCriticalBlock() {
 }
 
+CriticalDataCache& FRAMHandler::getCriticalDataCache() {
+    return criticalDataCache;
+}
+
 ReturnValue_t FRAMHandler::zeroOutDefaultZeroFields(int* errorField) {
     int result = fram_zero_out_default_zero_fields();
     if(result != 0) {
@@ -2,6 +2,7 @@
 #define SAM9G20_MEMORY_FRAMHANDLER_H_
 
 #include "OBSWConfig.h"
+#include "CriticalDataCache.h"
 
 #include "bsp_sam9g20/common/fram/FRAMApi.h"
 #include "bsp_sam9g20/common/fram/CommonFRAM.h"
@@ -51,6 +52,13 @@ public:
 	 */
 	static ReturnValue_t zeroOutDefaultZeroFields(int* errorField);
 
+	/**
+	 * Cache for the critical block which is loaded on initialization. Fields updated
+	 * periodically should be written with the cache to reduce the SPI traffic.
+	 * The cache has to be reloaded after writing owned fields with the FRAM API.
+	 */
+	CriticalDataCache& getCriticalDataCache();
+
 protected:
 	static std::array<uint8_t, sizeof(CriticalDataBlock)> criticalBlock;
 
@@ -63,6 +71,8 @@ protected:
 	virtual ReturnValue_t initialize() override;
 
 private:
+	CriticalDataCache criticalDataCache;
+
 	static void genericBlockPrinter(size_t blockSize);
 };
 
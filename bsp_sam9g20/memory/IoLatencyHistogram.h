@@ -0,0 +1,103 @@
+#ifndef SAM9G20_MEMORY_IOLATENCYHISTOGRAM_H_
+#define SAM9G20_MEMORY_IOLATENCYHISTOGRAM_H_
+
+#include <fsfw/serialize/SerializeAdapter.h>
+#include <fsfw/serialize/SerializeIF.h>
+
+#include <array>
+#include <cstdint>
+
+/**
+ * @brief   Simple latency histogram with logarithmic bins, used to track how long
+ *          file system requests take.
+ * @details
+ * Bin n counts all samples with a latency smaller than 2^n milliseconds, the last bin
+ * counts all remaining samples. Minimum, maximum and sum are tracked as well so the mean
+ * latency can be calculated on ground.
+ */
+class IoLatencyHistogram: public SerializeIF {
+public:
+    static constexpr uint8_t NUMBER_OF_BINS = 10;
+
+    IoLatencyHistogram() {
+        reset();
+    }
+
+    void addSample(uint32_t latencyMs) {
+        uint8_t binIdx = 0;
+        while((binIdx < NUMBER_OF_BINS - 1) and (latencyMs >= (1u << binIdx))) {
+            binIdx++;
+        }
+        bins[binIdx]++;
+        sampleCount++;
+        latencySumMs += latencyMs;
+        if(latencyMs < minLatencyMs) {
+            minLatencyMs = latencyMs;
+        }
+        if(latencyMs > maxLatencyMs) {
+            maxLatencyMs = latencyMs;
+        }
+    }
+
+    void reset() {
+        bins.fill(0);
+        sampleCount = 0;
+        latencySumMs = 0;
+        minLatencyMs = UINT32_MAX;
+        maxLatencyMs = 0;
+    }
+
+    uint32_t getSampleCount() const {
+        return sampleCount;
+    }
+
+    uint32_t getMeanLatencyMs() const {
+        if(sampleCount == 0) {
+            return 0;
+        }
+        return latencySumMs / sampleCount;
+    }
+
+    ReturnValue_t serialize(uint8_t **buffer, size_t *size, size_t maxSize,
+            Endianness streamEndianness) const override {
+        uint32_t minLatency = minLatencyMs;
+        if(sampleCount == 0) {
+            minLatency = 0;
+        }
+        uint32_t meanLatency = getMeanLatencyMs();
+        const uint32_t* fields[] = {&sampleCount, &minLatency, &meanLatency, &maxLatencyMs};
+        for(const uint32_t* field: fields) {
+            ReturnValue_t result = SerializeAdapter::serialize(field, buffer, size, maxSize,
+                    streamEndianness);
+            if(result != HasReturnvaluesIF::RETURN_OK) {
+                return result;
+            }
+        }
+        for(const uint32_t& bin: bins) {
+            ReturnValue_t result = SerializeAdapter::serialize(&bin, buffer, size, maxSize,
+                    streamEndianness);
+            if(result != HasReturnvaluesIF::RETURN_OK) {
+                return result;
+            }
+        }
+        return HasReturnvaluesIF::RETURN_OK;
+    }
+
+    size_t getSerializedSize() const override {
+        return 4 * sizeof(uint32_t) + NUMBER_OF_BINS * sizeof(uint32_t);
+    }
+
+    ReturnValue_t deSerialize(const uint8_t **buffer, size_t *size,
+            Endianness streamEndianness) override {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+
+private:
+    std::array<uint32_t, NUMBER_OF_BINS> bins;
+    uint32_t sampleCount = 0;
+    uint64_t latencySumMs = 0;
+    uint32_t minLatencyMs = UINT32_MAX;
+    uint32_t maxLatencyMs = 0;
+};
+
+#endif /* SAM9G20_MEMORY_IOLATENCYHISTOGRAM_H_ */
@@ -0,0 +1,131 @@
+#include "PersistentCounterRing.h"
+#include "OBSWConfig.h"
+
+#include <bsp_sam9g20/common/fram/FRAMApi.h>
+
+#include <fsfw/globalfunctions/CRC.h>
+#include <fsfw/serviceinterface/ServiceInterface.h>
+
+#include <cstring>
+
+PersistentCounterRing::PersistentCounterRing(uint32_t ringAddress, size_t ringSize):
+        ringAddress(ringAddress), numberOfSlots(ringSize / sizeof(Record)) {
+    /* The first append goes to slot 0 */
+    newestSlot = numberOfSlots - 1;
+}
+
+ReturnValue_t PersistentCounterRing::recover() {
+    if(numberOfSlots == 0) {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    Record record;
+    if(readRecord(0, &record) != HasReturnvaluesIF::RETURN_OK) {
+        /* Slot 0 was never written, writing it was interrupted after the ring wrapped around
+        or it was corrupted later. The newest record can be in any slot for the latter case. */
+        return scanAllSlots();
+    }
+
+    /* Slots 0 to newest hold consecutive sequence numbers, the following slots hold older
+    records from the previous round or invalid records */
+    uint32_t firstSequenceNumber = record.sequenceNumber;
+    takeRecord(0, record);
+    size_t lower = 0;
+    size_t upper = numberOfSlots;
+    while(upper - lower > 1) {
+        size_t middle = lower + (upper - lower) / 2;
+        if(readRecord(middle, &record) == HasReturnvaluesIF::RETURN_OK and
+                record.sequenceNumber == firstSequenceNumber + middle) {
+            takeRecord(middle, record);
+            lower = middle;
+        }
+        else {
+            upper = middle;
+        }
+    }
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t PersistentCounterRing::append(const Counters& newCounters) {
+    if(numberOfSlots == 0) {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    size_t slot = (newestSlot + 1) % numberOfSlots;
+    Record record = {};
+    record.sequenceNumber = sequenceNumber + 1;
+    std::memcpy(record.counters, newCounters.data(), sizeof(record.counters));
+    record.crc = CRC::crc16ccitt(reinterpret_cast<const uint8_t*>(&record),
+            offsetof(Record, crc));
+    int result = fram_write_counter_ring_range(ringAddress + slot * sizeof(Record),
+            reinterpret_cast<const uint8_t*>(&record), sizeof(Record));
+    if(result != 0) {
+#if OBSW_VERBOSE_LEVEL >= 1
+        sif::printWarning("PersistentCounterRing::append: Writing slot %lu failed with "
+                "code %d\n", static_cast<unsigned long>(slot), result);
+#endif
+        /* The next append writes the same slot again */
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    takeRecord(slot, record);
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+uint32_t PersistentCounterRing::getCounter(uint8_t index) const {
+    if(index >= NUMBER_OF_COUNTERS) {
+        return 0;
+    }
+    return counters[index];
+}
+
+const PersistentCounterRing::Counters& PersistentCounterRing::getCounters() const {
+    return counters;
+}
+
+uint32_t PersistentCounterRing::getSequenceNumber() const {
+    return sequenceNumber;
+}
+
+size_t PersistentCounterRing::getNumberOfSlots() const {
+    return numberOfSlots;
+}
+
+ReturnValue_t PersistentCounterRing::readRecord(size_t slot, Record* record) {
+    int result = fram_read_counter_ring_range(ringAddress + slot * sizeof(Record),
+            reinterpret_cast<uint8_t*>(record), sizeof(Record));
+    if(result != 0) {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    uint16_t crc = CRC::crc16ccitt(reinterpret_cast<const uint8_t*>(record),
+            offsetof(Record, crc));
+    if(crc != record->crc) {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+void PersistentCounterRing::takeRecord(size_t slot, const Record& record) {
+    newestSlot = slot;
+    sequenceNumber = record.sequenceNumber;
+    std::memcpy(counters.data(), record.counters, sizeof(record.counters));
+}
+
+/**
+ * Fallback if the first slot is not valid, the record with the highest sequence number
+ * is the newest one.
+ */
+ReturnValue_t PersistentCounterRing::scanAllSlots() {
+    bool found = false;
+    Record record;
+    for(size_t slot = 0; slot < numberOfSlots; slot++) {
+        if(readRecord(slot, &record) != HasReturnvaluesIF::RETURN_OK) {
+            continue;
+        }
+        if(not found or static_cast<int32_t>(record.sequenceNumber - sequenceNumber) > 0) {
+            takeRecord(slot, record);
+            found = true;
+        }
+    }
+    if(not found) {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    return HasReturnvaluesIF::RETURN_OK;
+}
@@ -0,0 +1,77 @@
+#ifndef SAM9G20_MEMORY_PERSISTENTCOUNTERRING_H_
+#define SAM9G20_MEMORY_PERSISTENTCOUNTERRING_H_
+
+#include <fsfw/returnvalues/HasReturnvaluesIF.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief   Persistent counters which are stored as a ring of records in the counter ring
+ *          region of the (virtualized) FRAM.
+ * @details
+ * Every update appends a complete record with all counter values, an incrementing sequence
+ * number and a CRC16 to the slot following the newest record. An update is therefore a
+ * single small write without reading the old value first, and the writes are spread over
+ * all slots of the ring. If a write is interrupted, only the record in that slot is invalid
+ * and the previous record is still available.
+ *
+ * Since slot n contains sequence number s0 + n for all slots written since slot 0 was last
+ * written, the newest record is found with a binary search over the slots on startup.
+ *
+ * Not thread-safe, the ring is intended to be owned by one component. The FRAM has to be
+ * accessible, which requires an SD card access token for the virtualized FRAM of the
+ * AT91 board.
+ */
+class PersistentCounterRing {
+public:
+    static constexpr uint8_t NUMBER_OF_COUNTERS = 4;
+    using Counters = std::array<uint32_t, NUMBER_OF_COUNTERS>;
+
+    /**
+     * @param ringAddress   Offset of the ring inside the counter ring region
+     * @param ringSize      Size of the ring, determines the number of slots
+     */
+    PersistentCounterRing(uint32_t ringAddress, size_t ringSize);
+
+    /**
+     * Find the newest valid record and load its counter values.
+     * @return RETURN_FAILED if no valid record was found, the counters are zero in that case
+     */
+    ReturnValue_t recover();
+
+    /**
+     * Store the given counter values in the slot following the newest record.
+     * @param counters
+     * @return
+     */
+    ReturnValue_t append(const Counters& counters);
+
+    uint32_t getCounter(uint8_t index) const;
+    const Counters& getCounters() const;
+    uint32_t getSequenceNumber() const;
+    size_t getNumberOfSlots() const;
+
+private:
+    struct __attribute__((packed)) Record {
+        uint32_t sequenceNumber;
+        uint32_t counters[NUMBER_OF_COUNTERS];
+        uint16_t reserved;
+        //! CRC16-CCITT of all preceding fields
+        uint16_t crc;
+    };
+
+    uint32_t ringAddress;
+    size_t numberOfSlots;
+
+    size_t newestSlot;
+    uint32_t sequenceNumber = 0;
+    Counters counters = {};
+
+    ReturnValue_t readRecord(size_t slot, Record* record);
+    void takeRecord(size_t slot, const Record& record);
+    ReturnValue_t scanAllSlots();
+};
+
+#endif /* SAM9G20_MEMORY_PERSISTENTCOUNTERRING_H_ */
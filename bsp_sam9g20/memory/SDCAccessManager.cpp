@@ -1,4 +1,5 @@
 #include "SDCAccessManager.h"
+#include "SDCardAccess.h"
 
 #ifdef ISIS_OBC_G20
 #include <bsp_sam9g20/common/fram/FRAMApi.h>
@@ -7,7 +8,8 @@
 #include <fsfw/ipc/MutexIF.h>
 #include <fsfw/ipc/MutexFactory.h>
 #include <fsfw/serviceinterface/ServiceInterface.h>
-#include <fsfw/ipc/MutexGuard.h>
+
+#include <hcc/api_fs_err.h>
 
 
 SDCardAccessManager* SDCardAccessManager::factoryInstance = nullptr;
@@ -38,11 +40,13 @@ SDCardAccessManager::SDCardAccessManager() {
                 "Could not get active SD Card\n");
     }
 #endif
-    mutex = MutexFactory::instance()->createMutex();
+    stateMutex = MutexFactory::instance()->createMutex();
+    volumeMutex = MutexFactory::instance()->createMutex();
 }
 
 SDCardAccessManager::~SDCardAccessManager() {
-    MutexFactory::instance()->deleteMutex(mutex);
+    MutexFactory::instance()->deleteMutex(stateMutex);
+    MutexFactory::instance()->deleteMutex(volumeMutex);
 }
 
 
@@ -50,32 +54,167 @@ bool SDCardAccessManager::getSdCardChangeOngoing() const {
 #ifndef ISIS_OBC_G20
     return false;
 #else
-    MutexGuard(mutex, MutexIF::TimeoutType::WAITING, config::SD_CARD_ACCESS_MUTEX_TIMEOUT);
+    /* Only a single flag is read, so no locking is required */
     return changingSdCard;
 #endif
 }
 
+ReturnValue_t SDCardAccessManager::acquireAccess(VolumeId& volumeId, int& fileSystemResult) {
+    fileSystemResult = F_NO_ERROR;
+    ReturnValue_t result = lockState(false);
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    if(changingSdCard) {
+        statistics.deniedAccesses++;
+        stateMutex->unlockMutex();
+        return SDCardAccess::SD_CARD_CHANGE_ONGOING;
+    }
+
+    /* Cheap path: The volume is already mounted, only register this task with the file
+    system */
+    if(volumeMounted) {
+        registerAccess(false);
+        volumeId = activeSdCard;
+        int result = mountResult;
+        stateMutex->unlockMutex();
+        fileSystemResult = joinFileSystem(result);
+        return HasReturnvaluesIF::RETURN_OK;
+    }
+    stateMutex->unlockMutex();
+
+    /* Exclusive path: The first access mounts the volume. Other accesses wait on the volume
+    mutex until the volume is mounted and then join it. */
+    bool volumeLockContended = lockVolume();
+    lockState(true);
+    if(volumeLockContended) {
+        statistics.volumeLockContentions++;
+    }
+    if(changingSdCard) {
+        statistics.deniedAccesses++;
+        stateMutex->unlockMutex();
+        volumeMutex->unlockMutex();
+        return SDCardAccess::SD_CARD_CHANGE_ONGOING;
+    }
+    volumeId = activeSdCard;
+    if(volumeMounted) {
+        registerAccess(false);
+        int result = mountResult;
+        stateMutex->unlockMutex();
+        volumeMutex->unlockMutex();
+        fileSystemResult = joinFileSystem(result);
+        return HasReturnvaluesIF::RETURN_OK;
+    }
+    stateMutex->unlockMutex();
+
+    fileSystemResult = open_filesystem();
+    int selectResult = select_sd_card(volumeId, true);
+    if(fileSystemResult == F_NO_ERROR) {
+        fileSystemResult = selectResult;
+    }
+
+    /* Even for failed cases, the volume is marked as mounted so the last access performs
+    a full teardown of the file system. The result is stored so that accesses joining the
+    failed volume fail as well. */
+    lockState(true);
+    volumeMounted = true;
+    mountResult = fileSystemResult;
+    registerAccess(true);
+    stateMutex->unlockMutex();
+    volumeMutex->unlockMutex();
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+int SDCardAccessManager::joinFileSystem(int volumeMountResult) {
+    /* The file system is entered in any case, because every access releases it */
+    int result = f_enterFS();
+    if(volumeMountResult != F_NO_ERROR) {
+        return volumeMountResult;
+    }
+    return result;
+}
+
+void SDCardAccessManager::releaseAccess() {
+    lockState(true);
+    if(activeAccesses > 1) {
+        activeAccesses--;
+        stateMutex->unlockMutex();
+        f_releaseFS();
+        return;
+    }
+    stateMutex->unlockMutex();
+
+    /* Probably the last access. The volume mutex is taken first so no other access can
+    mount the volume again while it is unmounted. */
+    bool volumeLockContended = lockVolume();
+    lockState(true);
+    if(volumeLockContended) {
+        statistics.volumeLockContentions++;
+    }
+    if(activeAccesses > 0) {
+        activeAccesses--;
+    }
+    bool lastAccess = activeAccesses == 0;
+    if(lastAccess) {
+        volumeMounted = false;
+    }
+    stateMutex->unlockMutex();
+
+    /* Only delete the volume if no other access is using it anymore */
+    if(lastAccess) {
+        /* The active SD card is always mounted as the primary drive */
+        int result = f_delvolume(PRIMARY_DRIVE);
+        if(result != F_NO_ERROR) {
+            sif::printWarning("SDCardAccessManager::releaseAccess: f_delvolume failed with"
+                    " code %d.\n", result);
+        }
+    }
+    f_releaseFS();
+    if(lastAccess) {
+        close_filesystem(false, false, VolumeId::SD_CARD_0);
+    }
+    volumeMutex->unlockMutex();
+}
+
 /* Only one manager class is supposed to call this! */
 bool SDCardAccessManager::tryActiveSdCardChange() {
 #ifndef ISIS_OBC_G20
     return true;
 #else
-    MutexGuard(mutex, MutexIF::TimeoutType::WAITING, config::SD_CARD_ACCESS_MUTEX_TIMEOUT);
-    if(this->changingSdCard == false) {
-        this->changingSdCard = true;
+    lockState(true);
+    /* New accesses are denied from now on */
+    changingSdCard = true;
+    if(activeAccesses > 0) {
+        statistics.deferredSdCardChanges++;
+        stateMutex->unlockMutex();
+        return false;
     }
+    stateMutex->unlockMutex();
+
+    /* Wait until a pending mount or unmount is complete */
+    bool volumeLockContended = lockVolume();
+    lockState(true);
+    if(volumeLockContended) {
+        statistics.volumeLockContentions++;
+    }
+    bool changeSuccess = false;
     /* No task is using the SD cards anymore, so we can safely switch the active SD card. */
-    if(this->activeAccesses == 0) {
-        if(this->activeSdCard == SD_CARD_0) {
-            this->activeSdCard = SD_CARD_1;
+    if(activeAccesses == 0 and not volumeMounted) {
+        if(activeSdCard == SD_CARD_0) {
+            activeSdCard = SD_CARD_1;
         }
         else {
-            this->activeSdCard = SD_CARD_0;
+            activeSdCard = SD_CARD_0;
         }
-        this->changingSdCard = false;
-        return true;
+        changingSdCard = false;
+        changeSuccess = true;
     }
-    return false;
+    else {
+        statistics.deferredSdCardChanges++;
+    }
+    stateMutex->unlockMutex();
+    volumeMutex->unlockMutex();
+    return changeSuccess;
 #endif
 }
 
@@ -83,3 +222,58 @@ VolumeId SDCardAccessManager::getActiveSdCard() const {
     return activeSdCard;
 }
 
+SDCardAccessManager::AccessStatistics SDCardAccessManager::getAccessStatistics() const {
+    lockState(true);
+    AccessStatistics statisticsCopy = statistics;
+    stateMutex->unlockMutex();
+    return statisticsCopy;
+}
+
+void SDCardAccessManager::resetAccessStatistics() {
+    lockState(true);
+    statistics = AccessStatistics();
+    stateMutex->unlockMutex();
+}
+
+void SDCardAccessManager::registerAccess(bool volumeMount) {
+    activeAccesses++;
+    if(volumeMount) {
+        statistics.volumeMounts++;
+    }
+    else {
+        statistics.sharedAccesses++;
+    }
+    if(activeAccesses > statistics.maxConcurrentAccesses) {
+        statistics.maxConcurrentAccesses = activeAccesses;
+    }
+}
+
+ReturnValue_t SDCardAccessManager::lockState(bool blocking) const {
+    ReturnValue_t result = stateMutex->lockMutex(MutexIF::TimeoutType::POLLING, 0);
+    if(result == HasReturnvaluesIF::RETURN_OK) {
+        return result;
+    }
+    if(blocking) {
+        result = stateMutex->lockMutex(MutexIF::TimeoutType::BLOCKING, 0);
+    }
+    else {
+        result = stateMutex->lockMutex(MutexIF::TimeoutType::WAITING,
+                config::SD_CARD_ACCESS_MUTEX_TIMEOUT);
+    }
+    if(result == HasReturnvaluesIF::RETURN_OK) {
+        /* Only counted while the lock is held */
+        statistics.stateLockContentions++;
+    }
+    return result;
+}
+
+bool SDCardAccessManager::lockVolume() {
+    /* The volume mutex is only held while the volume is mounted, unmounted or switched,
+    so waiting for it is bounded */
+    ReturnValue_t result = volumeMutex->lockMutex(MutexIF::TimeoutType::POLLING, 0);
+    if(result == HasReturnvaluesIF::RETURN_OK) {
+        return false;
+    }
+    volumeMutex->lockMutex(MutexIF::TimeoutType::BLOCKING, 0);
+    return true;
+}
@@ -4,6 +4,10 @@
 #include "OBSWConfig.h"
 #include <bsp_sam9g20/common/SDCardApi.h>
 
+#include <fsfw/returnvalues/HasReturnvaluesIF.h>
+
+#include <cstdint>
+
 class MutexIF;
 
 /**
@@ -12,13 +16,35 @@ class MutexIF;
  * @details
  * This class will cache the currently active SD card. It is always used by the SD card access
  * token automatically to get the currently active SD card in a  thread safe way and it is
- * also used to determine if a SD card switch is currently going on.
+ * also used to determine if a SD card change is going on.
+ *
+ * Accesses are handled like readers of a reader-writer lock. The state mutex is only held to
+ * update the access counter, so accesses to an already mounted volume do not wait for each
+ * other. Only the first access, which mounts the volume, the last access, which unmounts it,
+ * and a SD card change, which is the writer and waits for all accesses to drain, take the
+ * volume mutex.
  */
 class SDCardAccessManager {
     friend class SDCardHandler;
     friend class SDCardAccess;
     friend class SDCHStateMachine;
 public:
+    struct AccessStatistics {
+        //! Accesses which joined an already mounted volume
+        uint32_t sharedAccesses = 0;
+        //! Accesses which had to mount the volume
+        uint32_t volumeMounts = 0;
+        //! Accesses which were denied because of a SD card change
+        uint32_t deniedAccesses = 0;
+        //! Number of times the state mutex was not immediately available
+        uint32_t stateLockContentions = 0;
+        //! Number of times the volume mutex was not immediately available
+        uint32_t volumeLockContentions = 0;
+        //! SD card change attempts which had to wait for accesses to drain
+        uint32_t deferredSdCardChanges = 0;
+        uint8_t maxConcurrentAccesses = 0;
+    };
+
     virtual ~SDCardAccessManager();
 
     static void create();
@@ -37,20 +63,62 @@ public:
 
     VolumeId getActiveSdCard() const;
 
+    AccessStatistics getAccessStatistics() const;
+    void resetAccessStatistics();
+
 private:
     SDCardAccessManager();
-    MutexIF* mutex;
+    MutexIF* stateMutex;
+    MutexIF* volumeMutex;
+
+    /**
+     * Called by the SD card access token to register an access. Mounts the active SD card
+     * if this is the first access.
+     * @param volumeId Active SD card used by the access
+     * @param fileSystemResult Result of mounting the volume or registering the task with
+     * the file system
+     * @return
+     *  - RETURN_OK if the access was granted. The access has to be released with
+     *    releaseAccess, even if the file system result is not F_NO_ERROR
+     *  - SDCardAccess::SD_CARD_CHANGE_ONGOING if the access was denied
+     *  - RETURN_FAILED if the state could not be locked
+     */
+    ReturnValue_t acquireAccess(VolumeId& volumeId, int& fileSystemResult);
+    /**
+     * Called by the SD card access token to unregister an access. Unmounts the active
+     * SD card if this was the last access.
+     */
+    void releaseAccess();
 
     /**
      * Called by the SD card manager class to change the active SD card.
      * @return
      */
     bool tryActiveSdCardChange();
+
+    void registerAccess(bool volumeMount);
+    ReturnValue_t lockState(bool blocking) const;
+    /**
+     * Locks the volume mutex.
+     * @return True if the volume mutex was not immediately available
+     */
+    bool lockVolume();
+    /**
+     * Enter the file system for an access joining the mounted volume.
+     * @return Result of mounting the volume if it failed, otherwise the result of f_enterFS
+     */
+    int joinFileSystem(int volumeMountResult);
+
     bool changingSdCard = false;
+    bool volumeMounted = false;
+    /* Result of the last volume mount, valid while the volume is mounted */
+    int mountResult = 0;
 
     uint8_t activeAccesses = 0;
     VolumeId activeSdCard = SD_CARD_0;
 
+    mutable AccessStatistics statistics;
+
     static SDCardAccessManager* factoryInstance;
 };
 
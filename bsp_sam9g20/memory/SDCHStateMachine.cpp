@@ -8,7 +8,14 @@
 #include <bsp_sam9g20/common/SDCardApi.h>
 #include <bsp_sam9g20/memory/HCCFileGuard.h>
 
+#include <mission/utility/Crc32.h>
+
+#include <fsfw/globalfunctions/CRC.h>
 #include <fsfw/timemanager/Countdown.h>
+#include <fsfw/timemanager/Clock.h>
+#include <fsfw/serviceinterface/ServiceInterface.h>
+
+#include <cstdio>
 
 
 SDCHStateMachine::SDCHStateMachine(SDCardHandler* owner, Countdown* ownerCountdown):
@@ -21,13 +28,16 @@ ReturnValue_t SDCHStateMachine::continueCurrentOperation() {
         break;
     }
     case(this->States::SPLITTING_FILE): {
-        break;
+        return handleSplitOperation();
     }
     case(this->States::COPY_FILE): {
         return handleGenericCopyOperation();
     }
     case(this->States::MOVE_FILE): {
-        break;
+        return handleMoveOperation();
+    }
+    case(this->States::CHECKSUM_FILE): {
+        return handleChecksumOperation();
     }
     default: {
         break;
@@ -44,22 +54,72 @@ void SDCHStateMachine::resetAndSetToIdle() {
 
 bool SDCHStateMachine::setCopyFileOperation(RepositoryPath &sourceRepo, FileName &sourceName,
         RepositoryPath &targetRepo, FileName &targetName, MessageQueueId_t recipient) {
+    return setGenericSourceTargetOperation(this->States::COPY_FILE, sourceRepo, sourceName,
+            targetRepo, targetName, recipient);
+}
+
+bool SDCHStateMachine::setMoveFileOperation(RepositoryPath &sourceRepo, FileName &sourceName,
+        RepositoryPath &targetRepo, FileName &targetName, MessageQueueId_t recipient) {
+    return setGenericSourceTargetOperation(this->States::MOVE_FILE, sourceRepo, sourceName,
+            targetRepo, targetName, recipient);
+}
+
+bool SDCHStateMachine::setSplitFileOperation(RepositoryPath &sourceRepo, FileName &sourceName,
+        RepositoryPath &targetRepo, FileName &partBaseName, size_t partSize,
+        MessageQueueId_t recipient) {
+    /* The part index extension is appended to the base name */
+    if(partSize == 0 or partBaseName.size() + 4 > MAX_FILENAME_LENGTH) {
+        return false;
+    }
+    bool success = setGenericSourceTargetOperation(this->States::SPLITTING_FILE, sourceRepo,
+            sourceName, targetRepo, partBaseName, recipient);
+    if(success) {
+        this->partSize = partSize;
+    }
+    return success;
+}
+
+bool SDCHStateMachine::setChecksumOperation(RepositoryPath &repoPath, FileName &fileName,
+        uint8_t checksumType, MessageQueueId_t recipient) {
+    if(internalState != this->States::IDLE) {
+        return false;
+    }
+    if(checksumType != sdchandler::CRC32 and checksumType != sdchandler::CRC16_CCITT) {
+        return false;
+    }
+    this->path1 = repoPath;
+    this->fileName1 = fileName;
+    this->checksumType = checksumType;
+    this->currentRecipient = recipient;
+
+    currentByteIdx = 0;
+    stepCounter = 0;
+    bytesPerMs = 0;
+    internalState = this->States::CHECKSUM_FILE;
+    return true;
+}
+
+bool SDCHStateMachine::setGenericSourceTargetOperation(States state,
+        RepositoryPath &sourceRepo, FileName &sourceName, RepositoryPath &targetRepo,
+        FileName &targetName, MessageQueueId_t recipient) {
+    if (internalState != this->States::IDLE) {
+        return false;
+    }
     this->path1 = sourceRepo;
     this->fileName1 = sourceName;
     this->path2 = targetRepo;
     this->fileName2 = targetName;
     this->currentRecipient = recipient;
-    if (internalState != this->States::IDLE) {
-        return false;
-    }
 
     currentByteIdx = 0;
     stepCounter = 0;
-    internalState = this->States::COPY_FILE;
+    bytesPerMs = 0;
+    internalState = state;
     return true;
 }
 
 void SDCHStateMachine::reset() {
+    closeFiles();
     path1 = "";
     fileName1 = "";
     path2 = "";
@@ -67,55 +127,73 @@ void SDCHStateMachine::reset() {
     currentByteIdx = 0;
     currentFileSize = 0;
     stepCounter = 0;
+    bytesPerMs = 0;
+    operationStartMs = 0;
+    partSize = 0;
+    partIdx = 0;
+    bytesInPart = 0;
+    checksumType = 0;
+    checksum = 0;
     currentRecipient = MessageQueueIF::NO_QUEUE;
 }
 
+int SDCHStateMachine::closeFiles() {
+    if(sourceFile != nullptr) {
+        f_close(sourceFile);
+        sourceFile = nullptr;
+    }
+    int result = F_NO_ERROR;
+    if(targetFile != nullptr) {
+        result = f_close(targetFile);
+        if(result != F_NO_ERROR) {
+#if FSFW_CPP_OSTREAM_ENABLED == 1
+            sif::error << "SDCHStateMachine::closeFiles: Closing target file failed with code "
+                    << result << std::endl;
+#else
+            sif::printError("SDCHStateMachine::closeFiles: Closing target file failed with "
+                    "code %d\n", result);
+#endif
+        }
+        targetFile = nullptr;
+    }
+    return result;
+}
+
 SDCHStateMachine::States SDCHStateMachine::getInternalState() const {
     return internalState;
 }
 
-ReturnValue_t SDCHStateMachine::prepareCopyFileInformation(F_FILE** filePtr) {
-    if(filePtr == nullptr) {
-        return HasReturnvaluesIF::RETURN_FAILED;
-    }
-    int result = 0;
-    result = change_directory(path1.c_str(), true);
+ReturnValue_t SDCHStateMachine::openSourceFile() {
+    int result = change_directory(path1.c_str(), true);
     if(result != F_NO_ERROR) {
         /* Changing directory failed! Repository might not exist, so we should just cancel
         the algorithm */
+        owner->sendCompletionMessage(false, currentRecipient,
+                HasFileSystemIF::DIRECTORY_DOES_NOT_EXIST, result);
         return HasReturnvaluesIF::RETURN_FAILED;
     }
 
-    /* Current file size only needs to be cached once.
-    Info output should only be printed once. */
-    if(stepCounter == 0) {
-        long readFileLength = f_filelength(fileName1.c_str());
-        if(readFileLength < 0) {
-            /* File might not exist so we should just cancel the algorithm */
-            return HasReturnvaluesIF::RETURN_FAILED;
-        }
-        currentFileSize = readFileLength;
-    }
-
-    *filePtr = f_open(fileName1.c_str(), "r");
-    if(f_getlasterror() != F_NO_ERROR) {
-        /* Opening file failed! */
+    long readFileLength = f_filelength(fileName1.c_str());
+    if(readFileLength < 0) {
+        /* File might not exist so we should just cancel the algorithm */
+        owner->sendCompletionMessage(false, currentRecipient,
+                HasFileSystemIF::FILE_DOES_NOT_EXIST, 0);
         return HasReturnvaluesIF::RETURN_FAILED;
     }
+    currentFileSize = readFileLength;
 
-    /* Seek correct position in file. This needs to be done every time the file is reopened! */
-    result = f_seek(*filePtr, currentByteIdx, F_SEEK_SET);
-    if(result != F_NO_ERROR) {
-        /* should not happen! */
-        f_close(*filePtr);
+    sourceFile = f_open(fileName1.c_str(), "r");
+    if(sourceFile == nullptr) {
+        owner->sendCompletionMessage(false, currentRecipient,
+                HasFileSystemIF::GENERIC_FILE_ERROR, f_getlasterror());
         return HasReturnvaluesIF::RETURN_FAILED;
     }
+    Clock::getUptime(&operationStartMs);
     return HasReturnvaluesIF::RETURN_OK;
 }
 
-ReturnValue_t SDCHStateMachine::handleGenericCopyOperation() {
-    F_FILE* readFile;
-    ReturnValue_t result = prepareCopyFileInformation(&readFile);
+ReturnValue_t SDCHStateMachine::openCopyFiles() {
+    ReturnValue_t result = openSourceFile();
     if(result != HasReturnvaluesIF::RETURN_OK) {
         return result;
     }
@@ -124,76 +202,391 @@ ReturnValue_t SDCHStateMachine::handleGenericCopyOperation() {
     if(retval != F_NO_ERROR) {
         /* Target repository might not exist */
         owner->sendCompletionMessage(false, currentRecipient,
-                HasFileSystemIF::DIRECTORY_DOES_NOT_EXIST, 0);
+                HasFileSystemIF::DIRECTORY_DOES_NOT_EXIST, retval);
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+
+    /* Opening with "w" creates the file or truncates an existing file to 0 length */
+    targetFile = f_open(fileName2.c_str(), "w");
+    if(targetFile == nullptr) {
+        owner->sendCompletionMessage(false, currentRecipient,
+                HasFileSystemIF::GENERIC_FILE_ERROR, f_getlasterror());
         return HasReturnvaluesIF::RETURN_FAILED;
     }
 
-    F_FILE* writeFile = nullptr;
-    if(stepCounter == 0) {
-        /* Check whether file already exists */
-        writeFile = f_open(fileName2.c_str(), "r");
-        if(writeFile == nullptr) {
-            /* File does not exist, we create it */
-            writeFile = f_open(fileName2.c_str(), "a");
-        }
-        else {
-            /* File does exist, so we reopen it in write mode, which truncates it to 0 length */
-            f_close(writeFile);
-            writeFile = f_open(fileName2.c_str(), "w");
-        }
 #if OBSW_VERBOSE_LEVEL >= 1
-        sif::printInfo("Copying file %s/%s to %s/%s\n", path1.c_str(), fileName1.c_str(),
-                path2.c_str(), fileName2.c_str());
+    sif::printInfo("Copying file %s/%s to %s/%s\n", path1.c_str(), fileName1.c_str(),
+            path2.c_str(), fileName2.c_str());
 #endif
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t SDCHStateMachine::openNextPartFile() {
+    if(partIdx >= MAX_NUMBER_OF_PARTS) {
+        owner->sendCompletionMessage(false, currentRecipient,
+                HasFileSystemIF::INVALID_PARAMETERS, partIdx);
+        return HasReturnvaluesIF::RETURN_FAILED;
     }
-    else {
-        /* Higher step counter so target file should already exist, open with append */
-        writeFile = f_open(fileName2.c_str(), "a");
+    int retval = change_directory(path2.c_str(), true);
+    if(retval != F_NO_ERROR) {
+        owner->sendCompletionMessage(false, currentRecipient,
+                HasFileSystemIF::DIRECTORY_DOES_NOT_EXIST, retval);
+        return HasReturnvaluesIF::RETURN_FAILED;
     }
 
-    HCCFileGuard readHelper(&readFile);
-    HCCFileGuard writeHelper(&writeFile);
+    char partName[MAX_FILENAME_LENGTH + 1];
+    getPartFileName(partName, sizeof(partName));
+    targetFile = f_open(partName, "w");
+    if(targetFile == nullptr) {
+        owner->sendCompletionMessage(false, currentRecipient,
+                HasFileSystemIF::GENERIC_FILE_ERROR, f_getlasterror());
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    bytesInPart = 0;
+    return HasReturnvaluesIF::RETURN_OK;
+}
 
-    if(writeFile == nullptr) {
-        /* Something went wrong */
+size_t SDCHStateMachine::determineCopyChunkSize() const {
+    size_t chunkSize = currentFileSize - currentByteIdx;
+    if(chunkSize > fileBuffer.size()) {
+        chunkSize = fileBuffer.size();
+    }
+    /* Start with one sector to measure the copy rate */
+    size_t budgetSize = MIN_COPY_CHUNK_SIZE;
+    if(bytesPerMs > 0) {
+        budgetSize = owner->getRemainingCycleTimeMs() * bytesPerMs;
+        /* Keep chunks aligned to sectors */
+        budgetSize -= budgetSize % MIN_COPY_CHUNK_SIZE;
+        if(budgetSize < MIN_COPY_CHUNK_SIZE) {
+            budgetSize = MIN_COPY_CHUNK_SIZE;
+        }
+    }
+    if(chunkSize > budgetSize) {
+        chunkSize = budgetSize;
+    }
+    return chunkSize;
+}
+
+void SDCHStateMachine::updateCopyRate(size_t bytesCopied, uint32_t elapsedMs) {
+    if(elapsedMs == 0) {
+        /* Faster than the clock resolution */
+        elapsedMs = 1;
+    }
+    uint32_t currentRate = bytesCopied / elapsedMs;
+    if(currentRate == 0) {
+        currentRate = 1;
+    }
+    if(bytesPerMs == 0) {
+        bytesPerMs = currentRate;
+    }
+    else {
+        /* Smooth the estimate so a single slow access does not shrink the steps too much */
+        bytesPerMs = (3 * bytesPerMs + currentRate) / 4;
+    }
+}
+
+ReturnValue_t SDCHStateMachine::copyChunk(size_t sizeToCopy) {
+    uint32_t stepStartMs = 0;
+    Clock::getUptime(&stepStartMs);
+    long sizeReadOrWritten = f_read(fileBuffer.data(), sizeof(uint8_t), sizeToCopy,
+            sourceFile);
+    if(sizeReadOrWritten != static_cast<long>(sizeToCopy)) {
+        /* Read error */
         owner->sendCompletionMessage(false, currentRecipient,
                 HasFileSystemIF::GENERIC_FILE_ERROR, f_getlasterror());
         return HasReturnvaluesIF::RETURN_FAILED;
     }
+    sizeReadOrWritten = f_write(fileBuffer.data(), sizeof(uint8_t), sizeToCopy, targetFile);
+    if(sizeReadOrWritten != static_cast<long>(sizeToCopy)) {
+        /* Write error */
+        owner->sendCompletionMessage(false, currentRecipient,
+                HasFileSystemIF::GENERIC_FILE_ERROR, f_getlasterror());
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    currentByteIdx += sizeToCopy;
+    uint32_t stepEndMs = 0;
+    Clock::getUptime(&stepEndMs);
+    updateCopyRate(sizeToCopy, stepEndMs - stepStartMs);
+    return HasReturnvaluesIF::RETURN_OK;
+}
 
+ReturnValue_t SDCHStateMachine::performCopySteps() {
     while(currentByteIdx < currentFileSize) {
-        size_t sizeToCopy = 0;
-        if(currentFileSize - currentByteIdx > fileBuffer.size()) {
-            sizeToCopy = fileBuffer.size();
+        ReturnValue_t result = copyChunk(determineCopyChunkSize());
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
         }
-        else {
-            sizeToCopy = currentFileSize - currentByteIdx;
+        if(ownerCountdown->hasTimedOut()) {
+            return sdchandler::TASK_PERIOD_OVER_SOON;
         }
-        long sizeReadOrWritten = f_read(fileBuffer.data(), sizeof(uint8_t), sizeToCopy, readFile);
-        if(sizeReadOrWritten != static_cast<long>(sizeToCopy)) {
-            /* Read error */
+    }
+    return sdchandler::OPERATION_FINISHED;
+}
+
+ReturnValue_t SDCHStateMachine::handleGenericCopyOperation() {
+    if(stepCounter == 0) {
+        ReturnValue_t result = openCopyFiles();
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
+        }
+    }
+    stepCounter++;
+
+    ReturnValue_t result = performCopySteps();
+    if(result != sdchandler::OPERATION_FINISHED) {
+        return result;
+    }
+
+    return finishCopyOperation();
+}
+
+ReturnValue_t SDCHStateMachine::handleMoveOperation() {
+    if(stepCounter == 0) {
+        /* Try to move the directory entry first, which does not touch the file data */
+        char sourcePath[MAX_REPOSITORY_PATH_LENGTH + MAX_FILENAME_LENGTH + 3];
+        char targetPath[MAX_REPOSITORY_PATH_LENGTH + MAX_FILENAME_LENGTH + 3];
+        snprintf(sourcePath, sizeof(sourcePath), "/%s/%s", path1.c_str(), fileName1.c_str());
+        snprintf(targetPath, sizeof(targetPath), "/%s/%s", path2.c_str(), fileName2.c_str());
+        int retval = f_move(sourcePath, targetPath);
+        if(retval == F_NO_ERROR) {
+#if OBSW_VERBOSE_LEVEL >= 1
+            sif::printInfo("Moved file %s to %s\n", sourcePath, targetPath);
+#endif
+            owner->recordFileSystemChange(path1.c_str(), fileName1.c_str(),
+                    SDCardMirror::FILE_DELETED);
+            owner->recordFileSystemChange(path2.c_str(), fileName2.c_str(),
+                    SDCardMirror::FILE_UPDATED);
+            owner->sendCompletionMessage(true, currentRecipient);
+            this->resetAndSetToIdle();
+            return sdchandler::OPERATION_FINISHED;
+        }
+        else if(retval == F_ERR_NOTFOUND) {
             owner->sendCompletionMessage(false, currentRecipient,
-                    HasFileSystemIF::GENERIC_FILE_ERROR, f_getlasterror());
+                    HasFileSystemIF::FILE_DOES_NOT_EXIST, retval);
+            return HasReturnvaluesIF::RETURN_FAILED;
+        }
+        else if(retval == F_ERR_DUPLICATED) {
+            owner->sendCompletionMessage(false, currentRecipient,
+                    HasFileSystemIF::FILE_ALREADY_EXISTS, retval);
+            return HasReturnvaluesIF::RETURN_FAILED;
+        }
+        else if(retval != F_ERR_INVALIDDIR and retval != F_ERR_INVALIDDRIVE and
+                retval != F_ERR_NOTAVAILABLE) {
+            /* Other errors like a locked file would make the copy fail as well */
+            owner->sendCompletionMessage(false, currentRecipient,
+                    HasFileSystemIF::GENERIC_FILE_ERROR, retval);
             return HasReturnvaluesIF::RETURN_FAILED;
         }
-        sizeReadOrWritten = f_write(fileBuffer.data(), sizeof(uint8_t), sizeToCopy, writeFile);
-        if(sizeReadOrWritten != static_cast<long>(sizeToCopy)) {
-            /* Write error */
+
+        /* Entry can not be moved to the target directory, so the file is copied and the
+        source is deleted */
+        ReturnValue_t result = openCopyFiles();
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
+        }
+    }
+    stepCounter++;
+
+    ReturnValue_t result = performCopySteps();
+    if(result != sdchandler::OPERATION_FINISHED) {
+        return result;
+    }
+
+    /* Source file has to be closed before it can be deleted. The source is kept if the
+    target could not be closed properly. */
+    int retval = closeFiles();
+    if(retval != F_NO_ERROR) {
+        owner->recordFileSystemChange(path2.c_str(), fileName2.c_str(),
+                SDCardMirror::FILE_UPDATED);
+        owner->sendCompletionMessage(false, currentRecipient,
+                HasFileSystemIF::GENERIC_FILE_ERROR, retval);
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    retval = delete_file(path1.c_str(), fileName1.c_str());
+    if(retval != F_NO_ERROR) {
+        /* The copy is complete, but the source could not be removed */
+        owner->sendCompletionMessage(false, currentRecipient,
+                HasFileSystemIF::GENERIC_FILE_ERROR, retval);
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    owner->recordFileSystemChange(path1.c_str(), fileName1.c_str(), SDCardMirror::FILE_DELETED);
+    return finishCopyOperation();
+}
+
+ReturnValue_t SDCHStateMachine::handleSplitOperation() {
+    if(stepCounter == 0) {
+        ReturnValue_t result = openSourceFile();
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
+        }
+        if((currentFileSize + partSize - 1) / partSize > MAX_NUMBER_OF_PARTS) {
+            owner->sendCompletionMessage(false, currentRecipient,
+                    HasFileSystemIF::INVALID_PARAMETERS, partSize);
+            return HasReturnvaluesIF::RETURN_FAILED;
+        }
+#if OBSW_VERBOSE_LEVEL >= 1
+        sif::printInfo("Splitting file %s/%s into parts of %lu bytes\n", path1.c_str(),
+                fileName1.c_str(), static_cast<unsigned long>(partSize));
+#endif
+    }
+    stepCounter++;
+
+    while(currentByteIdx < currentFileSize) {
+        if(targetFile == nullptr) {
+            ReturnValue_t result = openNextPartFile();
+            if(result != HasReturnvaluesIF::RETURN_OK) {
+                return result;
+            }
+        }
+
+        size_t sizeToCopy = determineCopyChunkSize();
+        if(sizeToCopy > partSize - bytesInPart) {
+            sizeToCopy = partSize - bytesInPart;
+        }
+        ReturnValue_t result = copyChunk(sizeToCopy);
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
+        }
+        bytesInPart += sizeToCopy;
+
+        if(bytesInPart >= partSize) {
+            /* Part is full, the next one will be opened in the next step */
+            result = closePartFile();
+            if(result != HasReturnvaluesIF::RETURN_OK) {
+                return result;
+            }
+        }
+
+        if(ownerCountdown->hasTimedOut()) {
+            return sdchandler::TASK_PERIOD_OVER_SOON;
+        }
+    }
+
+    if(targetFile != nullptr) {
+        /* Last part was not full */
+        ReturnValue_t result = closePartFile();
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
+        }
+    }
+    closeFiles();
+    uint32_t bytesPerSecond = getBytesPerSecond();
+#if OBSW_VERBOSE_LEVEL >= 1
+    sif::printInfo("Split operation completed. %lu parts, %lu bytes/s\n",
+            static_cast<unsigned long>(partIdx), static_cast<unsigned long>(bytesPerSecond));
+#endif
+    owner->triggerEvent(sdchandler::FILE_SPLIT_FINISHED, partIdx, bytesPerSecond);
+    owner->sendCopyCompletionMessage(currentRecipient, currentFileSize, bytesPerSecond);
+    this->resetAndSetToIdle();
+    return sdchandler::OPERATION_FINISHED;
+}
+
+ReturnValue_t SDCHStateMachine::handleChecksumOperation() {
+    if(stepCounter == 0) {
+        ReturnValue_t result = openSourceFile();
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
+        }
+        if(checksumType == sdchandler::CRC16_CCITT) {
+            checksum = 0xffff;
+        }
+        else {
+            checksum = Crc32::DEFAULT_START_CRC;
+        }
+    }
+    stepCounter++;
+
+    while(currentByteIdx < currentFileSize) {
+        size_t sizeToRead = determineCopyChunkSize();
+        uint32_t stepStartMs = 0;
+        Clock::getUptime(&stepStartMs);
+        long sizeRead = f_read(fileBuffer.data(), sizeof(uint8_t), sizeToRead, sourceFile);
+        if(sizeRead != static_cast<long>(sizeToRead)) {
             owner->sendCompletionMessage(false, currentRecipient,
                     HasFileSystemIF::GENERIC_FILE_ERROR, f_getlasterror());
             return HasReturnvaluesIF::RETURN_FAILED;
         }
-        currentByteIdx += sizeToCopy;
+        if(checksumType == sdchandler::CRC16_CCITT) {
+            checksum = CRC::crc16ccitt(fileBuffer.data(), sizeToRead, checksum);
+        }
+        else {
+            checksum = Crc32::calculate(fileBuffer.data(), sizeToRead, checksum);
+        }
+        currentByteIdx += sizeToRead;
+        uint32_t stepEndMs = 0;
+        Clock::getUptime(&stepEndMs);
+        updateCopyRate(sizeToRead, stepEndMs - stepStartMs);
 
         if(ownerCountdown->hasTimedOut()) {
             return sdchandler::TASK_PERIOD_OVER_SOON;
         }
     }
 
+    closeFiles();
+#if OBSW_VERBOSE_LEVEL >= 1
+    sif::printInfo("Checksum of file %s/%s with %lu bytes: 0x%08lx\n", path1.c_str(),
+            fileName1.c_str(), static_cast<unsigned long>(currentFileSize),
+            static_cast<unsigned long>(checksum));
+#endif
+    owner->sendChecksumReply(currentRecipient, path1, fileName1, checksumType, checksum,
+            currentFileSize);
+    this->resetAndSetToIdle();
+    return sdchandler::OPERATION_FINISHED;
+}
+
+ReturnValue_t SDCHStateMachine::closePartFile() {
+    int retval = f_close(targetFile);
+    targetFile = nullptr;
+    recordPartFileChange();
+    if(retval != F_NO_ERROR) {
+        /* Part might be incomplete */
+        owner->sendCompletionMessage(false, currentRecipient,
+                HasFileSystemIF::GENERIC_FILE_ERROR, retval);
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    partIdx++;
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+void SDCHStateMachine::getPartFileName(char *partName, size_t maxSize) const {
+    snprintf(partName, maxSize, "%s.%03u", fileName2.c_str(),
+            static_cast<unsigned int>(partIdx));
+}
+
+void SDCHStateMachine::recordPartFileChange() {
+    char partName[MAX_FILENAME_LENGTH + 1];
+    getPartFileName(partName, sizeof(partName));
+    owner->recordFileSystemChange(path2.c_str(), partName, SDCardMirror::FILE_UPDATED);
+}
+
+uint32_t SDCHStateMachine::getBytesPerSecond() const {
+    uint32_t endMs = 0;
+    Clock::getUptime(&endMs);
+    uint32_t elapsedMs = endMs - operationStartMs;
+    if(elapsedMs == 0) {
+        elapsedMs = 1;
+    }
+    return static_cast<uint64_t>(currentByteIdx) * 1000 / elapsedMs;
+}
+
+ReturnValue_t SDCHStateMachine::finishCopyOperation() {
+    /* Closing the target file flushes the remaining data */
+    int retval = closeFiles();
+    owner->recordFileSystemChange(path2.c_str(), fileName2.c_str(), SDCardMirror::FILE_UPDATED);
+    if(retval != F_NO_ERROR) {
+        /* The last buffered data might not have been written to the card */
+        owner->sendCompletionMessage(false, currentRecipient,
+                HasFileSystemIF::GENERIC_FILE_ERROR, retval);
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    uint32_t bytesPerSecond = getBytesPerSecond();
 #if OBSW_VERBOSE_LEVEL >= 1
-    sif::printInfo("Copy operation completed\n");
+    sif::printInfo("Copy operation completed. %lu bytes, %lu bytes/s\n",
+            static_cast<unsigned long>(currentFileSize),
+            static_cast<unsigned long>(bytesPerSecond));
 #endif
+    owner->triggerEvent(sdchandler::FILE_COPY_FINISHED, currentFileSize, bytesPerSecond);
+    owner->sendCopyCompletionMessage(currentRecipient, currentFileSize, bytesPerSecond);
     this->resetAndSetToIdle();
-    owner->sendCompletionMessage(true, currentRecipient);
     return sdchandler::OPERATION_FINISHED;
 }
@@ -1,6 +1,7 @@
 #ifndef SAM9G20_MEMORY_SDCHSTATEMACHINE_H_
 #define SAM9G20_MEMORY_SDCHSTATEMACHINE_H_
 
+#include "OBSWConfig.h"
 #include "sdcardDefinitions.h"
 
 #include <fsfw/ipc/messageQueueDefinitions.h>
@@ -23,12 +24,24 @@ public:
     enum class States {
         /* Nothing to do */
         IDLE,
-        /* A file is being split into PUS packets for downlinking */
+        /* A file is being split into part files of a fixed size, e.g. for downlinking */
         SPLITTING_FILE,
         COPY_FILE,
-        MOVE_FILE
+        /* Moving is done by a rename if possible, otherwise by copying and deleting */
+        MOVE_FILE,
+        /* A checksum is calculated over a file */
+        CHECKSUM_FILE
     };
 
+    /* Part files are named <target name>.<part index> with a three digit index */
+    static constexpr uint16_t MAX_NUMBER_OF_PARTS = 1000;
+
+    /* Copy operations use a bounce buffer. The size copied per step is derived from the
+    measured copy rate and the remaining time of the current task cycle. */
+    static constexpr size_t COPY_BUFFER_SIZE = config::SD_CARD_COPY_BUFFER_SIZE;
+    /* Size of one SD card sector, chunks are always a multiple of this */
+    static constexpr size_t MIN_COPY_CHUNK_SIZE = 512;
+
     SDCHStateMachine(SDCardHandler* owner, Countdown* ownerCountdown);
 
     /**
@@ -41,6 +54,25 @@ public:
 
     bool setCopyFileOperation(RepositoryPath& sourceRepo, FileName& sourceName,
             RepositoryPath& targetRepo, FileName& targetName, MessageQueueId_t recipient);
+    bool setMoveFileOperation(RepositoryPath& sourceRepo, FileName& sourceName,
+            RepositoryPath& targetRepo, FileName& targetName, MessageQueueId_t recipient);
+    /**
+     * Split a file into part files with the given size.
+     * @param partBaseName  Name of the part files without extension. The extension will be
+     *                      the three digit part index, so the base name may have at most
+     *                      MAX_FILENAME_LENGTH - 4 characters
+     */
+    bool setSplitFileOperation(RepositoryPath& sourceRepo, FileName& sourceName,
+            RepositoryPath& targetRepo, FileName& partBaseName, size_t partSize,
+            MessageQueueId_t recipient);
+
+    /**
+     * Calculate a checksum over a file. The checksum and the file size will be sent
+     * to the SD card handler when the operation is finished.
+     * @param checksumType  One of sdchandler::ChecksumType
+     */
+    bool setChecksumOperation(RepositoryPath& repoPath, FileName& fileName,
+            uint8_t checksumType, MessageQueueId_t recipient);
 
     void resetAndSetToIdle();
 
@@ -48,7 +80,7 @@ public:
 
 private:
     SDCHStateMachine::States internalState = SDCHStateMachine::States::IDLE;
-    std::array<uint8_t, 8 * 1024> fileBuffer;
+    std::array<uint8_t, COPY_BUFFER_SIZE> fileBuffer;
     SDCardHandler* owner;
     Countdown* ownerCountdown = nullptr;
     /** Current recipient for success or failure messages */
@@ -67,10 +99,55 @@ private:
     size_t currentFileSize = 0;
     uint32_t stepCounter = 0;
 
+    /* Source and target file are kept open while an operation spans multiple cycles.
+    The SD card handler keeps the SD card access open as long as the state machine is busy. */
+    F_FILE* sourceFile = nullptr;
+    F_FILE* targetFile = nullptr;
+    /* Measured copy rate, used to size the next copy step */
+    uint32_t bytesPerMs = 0;
+    uint32_t operationStartMs = 0;
+
+    /* Split operation */
+    size_t partSize = 0;
+    uint16_t partIdx = 0;
+    size_t bytesInPart = 0;
+    /* Checksum operation */
+    uint8_t checksumType = 0;
+    uint32_t checksum = 0;
+
     void reset();
+    /**
+     * Close the source and target file.
+     * @return Result of closing the target file, F_NO_ERROR if no target file was open
+     */
+    int closeFiles();
+
+    bool setGenericSourceTargetOperation(States state, RepositoryPath& sourceRepo,
+            FileName& sourceName, RepositoryPath& targetRepo, FileName& targetName,
+            MessageQueueId_t recipient);
 
     ReturnValue_t handleGenericCopyOperation();
-    ReturnValue_t prepareCopyFileInformation(F_FILE** filePtr);
+    ReturnValue_t handleMoveOperation();
+    ReturnValue_t handleSplitOperation();
+    ReturnValue_t handleChecksumOperation();
+
+    ReturnValue_t openSourceFile();
+    ReturnValue_t openCopyFiles();
+    ReturnValue_t openNextPartFile();
+    /** Close the current part file, sends the failure reply if closing failed */
+    ReturnValue_t closePartFile();
+    void getPartFileName(char* partName, size_t maxSize) const;
+    void recordPartFileChange();
+    ReturnValue_t performCopySteps();
+    ReturnValue_t copyChunk(size_t sizeToCopy);
+    size_t determineCopyChunkSize() const;
+    void updateCopyRate(size_t bytesCopied, uint32_t elapsedMs);
+    uint32_t getBytesPerSecond() const;
+    /**
+     * Close the files and send the completion reply. The copy is reported as failed if
+     * the target file could not be closed.
+     */
+    ReturnValue_t finishCopyOperation();
 };
 
 
@@ -42,7 +42,7 @@ public:
 private:
     bool accessSuccess = false;
     ReturnValue_t accessResult = HasReturnvaluesIF::RETURN_OK;
-    VolumeId currentVolumeId;
+    VolumeId currentVolumeId = SD_CARD_0;
 };
 
 #endif /* SAM9G20_MEMORY_SDCARDACCESS_H_ */
@@ -7,18 +7,25 @@
 #include "bsp_sam9g20/common/fram/FRAMApi.h"
 
 #include "mission/memory/FileSystemMessage.h"
+#include "mission/utility/obswLog.h"
+#include "mission/utility/obswTrace.h"
 
 #include "fsfw/tasks/PeriodicTaskIF.h"
 #include "fsfw/objectmanager/ObjectManager.h"
 #include "fsfw/storagemanager/StorageManagerIF.h"
 #include "fsfw/ipc/QueueFactory.h"
 #include "fsfw/serviceinterface/ServiceInterface.h"
+#include "fsfw/timemanager/Clock.h"
+
+#include <algorithm>
 
 
 SDCardHandler::SDCardHandler(object_id_t objectId): SystemObject(objectId),
         commandQueue(QueueFactory::instance()->createMessageQueue(MAX_MESSAGE_QUEUE_DEPTH)),
         actionHelper(this, commandQueue), countdown(0), stateMachine(this, &countdown) {
     ipcStore = ObjectManager::instance()->get<StorageManagerIF>(objects::IPC_STORE);
+    /* Will be replaced by the request queue of the I/O worker if one is registered */
+    ioReplyQueue = commandQueue;
 }
 
 
@@ -32,6 +39,8 @@ ReturnValue_t SDCardHandler::initialize() {
     if(result != HasReturnvaluesIF::RETURN_OK) {
         return result;
     }
+    /* The mirror is optional */
+    sdCardMirror = ObjectManager::instance()->get<SDCardMirror>(objects::SD_CARD_MIRROR);
     return SystemObject::initialize();
 }
 
@@ -42,7 +51,8 @@ ReturnValue_t SDCardHandler::initializeAfterTaskCreation() {
     SDCardAccessManager::create();
     periodMs = executingTask->getPeriodMs();
     /* This prevents the task from blocking other low priority tasks (self-suspension) */
-    countdown.setTimeout(0.75 * periodMs);
+    cycleBudgetMs = 0.75 * periodMs;
+    countdown.setTimeout(cycleBudgetMs);
     return HasReturnvaluesIF::RETURN_OK;
 }
 
@@ -51,10 +61,16 @@ ReturnValue_t SDCardHandler::performOperation(uint8_t operationCode) {
     // Stopwatch stopwatch;
     CommandMessage message;
     countdown.resetTimer();
+    Clock::getUptime(&cycleStartMs);
     /* Check for first message */
     ReturnValue_t result = commandQueue->receiveMessage(&message);
+    bool messageReceived = true;
     if(result == MessageQueueIF::EMPTY) {
-        return HasReturnvaluesIF::RETURN_OK;
+        messageReceived = false;
+        /* Operations of the state machine are continued even if there are no messages */
+        if(stateMachine.getInternalState() == SDCHStateMachine::States::IDLE) {
+            return HasReturnvaluesIF::RETURN_OK;
+        }
     }
     else if(result != HasReturnvaluesIF::RETURN_OK) {
         return result;
@@ -72,18 +88,21 @@ ReturnValue_t SDCardHandler::performOperation(uint8_t operationCode) {
         actionSender = MessageQueueIF::NO_QUEUE;
     }
 
-    /* File system message received, open access to SD Card which will be closed automatically
-    on function exit. */
-    SDCardAccess sdCardAccess;
-    result = handleSdCardAccessResult(sdCardAccess);
+    /* Open access to SD Card. If the state machine is not busy at the end of the cycle,
+    the access is closed again. */
+    if(not sdCardAccess.has_value()) {
+        sdCardAccess.emplace();
+    }
+    result = handleSdCardAccessResult(*sdCardAccess);
     if(result != HasReturnvaluesIF::RETURN_OK) {
+        stateMachine.resetAndSetToIdle();
+        sdCardAccess.reset();
         return result;
     }
 
-    /* Handle first message. Returnvalue ignored for now. */
-    result = handleMessage(&message);
-    if(countdown.hasTimedOut()) {
-        return result;
+    if(messageReceived) {
+        /* Handle first message. Returnvalue ignored for now. */
+        result = handleMessage(&message);
     }
 
     /* Now we check if the state machine is busy. If it is, we drive it as long as possible
@@ -97,29 +116,54 @@ ReturnValue_t SDCardHandler::performOperation(uint8_t operationCode) {
             /* This might also set the state machine to a non-idle state */
             result = handleNextMessage(&message);
             if(result == MessageQueueIF::EMPTY) {
-                return HasReturnvaluesIF::RETURN_OK;
+                break;
             }
         }
 
         if(sdCardChangeOngoing) {
             /* SD card change might have been requested in a message. Return to tear down
             SD card access */
-            return HasReturnvaluesIF::RETURN_OK;
+            break;
         }
     }
+    releaseSdCardAccessIfIdle();
     return HasReturnvaluesIF::RETURN_OK;
 }
 
+void SDCardHandler::releaseSdCardAccessIfIdle() {
+    if(stateMachine.getInternalState() == SDCHStateMachine::States::IDLE or
+            sdCardChangeOngoing) {
+        sdCardAccess.reset();
+    }
+}
+
+uint32_t SDCardHandler::getRemainingCycleTimeMs() const {
+    uint32_t currentTimeMs = 0;
+    Clock::getUptime(&currentTimeMs);
+    uint32_t elapsedMs = currentTimeMs - cycleStartMs;
+    if(elapsedMs >= cycleBudgetMs) {
+        return 0;
+    }
+    return cycleBudgetMs - elapsedMs;
+}
+
 void SDCardHandler::driveStateMachine() {
+    OBSW_TRACE_BEGIN(traceid::SD_CARD_HANDLER_STATE_MACHINE,
+            static_cast<uint32_t>(stateMachine.getInternalState()));
     ReturnValue_t result = stateMachine.continueCurrentOperation();
     if(result == sdchandler::OPERATION_FINISHED) {
         stateMachine.resetAndSetToIdle();
     }
+    else if(result == sdchandler::TASK_PERIOD_OVER_SOON) {
+        /* Operation is continued in the next cycle */
+    }
     else if(result != HasReturnvaluesIF::RETURN_OK) {
         /* If the state machine did not fail because of a pending SD card change operation
         we reset it */
         stateMachine.resetAndSetToIdle();
     }
+    OBSW_TRACE_END(traceid::SD_CARD_HANDLER_STATE_MACHINE,
+            static_cast<uint32_t>(stateMachine.getInternalState()));
 }
 
 ReturnValue_t SDCardHandler::handleNextMessage(CommandMessage *message) {
@@ -128,9 +172,7 @@ ReturnValue_t SDCardHandler::handleNextMessage(CommandMessage *message) {
         return result;
     }
     else if(result != HasReturnvaluesIF::RETURN_OK) {
-#if OBSW_VERBOSE_LEVEL >= 1
-        sif::printWarning("SDCardHandler::handleNextMessage: Error receiving message!\n");
-#endif
+        OBSW_LOG_WARNING("SDCardHandler::handleNextMessage: Error receiving message!\n");
         return result;
     }
 
@@ -139,17 +181,15 @@ ReturnValue_t SDCardHandler::handleNextMessage(CommandMessage *message) {
 
 
 ReturnValue_t SDCardHandler::handleMessage(CommandMessage* message) {
+    OBSW_TRACE_BEGIN(traceid::SD_CARD_HANDLER_MESSAGE, message->getCommand());
     ReturnValue_t result = actionHelper.handleActionMessage(message);
-    if(result == HasReturnvaluesIF::RETURN_OK) {
-        return result;
-    }
-
-    result = handleFileMessage(message);
     if(result != HasReturnvaluesIF::RETURN_OK) {
-#if OBSW_VERBOSE_LEVEL >= 1
-        sif::printWarning("SDCardHandler::handleMessage: Invalid message type!\n");
-#endif
+        result = handleFileMessage(message);
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            OBSW_LOG_WARNING("SDCardHandler::handleMessage: Invalid message type!\n");
+        }
     }
+    OBSW_TRACE_END(traceid::SD_CARD_HANDLER_MESSAGE, result);
     return result;
 }
 
@@ -266,6 +306,35 @@ ReturnValue_t SDCardHandler::executeAction(ActionId_t actionId,
         actionHelper.finish(true, commandedBy, actionId, HasReturnvaluesIF::RETURN_OK);
         break;
     }
+    case(REPORT_IO_STATISTICS): {
+        result = reportIoStatistics(commandedBy, actionId);
+        if(result == HasReturnvaluesIF::RETURN_OK) {
+            actionHelper.finish(true, commandedBy, actionId, result);
+        }
+        else {
+            actionHelper.finish(false, commandedBy, actionId, result);
+        }
+        break;
+    }
+    case(RESET_IO_STATISTICS): {
+        for(auto& histogram: ioLatencyHistograms) {
+            histogram.reset();
+        }
+        rejectedIoRequests = 0;
+        for(auto& request: pendingIoRequests) {
+            request.pending = false;
+        }
+        SDCardAccessManager::instance()->resetAccessStatistics();
+        actionHelper.finish(true, commandedBy, actionId, HasReturnvaluesIF::RETURN_OK);
+        break;
+    }
+    case(REPORT_ACCESS_STATISTICS): {
+        AccessStatisticsReply reply(SDCardAccessManager::instance()->getAccessStatistics());
+        result = actionHelper.reportData(commandedBy, actionId, &reply);
+        actionHelper.finish(result == HasReturnvaluesIF::RETURN_OK, commandedBy, actionId,
+                result);
+        break;
+    }
     default: {
         return CommandMessage::UNKNOWN_COMMAND;
     }
@@ -277,12 +346,20 @@ ReturnValue_t SDCardHandler::executeAction(ActionId_t actionId,
 ReturnValue_t SDCardHandler::handleFileMessage(CommandMessage* message) {
     ReturnValue_t  result = HasReturnvaluesIF::RETURN_OK;
     switch(message->getCommand()) {
-    case FileSystemMessage::CMD_CREATE_FILE: {
-        result = handleCreateFileCommand(message);
+    case FileSystemMessage::CMD_CREATE_FILE:
+    case FileSystemMessage::CMD_DELETE_FILE:
+    case FileSystemMessage::CMD_DELETE_DIRECTORY:
+    case FileSystemMessage::CMD_APPEND_TO_FILE:
+    case FileSystemMessage::CMD_FINISH_APPEND_TO_FILE:
+    case FileSystemMessage::CMD_READ_FROM_FILE:
+    case FileSystemMessage::CMD_REPORT_REPOSITORY:
+    case FileSystemMessage::CMD_FIND_FILES: {
+        /* Potentially long-running, offloaded to the I/O worker if possible */
+        result = forwardIoRequest(message);
         break;
     }
-    case FileSystemMessage::CMD_DELETE_FILE: {
-        result = handleDeleteFileCommand(message);
+    case FileSystemMessage::NOTIFICATION_IO_REQUEST_DONE: {
+        handleIoRequestDone(message);
         break;
     }
     case FileSystemMessage::CMD_REPORT_FILE_ATTRIBUTES: {
@@ -293,10 +370,6 @@ ReturnValue_t SDCardHandler::handleFileMessage(CommandMessage* message) {
         result = handleCreateDirectoryCommand(message);
         break;
     }
-    case FileSystemMessage::CMD_DELETE_DIRECTORY: {
-        result = handleDeleteDirectoryCommand(message);
-        break;
-    }
     case FileSystemMessage::CMD_LOCK_FILE: {
         result = handleLockFileCommand(message, true);
         break;
@@ -305,14 +378,6 @@ ReturnValue_t SDCardHandler::handleFileMessage(CommandMessage* message) {
         result = handleLockFileCommand(message, false);
         break;
     }
-    case FileSystemMessage::CMD_APPEND_TO_FILE: {
-        result = handleAppendCommand(message);
-        break;
-    }
-    case FileSystemMessage::CMD_FINISH_APPEND_TO_FILE: {
-        result = handleFinishAppendCommand(message);
-        break;
-    }
     case FileSystemMessage::CMD_COPY_FILE: {
         /* Might take multiple cycles, we store the sender */
         fileSystemSender = message->getSender();
@@ -320,11 +385,19 @@ ReturnValue_t SDCardHandler::handleFileMessage(CommandMessage* message) {
         break;
     }
     case FileSystemMessage::CMD_MOVE_FILE: {
-        /* Not implemented yet */
+        /* Might take multiple cycles if the file needs to be copied */
+        fileSystemSender = message->getSender();
+        result = handleMoveCommand(message);
         break;
     }
-    case FileSystemMessage::CMD_READ_FROM_FILE: {
-        result = handleReadCommand(message);
+    case FileSystemMessage::CMD_SPLIT_FILE: {
+        fileSystemSender = message->getSender();
+        result = handleSplitCommand(message);
+        break;
+    }
+    case FileSystemMessage::CMD_CHECKSUM_FILE: {
+        fileSystemSender = message->getSender();
+        result = handleChecksumCommand(message);
         break;
     }
     default: {
@@ -339,6 +412,161 @@ ReturnValue_t SDCardHandler::handleFileMessage(CommandMessage* message) {
     return result;
 }
 
+void SDCardHandler::registerIoWorker(MessageQueueIF* workerQueue) {
+    if(workerQueue == nullptr) {
+        return;
+    }
+    ioReplyQueue = workerQueue;
+    ioWorkerQueueId = workerQueue->getId();
+}
+
+ReturnValue_t SDCardHandler::forwardIoRequest(CommandMessage* message) {
+    if(ioWorkerQueueId == MessageQueueIF::NO_QUEUE) {
+        /* No worker, handle the request inline */
+        OBSW_TRACE_BEGIN(traceid::SD_CARD_IO_REQUEST, message->getCommand());
+        ReturnValue_t result = handleIoRequest(message);
+        OBSW_TRACE_END(traceid::SD_CARD_IO_REQUEST, result);
+        return result;
+    }
+
+    uint32_t enqueueTimeMs = 0;
+    Clock::getUptime(&enqueueTimeMs);
+    updatePendingIoRequests(enqueueTimeMs);
+    PendingIoRequest* freeSlot = nullptr;
+    for(auto& request: pendingIoRequests) {
+        if(not request.pending) {
+            freeSlot = &request;
+            break;
+        }
+    }
+    if(freeSlot == nullptr) {
+        rejectedIoRequests++;
+        sendCompletionReply(false, sdchandler::IO_QUEUE_FULL);
+        FileSystemMessage::clear(message);
+        return sdchandler::IO_QUEUE_FULL;
+    }
+
+    uint32_t requestId = nextIoRequestId++;
+    FileSystemMessage::setIoRequestId(message, requestId);
+    /* The original sender is kept so the worker can reply directly */
+    ReturnValue_t result = commandQueue->sendMessageFrom(ioWorkerQueueId, message,
+            message->getSender());
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        rejectedIoRequests++;
+        sendCompletionReply(false, result);
+        FileSystemMessage::clear(message);
+        return result;
+    }
+    freeSlot->pending = true;
+    freeSlot->requestId = requestId;
+    freeSlot->enqueueTimeMs = enqueueTimeMs;
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t SDCardHandler::handleIoRequest(CommandMessage* message) {
+    switch(message->getCommand()) {
+    case FileSystemMessage::CMD_CREATE_FILE: {
+        return handleCreateFileCommand(message);
+    }
+    case FileSystemMessage::CMD_DELETE_FILE: {
+        return handleDeleteFileCommand(message);
+    }
+    case FileSystemMessage::CMD_DELETE_DIRECTORY: {
+        return handleDeleteDirectoryCommand(message);
+    }
+    case FileSystemMessage::CMD_APPEND_TO_FILE: {
+        return handleAppendCommand(message);
+    }
+    case FileSystemMessage::CMD_FINISH_APPEND_TO_FILE: {
+        return handleFinishAppendCommand(message);
+    }
+    case FileSystemMessage::CMD_READ_FROM_FILE: {
+        return handleReadCommand(message);
+    }
+    case FileSystemMessage::CMD_REPORT_REPOSITORY: {
+        return handleListingCommand(message, false);
+    }
+    case FileSystemMessage::CMD_FIND_FILES: {
+        return handleListingCommand(message, true);
+    }
+    default: {
+        return CommandMessageIF::UNKNOWN_COMMAND;
+    }
+    }
+}
+
+void SDCardHandler::handleIoRequestDone(CommandMessage* message) {
+    uint32_t requestId = FileSystemMessage::getIoRequestId(message);
+    for(auto& request: pendingIoRequests) {
+        if(not request.pending or request.requestId != requestId) {
+            continue;
+        }
+        request.pending = false;
+        uint32_t latencyMs = FileSystemMessage::getIoRequestCompletionTime(message) -
+                request.enqueueTimeMs;
+        IoRequestType requestType = getIoRequestType(
+                FileSystemMessage::getProcessedCommand(message));
+        if(requestType != IO_REQUEST_TYPES) {
+            ioLatencyHistograms[requestType].addSample(latencyMs);
+        }
+        return;
+    }
+    /* The request was already released after a timeout or a reset of the statistics */
+}
+
+uint8_t SDCardHandler::updatePendingIoRequests(uint32_t currentTimeMs) {
+    uint8_t numberOfPendingRequests = 0;
+    for(auto& request: pendingIoRequests) {
+        if(not request.pending) {
+            continue;
+        }
+        if(currentTimeMs - request.enqueueTimeMs >= IO_REQUEST_TIMEOUT_MS) {
+            request.pending = false;
+            continue;
+        }
+        numberOfPendingRequests++;
+    }
+    return numberOfPendingRequests;
+}
+
+ReturnValue_t SDCardHandler::reportIoStatistics(MessageQueueId_t commandedBy,
+        ActionId_t actionId) {
+    uint32_t currentTimeMs = 0;
+    Clock::getUptime(&currentTimeMs);
+    IoStatisticsReply reply(updatePendingIoRequests(currentTimeMs), rejectedIoRequests,
+            ioLatencyHistograms.data(), ioLatencyHistograms.size());
+    return actionHelper.reportData(commandedBy, actionId, &reply);
+}
+
+ReturnValue_t SDCardHandler::replyToIoRequest(CommandMessage* reply) {
+    /* The I/O worker replies with the handler queue as sender, because commanding services
+    only accept replies from the queue they sent the command to */
+    return ioReplyQueue->sendMessageFrom(ioReplyQueue->getLastPartner(), reply,
+            commandQueue->getId());
+}
+
+SDCardHandler::IoRequestType SDCardHandler::getIoRequestType(Command_t command) {
+    switch(command) {
+    case FileSystemMessage::CMD_READ_FROM_FILE:
+    case FileSystemMessage::CMD_REPORT_REPOSITORY:
+    case FileSystemMessage::CMD_FIND_FILES: {
+        return IO_READ;
+    }
+    case FileSystemMessage::CMD_CREATE_FILE:
+    case FileSystemMessage::CMD_APPEND_TO_FILE:
+    case FileSystemMessage::CMD_FINISH_APPEND_TO_FILE: {
+        return IO_WRITE;
+    }
+    case FileSystemMessage::CMD_DELETE_FILE:
+    case FileSystemMessage::CMD_DELETE_DIRECTORY: {
+        return IO_DELETE;
+    }
+    default: {
+        return IO_REQUEST_TYPES;
+    }
+    }
+}
+
 #ifdef ISIS_OBC_G20
 void SDCardHandler::subscribeForSdCardNotifications(MessageQueueId_t queueId) {
     sdCardNotificationRecipients.push_back(queueId);
@@ -396,17 +624,17 @@ ReturnValue_t SDCardHandler::handleDeleteFileCommand(CommandMessage* message){
     result = command.deSerialize(&ipcStoreBuffer,
             &remainingSize, SerializeIF::Endianness::BIG);
     if(result != HasReturnvaluesIF::RETURN_OK) {
-        sendCompletionReply(false, result);
+        sendIoCompletionReply(false, result);
         return HasReturnvaluesIF::RETURN_FAILED;
     }
 
     result = removeFile(command.getRepositoryPathRaw(),
             command.getFilenameRaw());
     if (result != HasReturnvaluesIF::RETURN_OK) {
-        sendCompletionReply(false, result);
+        sendIoCompletionReply(false, result);
     }
     else {
-        sendCompletionReply();
+        sendIoCompletionReply();
     }
     return HasReturnvaluesIF::RETURN_OK;
 }
@@ -531,7 +759,7 @@ ReturnValue_t SDCardHandler::handleDeleteDirectoryCommand(
     result = command.deSerialize(&ipcStoreBuffer, &remainingSize,
             SerializeIF::Endianness::BIG);
     if(result != HasReturnvaluesIF::RETURN_OK){
-        sendCompletionReply(false, result);
+        sendIoCompletionReply(false, result);
         return HasReturnvaluesIF::RETURN_FAILED;
     }
 
@@ -543,10 +771,10 @@ ReturnValue_t SDCardHandler::handleDeleteDirectoryCommand(
 #else
         sif::printError("Deleting directory %s failed.\n", command.getDirname());
 #endif
-        sendCompletionReply(false, result);
+        sendIoCompletionReply(false, result);
     }
     else {
-        sendCompletionReply();
+        sendIoCompletionReply();
     }
 
     return HasReturnvaluesIF::RETURN_OK;
@@ -773,6 +1001,7 @@ ReturnValue_t SDCardHandler::removeFile(const char* repositoryPath,
         const char* filename, FileSystemArgsIF* args) {
     int result = delete_file(repositoryPath, filename);
     if(result == F_NO_ERROR) {
+        recordFileSystemChange(repositoryPath, filename, SDCardMirror::FILE_DELETED);
         return HasReturnvaluesIF::RETURN_OK;
     }
     else {
@@ -792,6 +1021,7 @@ ReturnValue_t SDCardHandler::createFile(const char* dirname,
     }
     else {
         //*bytesWritten = result;
+        recordFileSystemChange(dirname, filename, SDCardMirror::FILE_UPDATED);
         return HasReturnvaluesIF::RETURN_OK;
     }
 }
@@ -806,11 +1036,28 @@ ReturnValue_t SDCardHandler::createDirectory(const char* repositoryPath, const c
         return result;
     }
 
+    recordFileSystemChange(repositoryPath, dirname, SDCardMirror::DIRECTORY_CREATED);
     return HasReturnvaluesIF::RETURN_OK;
 }
 
 ReturnValue_t SDCardHandler::renameFile(const char* repositoryPath, const char* oldFilename,
         const char* newFilename, FileSystemArgsIF* args) {
+    int result = change_directory(repositoryPath, true);
+    if(result != F_NO_ERROR) {
+        return HasFileSystemIF::DIRECTORY_DOES_NOT_EXIST;
+    }
+    result = f_rename(oldFilename, newFilename);
+    if(result == F_ERR_NOTFOUND) {
+        return HasFileSystemIF::FILE_DOES_NOT_EXIST;
+    }
+    else if(result == F_ERR_DUPLICATED) {
+        return HasFileSystemIF::FILE_ALREADY_EXISTS;
+    }
+    else if(result != F_NO_ERROR) {
+        return result;
+    }
+    recordFileSystemChange(repositoryPath, oldFilename, SDCardMirror::FILE_DELETED);
+    recordFileSystemChange(repositoryPath, newFilename, SDCardMirror::FILE_UPDATED);
     return HasReturnvaluesIF::RETURN_OK;
 }
 
@@ -824,6 +1071,7 @@ ReturnValue_t SDCardHandler::removeDirectory(const char* repositoryPath, const c
         // should not happen (directory read only)
         return result;
     }
+    recordFileSystemChange(repositoryPath, dirname, SDCardMirror::DIRECTORY_DELETED);
     return HasReturnvaluesIF::RETURN_OK;
 }
 
@@ -864,8 +1112,81 @@ void SDCardHandler::sendCompletionReply(bool success, ReturnValue_t errorCode,
     return sendCompletionMessage(success, MessageQueueIF::NO_QUEUE, errorCode, errorParam);
 }
 
+void SDCardHandler::sendCopyCompletionMessage(MessageQueueId_t queueId, uint32_t bytesCopied,
+        uint32_t bytesPerSecond) {
+    CommandMessage reply;
+    FileSystemMessage::setCopySuccessReply(&reply, bytesCopied, bytesPerSecond);
+    ReturnValue_t result = commandQueue->sendMessage(queueId, &reply);
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+#if FSFW_CPP_OSTREAM_ENABLED == 1
+        sif::error << "SDCardHandler::sendCopyCompletionMessage: Sending reply failed!" <<
+                std::endl;
+#else
+        sif::printError("SDCardHandler::sendCopyCompletionMessage: Sending reply failed!\n");
+#endif
+    }
+}
+
+void SDCardHandler::sendChecksumReply(MessageQueueId_t queueId,
+        const RepositoryPath& repoPath, const FileName& fileName, uint8_t checksumType,
+        uint32_t checksum, uint32_t fileSize) {
+    ChecksumReply replyPacket(&repoPath, &fileName, checksumType, checksum, fileSize);
+    store_address_t storeId;
+    uint8_t* writePtr = nullptr;
+    size_t sizeToSerialize = replyPacket.getSerializedSize();
+    ReturnValue_t result = ipcStore->getFreeElement(&storeId, sizeToSerialize, &writePtr);
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        sendCompletionMessage(false, queueId, result);
+        return;
+    }
+
+    size_t serializedSize = 0;
+    result = replyPacket.serialize(&writePtr, &serializedSize, sizeToSerialize,
+            SerializeIF::Endianness::BIG);
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        ipcStore->deleteData(storeId);
+        sendCompletionMessage(false, queueId, result);
+        return;
+    }
+
+    CommandMessage reply;
+    FileSystemMessage::setChecksumFileReply(&reply, storeId);
+    result = commandQueue->sendMessage(queueId, &reply);
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        ipcStore->deleteData(storeId);
+        sendCompletionMessage(false, queueId, result);
+        return;
+    }
+    sendCompletionMessage(true, queueId);
+}
+
+void SDCardHandler::recordFileSystemChange(const char* repositoryPath, const char* name,
+        SDCardMirror::ChangeType changeType) {
+    if(changeType == SDCardMirror::DIRECTORY_DELETED) {
+        /* Listings of subdirectories of the deleted directory might be cached as well */
+        listingCache.invalidateAll();
+    }
+    else {
+        listingCache.invalidate(repositoryPath);
+    }
+    if(sdCardMirror != nullptr) {
+        sdCardMirror->recordChange(repositoryPath, name, changeType);
+    }
+}
+
+void SDCardHandler::sendIoCompletionReply(bool success, ReturnValue_t errorCode,
+        uint32_t errorParam) {
+    return sendCompletionMessage(ioReplyQueue, success, MessageQueueIF::NO_QUEUE, errorCode,
+            errorParam);
+}
+
 void SDCardHandler::sendCompletionMessage(bool success, MessageQueueId_t queueId,
         ReturnValue_t errorCode, uint32_t errorParam) {
+    return sendCompletionMessage(commandQueue, success, queueId, errorCode, errorParam);
+}
+
+void SDCardHandler::sendCompletionMessage(MessageQueueIF* sendingQueue, bool success,
+        MessageQueueId_t queueId, ReturnValue_t errorCode, uint32_t errorParam) {
     CommandMessage reply;
     if(success) {
         FileSystemMessage::setSuccessReply(&reply);
@@ -876,21 +1197,18 @@ void SDCardHandler::sendCompletionMessage(bool success, MessageQueueId_t queueId
 
     ReturnValue_t result = HasReturnvaluesIF::RETURN_OK;
     if(queueId == MessageQueueIF::NO_QUEUE) {
-        result = commandQueue->reply(&reply);
+        /* Replies of the I/O worker are sent on behalf of the handler */
+        result = sendingQueue->sendMessageFrom(sendingQueue->getLastPartner(), &reply,
+                commandQueue->getId());
     }
     else {
-        result = commandQueue->sendMessage(queueId, &reply);
+        result = sendingQueue->sendMessage(queueId, &reply);
     }
 
     if(result != HasReturnvaluesIF::RETURN_OK){
         if(result == MessageQueueIF::FULL) {
             /* Configuration error. */
-#if FSFW_CPP_OSTREAM_ENABLED == 1
-            sif::error << "SDCardHandler::sendCompletionReply: Queue of receiver is full!" <<
-                    std::endl;
-#else
-            sif::printError("SDCardHandler::sendCompletionReply: Queue of receiver is full!\n");
-#endif
+            OBSW_LOG_ERROR("SDCardHandler::sendCompletionReply: Queue of receiver is full!\n");
         }
     }
 }
@@ -927,26 +1245,14 @@ ReturnValue_t SDCardHandler::handleSequenceNumberRead(uint16_t sequenceNumber) {
         lastPacketReadNumber = 0;
     }
     else if((sequenceNumber == 1) and (lastPacketReadNumber != 0)) {
-#if OBSW_VERBOSE_LEVEL >= 1
-#if FSFW_CPP_OSTREAM_ENABLED == 1
-        sif::debug << "SDCardHandler::appendToFile: First sequence packet missed!" << std::endl;
-#else
-        sif::printDebug("SDCardHandler::appendToFile: First sequence packet missed!\n");
-#endif
-#endif
+        OBSW_LOG_DEBUG("SDCardHandler::handleSequenceNumberRead: First sequence packet "
+                "missed!\n");
         triggerEvent(sdchandler::SEQUENCE_PACKET_MISSING_READ_EVENT, 0, 0);
         return SEQUENCE_PACKET_MISSING_READ;
     }
     else if((sequenceNumber - lastPacketReadNumber) > 1) {
-#if OBSW_VERBOSE_LEVEL >= 1
-#if FSFW_CPP_OSTREAM_ENABLED == 1
-        sif::debug << "SDCardHandler::appendToFile: Packet missing between "
-                << sequenceNumber << " and " << lastPacketReadNumber << std::endl;
-#else
-        sif::printDebug("SDCardHandler::appendToFile: Packet missing between %hu and %hu\n",
-                sequenceNumber, lastPacketReadNumber);
-#endif
-#endif
+        OBSW_LOG_DEBUG("SDCardHandler::handleSequenceNumberRead: Packet missing between "
+                "%hu and %hu\n", sequenceNumber, lastPacketReadNumber);
         triggerEvent(sdchandler::SEQUENCE_PACKET_MISSING_READ_EVENT,
                 lastPacketReadNumber + 1, 0);
         return SEQUENCE_PACKET_MISSING_READ;
@@ -1006,7 +1312,7 @@ ReturnValue_t SDCardHandler::handleReadReplies(ReadCommand& command) {
         sif::printWarning("SDCardHandler::handleReadReply: Reading from file %s failed\n",
                 command.getFilename()->c_str());
 #endif
-        sendCompletionReply(false, result);
+        sendIoCompletionReply(false, result);
         int retval = f_close(file);
         if(retval != F_NO_ERROR) {
 #if FSFW_CPP_OSTREAM_ENABLED == 1
@@ -1028,16 +1334,11 @@ ReturnValue_t SDCardHandler::handleReadReplies(ReadCommand& command) {
             FileSystemMessage::setReadReply(&reply, false, storeId);
         }
 
-        result = commandQueue->reply(&reply);
+        result = replyToIoRequest(&reply);
         if(result != HasReturnvaluesIF::RETURN_OK){
             if(result == MessageQueueIF::FULL){
-#if FSFW_CPP_OSTREAM_ENABLED == 1
-                sif::debug << "SDCardHandler::sendDataReply: Could not send "
-                        << "data reply, queue of receiver is full!" << std::endl;
-#else
-                sif::printDebug("SDCardHandler::sendDataReply: Could not send "
+                OBSW_LOG_DEBUG("SDCardHandler::sendDataReply: Could not send "
                         "data reply, queue of receiver is full!\n");
-#endif
             }
         }
     }
@@ -1055,7 +1356,7 @@ ReturnValue_t SDCardHandler::handleReadReplies(ReadCommand& command) {
         CommandMessage reply;
         // TODO: implement packing this;
         FileSystemMessage::setReadFinishedReply(&reply, storeId);
-        result = commandQueue->reply(&reply);
+        result = replyToIoRequest(&reply);
     }
     return result;
 }
@@ -1153,7 +1454,7 @@ ReturnValue_t SDCardHandler::handleCreateFileCommand(CommandMessage *message) {
     result = command.deSerialize(&readPtr, &sizeRemaining,
             SerializeIF::Endianness::BIG);
     if(result != HasReturnvaluesIF::RETURN_OK) {
-        sendCompletionReply(false, result);
+        sendIoCompletionReply(false, result);
         return result;
     }
 
@@ -1165,10 +1466,10 @@ ReturnValue_t SDCardHandler::handleCreateFileCommand(CommandMessage *message) {
     result = createFile(command.getRepositoryPath(), command.getFilename(),
             command.getFileData(), command.getFileSize(), nullptr);
     if(result == HasReturnvaluesIF::RETURN_OK) {
-        sendCompletionReply();
+        sendIoCompletionReply();
     }
     else {
-        sendCompletionReply(false, result);
+        sendIoCompletionReply(false, result);
     }
     return HasReturnvaluesIF::RETURN_OK;
 }
@@ -1204,7 +1505,7 @@ ReturnValue_t SDCardHandler::handleAppendCommand(CommandMessage* message){
             &sdArgs);
     if(result != HasReturnvaluesIF::RETURN_OK){
         if(result == SEQUENCE_PACKET_MISSING_WRITE) {
-            sendCompletionReply(false, result, packetSequenceIfMissing);
+            sendIoCompletionReply(false, result, packetSequenceIfMissing);
         }
         else {
 #if FSFW_CPP_OSTREAM_ENABLED == 1
@@ -1214,12 +1515,14 @@ ReturnValue_t SDCardHandler::handleAppendCommand(CommandMessage* message){
             sif::printError("SDCardHandler::handleWriteCommand: Writing to file %s failed\n",
                     command.getFilename());
 #endif
-            sendCompletionReply(false, result);
+            sendIoCompletionReply(false, result);
         }
 
     }
     else {
-        sendCompletionReply();
+        recordFileSystemChange(command.getRepositoryPath(), command.getFilename(),
+                SDCardMirror::FILE_UPDATED);
+        sendIoCompletionReply();
     }
 
     return HasReturnvaluesIF::RETURN_OK;
@@ -1408,7 +1711,7 @@ ReturnValue_t SDCardHandler::generateFinishAppendReply(RepositoryPath *repoPath,
 
     CommandMessage reply;
     FileSystemMessage::setFinishAppendReply(&reply, storeId);
-    result = commandQueue->reply(&reply);
+    result = replyToIoRequest(&reply);
     if(result != HasReturnvaluesIF::RETURN_OK) {
         lastPacketWriteNumber = UNSET_SEQUENCE;
         return result;
@@ -1449,28 +1752,15 @@ ReturnValue_t SDCardHandler::handleSequenceNumberWrite(uint16_t sequenceNumber,
         lastPacketWriteNumber = 0;
     }
     else if((sequenceNumber == 1) and (lastPacketWriteNumber != 0)) {
-#if OBSW_VERBOSE_LEVEL >= 1
-#if FSFW_CPP_OSTREAM_ENABLED == 1
-        sif::debug << "SDCardHandler::appendToFile: First sequence packet missed!" << std::endl;
-#else
-        sif::printDebug("SDCardHandler::appendToFile: First sequence packet missed!\n");
-#endif
-#endif
+        OBSW_LOG_DEBUG("SDCardHandler::handleSequenceNumberWrite: First sequence packet "
+                "missed!\n");
         triggerEvent(sdchandler::SEQUENCE_PACKET_MISSING_WRITE_EVENT, 0, 0);
         *packetSeqIfMissing = 0;
         return SEQUENCE_PACKET_MISSING_WRITE;
     }
     else if((sequenceNumber - lastPacketWriteNumber) > 1) {
-#if OBSW_VERBOSE_LEVEL >= 1
-#if FSFW_CPP_OSTREAM_ENABLED == 1
-        sif::debug << "SDCardHandler::appendToFile: Packet missing between "
-                << sequenceNumber << " and " << lastPacketWriteNumber
-                << std::endl;
-#else
-        sif::printDebug("SDCardHandler::appendToFile: Packet missing between %hu amd %hu\n",
-                sequenceNumber ,lastPacketWriteNumber);
-#endif
-#endif
+        OBSW_LOG_DEBUG("SDCardHandler::handleSequenceNumberWrite: Packet missing between "
+                "%hu and %hu\n", sequenceNumber, lastPacketWriteNumber);
         triggerEvent(sdchandler::SEQUENCE_PACKET_MISSING_WRITE_EVENT,
                 lastPacketWriteNumber + 1, 0);
         *packetSeqIfMissing = lastPacketWriteNumber + 1;
@@ -1520,3 +1810,187 @@ ReturnValue_t SDCardHandler::handleCopyCommand(CommandMessage *message) {
     return HasReturnvaluesIF::RETURN_OK;
 }
 
+ReturnValue_t SDCardHandler::handleMoveCommand(CommandMessage *message) {
+    store_address_t storeId = FileSystemMessage::getStoreId(message);
+    ConstStorageAccessor storeAccess(storeId);
+    ReturnValue_t result = ipcStore->getData(storeId, storeAccess);
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        sendCompletionReply(false, result);
+        return HasReturnvaluesIF::RETURN_OK;
+    }
+
+    MoveFileCommand moveCommand;
+    size_t sizeToDeserialize = storeAccess.size();
+    const uint8_t* dataPtr = storeAccess.data();
+    result = moveCommand.deSerialize(&dataPtr, &sizeToDeserialize, SerializeIF::Endianness::BIG);
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        sendCompletionReply(false, result);
+        return HasReturnvaluesIF::RETURN_OK;
+    }
+
+    /* The state machine tries a rename first and falls back to copying and deleting
+    the file, which might take multiple cycles */
+    if(not stateMachine.setMoveFileOperation(*moveCommand.getSourceRepoPath(),
+            *moveCommand.getSourceFilename(), *moveCommand.getTargetRepoPath(),
+            *moveCommand.getTargetFilename(), message->getSender())) {
+        sendCompletionReply(false, HasFileSystemIF::IS_BUSY);
+    }
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t SDCardHandler::handleSplitCommand(CommandMessage *message) {
+    store_address_t storeId = FileSystemMessage::getStoreId(message);
+    ConstStorageAccessor storeAccess(storeId);
+    ReturnValue_t result = ipcStore->getData(storeId, storeAccess);
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        sendCompletionReply(false, result);
+        return HasReturnvaluesIF::RETURN_OK;
+    }
+
+    SplitFileCommand splitCommand;
+    size_t sizeToDeserialize = storeAccess.size();
+    const uint8_t* dataPtr = storeAccess.data();
+    result = splitCommand.deSerialize(&dataPtr, &sizeToDeserialize,
+            SerializeIF::Endianness::BIG);
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        sendCompletionReply(false, result);
+        return HasReturnvaluesIF::RETURN_OK;
+    }
+
+    if(stateMachine.getInternalState() != SDCHStateMachine::States::IDLE) {
+        sendCompletionReply(false, HasFileSystemIF::IS_BUSY);
+        return HasReturnvaluesIF::RETURN_OK;
+    }
+    if(not stateMachine.setSplitFileOperation(*splitCommand.getSourceRepoPath(),
+            *splitCommand.getSourceFilename(), *splitCommand.getTargetRepoPath(),
+            *splitCommand.getTargetFilename(), splitCommand.getPartSize(),
+            message->getSender())) {
+        /* Invalid part size or base name too long */
+        sendCompletionReply(false, HasFileSystemIF::INVALID_PARAMETERS);
+    }
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t SDCardHandler::handleChecksumCommand(CommandMessage *message) {
+    store_address_t storeId = FileSystemMessage::getStoreId(message);
+    ConstStorageAccessor storeAccess(storeId);
+    ReturnValue_t result = ipcStore->getData(storeId, storeAccess);
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        sendCompletionReply(false, result);
+        return HasReturnvaluesIF::RETURN_OK;
+    }
+
+    ChecksumCommand checksumCommand;
+    size_t sizeToDeserialize = storeAccess.size();
+    const uint8_t* dataPtr = storeAccess.data();
+    result = checksumCommand.deSerialize(&dataPtr, &sizeToDeserialize,
+            SerializeIF::Endianness::BIG);
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        sendCompletionReply(false, result);
+        return HasReturnvaluesIF::RETURN_OK;
+    }
+
+    if(stateMachine.getInternalState() != SDCHStateMachine::States::IDLE) {
+        sendCompletionReply(false, HasFileSystemIF::IS_BUSY);
+        return HasReturnvaluesIF::RETURN_OK;
+    }
+    /* The checksum is calculated over multiple cycles for larger files */
+    if(not stateMachine.setChecksumOperation(*checksumCommand.getRepoPath(),
+            *checksumCommand.getFilename(), checksumCommand.getChecksumType(),
+            message->getSender())) {
+        sendCompletionReply(false, HasFileSystemIF::INVALID_PARAMETERS,
+                checksumCommand.getChecksumType());
+    }
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+
+ReturnValue_t SDCardHandler::handleListingCommand(CommandMessage *message, bool findFiles) {
+    store_address_t storeId = FileSystemMessage::getStoreId(message);
+    ConstStorageAccessor accessor(storeId);
+    const uint8_t* readPtr = nullptr;
+    size_t sizeRemaining = 0;
+    ReturnValue_t result = getStoreData(storeId, accessor, &readPtr, &sizeRemaining);
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        sendIoCompletionReply(false, result);
+        return result;
+    }
+
+    RepositoryListingCommand command(findFiles);
+    result = command.deSerialize(&readPtr, &sizeRemaining, SerializeIF::Endianness::BIG);
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        sendIoCompletionReply(false, result);
+        return result;
+    }
+
+    size_t maxEntries = command.getMaxEntries();
+    if(maxEntries == 0 or maxEntries > listingBuffer.size()) {
+        maxEntries = listingBuffer.size();
+    }
+    const char* pattern = nullptr;
+    if(findFiles) {
+        pattern = command.getPattern()->c_str();
+    }
+    size_t numberOfEntries = 0;
+    size_t totalMatches = 0;
+    result = listingCache.getEntries(command.getRepoPath()->c_str(), pattern,
+            command.getStartIndex(), listingBuffer.data(), maxEntries, &numberOfEntries,
+            &totalMatches);
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        sendIoCompletionReply(false, result);
+        return result;
+    }
+
+    uint16_t totalEntries = std::min(totalMatches, static_cast<size_t>(0xffff));
+    /* At least one page is sent so that the number of entries is also reported for
+    empty repositories or start indexes past the last entry. The last page completes the
+    command, so no separate completion reply is sent. */
+    size_t entriesSent = 0;
+    do {
+        size_t pageEntries = std::min(numberOfEntries - entriesSent, LISTING_ENTRIES_PER_PAGE);
+        RepositoryListingReply replyPacket(command.getRepoPath(), command.getPattern(),
+                totalEntries, command.getStartIndex() + entriesSent,
+                listingBuffer.data() + entriesSent, pageEntries);
+        bool lastPage = entriesSent + pageEntries >= numberOfEntries;
+        result = sendListingReply(replyPacket, findFiles, lastPage);
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            sendIoCompletionReply(false, result);
+            return result;
+        }
+        entriesSent += pageEntries;
+    } while(entriesSent < numberOfEntries);
+
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t SDCardHandler::sendListingReply(const RepositoryListingReply &replyPacket,
+        bool findFiles, bool lastPage) {
+    store_address_t storeId;
+    uint8_t* writePtr = nullptr;
+    size_t sizeToSerialize = replyPacket.getSerializedSize();
+    ReturnValue_t result = ipcStore->getFreeElement(&storeId, sizeToSerialize, &writePtr);
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        return result;
+    }
+
+    size_t serializedSize = 0;
+    result = replyPacket.serialize(&writePtr, &serializedSize, sizeToSerialize,
+            SerializeIF::Endianness::BIG);
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        ipcStore->deleteData(storeId);
+        return result;
+    }
+
+    CommandMessage reply;
+    if(findFiles) {
+        FileSystemMessage::setFindFilesReply(&reply, storeId, lastPage);
+    }
+    else {
+        FileSystemMessage::setReportRepositoryReply(&reply, storeId, lastPage);
+    }
+    result = replyToIoRequest(&reply);
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        ipcStore->deleteData(storeId);
+    }
+    return result;
+}
@@ -7,6 +7,10 @@
 
 #include "bsp_sam9g20/common/SDCardApi.h"
 #include "SDCHStateMachine.h"
+#include "SDCardAccess.h"
+#include "IoLatencyHistogram.h"
+#include "SDCardMirror.h"
+#include "DirectoryListingCache.h"
 
 #include <fsfw/action/HasActionsIF.h>
 #include <fsfw/tasks/ExecutableObjectIF.h>
@@ -16,11 +20,13 @@
 #include <fsfw/memory/HasFileSystemIF.h>
 #include <fsfw/timemanager/Countdown.h>
 
+#include <array>
+#include <optional>
 #include <vector>
 
-class SDCardAccess;
 class PeriodicTaskIF;
 class ReadCommand;
+class RepositoryListingReply;
 
 /**
  * @brief   This is the primary handler for access to the SD cards on the iOBC or the AT91
@@ -31,6 +37,15 @@ class ReadCommand;
  * at the handler for SD card notifications so that a clean change of the active SD card can be
  * implemented. Right now, this is not enforced strictly, but the SD card access helper will deny
  * any requests to open the file system if a change of active SD card is ongoing.
+ *
+ * If a SDCardIoWorker registers itself at the handler, reads, writes and deletions are
+ * forwarded to the worker and executed in the background. The worker replies on behalf of
+ * the handler, so the requester sees the replies coming from the handler. The handler keeps
+ * track of the pending requests and the request latencies, which can be reported with an
+ * action command.
+ *
+ * Repository listings and file searches are reported page-wise. Recently listed directories
+ * are cached and the cache is invalidated on all changes done by the handler.
  */
 class SDCardHandler :
         public SystemObject,
@@ -39,6 +54,7 @@ class SDCardHandler :
         public HasActionsIF {
     friend class SDCardAccess;
     friend class SDCHStateMachine;
+    friend class SDCardIoWorker;
 public:
     /** Constructor initializes the handler as a system object */
     SDCardHandler(object_id_t objectId);
@@ -47,6 +63,9 @@ public:
     static constexpr uint32_t MAX_MESSAGE_QUEUE_DEPTH =
             config::SD_CARD_MQ_DEPTH;
     static constexpr size_t MAX_READ_LENGTH = config::SD_CARD_MAX_READ_LENGTH;
+    static constexpr size_t LISTING_ENTRIES_PER_PAGE = config::SD_CARD_LISTING_ENTRIES_PER_PAGE;
+    static constexpr size_t MAX_LISTING_ENTRIES = LISTING_ENTRIES_PER_PAGE *
+            config::SD_CARD_LISTING_MAX_PAGES;
 
     /** Service 8 Commands */
 
@@ -71,6 +90,16 @@ public:
 
     static constexpr ActionId_t CANCEL_SDCH_OPERATIONS = 30;
 
+    //! [EXPORT] : [COMMAND] Report number of pending I/O requests and latency histograms
+    //! for read, write and delete requests.
+    static constexpr ActionId_t REPORT_IO_STATISTICS = 40;
+    //! [EXPORT] : [COMMAND] Reset the I/O latency histograms and the SD card access counters.
+    //! Pending I/O requests are released, their completions are not recorded anymore.
+    static constexpr ActionId_t RESET_IO_STATISTICS = 41;
+    //! [EXPORT] : [COMMAND] Report shared and exclusive SD card accesses and lock contention
+    //! counters of the SD card access manager.
+    static constexpr ActionId_t REPORT_ACCESS_STATISTICS = 42;
+
     MessageQueueId_t getCommandQueue() const override;
 
     /** SystemObjectIF */
@@ -128,9 +157,51 @@ private:
 
     PeriodicTaskIF* executingTask = nullptr;
     dur_millis_t periodMs = 0;
+    /* Time budget per cycle and start of the current cycle, used by the state machine
+    to size its work steps */
+    uint32_t cycleBudgetMs = 0;
+    uint32_t cycleStartMs = 0;
+
+    /* SD card access. It is kept open across cycles while the state machine is busy so that
+    open file handles stay valid. */
+    std::optional<SDCardAccess> sdCardAccess;
 
     StorageManagerIF *ipcStore;
 
+    /* Requests which can be offloaded to the I/O worker */
+    enum IoRequestType: uint8_t {
+        IO_READ,
+        IO_WRITE,
+        IO_DELETE,
+        IO_REQUEST_TYPES
+    };
+
+    /* Queue used to reply to I/O requests. This is the request queue of the I/O worker
+    if one is registered and the command queue otherwise. */
+    MessageQueueIF* ioReplyQueue = nullptr;
+    MessageQueueId_t ioWorkerQueueId = MessageQueueIF::NO_QUEUE;
+    /* Forwarded requests which are not completed yet. The request ID is sent to the worker
+    with the request and returned in the completion notification. */
+    struct PendingIoRequest {
+        bool pending = false;
+        uint32_t requestId = 0;
+        uint32_t enqueueTimeMs = 0;
+    };
+    /* Pending requests without a completion notification, for example because sending the
+    notification failed, are released after this time so they do not block the queue */
+    static constexpr uint32_t IO_REQUEST_TIMEOUT_MS = 30000;
+    std::array<PendingIoRequest, config::SD_CARD_IO_QUEUE_DEPTH> pendingIoRequests;
+    uint32_t nextIoRequestId = 0;
+    std::array<IoLatencyHistogram, IO_REQUEST_TYPES> ioLatencyHistograms;
+    uint32_t rejectedIoRequests = 0;
+
+    /* Optional, changes are recorded so they can be replicated to the inactive SD card */
+    SDCardMirror* sdCardMirror = nullptr;
+
+    /* Listings are generated by the I/O worker if one is registered */
+    DirectoryListingCache listingCache;
+    std::array<DirectoryListingCache::Entry, MAX_LISTING_ENTRIES> listingBuffer;
+
     /* Core functions called in performOperation */
     ReturnValue_t handleNextMessage(CommandMessage* message);
 
@@ -145,6 +216,19 @@ private:
     ReturnValue_t handleMessage(CommandMessage* message);
     ReturnValue_t handleFileMessage(CommandMessage* message);
 
+    /* I/O worker handling */
+    void registerIoWorker(MessageQueueIF* workerQueue);
+    ReturnValue_t forwardIoRequest(CommandMessage* message);
+    /** Called by the I/O worker or directly if no worker is registered */
+    ReturnValue_t handleIoRequest(CommandMessage* message);
+    void handleIoRequestDone(CommandMessage* message);
+    /** Release pending requests which timed out and return the number of pending requests */
+    uint8_t updatePendingIoRequests(uint32_t currentTimeMs);
+    /** Replies to the sender of the I/O request on behalf of the handler */
+    ReturnValue_t replyToIoRequest(CommandMessage* reply);
+    ReturnValue_t reportIoStatistics(MessageQueueId_t commandedBy, ActionId_t actionId);
+    static IoRequestType getIoRequestType(Command_t command);
+
     /** HasFilesystemIF overrides */
     ReturnValue_t createFile(const char* repositoryPath, const char* filename, const uint8_t* data,
             size_t size, FileSystemArgsIF* args = nullptr) override;
@@ -175,6 +259,12 @@ private:
     ReturnValue_t handleCreateDirectoryCommand(CommandMessage* message);
     ReturnValue_t handleDeleteDirectoryCommand(CommandMessage* message);
     ReturnValue_t handleCopyCommand(CommandMessage* message);
+    ReturnValue_t handleMoveCommand(CommandMessage* message);
+    ReturnValue_t handleSplitCommand(CommandMessage* message);
+    ReturnValue_t handleChecksumCommand(CommandMessage* message);
+    ReturnValue_t handleListingCommand(CommandMessage* message, bool findFiles);
+    ReturnValue_t sendListingReply(const RepositoryListingReply& replyPacket, bool findFiles,
+            bool lastPage);
 
     ReturnValue_t handleAppendCommand(CommandMessage* message);
     ReturnValue_t handleFinishAppendCommand(CommandMessage* message);
@@ -190,6 +280,11 @@ private:
     /** Specifying NO_QUEUE as queueId will cause a reply to the last sender */
     void sendCompletionMessage(bool success, MessageQueueId_t queueId,
             ReturnValue_t errorCode = HasReturnvaluesIF::RETURN_OK, uint32_t errorParam = 0);
+    /** Completion reply for I/O requests, which is sent with the I/O reply queue */
+    void sendIoCompletionReply(bool success = true,
+            ReturnValue_t errorCode = HasReturnvaluesIF::RETURN_OK, uint32_t errorParam = 0);
+    void sendCompletionMessage(MessageQueueIF* sendingQueue, bool success,
+            MessageQueueId_t queueId, ReturnValue_t errorCode, uint32_t errorParam);
 
     ReturnValue_t generateFinishAppendReply(RepositoryPath* repoPath, FileName* fileName,
             size_t filesize, bool locked);
@@ -199,6 +294,17 @@ private:
 
     ReturnValue_t handleSdCardAccessResult(SDCardAccess& sdCardAccess);
     void driveStateMachine();
+    void releaseSdCardAccessIfIdle();
+    uint32_t getRemainingCycleTimeMs() const;
+    void sendCopyCompletionMessage(MessageQueueId_t queueId, uint32_t bytesCopied,
+            uint32_t bytesPerSecond);
+    /* Sends the checksum reply followed by the completion reply */
+    void sendChecksumReply(MessageQueueId_t queueId, const RepositoryPath& repoPath,
+            const FileName& fileName, uint8_t checksumType, uint32_t checksum,
+            uint32_t fileSize);
+    /* Invalidates cached listings and records the change for the SD card mirror */
+    void recordFileSystemChange(const char* repositoryPath, const char* name,
+            SDCardMirror::ChangeType changeType);
 
     /* Static helper function to print out the SD card */
     static ReturnValue_t printFilesystemHelper(uint8_t recursionDepth);
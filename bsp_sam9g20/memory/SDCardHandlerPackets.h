@@ -2,6 +2,10 @@
 #define SAM9G20_MEMORY_SDCARDHANDLERPACKETS_H_
 
 #include "sdcardDefinitions.h"
+#include "sdcardHandlerDefinitions.h"
+#include "IoLatencyHistogram.h"
+#include "DirectoryListingCache.h"
+#include "SDCAccessManager.h"
 
 #include <fsfw/serialize/SerialLinkedListAdapter.h>
 #include <fsfw/serialize/SerialFixedArrayListAdapter.h>
@@ -45,6 +49,87 @@ private:
     SerializeElement<uint8_t> volumeId;
 };
 
+/**
+ * @brief   Reply containing the access and contention counters of the SD card access manager.
+ */
+class AccessStatisticsReply: public SerialLinkedListAdapter<SerializeIF> {
+public:
+    AccessStatisticsReply(const SDCardAccessManager::AccessStatistics& statistics):
+            sharedAccesses(statistics.sharedAccesses),
+            volumeMounts(statistics.volumeMounts),
+            deniedAccesses(statistics.deniedAccesses),
+            stateLockContentions(statistics.stateLockContentions),
+            volumeLockContentions(statistics.volumeLockContentions),
+            deferredSdCardChanges(statistics.deferredSdCardChanges),
+            maxConcurrentAccesses(statistics.maxConcurrentAccesses) {
+        setStart(&this->sharedAccesses);
+        this->sharedAccesses.setNext(&this->volumeMounts);
+        this->volumeMounts.setNext(&this->deniedAccesses);
+        this->deniedAccesses.setNext(&this->stateLockContentions);
+        this->stateLockContentions.setNext(&this->volumeLockContentions);
+        this->volumeLockContentions.setNext(&this->deferredSdCardChanges);
+        this->deferredSdCardChanges.setNext(&this->maxConcurrentAccesses);
+    }
+private:
+    SerializeElement<uint32_t> sharedAccesses;
+    SerializeElement<uint32_t> volumeMounts;
+    SerializeElement<uint32_t> deniedAccesses;
+    SerializeElement<uint32_t> stateLockContentions;
+    SerializeElement<uint32_t> volumeLockContentions;
+    SerializeElement<uint32_t> deferredSdCardChanges;
+    SerializeElement<uint8_t> maxConcurrentAccesses;
+};
+
+/**
+ * @brief   Reply containing the number of pending I/O requests, the number of
+ *          rejected requests and the latency histograms for each request type.
+ */
+class IoStatisticsReply: public SerializeIF {
+public:
+    IoStatisticsReply(uint8_t pendingRequests, uint32_t rejectedRequests,
+            const IoLatencyHistogram* histograms, size_t numberOfHistograms):
+                pendingRequests(pendingRequests), rejectedRequests(rejectedRequests),
+                histograms(histograms), numberOfHistograms(numberOfHistograms) {}
+
+    ReturnValue_t serialize(uint8_t **buffer, size_t *size,
+            size_t maxSize, Endianness streamEndianness) const override {
+        ReturnValue_t result = SerializeAdapter::serialize(&pendingRequests, buffer, size,
+                maxSize, streamEndianness);
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
+        }
+        result = SerializeAdapter::serialize(&rejectedRequests, buffer, size,
+                maxSize, streamEndianness);
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
+        }
+        for(size_t idx = 0; idx < numberOfHistograms; idx++) {
+            result = histograms[idx].serialize(buffer, size, maxSize, streamEndianness);
+            if(result != HasReturnvaluesIF::RETURN_OK) {
+                return result;
+            }
+        }
+        return HasReturnvaluesIF::RETURN_OK;
+    }
+
+    size_t getSerializedSize() const override {
+        size_t serializedSize = sizeof(pendingRequests) + sizeof(rejectedRequests);
+        for(size_t idx = 0; idx < numberOfHistograms; idx++) {
+            serializedSize += histograms[idx].getSerializedSize();
+        }
+        return serializedSize;
+    }
+
+    ReturnValue_t deSerialize(const uint8_t **buffer, size_t *size,
+            Endianness streamEndianness) override {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+private:
+    uint8_t pendingRequests;
+    uint32_t rejectedRequests;
+    const IoLatencyHistogram* histograms;
+    size_t numberOfHistograms;
+};
 
 /**
  * @brief 	Generic class for all packets containg a repository and a file
@@ -206,6 +291,250 @@ class LockFileCommand: public GenericFilePacket {};
 class CopyFileCommand: public GenericSourceTargetCommand {};
 class MoveFileCommand: public GenericSourceTargetCommand {};
 
+/**
+ * @brief   Split command. The target filename is used as the base name of the part files.
+ *          The source and target are followed by the part size as an uint32_t.
+ */
+class SplitFileCommand: public GenericSourceTargetCommand {
+public:
+    ReturnValue_t deSerialize(const uint8_t **buffer, size_t *size,
+            Endianness streamEndianness) override {
+        ReturnValue_t result = GenericSourceTargetCommand::deSerialize(buffer, size,
+                streamEndianness);
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
+        }
+        return SerializeAdapter::deSerialize(&partSize, buffer, size, streamEndianness);
+    }
+
+    uint32_t getPartSize() const {
+        return partSize;
+    }
+private:
+    uint32_t partSize = 0;
+};
+
+/**
+ * @brief   Checksum command. The repository and filename can be followed by the
+ *          checksum type (sdchandler::ChecksumType). CRC32 is used if it is omitted.
+ */
+class ChecksumCommand: public GenericFilePacket {
+public:
+    ReturnValue_t deSerialize(const uint8_t **buffer, size_t *size,
+            Endianness streamEndianness) override {
+        ReturnValue_t result = GenericFilePacket::deSerialize(buffer, size,
+                streamEndianness);
+        if(result != HasReturnvaluesIF::RETURN_OK or *size == 0) {
+            return result;
+        }
+        return SerializeAdapter::deSerialize(&checksumType, buffer, size, streamEndianness);
+    }
+
+    uint8_t getChecksumType() const {
+        return checksumType;
+    }
+private:
+    uint8_t checksumType = sdchandler::CRC32;
+};
+
+/**
+ * @brief   Command to list the content of a repository (TC[23,12]) or to find files in a
+ *          repository (TC[23,7]).
+ * @details
+ * Content:
+ *  1. The repository path as string
+ *  2. Only for find commands: the search pattern as string, which can contain the
+ *     wildcards '*' and '?'
+ *  3. Optional: Index of the first entry to report as an uint16_t. Defaults to 0
+ *  4. Optional: Maximum number of entries to report as an uint16_t. 0 or omitting it
+ *     reports as many entries as possible
+ */
+class RepositoryListingCommand: public SerializeIF {
+public:
+    RepositoryListingCommand(bool withPattern): withPattern(withPattern) {}
+
+    ReturnValue_t deSerialize(const uint8_t **buffer, size_t *size,
+            Endianness streamEndianness) override {
+        ReturnValue_t result = HasReturnvaluesIF::RETURN_OK;
+        if(withPattern) {
+            result = deSerializeRepositoryAndFilename(buffer, size, repositoryPath, pattern);
+        }
+        else {
+            result = deSerializeRepository(buffer, size);
+        }
+        if(result != HasReturnvaluesIF::RETURN_OK or *size == 0) {
+            return result;
+        }
+        result = SerializeAdapter::deSerialize(&startIndex, buffer, size, streamEndianness);
+        if(result != HasReturnvaluesIF::RETURN_OK or *size == 0) {
+            return result;
+        }
+        return SerializeAdapter::deSerialize(&maxEntries, buffer, size, streamEndianness);
+    }
+
+    size_t getSerializedSize() const override {
+        return 0;
+    }
+
+    ReturnValue_t serialize(uint8_t **buffer, size_t *size,
+            size_t maxSize, Endianness streamEndianness) const override {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+
+    RepositoryPath* getRepoPath() {
+        return &repositoryPath;
+    }
+
+    /** Returns nullptr for listing commands */
+    FileName* getPattern() {
+        if(not withPattern) {
+            return nullptr;
+        }
+        return &pattern;
+    }
+
+    uint16_t getStartIndex() const {
+        return startIndex;
+    }
+
+    uint16_t getMaxEntries() const {
+        return maxEntries;
+    }
+
+private:
+    bool withPattern;
+    RepositoryPath repositoryPath;
+    FileName pattern;
+    uint16_t startIndex = 0;
+    uint16_t maxEntries = 0;
+
+    ReturnValue_t deSerializeRepository(const uint8_t **buffer, size_t *size) {
+        if(*buffer == nullptr) {
+            return HasReturnvaluesIF::RETURN_FAILED;
+        }
+        size_t repositoryLength = strnlen(reinterpret_cast<const char*>(*buffer), *size);
+        if(repositoryLength == *size) {
+            /* No terminator */
+            return SerializeIF::STREAM_TOO_SHORT;
+        }
+        if(repositoryLength > MAX_REPOSITORY_PATH_LENGTH) {
+            return SerializeIF::TOO_MANY_ELEMENTS;
+        }
+        repositoryPath.assign(reinterpret_cast<const char*>(*buffer));
+        *buffer += repositoryLength + 1;
+        *size -= repositoryLength + 1;
+        return HasReturnvaluesIF::RETURN_OK;
+    }
+};
+
+/**
+ * @brief   One page of a repository listing (TM[23,13]) or of the files found in a
+ *          repository (TM[23,8]).
+ * @details
+ * Content:
+ *  1. The repository path as string
+ *  2. Only for found files replies: the search pattern as string
+ *  3. Total number of (matching) entries in the repository as an uint16_t
+ *  4. Index of the first entry in this packet as an uint16_t
+ *  5. Number of entries in this packet as an uint8_t
+ *  6. For each entry: directory flag as an uint8_t, size as an uint32_t and the name
+ *     as string
+ */
+class RepositoryListingReply: public SerializeIF {
+public:
+    RepositoryListingReply(const RepositoryPath* repoPath, const FileName* pattern,
+            uint16_t totalEntries, uint16_t firstIndex,
+            const DirectoryListingCache::Entry* entries, uint8_t numberOfEntries):
+                repoPath(repoPath), pattern(pattern), totalEntries(totalEntries),
+                firstIndex(firstIndex), entries(entries), numberOfEntries(numberOfEntries) {}
+
+    ReturnValue_t serialize(uint8_t **buffer, size_t *size,
+            size_t maxSize, Endianness streamEndianness) const override {
+        ReturnValue_t result = serializeString(buffer, size, maxSize, repoPath->c_str());
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
+        }
+        if(pattern != nullptr) {
+            result = serializeString(buffer, size, maxSize, pattern->c_str());
+            if(result != HasReturnvaluesIF::RETURN_OK) {
+                return result;
+            }
+        }
+        result = SerializeAdapter::serialize(&totalEntries, buffer, size, maxSize,
+                streamEndianness);
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
+        }
+        result = SerializeAdapter::serialize(&firstIndex, buffer, size, maxSize,
+                streamEndianness);
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
+        }
+        result = SerializeAdapter::serialize(&numberOfEntries, buffer, size, maxSize,
+                streamEndianness);
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
+        }
+        for(uint8_t idx = 0; idx < numberOfEntries; idx++) {
+            uint8_t isDirectory = entries[idx].isDirectory;
+            result = SerializeAdapter::serialize(&isDirectory, buffer, size, maxSize,
+                    streamEndianness);
+            if(result != HasReturnvaluesIF::RETURN_OK) {
+                return result;
+            }
+            result = SerializeAdapter::serialize(&entries[idx].size, buffer, size, maxSize,
+                    streamEndianness);
+            if(result != HasReturnvaluesIF::RETURN_OK) {
+                return result;
+            }
+            result = serializeString(buffer, size, maxSize, entries[idx].name);
+            if(result != HasReturnvaluesIF::RETURN_OK) {
+                return result;
+            }
+        }
+        return HasReturnvaluesIF::RETURN_OK;
+    }
+
+    size_t getSerializedSize() const override {
+        size_t serializedSize = repoPath->size() + 1 + sizeof(totalEntries) +
+                sizeof(firstIndex) + sizeof(numberOfEntries);
+        if(pattern != nullptr) {
+            serializedSize += pattern->size() + 1;
+        }
+        for(uint8_t idx = 0; idx < numberOfEntries; idx++) {
+            serializedSize += sizeof(uint8_t) + sizeof(entries[idx].size) +
+                    std::strlen(entries[idx].name) + 1;
+        }
+        return serializedSize;
+    }
+
+    ReturnValue_t deSerialize(const uint8_t **buffer, size_t *size,
+            Endianness streamEndianness) override {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+
+private:
+    const RepositoryPath* repoPath;
+    const FileName* pattern;
+    uint16_t totalEntries;
+    uint16_t firstIndex;
+    const DirectoryListingCache::Entry* entries;
+    uint8_t numberOfEntries;
+
+    static ReturnValue_t serializeString(uint8_t **buffer, size_t *size, size_t maxSize,
+            const char* string) {
+        size_t stringLength = std::strlen(string);
+        if(*size + stringLength + 1 > maxSize) {
+            return SerializeIF::BUFFER_TOO_SHORT;
+        }
+        /* Including the terminator */
+        std::memcpy(*buffer, string, stringLength + 1);
+        *buffer += stringLength + 1;
+        *size += stringLength + 1;
+        return HasReturnvaluesIF::RETURN_OK;
+    }
+};
+
 class CreateDirectoryCommand: public GenericDirectoryPacket {};
 class DeleteDirectoryCommand: public GenericDirectoryPacket {};
 
@@ -412,6 +741,52 @@ private:
 
 };
 
+/**
+ * @brief   Reply to a checksum command. Contains the repository path, the filename,
+ *          the checksum type, the checksum and the file size.
+ */
+class ChecksumReply: public SerialLinkedListAdapter<SerializeIF> {
+public:
+    ChecksumReply(const RepositoryPath* repoPath, const FileName* fileName,
+            uint8_t checksumType, uint32_t checksum, uint32_t fileSize):
+                repoPath(repoPath), fileName(fileName), checksumType(checksumType),
+                checksum(checksum), fileSize(fileSize) {
+        setStart(&this->checksumType);
+        this->checksumType.setNext(&this->checksum);
+        this->checksum.setNext(&this->fileSize);
+        this->fileSize.setEnd();
+    }
+
+    ReturnValue_t serialize(uint8_t **buffer, size_t *size,
+            size_t maxSize, Endianness streamEndianness) const override {
+        ReturnValue_t result = serializeRepositoryAndFilename(buffer, size,
+                maxSize, const_cast<RepositoryPath&>(*repoPath),
+                const_cast<FileName&>(*fileName));
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
+        }
+        return SerialLinkedListAdapter::serialize(buffer, size, maxSize,
+                streamEndianness);
+    }
+
+    size_t getSerializedSize() const override {
+        return repoPath->size() + fileName->size() + 2 +
+                SerialLinkedListAdapter::getSerializedSize();
+    }
+
+    ReturnValue_t deSerialize(const uint8_t **buffer, size_t *size,
+            Endianness streamEndianness) override {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+
+private:
+    const RepositoryPath* repoPath;
+    const FileName* fileName;
+    SerializeElement<uint8_t> checksumType;
+    SerializeElement<uint32_t> checksum;
+    SerializeElement<uint32_t> fileSize;
+};
+
 /**
  * @brief This Class extracts the repository path and the filename from the
  *        data buffer of a read command file system message
@@ -0,0 +1,94 @@
+#include "SDCardIoWorker.h"
+#include "SDCardHandler.h"
+#include "SDCardAccess.h"
+
+#include "mission/memory/FileSystemMessage.h"
+#include "mission/utility/obswTrace.h"
+
+#include "fsfw/ipc/CommandMessage.h"
+#include "fsfw/ipc/QueueFactory.h"
+#include "fsfw/objectmanager/ObjectManager.h"
+#include "fsfw/serviceinterface/ServiceInterface.h"
+#include "fsfw/timemanager/Clock.h"
+
+SDCardIoWorker::SDCardIoWorker(object_id_t objectId, object_id_t sdCardHandlerId):
+        SystemObject(objectId),
+        requestQueue(QueueFactory::instance()->createMessageQueue(REQUEST_QUEUE_DEPTH)),
+        sdCardHandlerId(sdCardHandlerId) {
+}
+
+SDCardIoWorker::~SDCardIoWorker() {
+    QueueFactory::instance()->deleteMessageQueue(requestQueue);
+}
+
+ReturnValue_t SDCardIoWorker::initialize() {
+    sdCardHandler = ObjectManager::instance()->get<SDCardHandler>(sdCardHandlerId);
+    if(sdCardHandler == nullptr) {
+#if FSFW_CPP_OSTREAM_ENABLED == 1
+        sif::error << "SDCardIoWorker::initialize: SD card handler invalid!" << std::endl;
+#else
+        sif::printError("SDCardIoWorker::initialize: SD card handler invalid!\n");
+#endif
+        return ObjectManagerIF::CHILD_INIT_FAILED;
+    }
+    /* From now on, the handler will forward file requests to this worker */
+    sdCardHandler->registerIoWorker(requestQueue);
+    return SystemObject::initialize();
+}
+
+MessageQueueId_t SDCardIoWorker::getRequestQueueId() const {
+    return requestQueue->getId();
+}
+
+ReturnValue_t SDCardIoWorker::performOperation(uint8_t operationCode) {
+    CommandMessage message;
+    ReturnValue_t result = requestQueue->receiveMessage(&message);
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        return HasReturnvaluesIF::RETURN_OK;
+    }
+
+    /* Only open the file system if there is something to do. The access is closed
+    automatically on function exit. */
+    SDCardAccess sdCardAccess;
+    while(result == HasReturnvaluesIF::RETURN_OK) {
+        Command_t command = message.getCommand();
+        uint32_t requestId = FileSystemMessage::getIoRequestId(&message);
+        ReturnValue_t requestResult = sdCardAccess.getAccessResult();
+        if(requestResult == HasReturnvaluesIF::RETURN_OK) {
+            OBSW_TRACE_BEGIN(traceid::SD_CARD_IO_REQUEST, command);
+            requestResult = sdCardHandler->handleIoRequest(&message);
+            OBSW_TRACE_END(traceid::SD_CARD_IO_REQUEST, requestResult);
+        }
+        else {
+            /* Requester still expects a reply */
+            sdCardHandler->sendIoCompletionReply(false, requestResult);
+            FileSystemMessage::clear(&message);
+        }
+        sendCompletionNotification(requestId, command, requestResult);
+        result = requestQueue->receiveMessage(&message);
+    }
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+void SDCardIoWorker::sendCompletionNotification(uint32_t requestId, Command_t processedCommand,
+        ReturnValue_t result) {
+    uint32_t completionTimeMs = 0;
+    Clock::getUptime(&completionTimeMs);
+    CommandMessage notification;
+    FileSystemMessage::setIoRequestDoneNotification(&notification, requestId, processedCommand,
+            result, completionTimeMs);
+    ReturnValue_t sendResult = requestQueue->sendMessage(sdCardHandler->getCommandQueue(),
+            &notification);
+    if(sendResult != HasReturnvaluesIF::RETURN_OK) {
+        /* The handler releases the pending request after a timeout */
+#if OBSW_VERBOSE_LEVEL >= 1
+#if FSFW_CPP_OSTREAM_ENABLED == 1
+        sif::warning << "SDCardIoWorker::sendCompletionNotification: Sending notification "
+                "failed!" << std::endl;
+#else
+        sif::printWarning("SDCardIoWorker::sendCompletionNotification: Sending notification "
+                "failed!\n");
+#endif
+#endif
+    }
+}
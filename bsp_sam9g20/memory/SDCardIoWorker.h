@@ -0,0 +1,49 @@
+#ifndef SAM9G20_MEMORY_SDCARDIOWORKER_H_
+#define SAM9G20_MEMORY_SDCARDIOWORKER_H_
+
+#include "OBSWConfig.h"
+
+#include <fsfw/objectmanager/SystemObject.h>
+#include <fsfw/tasks/ExecutableObjectIF.h>
+#include <fsfw/ipc/MessageQueueIF.h>
+
+class SDCardHandler;
+
+/**
+ * @brief   Background worker which processes potentially long-running file requests
+ *          (reads, writes and deletions) on behalf of the SD card handler.
+ * @details
+ * The SD card handler forwards these requests into the bounded request queue of this worker,
+ * keeping the original sender. The worker executes the request in its own task and replies
+ * directly to the original sender, with the command queue of the handler as sender. After each
+ * request, a completion notification with the ID of the request is sent back to the SD card
+ * handler, which uses it to track the pending requests and the request latencies. This way, the handler can keep processing commands and status queries
+ * while slow SD card operations are going on.
+ */
+class SDCardIoWorker:
+        public SystemObject,
+        public ExecutableObjectIF {
+public:
+    static constexpr uint8_t REQUEST_QUEUE_DEPTH = config::SD_CARD_IO_QUEUE_DEPTH;
+
+    SDCardIoWorker(object_id_t objectId, object_id_t sdCardHandlerId);
+    virtual ~SDCardIoWorker();
+
+    MessageQueueId_t getRequestQueueId() const;
+
+    /** SystemObjectIF */
+    ReturnValue_t initialize() override;
+
+    /** ExecutableObjectIF */
+    ReturnValue_t performOperation(uint8_t operationCode = 0) override;
+
+private:
+    MessageQueueIF* requestQueue = nullptr;
+    object_id_t sdCardHandlerId;
+    SDCardHandler* sdCardHandler = nullptr;
+
+    void sendCompletionNotification(uint32_t requestId, Command_t processedCommand,
+            ReturnValue_t result);
+};
+
+#endif /* SAM9G20_MEMORY_SDCARDIOWORKER_H_ */
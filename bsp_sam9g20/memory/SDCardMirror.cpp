@@ -0,0 +1,539 @@
+#include "SDCardMirror.h"
+#include "SDCAccessManager.h"
+#include "sdcardHandlerDefinitions.h"
+
+#include <bsp_sam9g20/common/SDCardApi.h>
+
+#include <fsfw/datapool/PoolReadGuard.h>
+#include <fsfw/ipc/MutexFactory.h>
+#include <fsfw/ipc/MutexGuard.h>
+#include <fsfw/serviceinterface/ServiceInterface.h>
+#include <fsfw/timemanager/Clock.h>
+
+#include <cstring>
+
+SDCardMirror::SDCardMirror(object_id_t objectId):
+        ExtendedControllerBase(objectId, objects::NO_OBJECT), mirrorSet(this) {
+    journalMutex = MutexFactory::instance()->createMutex();
+}
+
+SDCardMirror::~SDCardMirror() {
+    MutexFactory::instance()->deleteMutex(journalMutex);
+}
+
+ReturnValue_t SDCardMirror::initializeAfterTaskCreation() {
+    ReturnValue_t result = ExtendedControllerBase::initializeAfterTaskCreation();
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        return result;
+    }
+    /* Leave enough time for other low priority tasks */
+    countdown.setTimeout(0.5 * executingTask->getPeriodMs());
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+void SDCardMirror::recordChange(const char *repositoryPath, const char *name,
+        ChangeType changeType) {
+    uint32_t currentTimeMs = 0;
+    Clock::getUptime(&currentTimeMs);
+    VolumeId activeVolume = SDCardAccessManager::instance()->getActiveSdCard();
+    bool overflow = false;
+    {
+        MutexGuard mg(journalMutex, MutexIF::TimeoutType::WAITING,
+                config::SD_CARD_ACCESS_MUTEX_TIMEOUT);
+        JournalEntry* freeEntry = nullptr;
+        for(auto& entry: journal) {
+            if(not entry.valid) {
+                if(freeEntry == nullptr) {
+                    freeEntry = &entry;
+                }
+                continue;
+            }
+            if(entry.repositoryPath == repositoryPath and entry.name == name) {
+                /* Only the last change of a file is relevant */
+                entry.changeType = changeType;
+                entry.sourceVolume = activeVolume;
+                entry.lastChangeMs = currentTimeMs;
+                entry.changeCounter++;
+                return;
+            }
+        }
+
+        if(freeEntry == nullptr) {
+            journalOverflows++;
+            outOfSync = true;
+            overflow = true;
+        }
+        else {
+            freeEntry->repositoryPath = repositoryPath;
+            freeEntry->name = name;
+            freeEntry->changeType = changeType;
+            freeEntry->sourceVolume = activeVolume;
+            freeEntry->lastChangeMs = currentTimeMs;
+            freeEntry->changeCounter++;
+            freeEntry->valid = true;
+            journalEntries++;
+        }
+    }
+
+    if(overflow) {
+        triggerEvent(sdcmirror::JOURNAL_OVERFLOW, journalOverflows);
+#if OBSW_VERBOSE_LEVEL >= 1
+#if FSFW_CPP_OSTREAM_ENABLED == 1
+        sif::warning << "SDCardMirror::recordChange: Journal full, change of " <<
+                repositoryPath << "/" << name << " lost" << std::endl;
+#else
+        sif::printWarning("SDCardMirror::recordChange: Journal full, change of %s/%s lost\n",
+                repositoryPath, name);
+#endif
+#endif
+    }
+}
+
+void SDCardMirror::performControlOperation() {
+    countdown.resetTimer();
+    if(not mirroringEnabled) {
+        if(currentEntryIdx >= 0) {
+            postponeCurrentEntry();
+        }
+        releaseAccess();
+        updateHousekeeping();
+        return;
+    }
+
+    if(SDCardAccessManager::instance()->getSdCardChangeOngoing()) {
+        /* Release the SD card so the change can complete. The current entry is replicated
+        again afterwards, the source volume of the entry is still known. */
+        if(currentEntryIdx >= 0) {
+            postponeCurrentEntry();
+        }
+        releaseAccess();
+        updateHousekeeping();
+        return;
+    }
+
+    if(currentEntryIdx < 0 and not selectNextEntry()) {
+        releaseAccess();
+        updateHousekeeping();
+        return;
+    }
+
+    ReturnValue_t result = acquireAccess();
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        postponeCurrentEntry();
+        updateHousekeeping();
+        return;
+    }
+
+    while(countdown.isBusy()) {
+        result = replicateStep();
+        if(result == sdchandler::OPERATION_FINISHED) {
+            completeCurrentEntry();
+            if(not selectNextEntry()) {
+                break;
+            }
+        }
+        else if(result != HasReturnvaluesIF::RETURN_OK) {
+            replicationFailures++;
+            triggerEvent(sdcmirror::REPLICATION_FAILED, result, currentEntry.changeType);
+            postponeCurrentEntry();
+            break;
+        }
+    }
+
+    /* Keep the SD cards mounted while a file is replicated over multiple cycles */
+    if(currentEntryIdx < 0) {
+        releaseAccess();
+    }
+    updateHousekeeping();
+}
+
+bool SDCardMirror::selectNextEntry() {
+    uint32_t currentTimeMs = 0;
+    Clock::getUptime(&currentTimeMs);
+    MutexGuard mg(journalMutex, MutexIF::TimeoutType::WAITING,
+            config::SD_CARD_ACCESS_MUTEX_TIMEOUT);
+    int oldestIdx = -1;
+    for(size_t idx = 0; idx < journal.size(); idx++) {
+        const JournalEntry& entry = journal[idx];
+        if(not entry.valid) {
+            continue;
+        }
+        /* Skip entries which are still being changed */
+        if(currentTimeMs - entry.lastChangeMs < config::SD_CARD_MIRROR_SETTLE_TIME_MS) {
+            continue;
+        }
+        if(oldestIdx < 0 or entry.lastChangeMs < journal[oldestIdx].lastChangeMs) {
+            oldestIdx = idx;
+        }
+    }
+    if(oldestIdx < 0) {
+        return false;
+    }
+    currentEntryIdx = oldestIdx;
+    currentEntry = journal[oldestIdx];
+    bytesLeft = 0;
+    return true;
+}
+
+void SDCardMirror::completeCurrentEntry() {
+    closeFiles();
+    bool inSync = false;
+    {
+        MutexGuard mg(journalMutex, MutexIF::TimeoutType::WAITING,
+                config::SD_CARD_ACCESS_MUTEX_TIMEOUT);
+        JournalEntry& entry = journal[currentEntryIdx];
+        /* If the entry was changed during the replication, it needs to be replicated again */
+        if(entry.valid and entry.changeCounter == currentEntry.changeCounter) {
+            entry.valid = false;
+            journalEntries--;
+        }
+        inSync = journalEntries == 0 and not outOfSync;
+    }
+    currentEntryIdx = -1;
+    entriesReplicated++;
+    entriesSinceLastSync++;
+    if(inSync) {
+        triggerEvent(sdcmirror::MIRROR_IN_SYNC, entriesSinceLastSync);
+        entriesSinceLastSync = 0;
+    }
+}
+
+void SDCardMirror::postponeCurrentEntry() {
+    closeFiles();
+    uint32_t currentTimeMs = 0;
+    Clock::getUptime(&currentTimeMs);
+    {
+        MutexGuard mg(journalMutex, MutexIF::TimeoutType::WAITING,
+                config::SD_CARD_ACCESS_MUTEX_TIMEOUT);
+        JournalEntry& entry = journal[currentEntryIdx];
+        if(entry.valid and entry.changeCounter == currentEntry.changeCounter) {
+            /* Retry after the settle time */
+            entry.lastChangeMs = currentTimeMs;
+        }
+    }
+    currentEntryIdx = -1;
+}
+
+ReturnValue_t SDCardMirror::acquireAccess() {
+    if(mountRetryDelayCycles > 0) {
+        /* Do not access the SD cards each cycle while the mirror can not be mounted */
+        mountRetryDelayCycles--;
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    if(not sdCardAccess.has_value()) {
+        sdCardAccess.emplace();
+        ReturnValue_t result = sdCardAccess->getAccessResult();
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            sdCardAccess.reset();
+            return result;
+        }
+    }
+    if(not mirrorDriveMounted) {
+        VolumeId inactiveVolume = SD_CARD_0;
+        if(sdCardAccess->getActiveVolume() == SD_CARD_0) {
+            inactiveVolume = SD_CARD_1;
+        }
+        int result = mount_mirror_sd_card(inactiveVolume);
+        if(result != F_NO_ERROR) {
+            sdCardAccess.reset();
+            mountFailures++;
+            if(mountRetryDelay == 0) {
+                mountRetryDelay = 1;
+            }
+            else if(mountRetryDelay < MAX_MOUNT_RETRY_DELAY_CYCLES) {
+                mountRetryDelay *= 2;
+            }
+            mountRetryDelayCycles = mountRetryDelay;
+            replicationFailures++;
+            triggerEvent(sdcmirror::MIRROR_MOUNT_FAILED, result, mountFailures);
+#if OBSW_VERBOSE_LEVEL >= 1
+#if FSFW_CPP_OSTREAM_ENABLED == 1
+            sif::warning << "SDCardMirror::acquireAccess: Mounting SD card " <<
+                    static_cast<int>(inactiveVolume) << " failed with code " << result <<
+                    std::endl;
+#else
+            sif::printWarning("SDCardMirror::acquireAccess: Mounting SD card %d failed with "
+                    "code %d\n", static_cast<int>(inactiveVolume), result);
+#endif
+#endif
+            return result;
+        }
+        mountFailures = 0;
+        mountRetryDelay = 0;
+        mirrorDriveMounted = true;
+    }
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+void SDCardMirror::releaseAccess() {
+    if(not sdCardAccess.has_value()) {
+        return;
+    }
+    closeFiles();
+    if(mirrorDriveMounted) {
+        /* The mirror drive has to be removed before the file system is closed */
+        f_chdrive(PRIMARY_DRIVE);
+        unmount_mirror_sd_card();
+        mirrorDriveMounted = false;
+    }
+    sdCardAccess.reset();
+}
+
+void SDCardMirror::closeFiles() {
+    if(sourceFile != nullptr) {
+        f_close(sourceFile);
+        sourceFile = nullptr;
+    }
+    if(targetFile != nullptr) {
+        f_close(targetFile);
+        targetFile = nullptr;
+    }
+}
+
+ReturnValue_t SDCardMirror::replicateStep() {
+    switch(currentEntry.changeType) {
+    case(FILE_UPDATED): {
+        break;
+    }
+    case(FILE_DELETED): {
+        return replicateDeletion();
+    }
+    case(DIRECTORY_CREATED): {
+        return replicateDirectoryCreation();
+    }
+    case(DIRECTORY_DELETED): {
+        return replicateDirectoryDeletion();
+    }
+    default: {
+        return sdchandler::OPERATION_FINISHED;
+    }
+    }
+
+    if(sourceFile == nullptr) {
+        ReturnValue_t result = openFilesForReplication();
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return result;
+        }
+    }
+
+    size_t sizeToCopy = bytesLeft;
+    if(sizeToCopy > chunkBuffer.size()) {
+        sizeToCopy = chunkBuffer.size();
+    }
+    if(sizeToCopy > 0) {
+        long sizeReadOrWritten = f_read(chunkBuffer.data(), sizeof(uint8_t), sizeToCopy,
+                sourceFile);
+        if(sizeReadOrWritten != static_cast<long>(sizeToCopy)) {
+            return f_getlasterror();
+        }
+        sizeReadOrWritten = f_write(chunkBuffer.data(), sizeof(uint8_t), sizeToCopy, targetFile);
+        if(sizeReadOrWritten != static_cast<long>(sizeToCopy)) {
+            return f_getlasterror();
+        }
+        bytesLeft -= sizeToCopy;
+        bytesReplicated += sizeToCopy;
+    }
+
+    if(bytesLeft == 0) {
+        closeFiles();
+        return sdchandler::OPERATION_FINISHED;
+    }
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t SDCardMirror::openFilesForReplication() {
+    f_chdrive(getSourceDrive());
+    int result = change_directory(currentEntry.repositoryPath.c_str(), true);
+    if(result == F_ERR_NOTFOUND or result == F_ERR_INVALIDDIR) {
+        /* Repository was removed in the meantime, which will be replicated separately */
+        return sdchandler::OPERATION_FINISHED;
+    }
+    else if(result != F_NO_ERROR) {
+        return result;
+    }
+
+    long fileLength = f_filelength(currentEntry.name.c_str());
+    if(fileLength < 0) {
+        /* File was removed in the meantime */
+        return sdchandler::OPERATION_FINISHED;
+    }
+    sourceFile = f_open(currentEntry.name.c_str(), "r");
+    if(sourceFile == nullptr) {
+        return f_getlasterror();
+    }
+    bytesLeft = fileLength;
+
+    f_chdrive(getTargetDrive());
+    result = createDirectoryPath(currentEntry.repositoryPath.c_str());
+    if(result != F_NO_ERROR) {
+        closeFiles();
+        return result;
+    }
+    targetFile = f_open(currentEntry.name.c_str(), "w");
+    if(targetFile == nullptr) {
+        closeFiles();
+        return f_getlasterror();
+    }
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t SDCardMirror::replicateDeletion() {
+    f_chdrive(getTargetDrive());
+    int result = delete_file(currentEntry.repositoryPath.c_str(), currentEntry.name.c_str());
+    if(result == F_NO_ERROR or result == F_ERR_NOTFOUND or result == F_ERR_INVALIDDIR) {
+        return sdchandler::OPERATION_FINISHED;
+    }
+    return result;
+}
+
+ReturnValue_t SDCardMirror::replicateDirectoryCreation() {
+    f_chdrive(getTargetDrive());
+    int result = createDirectoryPath(currentEntry.repositoryPath.c_str());
+    if(result != F_NO_ERROR) {
+        return result;
+    }
+    result = f_mkdir(currentEntry.name.c_str());
+    if(result == F_NO_ERROR or result == F_ERR_DUPLICATED) {
+        return sdchandler::OPERATION_FINISHED;
+    }
+    return result;
+}
+
+ReturnValue_t SDCardMirror::replicateDirectoryDeletion() {
+    f_chdrive(getTargetDrive());
+    int result = delete_directory_force(currentEntry.repositoryPath.c_str(),
+            currentEntry.name.c_str(), true);
+    if(result == F_NO_ERROR or result == F_ERR_NOTFOUND or result == F_ERR_INVALIDDIR) {
+        return sdchandler::OPERATION_FINISHED;
+    }
+    return result;
+}
+
+int SDCardMirror::createDirectoryPath(const char *repositoryPath) {
+    /* Equivalent of mkdir -p, the repository will be the current directory afterwards */
+    char pathBuffer[MAX_REPOSITORY_PATH_LENGTH + 1];
+    std::strncpy(pathBuffer, repositoryPath, sizeof(pathBuffer) - 1);
+    pathBuffer[sizeof(pathBuffer) - 1] = '\0';
+    f_chdir("/");
+    char* savePtr = nullptr;
+    char* directory = strtok_r(pathBuffer, "/", &savePtr);
+    while(directory != nullptr) {
+        int result = f_chdir(directory);
+        if(result != F_NO_ERROR) {
+            result = f_mkdir(directory);
+            if(result != F_NO_ERROR and result != F_ERR_DUPLICATED) {
+                return result;
+            }
+            result = f_chdir(directory);
+            if(result != F_NO_ERROR) {
+                return result;
+            }
+        }
+        directory = strtok_r(nullptr, "/", &savePtr);
+    }
+    return F_NO_ERROR;
+}
+
+int SDCardMirror::getSourceDrive() const {
+    if(currentEntry.sourceVolume == sdCardAccess->getActiveVolume()) {
+        return PRIMARY_DRIVE;
+    }
+    /* The SD card was switched since the change was recorded */
+    return MIRROR_DRIVE;
+}
+
+int SDCardMirror::getTargetDrive() const {
+    if(getSourceDrive() == PRIMARY_DRIVE) {
+        return MIRROR_DRIVE;
+    }
+    return PRIMARY_DRIVE;
+}
+
+void SDCardMirror::updateHousekeeping() {
+    PoolReadGuard readHelper(&mirrorSet);
+    if(readHelper.getReadResult() != HasReturnvaluesIF::RETURN_OK) {
+        return;
+    }
+    uint8_t mirrorState = sdcmirror::IN_SYNC;
+    {
+        MutexGuard mg(journalMutex, MutexIF::TimeoutType::WAITING,
+                config::SD_CARD_ACCESS_MUTEX_TIMEOUT);
+        mirrorSet.journalEntries = journalEntries;
+        mirrorSet.journalOverflows = journalOverflows;
+        if(not mirroringEnabled) {
+            mirrorState = sdcmirror::DISABLED;
+        }
+        else if(outOfSync) {
+            mirrorState = sdcmirror::OUT_OF_SYNC;
+        }
+        else if(journalEntries > 0) {
+            mirrorState = sdcmirror::SYNCING;
+        }
+    }
+    mirrorSet.mirrorState = mirrorState;
+    mirrorSet.entriesReplicated = entriesReplicated;
+    mirrorSet.bytesReplicated = bytesReplicated;
+    mirrorSet.replicationFailures = replicationFailures;
+    mirrorSet.currentFileBytesLeft = bytesLeft;
+    mirrorSet.setValidity(true, true);
+}
+
+ReturnValue_t SDCardMirror::handleCommandMessage(CommandMessage *message) {
+    return CommandMessageIF::UNKNOWN_COMMAND;
+}
+
+ReturnValue_t SDCardMirror::checkModeCommand(Mode_t mode, Submode_t submode,
+        uint32_t *msToReachTheMode) {
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t SDCardMirror::executeAction(ActionId_t actionId, MessageQueueId_t commandedBy,
+        const uint8_t *data, size_t size) {
+    switch(actionId) {
+    case(ENABLE_MIRRORING): {
+        mirroringEnabled = true;
+        break;
+    }
+    case(DISABLE_MIRRORING): {
+        mirroringEnabled = false;
+        break;
+    }
+    case(ACKNOWLEDGE_RESYNC): {
+        MutexGuard mg(journalMutex, MutexIF::TimeoutType::WAITING,
+                config::SD_CARD_ACCESS_MUTEX_TIMEOUT);
+        outOfSync = false;
+        break;
+    }
+    default: {
+        return HasActionsIF::INVALID_ACTION_ID;
+    }
+    }
+    actionHelper.finish(true, commandedBy, actionId, HasReturnvaluesIF::RETURN_OK);
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t SDCardMirror::initializeLocalDataPool(localpool::DataPool &localDataPoolMap,
+        LocalDataPoolManager &poolManager) {
+    localDataPoolMap.emplace(sdcmirror::PoolIds::MIRROR_STATE, new PoolEntry<uint8_t>({0}));
+    localDataPoolMap.emplace(sdcmirror::PoolIds::JOURNAL_ENTRIES, new PoolEntry<uint8_t>({0}));
+    localDataPoolMap.emplace(sdcmirror::PoolIds::JOURNAL_OVERFLOWS,
+            new PoolEntry<uint32_t>({0}));
+    localDataPoolMap.emplace(sdcmirror::PoolIds::ENTRIES_REPLICATED,
+            new PoolEntry<uint32_t>({0}));
+    localDataPoolMap.emplace(sdcmirror::PoolIds::BYTES_REPLICATED,
+            new PoolEntry<uint32_t>({0}));
+    localDataPoolMap.emplace(sdcmirror::PoolIds::REPLICATION_FAILURES,
+            new PoolEntry<uint32_t>({0}));
+    localDataPoolMap.emplace(sdcmirror::PoolIds::CURRENT_FILE_BYTES_LEFT,
+            new PoolEntry<uint32_t>({0}));
+    /* Non-diagnostic with a period of 30 seconds, enabled by ground */
+    poolManager.subscribeForPeriodicPacket(mirrorSet.getSid(), false, 30.0, false);
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+LocalPoolDataSetBase* SDCardMirror::getDataSetHandle(sid_t sid) {
+    if(sid == mirrorSet.getSid()) {
+        return &mirrorSet;
+    }
+    return nullptr;
+}
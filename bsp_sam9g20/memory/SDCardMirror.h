@@ -0,0 +1,146 @@
+#ifndef SAM9G20_MEMORY_SDCARDMIRROR_H_
+#define SAM9G20_MEMORY_SDCARDMIRROR_H_
+
+#include "OBSWConfig.h"
+#include "sdcardDefinitions.h"
+#include "sdcardMirrorDefinitions.h"
+#include "SDCardAccess.h"
+
+#include <fsfw/controller/ExtendedControllerBase.h>
+#include <fsfw/timemanager/Countdown.h>
+
+#include <hcc/api_fat.h>
+
+#include <array>
+#include <optional>
+
+class MutexIF;
+
+/**
+ * @brief   Keeps the inactive SD card in sync with the active one.
+ * @details
+ * Components changing files on the active SD card record the change in a small journal.
+ * This low priority component replicates the journal entries to the inactive SD card, which is
+ * mounted as a second drive while there is work to do. Files are copied in chunks until the
+ * cycle budget is used up, so the replication of large files is spread over multiple cycles.
+ * Journal entries are only removed once they were replicated and were not changed again
+ * in the meantime.
+ *
+ * The backlog is reported as housekeeping data. If the journal overflows, changes are lost and
+ * the mirror state is set to out of sync until ground acknowledges a manual resynchronization.
+ */
+class SDCardMirror: public ExtendedControllerBase {
+public:
+    static constexpr uint8_t JOURNAL_SIZE = config::SD_CARD_MIRROR_JOURNAL_SIZE;
+    static constexpr size_t CHUNK_SIZE = config::SD_CARD_MIRROR_CHUNK_SIZE;
+    /* Upper limit of the delay between mount attempts after the inactive SD card
+    could not be mounted */
+    static constexpr uint32_t MAX_MOUNT_RETRY_DELAY_CYCLES = 64;
+
+    enum ChangeType: uint8_t {
+        FILE_UPDATED,
+        FILE_DELETED,
+        DIRECTORY_CREATED,
+        DIRECTORY_DELETED
+    };
+
+    //! [EXPORT] : [COMMAND] Enable replication of journal entries
+    static constexpr ActionId_t ENABLE_MIRRORING = 0;
+    //! [EXPORT] : [COMMAND] Disable replication. Changes are still recorded in the journal
+    static constexpr ActionId_t DISABLE_MIRRORING = 1;
+    //! [EXPORT] : [COMMAND] Clear the out of sync state after a manual resynchronization
+    static constexpr ActionId_t ACKNOWLEDGE_RESYNC = 2;
+
+    SDCardMirror(object_id_t objectId);
+    virtual ~SDCardMirror();
+
+    /**
+     * Record a change on the active SD card. Can be called from any task.
+     * @param repositoryPath    Repository of the changed file or directory
+     * @param name              Name of the changed file or directory
+     * @param changeType
+     */
+    void recordChange(const char* repositoryPath, const char* name, ChangeType changeType);
+
+    ReturnValue_t handleCommandMessage(CommandMessage *message) override;
+    void performControlOperation() override;
+    ReturnValue_t checkModeCommand(Mode_t mode, Submode_t submode,
+            uint32_t *msToReachTheMode) override;
+
+    /** HasActionsIF override */
+    ReturnValue_t executeAction(ActionId_t actionId, MessageQueueId_t commandedBy,
+            const uint8_t* data, size_t size) override;
+
+    /** HasLocalDataPoolIF overrides */
+    ReturnValue_t initializeLocalDataPool(localpool::DataPool& localDataPoolMap,
+            LocalDataPoolManager& poolManager) override;
+    LocalPoolDataSetBase* getDataSetHandle(sid_t sid) override;
+
+    ReturnValue_t initializeAfterTaskCreation() override;
+
+private:
+    struct JournalEntry {
+        RepositoryPath repositoryPath;
+        FileName name;
+        ChangeType changeType = FILE_UPDATED;
+        //! SD card which contained the change when it was recorded
+        VolumeId sourceVolume = SD_CARD_0;
+        uint32_t lastChangeMs = 0;
+        //! Incremented for each change, used to detect changes during a replication
+        uint16_t changeCounter = 0;
+        bool valid = false;
+    };
+
+    MutexIF* journalMutex = nullptr;
+    std::array<JournalEntry, JOURNAL_SIZE> journal;
+    uint8_t journalEntries = 0;
+    bool outOfSync = false;
+    uint32_t journalOverflows = 0;
+
+    bool mirroringEnabled = true;
+    Countdown countdown;
+
+    /* Access is held open while entries are replicated */
+    std::optional<SDCardAccess> sdCardAccess;
+    bool mirrorDriveMounted = false;
+    /* Delay is doubled after each consecutive failed mount attempt */
+    uint32_t mountFailures = 0;
+    uint32_t mountRetryDelay = 0;
+    uint32_t mountRetryDelayCycles = 0;
+
+    /* Entry which is currently replicated */
+    int currentEntryIdx = -1;
+    JournalEntry currentEntry;
+    F_FILE* sourceFile = nullptr;
+    F_FILE* targetFile = nullptr;
+    size_t bytesLeft = 0;
+    std::array<uint8_t, CHUNK_SIZE> chunkBuffer;
+
+    uint32_t entriesReplicated = 0;
+    uint32_t entriesSinceLastSync = 0;
+    uint32_t bytesReplicated = 0;
+    uint32_t replicationFailures = 0;
+
+    sdcmirror::MirrorSet mirrorSet;
+
+    bool selectNextEntry();
+    void completeCurrentEntry();
+    void postponeCurrentEntry();
+
+    ReturnValue_t acquireAccess();
+    void releaseAccess();
+    void closeFiles();
+
+    ReturnValue_t replicateStep();
+    ReturnValue_t openFilesForReplication();
+    ReturnValue_t replicateDeletion();
+    ReturnValue_t replicateDirectoryCreation();
+    ReturnValue_t replicateDirectoryDeletion();
+    int createDirectoryPath(const char* repositoryPath);
+    int getSourceDrive() const;
+    int getTargetDrive() const;
+
+    void updateHousekeeping();
+};
+
+#endif /* SAM9G20_MEMORY_SDCARDMIRROR_H_ */
@@ -16,11 +16,23 @@ static constexpr uint8_t INTERFACE_ID = CLASS_ID::SD_CARD_HANDLER;
 static constexpr ReturnValue_t OPERATION_FINISHED = MAKE_RETURN_CODE(0);
 static constexpr ReturnValue_t TASK_PERIOD_OVER_SOON = MAKE_RETURN_CODE(1);
 static constexpr ReturnValue_t BUSY = HasReturnvaluesIF::makeReturnCode(INTERFACE_ID, 2);
+//! The request queue of the SD card I/O worker is full
+static constexpr ReturnValue_t IO_QUEUE_FULL = MAKE_RETURN_CODE(3);
+
+/* Checksum algorithms supported for files on the SD card */
+enum ChecksumType: uint8_t {
+    //! CRC32 as calculated by zlib
+    CRC32 = 0,
+    //! CRC16-CCITT with start value 0xffff, as used by the bootloader for the binaries
+    CRC16_CCITT = 1
+};
 
 static constexpr Event SD_CARD_SWITCHED = MAKE_EVENT(0x00, severity::MEDIUM); //!< It was not possible to open the preferred SD card so the other was used. P1: Active volume
 static constexpr Event SD_CARD_ACCESS_FAILED = MAKE_EVENT(0x01, severity::HIGH); //!< Opening failed for both SD cards.
 static constexpr Event SEQUENCE_PACKET_MISSING_WRITE_EVENT = MAKE_EVENT(0x02, severity::LOW); //!< P1: Sequence packet missing.
 static constexpr Event SEQUENCE_PACKET_MISSING_READ_EVENT = MAKE_EVENT(0x03, severity::LOW); //!< P1: Sequence packet missing.
+static constexpr Event FILE_COPY_FINISHED = MAKE_EVENT(0x04, severity::INFO); //!< P1: Copied bytes. P2: Copy throughput in bytes per second.
+static constexpr Event FILE_SPLIT_FINISHED = MAKE_EVENT(0x05, severity::INFO); //!< P1: Number of part files. P2: Throughput in bytes per second.
 
 }
 
@@ -0,0 +1,79 @@
+#ifndef SAM9G20_MEMORY_SDCARDMIRRORDEFINITIONS_H_
+#define SAM9G20_MEMORY_SDCARDMIRRORDEFINITIONS_H_
+
+#include <events/subsystemIdRanges.h>
+
+#include <fsfw/datapoollocal/StaticLocalDataSet.h>
+#include <fsfw/datapoollocal/LocalPoolVariable.h>
+#include <fsfw/events/Event.h>
+#include <cstdint>
+
+namespace sdcmirror {
+
+static constexpr uint8_t SUBSYSTEM_ID = SUBSYSTEM_ID::SD_CARD_MIRROR;
+
+//! The change journal is full, the inactive SD card needs to be resynchronized by ground.
+//! P1: Number of journal overflows
+static constexpr Event JOURNAL_OVERFLOW = MAKE_EVENT(0x00, severity::MEDIUM);
+//! Replicating a journal entry to the inactive SD card failed. It will be retried.
+//! P1: Error code. P2: Change type
+static constexpr Event REPLICATION_FAILED = MAKE_EVENT(0x01, severity::LOW);
+//! All journal entries were replicated, the inactive SD card is in sync.
+//! P1: Number of replicated entries since the last sync event
+static constexpr Event MIRROR_IN_SYNC = MAKE_EVENT(0x02, severity::INFO);
+//! The inactive SD card could not be mounted. Mounting is retried with an increasing delay.
+//! P1: Error code. P2: Number of consecutive failed mount attempts
+static constexpr Event MIRROR_MOUNT_FAILED = MAKE_EVENT(0x03, severity::LOW);
+
+enum MirrorState: uint8_t {
+    DISABLED = 0,
+    IN_SYNC = 1,
+    SYNCING = 2,
+    //! Journal overflowed, changes were lost
+    OUT_OF_SYNC = 3
+};
+
+static constexpr uint32_t MIRROR_SET_ID = 0;
+
+enum PoolIds: lp_id_t {
+    MIRROR_STATE,
+    JOURNAL_ENTRIES,
+    JOURNAL_OVERFLOWS,
+    ENTRIES_REPLICATED,
+    BYTES_REPLICATED,
+    REPLICATION_FAILURES,
+    CURRENT_FILE_BYTES_LEFT
+};
+
+/**
+ * @brief   Housekeeping set of the SD card mirror, containing the replication backlog.
+ */
+class MirrorSet: public StaticLocalDataSet<7> {
+public:
+    MirrorSet(HasLocalDataPoolIF* owner):
+        StaticLocalDataSet(owner, MIRROR_SET_ID) {
+    }
+
+    MirrorSet(object_id_t objectId):
+        StaticLocalDataSet(sid_t(objectId, MIRROR_SET_ID)) {
+    }
+
+    lp_var_t<uint8_t> mirrorState = lp_var_t<uint8_t>(sid.objectId,
+            PoolIds::MIRROR_STATE, this);
+    lp_var_t<uint8_t> journalEntries = lp_var_t<uint8_t>(sid.objectId,
+            PoolIds::JOURNAL_ENTRIES, this);
+    lp_var_t<uint32_t> journalOverflows = lp_var_t<uint32_t>(sid.objectId,
+            PoolIds::JOURNAL_OVERFLOWS, this);
+    lp_var_t<uint32_t> entriesReplicated = lp_var_t<uint32_t>(sid.objectId,
+            PoolIds::ENTRIES_REPLICATED, this);
+    lp_var_t<uint32_t> bytesReplicated = lp_var_t<uint32_t>(sid.objectId,
+            PoolIds::BYTES_REPLICATED, this);
+    lp_var_t<uint32_t> replicationFailures = lp_var_t<uint32_t>(sid.objectId,
+            PoolIds::REPLICATION_FAILURES, this);
+    lp_var_t<uint32_t> currentFileBytesLeft = lp_var_t<uint32_t>(sid.objectId,
+            PoolIds::CURRENT_FILE_BYTES_LEFT, this);
+};
+
+}
+
+#endif /* SAM9G20_MEMORY_SDCARDMIRRORDEFINITIONS_H_ */
@@ -8,6 +8,7 @@
 #include <fsfw/tmtcpacket/pus/tc.h>
 #include <fsfw/globalfunctions/arrayprinter.h>
 #include <fsfw/globalfunctions/DleEncoder.h>
+#include <mission/utility/obswLog.h>
 
 #include <cmath>
 
@@ -48,21 +49,13 @@ ReturnValue_t TmTcSerialBridge::handleTc() {
 		if(result == HasReturnvaluesIF::RETURN_OK) {
 			result = handleTcReception(packetFoundLen);
 			if(result != HasReturnvaluesIF::RETURN_OK) {
-#if FSFW_CPP_OSTREAM_ENABLED == 1
-			    sif::debug << "TmTcSerialBridge::handleTc: Handling TC failed!" << std::endl;
-#else
-	            sif::printDebug("TmTcSerialBridge::handleTc: Handling TC failed!\n");
-#endif
+				OBSW_LOG_DEBUG("TmTcSerialBridge::handleTc: Handling TC failed!\n");
 				return result;
 			}
 		}
 		else if(result == RingBufferAnalyzer::POSSIBLE_PACKET_LOSS) {
 			// trigger event?
-#if FSFW_CPP_OSTREAM_ENABLED == 1
-		    sif::debug << "TmTcSerialBridge::handleTc: Possible data loss" << std::endl;
-#else
-		    sif::printDebug("TmTcSerialBridge::handleTc: Possible data loss\n");
-#endif
+			OBSW_LOG_DEBUG("TmTcSerialBridge::handleTc: Possible data loss\n");
 			continue;
 		}
 		else if(result == RingBufferAnalyzer::NO_PACKET_FOUND) {
@@ -96,12 +89,7 @@ ReturnValue_t TmTcSerialBridge::sendTm(const uint8_t *data, size_t dataLen) {
     result = UART_write(bus0_uart, tmArray.data(), encodedLen);
 	//sif::info << "TmTcSerialBridge::sendTm: Sending telemetry." << std::endl;
 	if(result != RETURN_OK) {
-#if FSFW_CPP_OSTREAM_ENABLED == 1
-		sif::error << "TmTcSerialBridge::sendTm: Send error with code "
-		      << static_cast<int>(result) << "on bus 0." << std::endl;
-#else
-		sif::printError("TmTcSerialBridge::sendTm: Send error with code %d on bus0\n", result);
-#endif
+		OBSW_LOG_ERROR("TmTcSerialBridge::sendTm: Send error with code %d on bus0\n", result);
 	}
 	// If data is being sent too fast, this delay could be used.
 	// It will not block the CPU, because a context switch will be requested.
@@ -1,18 +1,21 @@
 #!/usr/bin/env python3
+import argparse
 import time
 
 from objects.objects import parse_objects
 from events.event_parser import parse_events
 from returnvalues.returnvalues_parser import parse_returnvalues
+from logformats.log_format_parser import parse_log_formats
 from fsfwgen.core import return_generic_args_parser, init_printout, get_console_logger, ParserTypes
 
 
 LOGGER = get_console_logger()
+LOG_FORMATS_TYPE = 'logformats'
 
 
 def main():
     init_printout(project_string='SOURCE')
-    parser = return_generic_args_parser()
+    parser = return_args_parser()
     args = parser.parse_args()
     if args.type == 'objects':
         LOGGER.info(f'Generating objects data..')
@@ -26,8 +29,22 @@ def main():
         LOGGER.info('Generating returnvalue data')
         time.sleep(0.05)
         parse_returnvalues()
+    elif args.type == LOG_FORMATS_TYPE:
+        LOGGER.info('Generating log format data')
+        time.sleep(0.05)
+        parse_log_formats()
     pass
 
 
+def return_args_parser() -> argparse.ArgumentParser:
+    """The generic parser of fsfwgen only knows the FSFW types, so the log format type is added
+    to the choices of its type argument"""
+    parser = return_generic_args_parser()
+    for action in parser._actions:
+        if action.dest == 'type' and action.choices is not None:
+            action.choices = list(action.choices) + [LOG_FORMATS_TYPE]
+    return parser
+
+
 if __name__ == "__main__":
     main()
@@ -0,0 +1,110 @@
+# -*- coding: utf-8 -*-
+"""Part of the MOD export tools for the SOURCE project by KSat.
+Deferred log format exporter. Collects the format strings passed to the OBSW_LOG_* macros
+(mission/utility/obswLog.h) and maps them to the format IDs recorded by the deferred logger.
+The table is used by misc/decode_deferred_log.py to format dumped log records on ground.
+Run with "fsfwgen.py logformats" or with "python3 -m logformats.log_format_parser" from the
+generators folder.
+"""
+import codecs
+import re
+from pathlib import Path
+
+from fsfwgen.core import get_console_logger
+
+from definitions import OBSW_ROOT_DIR, ROOT_DIR
+
+LOGGER = get_console_logger()
+
+CSV_LOG_FORMAT_FILENAME = f"{ROOT_DIR}/mod_log_formats.csv"
+FILE_SEPARATOR = ";"
+LOG_FORMAT_DESTINATIONS = [
+    f"{OBSW_ROOT_DIR}/mission/",
+    f"{OBSW_ROOT_DIR}/common/",
+    f"{OBSW_ROOT_DIR}/bsp_sam9g20/",
+    f"{OBSW_ROOT_DIR}/bsp_hosted/",
+]
+SOURCE_FILE_SUFFIXES = [".cpp", ".h", ".c"]
+
+# A format consists of one or more adjacent string literals
+LOG_CALL_REGEX = re.compile(
+    r'OBSW_LOG_(DEBUG|INFO|WARNING|ERROR)\s*\(\s*((?:"(?:[^"\\]|\\.)*"\s*)+)'
+)
+STRING_LITERAL_REGEX = re.compile(r'"((?:[^"\\]|\\.)*)"')
+CONVERSION_REGEX = re.compile(r"%[-+ #0]*\d*(?:\.\d+)?(hh|h|ll|l|j|z|t|L)?([a-zA-Z%])")
+# The arguments are recorded as 32 bit integer words
+SUPPORTED_CONVERSIONS = "diuxXoc%"
+
+FNV_OFFSET_BASIS = 2166136261
+FNV_PRIME = 16777619
+
+
+def parse_log_formats():
+    log_format_table = generate_log_format_table()
+    export_log_format_file(CSV_LOG_FORMAT_FILENAME, log_format_table)
+    LOGGER.info(f"LogFormatParser: Exported {len(log_format_table)} log formats to "
+                f"{CSV_LOG_FORMAT_FILENAME}")
+
+
+def generate_log_format_table() -> dict:
+    """Maps the format IDs to the level, the file and the format string"""
+    log_format_table = dict()
+    for destination in LOG_FORMAT_DESTINATIONS:
+        for file_path in sorted(Path(destination).rglob("*")):
+            if file_path.suffix not in SOURCE_FILE_SUFFIXES or not file_path.is_file():
+                continue
+            parse_file(file_path, log_format_table)
+    LOGGER.info(f"LogFormatParser: Found {len(log_format_table)} log formats")
+    return log_format_table
+
+
+def parse_file(file_path: Path, log_format_table: dict):
+    content = file_path.read_text(errors="replace")
+    relative_path = file_path.relative_to(OBSW_ROOT_DIR)
+    for match in LOG_CALL_REGEX.finditer(content):
+        level = match.group(1)
+        literals = STRING_LITERAL_REGEX.findall(match.group(2))
+        log_format = unescape("".join(literals))
+        format_id = get_format_id(log_format)
+        line = content.count("\n", 0, match.start()) + 1
+        check_conversions(log_format, relative_path, line)
+        if format_id in log_format_table:
+            if log_format_table[format_id][2] != log_format:
+                LOGGER.error(f"LogFormatParser: ID collision 0x{format_id:08x} for "
+                             f"{relative_path}:{line}, change the format string")
+            continue
+        log_format_table[format_id] = (level, f"{relative_path}:{line}", log_format)
+
+
+def get_format_id(log_format: str) -> int:
+    """Same 32 bit FNV-1a hash as deferredlog::getFormatId"""
+    format_hash = FNV_OFFSET_BASIS
+    for byte in log_format.encode("latin-1"):
+        format_hash = ((format_hash ^ byte) * FNV_PRIME) & 0xFFFFFFFF
+    return format_hash
+
+
+def unescape(literal: str) -> str:
+    return codecs.escape_decode(literal.encode("latin-1"))[0].decode("latin-1")
+
+
+def check_conversions(log_format: str, relative_path: Path, line: int):
+    for length, conversion in CONVERSION_REGEX.findall(log_format):
+        if conversion not in SUPPORTED_CONVERSIONS or length in ["ll", "j"]:
+            LOGGER.warning(f"LogFormatParser: Conversion {conversion} in {relative_path}:{line} "
+                           f"can not be used with the deferred logger")
+
+
+def export_log_format_file(filename: str, log_format_table: dict):
+    with open(filename, "w") as out:
+        # The format is the last column because it may contain the separator
+        out.write(f"Format ID{FILE_SEPARATOR}Level{FILE_SEPARATOR}File{FILE_SEPARATOR}"
+                  f"Format\n")
+        for format_id, (level, location, log_format) in sorted(log_format_table.items()):
+            escaped_format = log_format.encode("unicode_escape").decode("latin-1")
+            out.write(f"0x{format_id:08x}{FILE_SEPARATOR}{level}{FILE_SEPARATOR}{location}"
+                      f"{FILE_SEPARATOR}{escaped_format}\n")
+
+
+if __name__ == "__main__":
+    parse_log_formats()
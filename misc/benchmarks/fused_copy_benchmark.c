@@ -0,0 +1,123 @@
+/**
+ * Host benchmark for the fused copy operations used by the NOR-Flash bootloader.
+ * Compares the previous approaches (copy the whole image, then verify it in the destination
+ * in a second pass) with the fused single pass copy operations.
+ *
+ * Build and run from the repository root:
+ *
+ * gcc -O2 -DISIS_OBC_G20 -Dat91sam9g20 -I. -Iat91/include \
+ *      -Iat91/include/at91/boards/common -Iat91/include/at91/boards/ISIS_OBC_G20 \
+ *      -Iat91/include/at91/boards/ISIS_OBC_G20/at91sam9g20 \
+ *      misc/benchmarks/fused_copy_benchmark.c bootloader/utility/fused_copy.c \
+ *      bootloader/utility/CRC.c at91/src/utility/hamming.c -o fused_copy_benchmark
+ * ./fused_copy_benchmark
+ *
+ * Most of the gain comes from computing the parities with a lookup table while copying,
+ * instead of counting the bits of each byte in a separate pass. On the iOBC, the data cache
+ * is not enabled by the bootloader, so the saved read pass over the SDRAM adds to that.
+ */
+#include <bootloader/utility/fused_copy.h>
+#include <bootloader/utility/CRC.h>
+#include <at91/utility/hamming.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Around the size of the OBSW image, deliberately not a multiple of 256 */
+#define IMAGE_SIZE              (1000 * 1024 + 100)
+#define PADDED_SIZE             ((IMAGE_SIZE + 255) / 256 * 256)
+#define HAMMING_CODE_SIZE       (PADDED_SIZE / 256 * 3)
+#define ITERATIONS              50
+
+static double get_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static int two_pass_copy(uint8_t* destination, const uint8_t* source,
+        const uint8_t* hamming_code) {
+    memcpy(destination, source, IMAGE_SIZE);
+    memset(destination + IMAGE_SIZE, 0, PADDED_SIZE - IMAGE_SIZE);
+    return Hamming_Verify256x(destination, PADDED_SIZE, hamming_code);
+}
+
+int main(void) {
+    uint8_t* source = malloc(PADDED_SIZE);
+    uint8_t* destination = malloc(PADDED_SIZE);
+    uint8_t* hamming_code = malloc(HAMMING_CODE_SIZE);
+    if(source == NULL || destination == NULL || hamming_code == NULL) {
+        printf("Allocation failed\n");
+        return 1;
+    }
+    srand(42);
+    for(size_t idx = 0; idx < IMAGE_SIZE; idx++) {
+        source[idx] = rand();
+    }
+    memset(source + IMAGE_SIZE, 0, PADDED_SIZE - IMAGE_SIZE);
+    Hamming_Compute256x(source, PADDED_SIZE, hamming_code);
+    /* Single bit error which needs to be corrected in the destination */
+    source[IMAGE_SIZE / 2] ^= 0x10;
+    uint8_t expected = source[IMAGE_SIZE / 2] ^ 0x10;
+
+    int result_two_pass = 0;
+    int result_fused = 0;
+    double two_pass_ms = 0;
+    double fused_ms = 0;
+    for(int iteration = 0; iteration < ITERATIONS; iteration++) {
+        memset(destination, 0xff, PADDED_SIZE);
+        double start = get_ms();
+        result_two_pass = two_pass_copy(destination, source, hamming_code);
+        two_pass_ms += get_ms() - start;
+        if(destination[IMAGE_SIZE / 2] != expected) {
+            printf("Two pass copy did not correct the error\n");
+            return 1;
+        }
+
+        memset(destination, 0xff, PADDED_SIZE);
+        start = get_ms();
+        result_fused = fused_copy_hamming_verify(destination, source, IMAGE_SIZE,
+                hamming_code, NULL);
+        fused_ms += get_ms() - start;
+        if(destination[IMAGE_SIZE / 2] != expected) {
+            printf("Fused copy did not correct the error\n");
+            return 1;
+        }
+    }
+
+    printf("Image size: %d bytes, %d iterations\n", IMAGE_SIZE, ITERATIONS);
+    printf("Two pass copy and verify: %.3f ms per image, result %d\n",
+            two_pass_ms / ITERATIONS, result_two_pass);
+    printf("Fused copy and verify:    %.3f ms per image, result %d\n",
+            fused_ms / ITERATIONS, result_fused);
+    printf("Speedup: %.2f\n", two_pass_ms / fused_ms);
+
+    uint16_t crc_two_pass = 0;
+    uint16_t crc_fused = 0;
+    two_pass_ms = 0;
+    fused_ms = 0;
+    for(int iteration = 0; iteration < ITERATIONS; iteration++) {
+        double start = get_ms();
+        memcpy(destination, source, IMAGE_SIZE);
+        crc_two_pass = crc16ccitt_default_start_crc(destination, IMAGE_SIZE);
+        two_pass_ms += get_ms() - start;
+
+        start = get_ms();
+        crc_fused = fused_copy_crc16(destination, source, IMAGE_SIZE, 0xffff, NULL);
+        fused_ms += get_ms() - start;
+    }
+    if(crc_two_pass != crc_fused) {
+        printf("CRC mismatch\n");
+        return 1;
+    }
+    printf("Copy, then CRC16:         %.3f ms per image\n", two_pass_ms / ITERATIONS);
+    printf("Fused copy and CRC16:     %.3f ms per image\n", fused_ms / ITERATIONS);
+    printf("Speedup: %.2f\n", two_pass_ms / fused_ms);
+    free(source);
+    free(destination);
+    free(hamming_code);
+    return 0;
+}
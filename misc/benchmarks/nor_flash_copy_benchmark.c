@@ -0,0 +1,196 @@
+/**
+ * Host benchmark for copying an image to the simulated NOR-Flash of the iOBC.
+ * Compares erasing a sector and then reading and programming its content with the scheduling
+ * of the ImageCopyingEngine, which reads the next buckets from the SD card while the sector
+ * is being erased. The erase and program latencies of the iOBC NOR-Flash are injected, the
+ * SD card reads are modelled with a fixed latency per bucket.
+ *
+ * Build and run from the repository root:
+ *
+ * gcc -O2 -DNO_RTOS -I. -Ibsp_hosted/flash -Ibsp_hosted/flash/include \
+ *      misc/benchmarks/nor_flash_copy_benchmark.c bsp_hosted/flash/HostFlash.c \
+ *      bsp_hosted/flash/HostNorFlash.c bsp_sam9g20/common/norflashHook.c \
+ *      -lpthread -o nor_flash_copy_benchmark
+ * ./nor_flash_copy_benchmark
+ *
+ * Each copy takes several seconds because the latencies are waited for. The critical window is
+ * the time in which neither the old nor the new image is complete on the NOR-Flash.
+ */
+#include <bsp_hosted/flash/HostNorFlash.h>
+#include <bsp_sam9g20/common/norflashHook.h>
+#include <hal/Storage/NORflash.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define IMAGE_PATH              "/tmp/nor_flash_copy_benchmark.bin"
+/* Start of the OBSW image behind a 64 KB bootloader */
+#define IMAGE_OFFSET            NORFLASH_SA8_ADDRESS
+/* Deliberately not a multiple of the bucket size */
+#define IMAGE_SIZE              (512 * 1024 + 100)
+/* Same bucket size and number of buckets as the ImageCopyingEngine */
+#define BUCKET_SIZE             NORFLASH_SMALL_SECTOR_SIZE
+#define NUMBER_OF_BUCKETS       2
+/* Reading one bucket from the SD card, around 400 kB/s */
+#define SD_READ_LATENCY_US      20000
+
+typedef struct {
+    const uint8_t* image;
+    uint8_t buckets[NUMBER_OF_BUCKETS][BUCKET_SIZE];
+    size_t bucket_sizes[NUMBER_OF_BUCKETS];
+    /* Ring of filled buckets */
+    uint8_t program_idx;
+    uint8_t filled_buckets;
+    size_t read_idx;
+    size_t program_address;
+    uint32_t buckets_read_during_erase;
+} CopyState;
+
+static double get_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static int read_next_bucket(CopyState* state) {
+    if(state->filled_buckets >= NUMBER_OF_BUCKETS || state->read_idx >= IMAGE_SIZE) {
+        return 0;
+    }
+    size_t size = IMAGE_SIZE - state->read_idx;
+    if(size > BUCKET_SIZE) {
+        size = BUCKET_SIZE;
+    }
+    uint8_t bucket_idx = (state->program_idx + state->filled_buckets) % NUMBER_OF_BUCKETS;
+    usleep(SD_READ_LATENCY_US);
+    memcpy(state->buckets[bucket_idx], state->image + state->read_idx, size);
+    state->bucket_sizes[bucket_idx] = size;
+    state->read_idx += size;
+    state->filled_buckets++;
+    return 1;
+}
+
+static int erase_wait_callback(void* args) {
+    CopyState* state = (CopyState*) args;
+    if(read_next_bucket(state) == 0) {
+        return 0;
+    }
+    state->buckets_read_during_erase++;
+    return 1;
+}
+
+static int program_next_bucket(CopyState* state) {
+    uint8_t bucket_idx = state->program_idx;
+    if(NORFLASH_WriteData(&NORFlash, state->program_address, state->buckets[bucket_idx],
+            state->bucket_sizes[bucket_idx]) != 0) {
+        return -1;
+    }
+    state->program_address += state->bucket_sizes[bucket_idx];
+    state->program_idx = (state->program_idx + 1) % NUMBER_OF_BUCKETS;
+    state->filled_buckets--;
+    return 0;
+}
+
+/**
+ * Copy the image sector by sector.
+ * @param overlapped    Read buckets while the sector is being erased
+ * @param critical_ms   Time from the start of the first erase until the image is written
+ * @return 0 on success
+ */
+static int copy_image(CopyState* state, int overlapped, double* critical_ms) {
+    state->program_idx = 0;
+    state->filled_buckets = 0;
+    state->read_idx = 0;
+    state->program_address = IMAGE_OFFSET;
+    state->buckets_read_during_erase = 0;
+
+    double critical_start = get_ms();
+    size_t erased_address = IMAGE_OFFSET;
+    while(state->program_address < IMAGE_OFFSET + IMAGE_SIZE) {
+        if(state->program_address >= erased_address) {
+            if(overlapped) {
+                norflash_set_wait_callback(&erase_wait_callback, state);
+            }
+            int result = NORFLASH_EraseSector(&NORFlash, erased_address);
+            norflash_set_wait_callback(NULL, NULL);
+            if(result != 0) {
+                return -1;
+            }
+            uint32_t sector_size = 0;
+            host_flash_get_sector(host_nor_flash_get_device(), erased_address, NULL,
+                    &sector_size);
+            erased_address += sector_size;
+        }
+        if(state->filled_buckets == 0) {
+            read_next_bucket(state);
+        }
+        /* The sector size is a multiple of the bucket size, so a bucket never spans
+        two sectors */
+        if(program_next_bucket(state) != 0) {
+            return -1;
+        }
+    }
+    *critical_ms = get_ms() - critical_start;
+    return 0;
+}
+
+static int run_copy(const char* name, CopyState* state, int overlapped) {
+    HostFlash* flash = host_nor_flash_get_device();
+    host_flash_reset_statistics(flash);
+    double critical_ms = 0;
+    if(copy_image(state, overlapped, &critical_ms) != 0) {
+        printf("%s: Copying the image failed\n", name);
+        return -1;
+    }
+    if(memcmp(host_flash_get_memory(flash) + IMAGE_OFFSET, state->image, IMAGE_SIZE) != 0) {
+        printf("%s: Image on the NOR-Flash does not match\n", name);
+        return -1;
+    }
+    HostFlashStatistics statistics;
+    host_flash_get_statistics(flash, &statistics);
+    printf("%s: critical window %.0f ms, %.1f kB/s, %u sectors erased, "
+            "%u buckets read while erasing\n", name, critical_ms,
+            IMAGE_SIZE / critical_ms * 1000.0 / 1024.0, statistics.sectors_erased,
+            state->buckets_read_during_erase);
+    return 0;
+}
+
+int main(void) {
+    CopyState* state = malloc(sizeof(CopyState));
+    uint8_t* image = malloc(IMAGE_SIZE);
+    if(state == NULL || image == NULL) {
+        printf("Allocation failed\n");
+        return 1;
+    }
+    srand(42);
+    for(size_t idx = 0; idx < IMAGE_SIZE; idx++) {
+        image[idx] = rand();
+    }
+    state->image = image;
+
+    HostNorFlashConfig config;
+    host_nor_flash_get_default_config(&config);
+    config.image_path = IMAGE_PATH;
+    config.inject_latency = true;
+    host_nor_flash_configure(&config);
+    if(NORflash_start() != 0) {
+        printf("Opening the NOR-Flash image %s failed\n", IMAGE_PATH);
+        return 1;
+    }
+
+    printf("Image size: %d bytes, SD card read latency %d us per %d byte bucket\n",
+            IMAGE_SIZE, SD_READ_LATENCY_US, BUCKET_SIZE);
+    int result = run_copy("Erase, then read  ", state, 0);
+    if(result == 0) {
+        result = run_copy("Read while erasing", state, 1);
+    }
+
+    host_nor_flash_configure(NULL);
+    unlink(IMAGE_PATH);
+    free(state);
+    free(image);
+    return result == 0 ? 0 : 1;
+}
@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+"""
+Creates a compressed image which can be stored in an image slot on the SD card instead of the
+raw binary. The bootloader and the software image handler decompress the image while copying
+it. The format is documented in bsp_sam9g20/common/imageCompression.h.
+
+Usage: create_compressed_image.py <image> <compressed image>
+"""
+import binascii
+import struct
+import sys
+
+MAGIC = 0x4C5A494D
+# Must not exceed IMAGE_COMPRESSION_WINDOW_SIZE of the decompressor
+WINDOW_SIZE = 8192
+MIN_MATCH_LENGTH = 4
+EXTENDED_LENGTH = 15
+# Number of previous positions which are checked for each match candidate
+MAX_CHAIN_LENGTH = 16
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(__doc__)
+        sys.exit(1)
+    with open(sys.argv[1], "rb") as image_file:
+        image = image_file.read()
+    compressed = compress(image)
+    if decompress(compressed) != image:
+        print("Verification of the compressed image failed!")
+        sys.exit(1)
+    with open(sys.argv[2], "wb") as compressed_file:
+        compressed_file.write(compressed)
+    print(
+        f"Compressed {len(image)} byte image to {len(compressed)} bytes "
+        f"({100.0 * len(compressed) / max(len(image), 1):.1f} %)"
+    )
+
+
+def crc16ccitt(data: bytes) -> int:
+    # Same as CRC::crc16ccitt with the default start value
+    return binascii.crc_hqx(data, 0xFFFF)
+
+
+def compress(image: bytes) -> bytes:
+    sequences = bytearray()
+    chains = dict()
+    literal_start = 0
+    idx = 0
+    while idx + MIN_MATCH_LENGTH <= len(image):
+        key = image[idx : idx + MIN_MATCH_LENGTH]
+        candidates = chains.setdefault(key, [])
+        best_length = 0
+        best_offset = 0
+        for candidate in reversed(candidates):
+            offset = idx - candidate
+            if offset > WINDOW_SIZE:
+                break
+            length = MIN_MATCH_LENGTH
+            while idx + length < len(image) and image[candidate + length] == image[idx + length]:
+                length += 1
+            if length > best_length:
+                best_length = length
+                best_offset = offset
+        candidates.append(idx)
+        if len(candidates) > MAX_CHAIN_LENGTH:
+            del candidates[0]
+        if best_length < MIN_MATCH_LENGTH:
+            idx += 1
+            continue
+        sequences += sequence(image[literal_start:idx], best_offset, best_length)
+        # Positions inside the match are indexed as well so later data can refer to them
+        for match_idx in range(idx + 1, min(idx + best_length, len(image) - MIN_MATCH_LENGTH + 1)):
+            match_candidates = chains.setdefault(
+                image[match_idx : match_idx + MIN_MATCH_LENGTH], []
+            )
+            match_candidates.append(match_idx)
+            if len(match_candidates) > MAX_CHAIN_LENGTH:
+                del match_candidates[0]
+        idx += best_length
+        literal_start = idx
+    # The last sequence only consists of literals
+    sequences += sequence(image[literal_start:], 0, 0)
+
+    header = struct.pack(">IIHHI", MAGIC, len(image), crc16ccitt(image), 0, len(sequences))
+    return header + sequences
+
+
+def sequence(literals: bytes, offset: int, match_length: int) -> bytes:
+    data = bytearray()
+    literal_length = len(literals)
+    match_code = match_length - MIN_MATCH_LENGTH if match_length > 0 else 0
+    data.append((min(literal_length, EXTENDED_LENGTH) << 4) | min(match_code, EXTENDED_LENGTH))
+    data += extended_length(literal_length)
+    data += literals
+    if match_length > 0:
+        data += struct.pack("<H", offset)
+        data += extended_length(match_code)
+    return data
+
+
+def extended_length(length: int) -> bytes:
+    if length < EXTENDED_LENGTH:
+        return b""
+    length -= EXTENDED_LENGTH
+    return b"\xff" * (length // 255) + bytes([length % 255])
+
+
+def decompress(compressed: bytes) -> bytes:
+    _, image_size, image_crc, _, compressed_size = struct.unpack(">IIHHI", compressed[:16])
+    data = compressed[16 : 16 + compressed_size]
+    image = bytearray()
+    idx = 0
+    while idx < len(data):
+        token = data[idx]
+        idx += 1
+        literal_length, idx = read_length(data, idx, token >> 4)
+        image += data[idx : idx + literal_length]
+        idx += literal_length
+        if idx >= len(data):
+            break
+        offset = data[idx] | (data[idx + 1] << 8)
+        idx += 2
+        match_length, idx = read_length(data, idx, token & 0x0F)
+        for _ in range(match_length + MIN_MATCH_LENGTH):
+            image.append(image[-offset])
+    if len(image) != image_size or crc16ccitt(bytes(image)) != image_crc:
+        return b""
+    return bytes(image)
+
+
+def read_length(data: bytes, idx: int, length: int):
+    if length == EXTENDED_LENGTH:
+        while True:
+            length += data[idx]
+            idx += 1
+            if data[idx - 1] != 255:
+                break
+    return length, idx
+
+
+if __name__ == "__main__":
+    main()
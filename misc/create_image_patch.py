@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+"""
+Creates a delta patch which can be applied to an image on the SD card by the software image
+handler (APPLY_PATCH action). The patch format is documented in
+bsp_sam9g20/core/imageHandlerDefintions.h. The patch has to be uploaded to BIN/OBSW/obsw.pat.
+
+Usage: create_image_patch.py <source image> <target image> <patch file>
+"""
+import binascii
+import struct
+import sys
+
+MAGIC = 0x44504154
+OP_COPY = 0
+OP_INSERT = 1
+# Matches are searched for blocks of this size which are aligned in the source image
+BLOCK_SIZE = 16
+# Shorter matches are inserted as literal bytes, because a copy operation has a 9 byte header
+# and splits the insert operation around it. Has to be larger than BLOCK_SIZE, the matches
+# are extended from the block and are at least BLOCK_SIZE bytes long.
+MIN_MATCH_SIZE = 24
+
+
+def main():
+    if len(sys.argv) != 4:
+        print(__doc__)
+        sys.exit(1)
+    with open(sys.argv[1], "rb") as source_file:
+        source = source_file.read()
+    with open(sys.argv[2], "rb") as target_file:
+        target = target_file.read()
+    patch = create_patch(source, target)
+    with open(sys.argv[3], "wb") as patch_file:
+        patch_file.write(patch)
+    print(
+        f"Patch with {len(patch)} bytes created for {len(target)} byte image "
+        f"({100.0 * len(patch) / max(len(target), 1):.1f} %)"
+    )
+
+
+def crc16ccitt(data: bytes) -> int:
+    # Same as CRC::crc16ccitt with the default start value
+    return binascii.crc_hqx(data, 0xFFFF)
+
+
+def create_patch(source: bytes, target: bytes) -> bytes:
+    block_index = dict()
+    for offset in range(0, len(source) - BLOCK_SIZE + 1, BLOCK_SIZE):
+        block_index.setdefault(source[offset : offset + BLOCK_SIZE], offset)
+
+    operations = bytearray()
+    literal_start = 0
+    target_idx = 0
+    while target_idx + BLOCK_SIZE <= len(target):
+        source_offset = block_index.get(target[target_idx : target_idx + BLOCK_SIZE])
+        if source_offset is None:
+            target_idx += 1
+            continue
+        # Extend the match in both directions
+        match_start = target_idx
+        while (
+            match_start > literal_start
+            and source_offset > 0
+            and target[match_start - 1] == source[source_offset - 1]
+        ):
+            match_start -= 1
+            source_offset -= 1
+        match_end = target_idx + BLOCK_SIZE
+        source_end = source_offset + (match_end - match_start)
+        while (
+            match_end < len(target)
+            and source_end < len(source)
+            and target[match_end] == source[source_end]
+        ):
+            match_end += 1
+            source_end += 1
+        if match_end - match_start < MIN_MATCH_SIZE:
+            target_idx += 1
+            continue
+        operations += insert_operation(target[literal_start:match_start])
+        operations += struct.pack(
+            ">BII", OP_COPY, match_end - match_start, source_offset
+        )
+        literal_start = match_end
+        target_idx = match_end
+    operations += insert_operation(target[literal_start:])
+
+    header = struct.pack(
+        ">IIHIH",
+        MAGIC,
+        len(source),
+        crc16ccitt(source),
+        len(target),
+        crc16ccitt(target),
+    )
+    return header + operations
+
+
+def insert_operation(literal: bytes) -> bytes:
+    if not literal:
+        return b""
+    return struct.pack(">BI", OP_INSERT, len(literal)) + literal
+
+
+if __name__ == "__main__":
+    main()
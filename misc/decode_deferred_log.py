@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+"""
+Formats the records of a deferred logger image, which is the concatenated Service 6 dump of
+the deferred logger object. The image format is documented in mission/utility/DeferredLogger.h.
+The format ID table is generated with the logformats type of generators/fsfwgen.py.
+
+Usage: decode_deferred_log.py <log image> <mod_log_formats.csv>
+"""
+import re
+import struct
+import sys
+
+MAGIC = 0x444C4F47
+VERSION = 1
+# magic, version, record size, capacity, record count, dropped records
+HEADER_FORMAT = "<IHHIII"
+# timestamp, format ID, level, number of arguments, spare, arguments
+RECORD_FORMAT = "<IIBBH4I"
+
+LEVELS = {0: "DEBUG", 1: "INFO", 2: "WARNING", 3: "ERROR"}
+FILE_SEPARATOR = ";"
+CONVERSION_REGEX = re.compile(r"%([-+ #0]*\d*(?:\.\d+)?)(?:hh|h|ll|l|j|z|t|L)?([a-zA-Z%])")
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(__doc__)
+        sys.exit(1)
+    with open(sys.argv[1], "rb") as image_file:
+        image = image_file.read()
+    log_formats = read_log_formats(sys.argv[2])
+    dropped_records, records = parse_image(image)
+    for record in records:
+        print(format_record(record, log_formats))
+    if dropped_records > 0:
+        print(f"{dropped_records} records were dropped because the log was locked")
+
+
+def read_log_formats(filename: str) -> dict:
+    log_formats = dict()
+    with open(filename) as csv_file:
+        next(csv_file)
+        for line in csv_file:
+            format_id, _, _, escaped_format = line.rstrip("\n").split(FILE_SEPARATOR, 3)
+            log_format = escaped_format.encode("latin-1").decode("unicode_escape")
+            log_formats[int(format_id, 16)] = log_format
+    return log_formats
+
+
+def parse_image(image: bytes):
+    header_size = struct.calcsize(HEADER_FORMAT)
+    (
+        magic,
+        version,
+        record_size,
+        capacity,
+        record_count,
+        dropped_records,
+    ) = struct.unpack_from(HEADER_FORMAT, image)
+    if magic != MAGIC or version != VERSION:
+        print("Invalid deferred logger image")
+        sys.exit(1)
+    if record_size != struct.calcsize(RECORD_FORMAT):
+        print(f"Unexpected record size {record_size}")
+        sys.exit(1)
+    if len(image) < header_size + capacity * record_size:
+        print(f"Image size {len(image)} does not match capacity {capacity}")
+        sys.exit(1)
+
+    if record_count > capacity:
+        # The ring was overwritten, the oldest record is the next one which will be written
+        first_idx = record_count % capacity
+        indexes = list(range(first_idx, capacity)) + list(range(first_idx))
+    else:
+        indexes = range(record_count)
+    records = [
+        struct.unpack_from(RECORD_FORMAT, image, header_size + idx * record_size)
+        for idx in indexes
+    ]
+    return dropped_records, records
+
+
+def format_record(record: tuple, log_formats: dict) -> str:
+    timestamp, format_id, level, number_of_args = record[:4]
+    args = record[5 : 5 + number_of_args]
+    prefix = f"{timestamp / 1000:12.3f} s | {LEVELS.get(level, 'UNKNOWN'):7} | "
+    log_format = log_formats.get(format_id)
+    if log_format is None:
+        arg_string = " ".join(f"0x{arg:08x}" for arg in args)
+        return f"{prefix}Unknown format ID 0x{format_id:08x}, arguments: {arg_string}"
+    return prefix + apply_format(log_format, args).rstrip("\n")
+
+
+def apply_format(log_format: str, args: tuple) -> str:
+    """Formats the 32 bit argument words like printf on the board"""
+    remaining_args = list(args)
+
+    def convert(match) -> str:
+        flags, conversion = match.groups()
+        if conversion == "%":
+            return "%"
+        if not remaining_args:
+            return match.group(0)
+        arg = remaining_args.pop(0)
+        if conversion in "di":
+            arg = arg - (1 << 32) if arg & 0x80000000 else arg
+            return f"%{flags}d" % arg
+        if conversion == "u":
+            return f"%{flags}d" % arg
+        if conversion in "xXoc":
+            return f"%{flags}{conversion}" % arg
+        return f"0x{arg:08x}"
+
+    return CONVERSION_REGEX.sub(convert, log_format)
+
+
+if __name__ == "__main__":
+    main()
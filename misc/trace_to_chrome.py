@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+"""
+Converts a trace buffer image to the Chrome trace format, which can be opened with
+chrome://tracing or https://ui.perfetto.dev. The image is either the file written by the
+WRITE_TRACE_FILE action of the trace buffer handler (TRACE/trace.bin) or the concatenated
+Service 6 dump of the trace buffer handler. The image format is documented in
+bsp_sam9g20/boardconfig/traceBuffer.h.
+
+The trace points are shown in one track per task. If the task switches were recorded, the
+running task is shown in an additional CPU track.
+
+Usage: trace_to_chrome.py <trace image> <json file>
+"""
+import json
+import struct
+import sys
+
+MAGIC = 0x54524345
+VERSION = 1
+# magic, version, record size, capacity, record count, counter frequency, number of tasks,
+# task name length, enabled, task switches enabled, spare
+HEADER_FORMAT = "<IHHIIIHHBB6x"
+RECORD_FORMAT = "<QHHI"
+
+PHASE_MASK = 0xC000
+PHASES = {0x0000: "i", 0x4000: "B", 0x8000: "E"}
+TASK_SWITCH_ID = 0x0001
+# Keep up to date with mission/utility/obswTrace.h
+EVENT_NAMES = {
+    0x100: "TmFunnel",
+    0x110: "SDCardHandler message",
+    0x111: "SDCardHandler state machine",
+    0x112: "SD card I/O request",
+}
+
+OBSW_PID = 1
+CPU_PID = 2
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(__doc__)
+        sys.exit(1)
+    with open(sys.argv[1], "rb") as image_file:
+        image = image_file.read()
+    header, task_names, records = parse_image(image)
+    events = convert(header, task_names, records)
+    with open(sys.argv[2], "w") as json_file:
+        json.dump({"traceEvents": events, "displayTimeUnit": "ms"}, json_file)
+    print(f"Converted {len(records)} records of {len(task_names)} tasks")
+
+
+def parse_image(image: bytes):
+    header_size = struct.calcsize(HEADER_FORMAT)
+    (
+        magic,
+        version,
+        record_size,
+        capacity,
+        record_count,
+        frequency,
+        number_of_tasks,
+        name_length,
+        _,
+        _,
+    ) = struct.unpack_from(HEADER_FORMAT, image)
+    if magic != MAGIC or version != VERSION:
+        print("Invalid trace buffer image")
+        sys.exit(1)
+    if record_size != struct.calcsize(RECORD_FORMAT):
+        print(f"Unexpected record size {record_size}")
+        sys.exit(1)
+
+    # The name table has a fixed size, which is derived from the image size
+    records_size = capacity * record_size
+    name_entry_size = 4 + name_length
+    name_table_size = len(image) - header_size - records_size
+    if name_table_size < 0 or name_table_size % name_entry_size != 0:
+        print(f"Image size {len(image)} does not match capacity {capacity}")
+        sys.exit(1)
+    task_names = dict()
+    for idx in range(number_of_tasks):
+        offset = header_size + idx * name_entry_size
+        (task_number,) = struct.unpack_from("<I", image, offset)
+        name = image[offset + 4 : offset + name_entry_size].split(b"\0")[0]
+        task_names[task_number] = name.decode(errors="replace")
+
+    records_offset = header_size + name_table_size
+    if record_count > capacity:
+        # The ring was overwritten, the oldest record is the next one which will be written
+        first_idx = record_count % capacity
+        indexes = list(range(first_idx, capacity)) + list(range(first_idx))
+    else:
+        indexes = range(record_count)
+    records = [
+        struct.unpack_from(RECORD_FORMAT, image, records_offset + idx * record_size)
+        for idx in indexes
+    ]
+    return {"frequency": frequency}, task_names, records
+
+
+def convert(header: dict, task_names: dict, records: list) -> list:
+    to_us = 1e6 / header["frequency"]
+    events = [
+        metadata_event(OBSW_PID, 0, "process_name", "OBSW"),
+        metadata_event(CPU_PID, 0, "process_name", "CPU"),
+    ]
+    task_numbers = set(record[1] for record in records)
+    for task_number in sorted(task_numbers):
+        name = task_names.get(task_number, f"Task {task_number}")
+        events.append(metadata_event(OBSW_PID, task_number, "thread_name", name))
+
+    running_task = None
+    for timestamp, task_number, event_id, arg in records:
+        ts = timestamp * to_us
+        trace_id = event_id & ~PHASE_MASK
+        if trace_id == TASK_SWITCH_ID:
+            if running_task is not None:
+                events.append(cpu_slice(running_task, ts, task_names))
+            running_task = (task_number, ts)
+            continue
+        event = {
+            "name": EVENT_NAMES.get(trace_id, f"0x{trace_id:04x}"),
+            "ph": PHASES.get(event_id & PHASE_MASK, "i"),
+            "ts": ts,
+            "pid": OBSW_PID,
+            "tid": task_number,
+            "args": {"arg": arg},
+        }
+        if event["ph"] == "i":
+            event["s"] = "t"
+        events.append(event)
+    return events
+
+
+def metadata_event(pid: int, tid: int, kind: str, name: str) -> dict:
+    return {"name": kind, "ph": "M", "pid": pid, "tid": tid, "args": {"name": name}}
+
+
+def cpu_slice(running_task: tuple, end: float, task_names: dict) -> dict:
+    task_number, start = running_task
+    return {
+        "name": task_names.get(task_number, f"Task {task_number}"),
+        "ph": "X",
+        "ts": start,
+        "dur": end - start,
+        "pid": CPU_PID,
+        "tid": 0,
+    }
+
+
+if __name__ == "__main__":
+    main()
@@ -3,6 +3,7 @@
 #include <fsfw/objectmanager/SystemObject.h>
 #include <fsfw/serviceinterface/ServiceInterface.h>
 #include <fsfw/devicehandlers/AcceptsDeviceResponsesIF.h>
+#include <mission/utility/obswLog.h>
 
 GPSHandler::GPSHandler(object_id_t objectId_, object_id_t comIF_,
         CookieIF * cookie_, uint8_t powerSwitchId):
@@ -278,11 +279,7 @@ ReturnValue_t GPSHandler::scanForReply(const uint8_t *start, size_t len,
     }
     else if(startOfSequence == NMEA_START_OF_SEQUENCE){
         *foundId = NMEA_MESSAGE;
-#if FSFW_CPP_OSTREAM_ENABLED == 1
-        sif::debug << "GPS Handler: Received NMEA string" << std::endl;
-#else
-        sif::printDebug("GPS Handler: Received NMEA string\n");
-#endif
+        OBSW_LOG_DEBUG("GPS Handler: Received NMEA string\n");
         // should we specify the size?
         // maybe we are going to use NMEA messages at some point ?
         uint8_t nmeaTypeBuffer[NMEA_TYPE_SIZE];
@@ -303,11 +300,7 @@ ReturnValue_t GPSHandler::checkBinaryReply(const uint8_t *start, size_t * len,
         DeviceCommandId_t *foundId, size_t *foundLen) {
     uint16_t payloadSize = start[2] << 8 | start[3];
     if((payloadSize + BINARY_HEADER_AND_TAIL_SIZE) > static_cast<uint16_t>(*len)) {
-#if FSFW_CPP_OSTREAM_ENABLED == 1
-        sif::info << "GPSHandler::checkBinaryReply: Invalid size !" << std::endl;
-#else
-        sif::printInfo("GPSHandler::checkBinaryReply: Invalid size!\n");
-#endif
+        OBSW_LOG_INFO("GPSHandler::checkBinaryReply: Invalid size!\n");
         return IGNORE_REPLY_DATA;
     }
 
@@ -324,21 +317,13 @@ ReturnValue_t GPSHandler::checkBinaryReply(const uint8_t *start, size_t * len,
     case ACK:
         // assigns message type of corresponding command
         *foundId = start[PAYLOAD_START_INDEX + 1];
-#if FSFW_CPP_OSTREAM_ENABLED == 1
-        sif::info << "GPSHandler: Got reply " << std::hex << *foundId << std::endl;
-#else
-        sif::printInfo("GPSHandler: Got reply 0x%08x", *foundId);
-#endif
+        OBSW_LOG_INFO("GPSHandler: Got reply 0x%08x\n", *foundId);
         size = 2 + BINARY_HEADER_AND_TAIL_SIZE;
         break;
     default:
         * foundLen = 1;
-#if FSFW_CPP_OSTREAM_ENABLED == 1
-        sif::info << "GPSHandler::checkBinaryReply: Ignoring packet because start ID is weird"
-                << std::endl;
-#else
-        sif::printInfo("GPSHandler::checkBinaryReply: Ignoring packet because start ID is weird\n");
-#endif
+        OBSW_LOG_INFO("GPSHandler::checkBinaryReply: Ignoring packet because start ID is "
+                "weird\n");
         return IGNORE_FULL_PACKET;
     }
 
@@ -346,11 +331,7 @@ ReturnValue_t GPSHandler::checkBinaryReply(const uint8_t *start, size_t * len,
     uint8_t calculatedChecksum = calcChecksum(start + BINARY_HEADER_SIZE,
             payloadSize);
     if(foundChecksum != calculatedChecksum) {
-#if FSFW_CPP_OSTREAM_ENABLED == 1
-        sif::error << "GPSHandler: Checksum error!" << std::endl;
-#else
-        sif::printError("GPSHandler: Checksum error!\n");
-#endif
+        OBSW_LOG_ERROR("GPSHandler: Checksum error!\n");
         return DeviceHandlerIF::INVALID_DATA;
     }
     *foundLen = size;
@@ -371,11 +352,7 @@ ReturnValue_t GPSHandler::interpretDeviceReply(DeviceCommandId_t id,
     case SET_GPS_UPDATE_RATE:
     case SET_GPS_MESSAGE_TYPE:
     case SET_GPS_BAUDRATE: {
-#if FSFW_CPP_OSTREAM_ENABLED == 1
-        sif::debug << "GPS Handler: Binary reply received" << std::endl;
-#else
-        sif::printDebug("GPS Handler: Binary reply received\n");
-#endif
+        OBSW_LOG_DEBUG("GPS Handler: Binary reply received\n");
         if(internalState == InternalState::STATE_WAIT_FIRST_MESSAGE) {
             firstReplyReceived = true;
         }
@@ -15,9 +15,114 @@ void FileSystemMessage::setCeaseSdCardOperationNotification(
     command->setCommand(NOTIFICATION_CEASE_SD_CARD_OPERATION);
 }
 
+void FileSystemMessage::setMoveFileCommand(CommandMessage *message,
+        store_address_t storeId) {
+    message->setCommand(CMD_MOVE_FILE);
+    message->setParameter2(storeId.raw);
+}
+
+void FileSystemMessage::setSplitFileCommand(CommandMessage *message,
+        store_address_t storeId) {
+    message->setCommand(CMD_SPLIT_FILE);
+    message->setParameter2(storeId.raw);
+}
+
+void FileSystemMessage::setChecksumFileCommand(CommandMessage *message,
+        store_address_t storeId) {
+    message->setCommand(CMD_CHECKSUM_FILE);
+    message->setParameter2(storeId.raw);
+}
+
+void FileSystemMessage::setChecksumFileReply(CommandMessage *message,
+        store_address_t storeId) {
+    message->setCommand(REPLY_CHECKSUM_FILE);
+    message->setParameter2(storeId.raw);
+}
+
+void FileSystemMessage::setReportRepositoryCommand(CommandMessage *message,
+        store_address_t storeId) {
+    message->setCommand(CMD_REPORT_REPOSITORY);
+    message->setParameter2(storeId.raw);
+}
+
+void FileSystemMessage::setReportRepositoryReply(CommandMessage *message,
+        store_address_t storeId, bool lastPage) {
+    message->setCommand(REPLY_REPORT_REPOSITORY);
+    message->setParameter(lastPage);
+    message->setParameter2(storeId.raw);
+}
+
+void FileSystemMessage::setFindFilesCommand(CommandMessage *message,
+        store_address_t storeId) {
+    message->setCommand(CMD_FIND_FILES);
+    message->setParameter2(storeId.raw);
+}
+
+void FileSystemMessage::setFindFilesReply(CommandMessage *message,
+        store_address_t storeId, bool lastPage) {
+    message->setCommand(REPLY_FIND_FILES);
+    message->setParameter(lastPage);
+    message->setParameter2(storeId.raw);
+}
+
+bool FileSystemMessage::isLastListingPage(const CommandMessage *message) {
+    return message->getParameter();
+}
+
+void FileSystemMessage::setCopySuccessReply(CommandMessage *message, uint32_t bytesCopied,
+        uint32_t bytesPerSecond) {
+    setSuccessReply(message);
+    message->setParameter(bytesCopied);
+    message->setParameter2(bytesPerSecond);
+}
+
+uint32_t FileSystemMessage::getCopiedBytes(const CommandMessage *message) {
+    return message->getParameter();
+}
+
+uint32_t FileSystemMessage::getCopyThroughput(const CommandMessage *message) {
+    return message->getParameter2();
+}
+
+void FileSystemMessage::setIoRequestId(CommandMessage *message, uint32_t requestId) {
+    message->setParameter3(requestId);
+}
+
+uint32_t FileSystemMessage::getIoRequestId(const CommandMessage *message) {
+    return message->getParameter3();
+}
+
+void FileSystemMessage::setIoRequestDoneNotification(CommandMessage *message,
+        uint32_t requestId, Command_t processedCommand, ReturnValue_t result,
+        uint32_t completionTimeMs) {
+    message->setCommand(NOTIFICATION_IO_REQUEST_DONE);
+    message->setParameter((static_cast<uint32_t>(processedCommand) << 16) | result);
+    message->setParameter2(completionTimeMs);
+    message->setParameter3(requestId);
+}
+
+Command_t FileSystemMessage::getProcessedCommand(const CommandMessage *message) {
+    return static_cast<Command_t>(message->getParameter() >> 16);
+}
+
+ReturnValue_t FileSystemMessage::getIoRequestResult(const CommandMessage *message) {
+    return static_cast<ReturnValue_t>(message->getParameter() & 0xffff);
+}
+
+uint32_t FileSystemMessage::getIoRequestCompletionTime(const CommandMessage *message) {
+    return message->getParameter2();
+}
+
 ReturnValue_t FileSystemMessage::clear(CommandMessage *message) {
 	switch(message->getCommand()) {
-	case(CMD_CLEAR_REPOSITORY): {
+	case(CMD_CLEAR_REPOSITORY):
+	case(CMD_SPLIT_FILE):
+	case(CMD_CHECKSUM_FILE):
+	case(REPLY_CHECKSUM_FILE):
+	case(CMD_REPORT_REPOSITORY):
+	case(REPLY_REPORT_REPOSITORY):
+	case(CMD_FIND_FILES):
+	case(REPLY_FIND_FILES): {
 		store_address_t storeId = GenericFileSystemMessage::getStoreId(message);
 		auto ipcStore = ObjectManager::instance()->get<StorageManagerIF>(objects::IPC_STORE);
 		if(ipcStore == nullptr) {
@@ -15,13 +15,68 @@ public:
     static const Command_t CMD_CLEAR_SD_CARD = MAKE_COMMAND_ID(181);
     /** Formats the SD card (which also clears it!). Use with care ! */
     static const Command_t CMD_FORMAT_SD_CARD = MAKE_COMMAND_ID(182);
+    /** Splits a file into multiple part files with a fixed size */
+    static const Command_t CMD_SPLIT_FILE = MAKE_COMMAND_ID(183);
+    /** Calculates a checksum over a file */
+    static const Command_t CMD_CHECKSUM_FILE = MAKE_COMMAND_ID(184);
+    /** Contains the checksum and the size of a file in the store */
+    static const Command_t REPLY_CHECKSUM_FILE = MAKE_COMMAND_ID(185);
+    /** Lists the content of a repository page-wise */
+    static const Command_t CMD_REPORT_REPOSITORY = MAKE_COMMAND_ID(186);
+    /**
+     * Contains one page of a repository listing in the store. Parameter 1 is set for
+     * the last page, which also completes the command.
+     */
+    static const Command_t REPLY_REPORT_REPOSITORY = MAKE_COMMAND_ID(187);
+    /** Finds the files matching a wildcard pattern in a repository */
+    static const Command_t CMD_FIND_FILES = MAKE_COMMAND_ID(188);
+    /** Contains one page of found files in the store, last page flag like above */
+    static const Command_t REPLY_FIND_FILES = MAKE_COMMAND_ID(189);
 
     static const Command_t NOTIFICATION_CEASE_SD_CARD_OPERATION =
             MAKE_COMMAND_ID(205);
+    /**
+     * Sent by an I/O worker to the owning handler when a forwarded request was processed.
+     * Parameter 1 contains the command ID of the processed request and the result, parameter 2
+     * the uptime in milliseconds at which the request was completed and parameter 3 the ID
+     * of the request.
+     */
+    static const Command_t NOTIFICATION_IO_REQUEST_DONE =
+            MAKE_COMMAND_ID(206);
 
     static void setClearSdCardCommand(CommandMessage* message);
     static void setFormatSdCardCommand(CommandMessage* message);
     static void setCeaseSdCardOperationNotification( CommandMessage* command);
+    static void setMoveFileCommand(CommandMessage* message, store_address_t storeId);
+    static void setSplitFileCommand(CommandMessage* message, store_address_t storeId);
+    static void setChecksumFileCommand(CommandMessage* message, store_address_t storeId);
+    static void setChecksumFileReply(CommandMessage* message, store_address_t storeId);
+    static void setReportRepositoryCommand(CommandMessage* message, store_address_t storeId);
+    static void setReportRepositoryReply(CommandMessage* message, store_address_t storeId,
+            bool lastPage);
+    static void setFindFilesCommand(CommandMessage* message, store_address_t storeId);
+    static void setFindFilesReply(CommandMessage* message, store_address_t storeId,
+            bool lastPage);
+    static bool isLastListingPage(const CommandMessage* message);
+    /**
+     * Success reply for copy operations. Parameter 1 contains the number of copied bytes,
+     * parameter 2 the copy throughput in bytes per second.
+     */
+    static void setCopySuccessReply(CommandMessage* message, uint32_t bytesCopied,
+            uint32_t bytesPerSecond);
+    static uint32_t getCopiedBytes(const CommandMessage* message);
+    static uint32_t getCopyThroughput(const CommandMessage* message);
+    /**
+     * The owning handler stores the ID of a forwarded request in parameter 3, which is not
+     * used by the file system commands.
+     */
+    static void setIoRequestId(CommandMessage* message, uint32_t requestId);
+    static uint32_t getIoRequestId(const CommandMessage* message);
+    static void setIoRequestDoneNotification(CommandMessage* message, uint32_t requestId,
+            Command_t processedCommand, ReturnValue_t result, uint32_t completionTimeMs);
+    static Command_t getProcessedCommand(const CommandMessage* message);
+    static ReturnValue_t getIoRequestResult(const CommandMessage* message);
+    static uint32_t getIoRequestCompletionTime(const CommandMessage* message);
 
     static ReturnValue_t clear(CommandMessage* command);
 };
@@ -0,0 +1,189 @@
+#include "MonitoredPoolManager.h"
+
+#include <fsfw/serviceinterface/ServiceInterface.h>
+
+MonitoredPoolManager::MonitoredPoolManager(object_id_t setObjectId,
+        const LocalPoolConfig& poolConfig): PoolManager(setObjectId, poolConfig) {
+    /* The configuration is sorted by element size like the subpools */
+    for(auto const& subpoolConfig: poolConfig) {
+        if(numberOfSubpools >= MAX_NUMBER_OF_SUBPOOLS) {
+#if FSFW_CPP_OSTREAM_ENABLED == 1
+            sif::warning << "MonitoredPoolManager: Only the first " <<
+                    static_cast<int>(MAX_NUMBER_OF_SUBPOOLS) << " subpools are monitored" <<
+                    std::endl;
+#else
+            sif::printWarning("MonitoredPoolManager: Only the first %d subpools are "
+                    "monitored\n", MAX_NUMBER_OF_SUBPOOLS);
+#endif
+            break;
+        }
+        subpoolStats[numberOfSubpools].numberOfElements = subpoolConfig.first;
+        subpoolStats[numberOfSubpools].elementSize = subpoolConfig.second;
+        numberOfSubpools++;
+    }
+}
+
+MonitoredPoolManager::~MonitoredPoolManager() {
+}
+
+ReturnValue_t MonitoredPoolManager::deleteData(store_address_t storeId) {
+    ReturnValue_t result = lockPool();
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        return result;
+    }
+    result = LocalPool::deleteData(storeId);
+    recordDeletion(result, storeId);
+    mutex->unlockMutex();
+    return result;
+}
+
+ReturnValue_t MonitoredPoolManager::deleteData(uint8_t* buffer, size_t size,
+        store_address_t* storeId) {
+    /* Only resolves the store ID, the element is deleted with the locked overload above */
+    return LocalPool::deleteData(buffer, size, storeId);
+}
+
+void MonitoredPoolManager::clearStore() {
+    if(lockPool() != HasReturnvaluesIF::RETURN_OK) {
+        return;
+    }
+    LocalPool::clearStore();
+    for(uint8_t subpool = 0; subpool < numberOfSubpools; subpool++) {
+        subpoolStats[subpool].usedElements = 0;
+    }
+    mutex->unlockMutex();
+}
+
+void MonitoredPoolManager::clearSubPool(max_subpools_t poolIndex) {
+    if(lockPool() != HasReturnvaluesIF::RETURN_OK) {
+        return;
+    }
+    LocalPool::clearSubPool(poolIndex);
+    if(poolIndex < numberOfSubpools) {
+        subpoolStats[poolIndex].usedElements = 0;
+    }
+    mutex->unlockMutex();
+}
+
+ReturnValue_t MonitoredPoolManager::getSubpoolStats(max_subpools_t subpool,
+        SubpoolStats* stats) {
+    if(subpool >= numberOfSubpools or stats == nullptr) {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    ReturnValue_t result = lockPool();
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        return result;
+    }
+    *stats = subpoolStats[subpool];
+    mutex->unlockMutex();
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t MonitoredPoolManager::resetStats() {
+    ReturnValue_t result = lockPool();
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        return result;
+    }
+    for(uint8_t subpool = 0; subpool < numberOfSubpools; subpool++) {
+        subpoolStats[subpool].highWaterMark = subpoolStats[subpool].usedElements;
+        subpoolStats[subpool].allocationFailures = 0;
+        subpoolStats[subpool].maxRequestedSize = 0;
+        subpoolStats[subpool].maxFailedSize = 0;
+    }
+    mutex->unlockMutex();
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t MonitoredPoolManager::getRecommendedConfig(uint8_t marginPercent,
+        LocalPoolConfig* recommendedConfig) {
+    if(recommendedConfig == nullptr) {
+        return HasReturnvaluesIF::RETURN_FAILED;
+    }
+    ReturnValue_t result = lockPool();
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        return result;
+    }
+    recommendedConfig->clear();
+    for(uint8_t subpool = 0; subpool < numberOfSubpools; subpool++) {
+        const SubpoolStats& stats = subpoolStats[subpool];
+        uint32_t requiredSize = stats.maxRequestedSize;
+        if(stats.maxFailedSize > requiredSize) {
+            requiredSize = stats.maxFailedSize;
+        }
+        if(requiredSize == 0) {
+            recommendedConfig->emplace(1, stats.elementSize);
+            continue;
+        }
+        uint32_t elementSize = (requiredSize + 3) & ~3u;
+        uint32_t numberOfElements = 0;
+        if(stats.allocationFailures > 0) {
+            numberOfElements = 2 * stats.numberOfElements;
+        }
+        else {
+            numberOfElements = stats.highWaterMark +
+                    (stats.highWaterMark * marginPercent + 99) / 100;
+        }
+        if(numberOfElements > UINT16_MAX) {
+            numberOfElements = UINT16_MAX;
+        }
+        recommendedConfig->emplace(static_cast<n_pool_elem_t>(numberOfElements),
+                elementSize);
+    }
+    mutex->unlockMutex();
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+ReturnValue_t MonitoredPoolManager::reserveSpace(const size_t size, store_address_t* address,
+        bool ignoreFault) {
+    ReturnValue_t result = lockPool();
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        return result;
+    }
+    result = LocalPool::reserveSpace(size, address, ignoreFault);
+    recordAllocation(result, *address, size);
+    mutex->unlockMutex();
+    return result;
+}
+
+ReturnValue_t MonitoredPoolManager::lockPool() {
+    return mutex->lockMutex(MutexIF::TimeoutType::WAITING, MUTEX_TIMEOUT_MS);
+}
+
+void MonitoredPoolManager::recordAllocation(ReturnValue_t result, store_address_t storeId,
+        size_t size) {
+    if(numberOfSubpools == 0) {
+        return;
+    }
+    if(result == HasReturnvaluesIF::RETURN_OK) {
+        if(storeId.poolIndex >= numberOfSubpools) {
+            return;
+        }
+        SubpoolStats& stats = subpoolStats[storeId.poolIndex];
+        stats.usedElements++;
+        if(stats.usedElements > stats.highWaterMark) {
+            stats.highWaterMark = stats.usedElements;
+        }
+        if(size > stats.maxRequestedSize) {
+            stats.maxRequestedSize = size;
+        }
+        return;
+    }
+    uint8_t subpool = 0;
+    while(subpool < numberOfSubpools - 1 and subpoolStats[subpool].elementSize < size) {
+        subpool++;
+    }
+    SubpoolStats& stats = subpoolStats[subpool];
+    stats.allocationFailures++;
+    if(size > stats.maxFailedSize) {
+        stats.maxFailedSize = size;
+    }
+}
+
+void MonitoredPoolManager::recordDeletion(ReturnValue_t result, store_address_t storeId) {
+    if(result != HasReturnvaluesIF::RETURN_OK or storeId.poolIndex >= numberOfSubpools) {
+        return;
+    }
+    if(subpoolStats[storeId.poolIndex].usedElements > 0) {
+        subpoolStats[storeId.poolIndex].usedElements--;
+    }
+}
@@ -0,0 +1,89 @@
+#ifndef MISSION_MEMORY_MONITOREDPOOLMANAGER_H_
+#define MISSION_MEMORY_MONITOREDPOOLMANAGER_H_
+
+#include <fsfw/ipc/MutexIF.h>
+#include <fsfw/storagemanager/PoolManager.h>
+
+#include <array>
+#include <cstdint>
+
+/**
+ * @brief   Pool manager which keeps usage statistics of its subpools.
+ * @details
+ * For every subpool, the number of used elements, the highest number of concurrently used
+ * elements, the number of failed allocations, the largest requested size and the largest
+ * size of a failed allocation are recorded. A failed allocation is counted for the subpool
+ * the requested size belongs to, requests which are larger than all elements are counted for
+ * the last subpool. The statistics are updated while the pool mutex is still locked by the
+ * pool operation, so they always match the state of the pool.
+ *
+ * The statistics are used to derive a pool configuration from the observed usage, see
+ * getRecommendedConfig.
+ */
+class MonitoredPoolManager: public PoolManager {
+public:
+    static constexpr max_subpools_t MAX_NUMBER_OF_SUBPOOLS = 8;
+
+    struct SubpoolStats {
+        uint16_t numberOfElements = 0;
+        uint32_t elementSize = 0;
+        uint16_t usedElements = 0;
+        uint16_t highWaterMark = 0;
+        uint32_t allocationFailures = 0;
+        uint32_t maxRequestedSize = 0;
+        uint32_t maxFailedSize = 0;
+    };
+
+    MonitoredPoolManager(object_id_t setObjectId, const LocalPoolConfig& poolConfig);
+    virtual ~MonitoredPoolManager();
+
+    /** StorageManagerIF overrides */
+    ReturnValue_t deleteData(store_address_t storeId) override;
+    ReturnValue_t deleteData(uint8_t* buffer, size_t size,
+            store_address_t* storeId = nullptr) override;
+    void clearStore() override;
+    void clearSubPool(max_subpools_t poolIndex) override;
+
+    /**
+     * Copy the statistics of the given subpool.
+     * @return RETURN_FAILED if the subpool does not exist or the mutex error code
+     */
+    ReturnValue_t getSubpoolStats(max_subpools_t subpool, SubpoolStats* stats);
+
+    /**
+     * Set the high water marks to the number of currently used elements and clear the
+     * failure counters and the largest requested and failed sizes.
+     * @return Mutex error code if the statistics could not be locked
+     */
+    ReturnValue_t resetStats();
+
+    /**
+     * Derive a pool configuration from the recorded statistics. The element size of a used
+     * subpool is set to the largest requested or failed size, rounded up to a multiple of
+     * 4 bytes, so requests which did not fit into the last subpool are covered as well.
+     * The number of elements is the high water mark plus the given margin in percent, or
+     * twice the configured number if allocations failed. Unused subpools keep a single
+     * element of the configured size.
+     * @return Mutex error code if the statistics could not be locked
+     */
+    ReturnValue_t getRecommendedConfig(uint8_t marginPercent,
+            LocalPoolConfig* recommendedConfig);
+
+protected:
+    /** Called by addData and getFreeElement */
+    ReturnValue_t reserveSpace(const size_t size, store_address_t* address,
+            bool ignoreFault) override;
+
+private:
+    static constexpr uint32_t MUTEX_TIMEOUT_MS = 20;
+
+    uint8_t numberOfSubpools = 0;
+    //! Protected by the pool mutex
+    std::array<SubpoolStats, MAX_NUMBER_OF_SUBPOOLS> subpoolStats;
+
+    ReturnValue_t lockPool();
+    void recordAllocation(ReturnValue_t result, store_address_t storeId, size_t size);
+    void recordDeletion(ReturnValue_t result, store_address_t storeId);
+};
+
+#endif /* MISSION_MEMORY_MONITOREDPOOLMANAGER_H_ */
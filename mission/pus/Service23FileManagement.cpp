@@ -25,13 +25,18 @@ ReturnValue_t Service23FileManagement::isValidSubservice(uint8_t subservice) {
     case Subservice::CMD_DELETE_FILE:
     case Subservice::CMD_LOCK_FILE:
     case Subservice::CMD_UNLOCK_FILE:
+    case Subservice::FIND_FILE:
     case Subservice::CREATE_DIRECTORY:
     case Subservice::DELETE_DIRECTORY:
+    case Subservice::REPORT_REPOSITORY:
     case Subservice::CMD_REPORT_FILE_ATTRIBUTES:
     case Subservice::APPEND_TO_FILE:
     case Subservice::FINISH_APPEND_TO_FILE:
     case Subservice::CMD_READ_FROM_FILE:
-    case Subservice::CMD_COPY_FILE: {
+    case Subservice::CMD_COPY_FILE:
+    case Subservice::CMD_MOVE_FILE:
+    case Subservice::CMD_SPLIT_FILE:
+    case Subservice::CMD_CHECKSUM_FILE: {
         return HasReturnvaluesIF::RETURN_OK;
     }
     default:
@@ -82,8 +87,13 @@ ReturnValue_t Service23FileManagement::prepareCommand(CommandMessage* message,
     case(Subservice::CMD_REPORT_FILE_ATTRIBUTES):
     case(Subservice::CMD_LOCK_FILE):
     case(Subservice::CMD_UNLOCK_FILE):
+    case(Subservice::FIND_FILE):
+    case(Subservice::REPORT_REPOSITORY):
     case(Subservice::CMD_READ_FROM_FILE):
-    case(Subservice::CMD_COPY_FILE): {
+    case(Subservice::CMD_COPY_FILE):
+    case(Subservice::CMD_MOVE_FILE):
+    case(Subservice::CMD_SPLIT_FILE):
+    case(Subservice::CMD_CHECKSUM_FILE): {
         result = addDataToStore(&storeId, tcData, tcDataLen);
         if(result != HasReturnvaluesIF::RETURN_OK) {
             return result;
@@ -125,6 +135,14 @@ ReturnValue_t Service23FileManagement::prepareCommand(CommandMessage* message,
 	    FileSystemMessage::setDeleteDirectoryCommand(message, storeId, false);
 		break;
 	}
+	case(Subservice::FIND_FILE): {
+	    FileSystemMessage::setFindFilesCommand(message, storeId);
+	    break;
+	}
+	case(Subservice::REPORT_REPOSITORY): {
+	    FileSystemMessage::setReportRepositoryCommand(message, storeId);
+	    break;
+	}
 	case(Subservice::FINISH_APPEND_TO_FILE): {
 		FileSystemMessage::setFinishStopWriteCommand(message, storeId);
 		break;
@@ -141,6 +159,18 @@ ReturnValue_t Service23FileManagement::prepareCommand(CommandMessage* message,
 	    FileSystemMessage::setCopyCommand(message, storeId);
 	    break;
 	}
+	case(Subservice::CMD_MOVE_FILE): {
+	    FileSystemMessage::setMoveFileCommand(message, storeId);
+	    break;
+	}
+	case(Subservice::CMD_SPLIT_FILE): {
+	    FileSystemMessage::setSplitFileCommand(message, storeId);
+	    break;
+	}
+	case(Subservice::CMD_CHECKSUM_FILE): {
+	    FileSystemMessage::setChecksumFileCommand(message, storeId);
+	    break;
+	}
 	}
 
 	return HasReturnvaluesIF::RETURN_OK;
@@ -187,6 +217,17 @@ ReturnValue_t Service23FileManagement::handleReply(const CommandMessage* reply,
                 Subservice::REPLY_REPORT_FILE_ATTRIBUTES);
         break;
 	}
+	case(FileSystemMessage::REPLY_CHECKSUM_FILE): {
+	    /* Completion reply follows */
+	    return forwardFileSystemReply(reply, objectId, Subservice::REPLY_CHECKSUM_FILE);
+	}
+	case(FileSystemMessage::REPLY_REPORT_REPOSITORY): {
+	    return handleListingReply(reply, objectId, Subservice::REPORT_REPOSTIROY_REPLY,
+	            isStep);
+	}
+	case(FileSystemMessage::REPLY_FIND_FILES): {
+	    return handleListingReply(reply, objectId, Subservice::FOUND_FILES_REPLY, isStep);
+	}
 	default:
 		result = INVALID_REPLY;
 	}
@@ -204,6 +245,8 @@ void Service23FileManagement::handleUnrequestedReply(CommandMessage *reply) {
         break;
     }
     default:
+        /* Replies might contain data in the IPC store */
+        FileSystemMessage::clear(reply);
 #if FSFW_CPP_OSTREAM_ENABLED == 1
         sif::warning << "Service23FileManagement::handleUnrequestedReply: "
                 "Unknown reply with reply ID " << replyId << std::endl;
@@ -215,6 +258,20 @@ void Service23FileManagement::handleUnrequestedReply(CommandMessage *reply) {
 }
 
 
+ReturnValue_t Service23FileManagement::handleListingReply(const CommandMessage* reply,
+        object_id_t objectId, Subservice subservice, bool* isStep) {
+    bool lastPage = FileSystemMessage::isLastListingPage(reply);
+    if(not lastPage) {
+        /* Further pages follow */
+        *isStep = true;
+    }
+    ReturnValue_t result = forwardFileSystemReply(reply, objectId, subservice);
+    if(result == HasReturnvaluesIF::RETURN_OK and lastPage) {
+        return CommandingServiceBase::EXECUTION_COMPLETE;
+    }
+    return result;
+}
+
 ReturnValue_t Service23FileManagement::addDataToStore(
         store_address_t* storeId, const uint8_t* tcData,
         size_t tcDataLen) {
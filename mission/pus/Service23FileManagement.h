@@ -29,6 +29,10 @@
  *   - TM[23,13]: Response of TC[23,12]
  *   - TC[23,15]: Move a file
  *
+ * Repository reports and found files are reported page-wise. The command can contain the
+ * index of the first entry to report and the maximum number of entries, so large
+ * repositories can be inspected with multiple commands.
+ *
  * A set of custom subservices will be implemented for uploading files:
  *  - TC[23,130]: Append to file. The service will  implement sequence checking
  *    for consecutive append operations on the same file but only support one
@@ -122,7 +126,9 @@ private:
         CMD_LOCK_FILE = 5,
         CMD_UNLOCK_FILE = 6,
 
+        //! [EXPORT] : [COMMAND] Find files matching a wildcard pattern in a repository
         FIND_FILE = 7,
+        //! [EXPORT] : [REPLY] One page of files found with subservice 7
         FOUND_FILES_REPLY = 8,
 
         //! [EXPORT] : [COMMAND] Create a directory
@@ -131,7 +137,9 @@ private:
         DELETE_DIRECTORY = 10,
 
         RENAME_DIRECTORY = 11,
+        //! [EXPORT] : [COMMAND] Report the content of a repository
         REPORT_REPOSITORY = 12,
+        //! [EXPORT] : [REPLY] One page of the repository content reported with subservice 12
         REPORT_REPOSTIROY_REPLY = 13,
 
         //! [EXPORT] : [COMMAND] Copy a file
@@ -144,6 +152,13 @@ private:
         FINISH_APPEND_TO_FILE = 131,
         FINISH_APPEND_REPLY = 132,
 
+        //! [EXPORT] : [COMMAND] Split a file into part files with a fixed size
+        CMD_SPLIT_FILE = 133,
+        //! [EXPORT] : [COMMAND] Calculate a CRC32 or CRC16 checksum over a file
+        CMD_CHECKSUM_FILE = 134,
+        //! [EXPORT] : [REPLY] Reply of subservice 134 containing the checksum and the file size
+        REPLY_CHECKSUM_FILE = 135,
+
         CMD_READ_FROM_FILE = 140, //!< [EXPORT] : [COMMAND] Read data from a file
         REPLY_READ_FROM_FILE = 141, //!< [EXPORT] : [REPLY] Reply of subservice 140
         CMD_STOP_READ_FROM_FILE = 142, //!< [EXPORT] : [COMMAND] Stop read from file
@@ -156,6 +171,12 @@ private:
             size_t tcDataLen);
     ReturnValue_t forwardFileSystemReply(const CommandMessage* reply,
             object_id_t objectId, Subservice subservice);
+    /**
+     * Forward one page of a repository listing. Intermediate pages are reported as steps,
+     * the last page completes the command.
+     */
+    ReturnValue_t handleListingReply(const CommandMessage* reply, object_id_t objectId,
+            Subservice subservice, bool* isStep);
 };
 
 
@@ -0,0 +1,26 @@
+#ifndef MISSION_UTILITY_CRC32_H_
+#define MISSION_UTILITY_CRC32_H_
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief   CRC32 (IEEE 802.3, reflected polynomial 0xEDB88320) as used by zlib and most
+ *          ground tools like crc32 or Python's zlib.crc32.
+ * @details
+ * The CRC can be calculated incrementally by passing the result of the previous call
+ * as the starting value, e.g. when processing a file chunk by chunk.
+ */
+class Crc32 {
+public:
+    static constexpr uint32_t DEFAULT_START_CRC = 0;
+
+    static uint32_t calculate(const uint8_t* data, size_t length,
+            uint32_t startingCrc = DEFAULT_START_CRC);
+
+private:
+    Crc32() = delete;
+    static const uint32_t crc32Table[256];
+};
+
+#endif /* MISSION_UTILITY_CRC32_H_ */
@@ -0,0 +1,182 @@
+#include "DeferredLogger.h"
+#include "OBSWConfig.h"
+
+#include <fsfw/ipc/CommandMessage.h>
+#include <fsfw/ipc/MutexFactory.h>
+#include <fsfw/ipc/QueueFactory.h>
+#include <fsfw/serviceinterface/ServiceInterface.h>
+#include <fsfw/timemanager/Clock.h>
+
+#include <cstring>
+
+DeferredLogger* DeferredLogger::instance = nullptr;
+
+DeferredLogger::DeferredLogger(object_id_t objectId): SystemObject(objectId),
+        commandQueue(QueueFactory::instance()->createMessageQueue(MAX_MESSAGE_QUEUE_DEPTH)),
+        memoryHelper(this, commandQueue) {
+    logMutex = MutexFactory::instance()->createMutex();
+    image.header.magic = deferredlog::MAGIC;
+    image.header.version = deferredlog::VERSION;
+    image.header.recordSize = sizeof(deferredlog::Record);
+    image.header.capacity = CAPACITY;
+    /* The macros record from now on, the printouts are formatted once the task is running */
+    instance = this;
+}
+
+DeferredLogger::~DeferredLogger() {
+    if(instance == this) {
+        instance = nullptr;
+    }
+    MutexFactory::instance()->deleteMutex(logMutex);
+    QueueFactory::instance()->deleteMessageQueue(commandQueue);
+}
+
+ReturnValue_t DeferredLogger::initialize() {
+    ReturnValue_t result = SystemObject::initialize();
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        return result;
+    }
+    return memoryHelper.initialize(commandQueue);
+}
+
+ReturnValue_t DeferredLogger::performOperation(uint8_t opCode) {
+    CommandMessage message;
+    for(ReturnValue_t result = commandQueue->receiveMessage(&message);
+            result == HasReturnvaluesIF::RETURN_OK;
+            result = commandQueue->receiveMessage(&message)) {
+        result = memoryHelper.handleMemoryCommand(&message);
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            message.setToUnknownCommand();
+            commandQueue->reply(&message);
+        }
+    }
+#if OBSW_VERBOSE_LEVEL >= 1
+    printPendingRecords();
+#endif
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+MessageQueueId_t DeferredLogger::getCommandQueue() const {
+    return commandQueue->getId();
+}
+
+ReturnValue_t DeferredLogger::handleMemoryLoad(uint32_t address, const uint8_t *data,
+        uint32_t size, uint8_t **dataPointer) {
+    /* The log is read-only for the ground */
+    return HasReturnvaluesIF::RETURN_FAILED;
+}
+
+ReturnValue_t DeferredLogger::handleMemoryDump(uint32_t address, uint32_t size,
+        uint8_t **dataPointer, uint8_t *dumpTarget) {
+    if(address >= sizeof(LogImage)) {
+        return HasMemoryIF::INVALID_ADDRESS;
+    }
+    if(size > sizeof(LogImage) - address) {
+        return HasMemoryIF::INVALID_SIZE;
+    }
+    /* Records are added while the dump is done, so the image is copied to the IPC store here
+    with the log locked instead of leaving the copy to the memory helper */
+    ReturnValue_t result = logMutex->lockMutex(MutexIF::TimeoutType::WAITING,
+            MUTEX_TIMEOUT_MS);
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        return result;
+    }
+    std::memcpy(dumpTarget, reinterpret_cast<uint8_t*>(&image) + address, size);
+    logMutex->unlockMutex();
+    return HasMemoryIF::ACTIVITY_COMPLETED;
+}
+
+ReturnValue_t DeferredLogger::setAddress(uint32_t *startAddress) {
+    return HasReturnvaluesIF::RETURN_OK;
+}
+
+void DeferredLogger::record(deferredlog::Level level, uint32_t formatId, const char* format,
+        uint8_t numberOfArgs, const uint32_t* args) {
+    if(instance == nullptr) {
+#if OBSW_VERBOSE_LEVEL >= 1
+        print(level, format, args);
+#endif
+        return;
+    }
+    instance->addRecord(level, formatId, format, numberOfArgs, args);
+}
+
+void DeferredLogger::addRecord(deferredlog::Level level, uint32_t formatId,
+        const char* format, uint8_t numberOfArgs, const uint32_t* args) {
+    uint32_t uptimeMs = 0;
+    Clock::getUptime(&uptimeMs);
+    ReturnValue_t result = logMutex->lockMutex(MutexIF::TimeoutType::WAITING,
+            MUTEX_TIMEOUT_MS);
+    if(result != HasReturnvaluesIF::RETURN_OK) {
+        /* Not protected, an imprecise count is acceptable here */
+        image.header.droppedRecords++;
+        return;
+    }
+    uint32_t index = image.header.recordCount % CAPACITY;
+    deferredlog::Record& record = image.records[index];
+    record.timestamp = uptimeMs;
+    record.formatId = formatId;
+    record.level = level;
+    record.numberOfArgs = numberOfArgs;
+    for(uint8_t idx = 0; idx < deferredlog::MAX_NUMBER_OF_ARGS; idx++) {
+        record.args[idx] = args[idx];
+    }
+    formats[index] = format;
+    image.header.recordCount++;
+    logMutex->unlockMutex();
+}
+
+void DeferredLogger::printPendingRecords() {
+    for(uint32_t printouts = 0; printouts < MAX_PRINTOUTS_PER_CYCLE; printouts++) {
+        deferredlog::Record record;
+        const char* format = nullptr;
+        uint32_t overwrittenRecords = 0;
+        ReturnValue_t result = logMutex->lockMutex(MutexIF::TimeoutType::WAITING,
+                MUTEX_TIMEOUT_MS);
+        if(result != HasReturnvaluesIF::RETURN_OK) {
+            return;
+        }
+        uint32_t recordCount = image.header.recordCount;
+        if(printedRecords == recordCount) {
+            logMutex->unlockMutex();
+            return;
+        }
+        if(recordCount - printedRecords > CAPACITY) {
+            overwrittenRecords = recordCount - printedRecords - CAPACITY;
+            printedRecords = recordCount - CAPACITY;
+        }
+        uint32_t index = printedRecords % CAPACITY;
+        record = image.records[index];
+        format = formats[index];
+        printedRecords++;
+        logMutex->unlockMutex();
+
+        if(overwrittenRecords > 0) {
+            sif::printWarning("DeferredLogger: %lu records were overwritten before they "
+                    "were printed\n", static_cast<unsigned long>(overwrittenRecords));
+        }
+        print(record.level, format, record.args);
+    }
+}
+
+void DeferredLogger::print(uint8_t level, const char* format, const uint32_t* args) {
+    /* Unused arguments are zero and ignored by the formatting */
+    switch(level) {
+    case(deferredlog::LEVEL_DEBUG): {
+        sif::printDebug(format, args[0], args[1], args[2], args[3]);
+        break;
+    }
+    case(deferredlog::LEVEL_INFO): {
+        sif::printInfo(format, args[0], args[1], args[2], args[3]);
+        break;
+    }
+    case(deferredlog::LEVEL_WARNING): {
+        sif::printWarning(format, args[0], args[1], args[2], args[3]);
+        break;
+    }
+    default: {
+        sif::printError(format, args[0], args[1], args[2], args[3]);
+        break;
+    }
+    }
+}
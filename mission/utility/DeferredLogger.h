@@ -0,0 +1,108 @@
+#ifndef MISSION_UTILITY_DEFERREDLOGGER_H_
+#define MISSION_UTILITY_DEFERREDLOGGER_H_
+
+#include <fsfw/ipc/MessageQueueIF.h>
+#include <fsfw/ipc/MutexIF.h>
+#include <fsfw/memory/AcceptsMemoryMessagesIF.h>
+#include <fsfw/memory/MemoryHelper.h>
+#include <fsfw/objectmanager/SystemObject.h>
+#include <fsfw/tasks/ExecutableObjectIF.h>
+
+#include "deferredLogDefinitions.h"
+
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * @brief   Records printouts as format ID and arguments and formats them later.
+ * @details
+ * The OBSW_LOG_* macros in mission/utility/obswLog.h store the hash of the format string and
+ * up to four integer arguments in a ring buffer instead of formatting the string on the
+ * calling task. This object formats and prints the pending records in its own low priority
+ * task if OBSW_VERBOSE_LEVEL is at least 1, so the printouts do not distort the timing of the
+ * calling tasks.
+ *
+ * The ring, consisting of a header and the records, can also be dumped with Service 6 using
+ * this object as memory ID, the address is the offset inside the image. The records are then
+ * formatted on ground with misc/decode_deferred_log.py, using the format ID table generated
+ * by generators/logformats/log_format_parser.py. This way, the diagnostics can stay enabled
+ * in builds without printouts.
+ *
+ * The arguments are stored as 32 bit words, so only integer and enumeration arguments can be
+ * logged and strings must not be printed with %s. Logging must not be used in interrupts.
+ */
+class DeferredLogger: public SystemObject,
+        public ExecutableObjectIF,
+        public AcceptsMemoryMessagesIF {
+public:
+    static constexpr uint32_t CAPACITY = 256;
+
+    struct LogImage {
+        deferredlog::Header header;
+        deferredlog::Record records[CAPACITY];
+    };
+
+    DeferredLogger(object_id_t objectId);
+    virtual ~DeferredLogger();
+
+    /**
+     * Record a printout. Use the OBSW_LOG_* macros, which calculate the format ID at compile
+     * time. The printout is formatted immediately if the logger has not been created yet.
+     * @param format    Must be a string literal, it is only used for the printout on board
+     */
+    template<typename... Args>
+    static void log(deferredlog::Level level, uint32_t formatId, const char* format,
+            Args... args) {
+        static_assert(sizeof...(Args) <= deferredlog::MAX_NUMBER_OF_ARGS,
+                "DeferredLogger: Too many arguments");
+        const uint32_t words[deferredlog::MAX_NUMBER_OF_ARGS] = { toWord(args)... };
+        record(level, formatId, format, sizeof...(Args), words);
+    }
+
+    ReturnValue_t performOperation(uint8_t opCode) override;
+    ReturnValue_t initialize() override;
+
+    /** AcceptsMemoryMessagesIF overrides */
+    MessageQueueId_t getCommandQueue() const override;
+
+    /** HasMemoryIF overrides */
+    ReturnValue_t handleMemoryLoad(uint32_t address, const uint8_t* data, uint32_t size,
+            uint8_t** dataPointer) override;
+    ReturnValue_t handleMemoryDump(uint32_t address, uint32_t size, uint8_t** dataPointer,
+            uint8_t* dumpTarget) override;
+    ReturnValue_t setAddress(uint32_t* startAddress) override;
+
+private:
+    static constexpr uint8_t MAX_MESSAGE_QUEUE_DEPTH = 3;
+    static constexpr uint32_t MUTEX_TIMEOUT_MS = 5;
+    //! Limits the time spent printing in one cycle of the low priority task
+    static constexpr uint32_t MAX_PRINTOUTS_PER_CYCLE = 32;
+
+    static DeferredLogger* instance;
+
+    MessageQueueIF* commandQueue = nullptr;
+    MemoryHelper memoryHelper;
+    MutexIF* logMutex = nullptr;
+
+    LogImage image = {};
+    //! The format strings are kept separately because they are not part of the dump
+    const char* formats[CAPACITY] = {};
+    uint32_t printedRecords = 0;
+
+    template<typename T>
+    static constexpr uint32_t toWord(T arg) {
+        static_assert(std::is_integral<T>::value or std::is_enum<T>::value,
+                "DeferredLogger: Only integer and enumeration arguments can be logged");
+        return static_cast<uint32_t>(arg);
+    }
+
+    static void record(deferredlog::Level level, uint32_t formatId, const char* format,
+            uint8_t numberOfArgs, const uint32_t* args);
+    static void print(uint8_t level, const char* format, const uint32_t* args);
+
+    void addRecord(deferredlog::Level level, uint32_t formatId, const char* format,
+            uint8_t numberOfArgs, const uint32_t* args);
+    void printPendingRecords();
+};
+
+#endif /* MISSION_UTILITY_DEFERREDLOGGER_H_ */
@@ -64,9 +64,13 @@ public:
      */
     ReturnValue_t performOperation(uint8_t opCode) override;
 
-    ReturnValue_t insertPeriodicTask(object_id_t objectId,
+    /**
+     * Insert a task into the map shared by all monitors. Can be called before the
+     * monitors are created.
+     */
+    static ReturnValue_t insertPeriodicTask(object_id_t objectId,
             PeriodicTaskIF* periodicTask);
-    ReturnValue_t insertFixedTimeslotTask(object_id_t objectId,
+    static ReturnValue_t insertFixedTimeslotTask(object_id_t objectId,
             FixedTimeslotTaskIF* fixedTimeslotTask);
 
     PeriodicTaskIF* getPeriodicTaskHandle(object_id_t objectId);
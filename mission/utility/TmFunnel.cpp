@@ -1,4 +1,5 @@
 #include <mission/utility/TmFunnel.h>
+#include <mission/utility/obswTrace.h>
 
 #include <fsfw/ipc/QueueFactory.h>
 #include <fsfw/objectmanager/ObjectManager.h>
@@ -26,6 +27,7 @@ MessageQueueId_t TmFunnel::getReportReceptionQueue(uint8_t virtualChannel) {
 }
 
 ReturnValue_t TmFunnel::performOperation(uint8_t operationCode) {
+    OBSW_TRACE_BEGIN(traceid::TM_FUNNEL, sourceSequenceCount);
     TmTcMessage currentMessage;
     ReturnValue_t status = tmQueue->receiveMessage(&currentMessage);
     while(status == HasReturnvaluesIF::RETURN_OK)
@@ -36,6 +38,7 @@ ReturnValue_t TmFunnel::performOperation(uint8_t operationCode) {
         }
         status = tmQueue->receiveMessage(&currentMessage);
     }
+    OBSW_TRACE_END(traceid::TM_FUNNEL, sourceSequenceCount);
 
     if (status == MessageQueueIF::EMPTY) {
         return HasReturnvaluesIF::RETURN_OK;
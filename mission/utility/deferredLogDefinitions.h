@@ -0,0 +1,55 @@
+#ifndef MISSION_UTILITY_DEFERREDLOGDEFINITIONS_H_
+#define MISSION_UTILITY_DEFERREDLOGDEFINITIONS_H_
+
+#include <cstdint>
+
+namespace deferredlog {
+
+static constexpr uint32_t MAGIC = 0x444C4F47;
+static constexpr uint16_t VERSION = 1;
+static constexpr uint8_t MAX_NUMBER_OF_ARGS = 4;
+
+enum Level: uint8_t {
+    LEVEL_DEBUG,
+    LEVEL_INFO,
+    LEVEL_WARNING,
+    LEVEL_ERROR
+};
+
+/**
+ * 32 bit FNV-1a hash of the format string. generators/logformats/log_format_parser.py uses
+ * the same hash to map the IDs back to the format strings.
+ */
+constexpr uint32_t getFormatId(const char* format) {
+    uint32_t hash = 2166136261u;
+    while(*format != '\0') {
+        hash = (hash ^ static_cast<uint8_t>(*format)) * 16777619u;
+        format++;
+    }
+    return hash;
+}
+
+struct Header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recordSize;
+    uint32_t capacity;
+    //! Total number of written records, the ring index is recordCount % capacity
+    uint32_t recordCount;
+    //! Records which could not be written because the ring was locked for too long
+    uint32_t droppedRecords;
+};
+
+struct Record {
+    //! Uptime in milliseconds
+    uint32_t timestamp;
+    uint32_t formatId;
+    uint8_t level;
+    uint8_t numberOfArgs;
+    uint16_t spare;
+    uint32_t args[MAX_NUMBER_OF_ARGS];
+};
+
+}
+
+#endif /* MISSION_UTILITY_DEFERREDLOGDEFINITIONS_H_ */
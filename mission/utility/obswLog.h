@@ -0,0 +1,55 @@
+#ifndef MISSION_UTILITY_OBSWLOG_H_
+#define MISSION_UTILITY_OBSWLOG_H_
+
+#include "OBSWConfig.h"
+
+/**
+ * Printouts for the hot paths of the OBSW. If OBSW_DEFERRED_LOGGING is set to 1, the macros
+ * only record the ID of the format string and the arguments in the deferred logger, which
+ * formats them in a low priority task or leaves them to be formatted on ground. Otherwise,
+ * the macros print immediately. Errors are always printed, the other levels only if
+ * OBSW_VERBOSE_LEVEL is at least 1.
+ *
+ * The format must be a string literal. The format IDs are collected by
+ * generators/logformats/log_format_parser.py, which only finds literals passed directly to
+ * the macros. At most four integer or enumeration arguments are supported, strings and
+ * floating point values can not be logged.
+ */
+#if OBSW_DEFERRED_LOGGING == 1
+
+#include <mission/utility/DeferredLogger.h>
+
+#define OBSW_LOG(level, format, ...) do { \
+        constexpr uint32_t obswLogFormatId = deferredlog::getFormatId(format); \
+        DeferredLogger::log(level, obswLogFormatId, format, ##__VA_ARGS__); \
+    } while(0)
+
+#define OBSW_LOG_DEBUG(format, ...) OBSW_LOG(deferredlog::LEVEL_DEBUG, format, ##__VA_ARGS__)
+#define OBSW_LOG_INFO(format, ...) OBSW_LOG(deferredlog::LEVEL_INFO, format, ##__VA_ARGS__)
+#define OBSW_LOG_WARNING(format, ...) OBSW_LOG(deferredlog::LEVEL_WARNING, format, \
+        ##__VA_ARGS__)
+#define OBSW_LOG_ERROR(format, ...) OBSW_LOG(deferredlog::LEVEL_ERROR, format, ##__VA_ARGS__)
+
+#else
+
+#include <fsfw/serviceinterface/ServiceInterface.h>
+
+#if OBSW_VERBOSE_LEVEL >= 1
+
+#define OBSW_LOG_DEBUG(format, ...) sif::printDebug(format, ##__VA_ARGS__)
+#define OBSW_LOG_INFO(format, ...) sif::printInfo(format, ##__VA_ARGS__)
+#define OBSW_LOG_WARNING(format, ...) sif::printWarning(format, ##__VA_ARGS__)
+
+#else
+
+#define OBSW_LOG_DEBUG(format, ...)
+#define OBSW_LOG_INFO(format, ...)
+#define OBSW_LOG_WARNING(format, ...)
+
+#endif /* OBSW_VERBOSE_LEVEL >= 1 */
+
+#define OBSW_LOG_ERROR(format, ...) sif::printError(format, ##__VA_ARGS__)
+
+#endif /* OBSW_DEFERRED_LOGGING == 1 */
+
+#endif /* MISSION_UTILITY_OBSWLOG_H_ */
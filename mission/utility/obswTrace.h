@@ -0,0 +1,50 @@
+#ifndef MISSION_UTILITY_OBSWTRACE_H_
+#define MISSION_UTILITY_OBSWTRACE_H_
+
+#include "OBSWConfig.h"
+
+#include <cstdint>
+
+/**
+ * Trace points for the hot paths of the OBSW. If OBSW_ENABLE_TRACE is set to 1, the macros
+ * write timestamped records into the trace buffer of the board, which can be dumped with
+ * Service 6 or written to a file by the trace buffer handler and converted to the Chrome trace
+ * format with misc/trace_to_chrome.py. Otherwise, the macros compile to nothing.
+ *
+ * A begin record should always be followed by an end record with the same ID on all paths.
+ */
+namespace traceid {
+
+//! IDs up to 0xff are reserved for the board. The names used by the converter are listed in
+//! misc/trace_to_chrome.py and should be kept up to date.
+enum TraceId: uint16_t {
+    //! Arg: Source sequence count, the difference is the number of forwarded packets
+    TM_FUNNEL = 0x100,
+    //! Arg: Command ID of the message at the begin, return value at the end
+    SD_CARD_HANDLER_MESSAGE = 0x110,
+    //! Arg: Internal state of the state machine
+    SD_CARD_HANDLER_STATE_MACHINE = 0x111,
+    //! Arg: Command ID of the request at the begin, return value at the end
+    SD_CARD_IO_REQUEST = 0x112
+};
+
+}
+
+#if OBSW_ENABLE_TRACE == 1
+
+#include <traceBuffer.h>
+
+#define OBSW_TRACE_BEGIN(id, arg) trace_buffer_record(TRACE_BUFFER_PHASE_BEGIN | (id), (arg))
+#define OBSW_TRACE_END(id, arg) trace_buffer_record(TRACE_BUFFER_PHASE_END | (id), (arg))
+#define OBSW_TRACE_INSTANT(id, arg) trace_buffer_record(TRACE_BUFFER_PHASE_INSTANT | (id), \
+        (arg))
+
+#else
+
+#define OBSW_TRACE_BEGIN(id, arg)
+#define OBSW_TRACE_END(id, arg)
+#define OBSW_TRACE_INSTANT(id, arg)
+
+#endif /* OBSW_ENABLE_TRACE == 1 */
+
+#endif /* MISSION_UTILITY_OBSWTRACE_H_ */
@@ -21,7 +21,9 @@ namespace objects {
 		HK_RECEIVER_MOCK = 22,
 		TEST_LOCAL_POOL_OWNER_BASE = 25,
 
-		SHARED_SET_ID = 26
+		SHARED_SET_ID = 26,
+
+		SOFTWARE_IMAGE_HANDLER = 0x4D009000
 
 	};
 }
@@ -10,6 +10,8 @@
 namespace CLASS_ID {
 enum {
 	MISSION_CLASS_ID_START = FW_CLASS_ID_COUNT,
+	SD_CARD_HANDLER, //SDCH
+	SW_IMAGE_HANDLER, //SWIH
 };
 }
 
@@ -0,0 +1,32 @@
+#include <catch2/catch_test_macros.hpp>
+#include <mission/utility/Crc32.h>
+
+#include <cstring>
+
+TEST_CASE("CRC32 Test", "[crc32]") {
+    const char* checkString = "123456789";
+    const uint8_t* checkData = reinterpret_cast<const uint8_t*>(checkString);
+    size_t checkLength = std::strlen(checkString);
+
+    SECTION("Reference vectors") {
+        /* Same values as zlib.crc32 */
+        CHECK(Crc32::calculate(nullptr, 0) == 0);
+        CHECK(Crc32::calculate(checkData, checkLength) == 0xCBF43926);
+        const uint8_t singleByte = 'a';
+        CHECK(Crc32::calculate(&singleByte, 1) == 0xE8B7BE43);
+        const char* fox = "The quick brown fox jumps over the lazy dog";
+        CHECK(Crc32::calculate(reinterpret_cast<const uint8_t*>(fox), std::strlen(fox)) ==
+                0x414FA339);
+        const uint8_t zeros[32] = {};
+        CHECK(Crc32::calculate(zeros, sizeof(zeros)) == 0x190A55AD);
+    }
+
+    SECTION("Incremental calculation") {
+        /* Used when a file is processed chunk by chunk */
+        for(size_t split = 0; split <= checkLength; split++) {
+            uint32_t crc = Crc32::calculate(checkData, split);
+            crc = Crc32::calculate(checkData + split, checkLength - split, crc);
+            CHECK(crc == 0xCBF43926);
+        }
+    }
+}
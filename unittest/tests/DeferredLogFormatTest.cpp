@@ -0,0 +1,68 @@
+#include <catch2/catch_test_macros.hpp>
+#include <mission/utility/deferredLogDefinitions.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+namespace {
+
+/* Reverts the unicode_escape encoding of the format column */
+std::string unescapeFormat(const std::string& escaped) {
+    std::string format;
+    for(size_t idx = 0; idx < escaped.size(); idx++) {
+        if(escaped[idx] != '\\' or idx + 1 == escaped.size()) {
+            format += escaped[idx];
+            continue;
+        }
+        idx++;
+        switch(escaped[idx]) {
+        case('n'): format += '\n'; break;
+        case('r'): format += '\r'; break;
+        case('t'): format += '\t'; break;
+        case('x'): {
+            format += static_cast<char>(std::strtoul(escaped.substr(idx + 1, 2).c_str(),
+                    nullptr, 16));
+            idx += 2;
+            break;
+        }
+        default: format += escaped[idx]; break;
+        }
+    }
+    return format;
+}
+
+}
+
+TEST_CASE("Deferred Log Format IDs", "[deferredlog]") {
+    SECTION("Reference vectors") {
+        /* Same values as get_format_id of the log format parser */
+        static_assert(deferredlog::getFormatId("") == 0x811C9DC5,
+                "Format ID must be calculated at compile time");
+        CHECK(deferredlog::getFormatId("a") == 0xE40C292C);
+        CHECK(deferredlog::getFormatId("foobar") == 0xBF9CF968);
+        CHECK(deferredlog::getFormatId("Value %d\n") == 0xC908CD6F);
+    }
+
+    SECTION("Generated format table") {
+        /* The IDs in the table were calculated by generators/logformats/log_format_parser.py */
+        std::ifstream table(LOG_FORMAT_TABLE);
+        REQUIRE(table.is_open());
+        std::string line;
+        REQUIRE(std::getline(table, line));
+        size_t numberOfFormats = 0;
+        while(std::getline(table, line)) {
+            /* The format is the last column and may contain the separator */
+            size_t idEnd = line.find(';');
+            size_t levelEnd = line.find(';', idEnd + 1);
+            size_t fileEnd = line.find(';', levelEnd + 1);
+            REQUIRE(fileEnd != std::string::npos);
+            uint32_t formatId = std::strtoul(line.substr(0, idEnd).c_str(), nullptr, 16);
+            std::string format = unescapeFormat(line.substr(fileEnd + 1));
+            INFO(line);
+            CHECK(deferredlog::getFormatId(format.c_str()) == formatId);
+            numberOfFormats++;
+        }
+        CHECK(numberOfFormats > 0);
+    }
+}
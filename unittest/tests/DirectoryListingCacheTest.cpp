@@ -0,0 +1,108 @@
+#include "HostSdCard.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <bsp_sam9g20/memory/DirectoryListingCache.h>
+
+#include <fsfw/memory/HasFileSystemIF.h>
+
+#include <cstring>
+
+namespace {
+
+uint32_t getDirectorySearches() {
+    HostFatStatistics statistics;
+    host_fat_get_statistics(&statistics);
+    return statistics.directory_searches;
+}
+
+}
+
+TEST_CASE("Directory Listing Cache Test", "[sdcard]") {
+    REQUIRE(hostsdcard::prepare() == F_NO_ERROR);
+    REQUIRE(create_directory("/", "LOGS") == F_NO_ERROR);
+    const uint8_t data[4] = {1, 2, 3, 4};
+    REQUIRE(create_file("LOGS", "A.TXT", data, 1) >= 0);
+    REQUIRE(create_file("LOGS", "B.TXT", data, 2) >= 0);
+    REQUIRE(create_file("LOGS", "C.BIN", data, 4) >= 0);
+
+    DirectoryListingCache cache;
+    DirectoryListingCache::Entry entries[8];
+    size_t numberOfEntries = 0;
+    size_t totalMatches = 0;
+
+    host_fat_reset_statistics();
+    REQUIRE(cache.getEntries("LOGS", nullptr, 0, entries, 8, &numberOfEntries,
+            &totalMatches) == (int) HasReturnvaluesIF::RETURN_OK);
+    CHECK(numberOfEntries == 3);
+    CHECK(totalMatches == 3);
+    CHECK(getDirectorySearches() == 1);
+
+    SECTION("Cache hits") {
+        REQUIRE(cache.getEntries("/logs/", "*.txt", 0, entries, 8, &numberOfEntries,
+                &totalMatches) == (int) HasReturnvaluesIF::RETURN_OK);
+        CHECK(numberOfEntries == 2);
+        CHECK(totalMatches == 2);
+
+        /* Pages of the listing */
+        REQUIRE(cache.getEntries("LOGS", nullptr, 2, entries, 1, &numberOfEntries,
+                &totalMatches) == (int) HasReturnvaluesIF::RETURN_OK);
+        CHECK(numberOfEntries == 1);
+        CHECK(totalMatches == 3);
+
+        REQUIRE(cache.getEntries("LOGS", "C.BIN", 0, entries, 8, &numberOfEntries,
+                &totalMatches) == (int) HasReturnvaluesIF::RETURN_OK);
+        REQUIRE(numberOfEntries == 1);
+        CHECK(std::strcmp(entries[0].name, "C.BIN") == 0);
+        CHECK(entries[0].size == 4);
+        CHECK(not entries[0].isDirectory);
+
+        /* All requests were served without scanning the SD card again */
+        CHECK(getDirectorySearches() == 1);
+    }
+
+    SECTION("Invalidation") {
+        REQUIRE(create_file("LOGS", "D.TXT", data, 3) >= 0);
+        host_fat_reset_statistics();
+
+        /* Changes which were not recorded are not visible until the listing expires */
+        REQUIRE(cache.getEntries("LOGS", "*.TXT", 0, entries, 8, &numberOfEntries,
+                &totalMatches) == (int) HasReturnvaluesIF::RETURN_OK);
+        CHECK(totalMatches == 2);
+        CHECK(getDirectorySearches() == 0);
+
+        cache.invalidate("/LOGS");
+        REQUIRE(cache.getEntries("LOGS", "*.TXT", 0, entries, 8, &numberOfEntries,
+                &totalMatches) == (int) HasReturnvaluesIF::RETURN_OK);
+        CHECK(totalMatches == 3);
+        CHECK(getDirectorySearches() == 1);
+
+        /* Invalidating another repository keeps the listing */
+        cache.invalidate("MISC");
+        REQUIRE(cache.getEntries("LOGS", nullptr, 0, entries, 8, &numberOfEntries,
+                &totalMatches) == (int) HasReturnvaluesIF::RETURN_OK);
+        CHECK(totalMatches == 4);
+        CHECK(getDirectorySearches() == 1);
+
+        cache.invalidateAll();
+        REQUIRE(cache.getEntries("LOGS", nullptr, 0, entries, 8, &numberOfEntries,
+                &totalMatches) == (int) HasReturnvaluesIF::RETURN_OK);
+        CHECK(totalMatches == 4);
+        CHECK(getDirectorySearches() == 2);
+    }
+
+    SECTION("Missing repository") {
+        CHECK(cache.getEntries("MISSING", nullptr, 0, entries, 8, &numberOfEntries,
+                &totalMatches) == (int) HasFileSystemIF::DIRECTORY_DOES_NOT_EXIST);
+        CHECK(numberOfEntries == 0);
+        CHECK(totalMatches == 0);
+    }
+}
+
+TEST_CASE("Directory Listing Pattern Test", "[sdcard]") {
+    CHECK(DirectoryListingCache::matchesPattern("*.*", "NOEXT"));
+    CHECK(DirectoryListingCache::matchesPattern("*.bin", "IMAGE.BIN"));
+    CHECK(DirectoryListingCache::matchesPattern("IMG?.BIN", "img1.bin"));
+    CHECK(DirectoryListingCache::matchesPattern("*A*B", "XAYAB"));
+    CHECK(not DirectoryListingCache::matchesPattern("*.TXT", "IMAGE.BIN"));
+    CHECK(not DirectoryListingCache::matchesPattern("IMG?.BIN", "IMG10.BIN"));
+}
@@ -0,0 +1,33 @@
+#ifndef UNITTEST_TESTS_HOSTSDCARD_H_
+#define UNITTEST_TESTS_HOSTSDCARD_H_
+
+#include <bsp_hosted/hcc/HostFatApi.h>
+#include <bsp_sam9g20/common/SDCardApi.h>
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace hostsdcard {
+
+/**
+ * Select an empty simulated SD card 0 in a new temporary directory, so the tests do not
+ * depend on the files left by other tests or previous runs.
+ * @param config    Latency and throughput limits, the root path is set by this function
+ * @return F_NO_ERROR on success
+ */
+inline int prepare(HostFatConfig config = {}) {
+    /* The configuration only stores the pointer to the root path */
+    static char rootPath[64];
+    std::snprintf(rootPath, sizeof(rootPath), "/tmp/obsw_unittest_XXXXXX");
+    if(mkdtemp(rootPath) == nullptr) {
+        return F_ERR_WRITE;
+    }
+    config.root_path = rootPath;
+    host_fat_configure(&config);
+    host_fat_reset_statistics();
+    return select_sd_card(SD_CARD_0, true);
+}
+
+}
+
+#endif /* UNITTEST_TESTS_HOSTSDCARD_H_ */
@@ -0,0 +1,247 @@
+#include "HostSdCard.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <bsp_sam9g20/core/ImageCopyingEngine.h>
+#include <bsp_sam9g20/core/ScrubbingEngine.h>
+#include <bsp_sam9g20/common/fram/FRAMApi.h>
+#include <bsp_sam9g20/common/fram/VirtualFRAMApi.h>
+#include <bsp_hosted/flash/HostNorFlash.h>
+
+#include <fsfw/globalfunctions/CRC.h>
+#include <fsfw/timemanager/Countdown.h>
+#include <hal/Storage/NORflash.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+/* Deliberately not a multiple of the hamming block size */
+constexpr size_t IMAGE_SIZE = 100000;
+
+/* Fresh NOR-Flash image without latency injection */
+int prepareNorFlash() {
+    static char imagePath[64];
+    std::snprintf(imagePath, sizeof(imagePath), "/tmp/obsw_unittest_nor_XXXXXX");
+    if(mkdtemp(imagePath) == nullptr) {
+        return -1;
+    }
+    std::strncat(imagePath, "/norflash.bin", sizeof(imagePath) - std::strlen(imagePath) - 1);
+    HostNorFlashConfig config;
+    host_nor_flash_get_default_config(&config);
+    config.image_path = imagePath;
+    host_nor_flash_configure(&config);
+    return NORflash_start();
+}
+
+std::vector<uint8_t> createImage() {
+    std::vector<uint8_t> image(IMAGE_SIZE);
+    uint32_t state = 42;
+    for(auto& byte: image) {
+        state = state * 1103515245 + 12345;
+        byte = state >> 16;
+    }
+    return image;
+}
+
+void writeSlot0Image(const std::vector<uint8_t>& image) {
+    delete_file(config::SW_REPOSITORY, config::SW_SLOT_0_NAME);
+    REQUIRE(create_file(config::SW_REPOSITORY, config::SW_SLOT_0_NAME, image.data(),
+            image.size()) == static_cast<int>(image.size()));
+}
+
+void appendBigEndian(std::vector<uint8_t>& buffer, uint32_t value, size_t size) {
+    for(size_t idx = size; idx > 0; idx--) {
+        buffer.push_back(value >> ((idx - 1) * 8));
+    }
+}
+
+/* Copies the first half of the source image and appends the given bytes */
+std::vector<uint8_t> createPatch(const std::vector<uint8_t>& source, uint32_t targetSize,
+        uint16_t targetCrc, const std::vector<uint8_t>& literal) {
+    std::vector<uint8_t> patch;
+    appendBigEndian(patch, image::patch::MAGIC, 4);
+    appendBigEndian(patch, source.size(), 4);
+    appendBigEndian(patch, CRC::crc16ccitt(source.data(), source.size()), 2);
+    appendBigEndian(patch, targetSize, 4);
+    appendBigEndian(patch, targetCrc, 2);
+    patch.push_back(image::patch::COPY);
+    appendBigEndian(patch, source.size() / 2, 4);
+    appendBigEndian(patch, 0, 4);
+    patch.push_back(image::patch::INSERT);
+    appendBigEndian(patch, literal.size(), 4);
+    patch.insert(patch.end(), literal.begin(), literal.end());
+    return patch;
+}
+
+bool fileExists(const char* fileName) {
+    return change_directory(config::SW_REPOSITORY, true) == F_NO_ERROR and
+            f_filelength(fileName) >= 0;
+}
+
+ReturnValue_t finishCopyOperation(ImageCopyingEngine& engine, Countdown& countdown) {
+    ReturnValue_t result = image::TASK_PERIOD_OVER_SOON;
+    for(uint16_t cycle = 0; cycle < 1000 and result == image::TASK_PERIOD_OVER_SOON; cycle++) {
+        countdown.resetTimer();
+        result = engine.continueCurrentOperation();
+    }
+    return result;
+}
+
+ReturnValue_t finishScrubbingOperation(ScrubbingEngine& engine, Countdown& countdown) {
+    ReturnValue_t result = image::TASK_PERIOD_OVER_SOON;
+    for(uint16_t cycle = 0; cycle < 1000 and result == image::TASK_PERIOD_OVER_SOON; cycle++) {
+        countdown.resetTimer();
+        result = engine.continueCurrentOperation();
+    }
+    return result;
+}
+
+}
+
+TEST_CASE("Image Copying Engine Test", "[image]") {
+    REQUIRE(hostsdcard::prepare() == F_NO_ERROR);
+    REQUIRE(FRAM_start() == 0);
+    REQUIRE(prepareNorFlash() == 0);
+    REQUIRE(create_directory("/", "BIN") == F_NO_ERROR);
+    REQUIRE(create_directory("BIN", "OBSW") == F_NO_ERROR);
+    std::vector<uint8_t> image = createImage();
+    writeSlot0Image(image);
+
+    image::ImageBuffer imgBuffer;
+    Countdown countdown(1000);
+    ImageCopyingEngine copyingEngine(nullptr, &countdown, &imgBuffer);
+    ScrubbingEngine scrubbingEngine(nullptr, &countdown, &imgBuffer, 1000);
+    const uint8_t* norImage = reinterpret_cast<const uint8_t*>(BINARY_BASE_ADDRESS_READ);
+
+    SECTION("Copy to the NOR-Flash") {
+        REQUIRE(copyingEngine.startSdcToFlashOperation(image::ImageSlot::SDC_SLOT_0) ==
+                (int) HasReturnvaluesIF::RETURN_OK);
+        REQUIRE(finishCopyOperation(copyingEngine, countdown) == (int) image::OPERATION_FINISHED);
+        CHECK(std::memcmp(norImage, image.data(), image.size()) == 0);
+        size_t binarySize = 0;
+        REQUIRE(fram_read_binary_size(FLASH_SLOT, &binarySize) == 0);
+        CHECK(binarySize == IMAGE_SIZE);
+        /* The engine accounts for all erase operations of the device */
+        ImageCopyingEngine::NorCopyTimings timings = copyingEngine.getNorCopyTimings();
+        HostFlashStatistics statistics;
+        host_flash_get_statistics(host_nor_flash_get_device(), &statistics);
+        CHECK(timings.sectorsErased == statistics.sectors_erased);
+        CHECK(statistics.program_violations == 0);
+    }
+
+    SECTION("Scrub the NOR-Flash") {
+        REQUIRE(copyingEngine.startSdcToFlashOperation(image::ImageSlot::SDC_SLOT_0) ==
+                (int) HasReturnvaluesIF::RETURN_OK);
+        REQUIRE(finishCopyOperation(copyingEngine, countdown) == (int) image::OPERATION_FINISHED);
+        REQUIRE(copyingEngine.startHammingCodeGenerationOperation(image::ImageSlot::FLASH) ==
+                (int) HasReturnvaluesIF::RETURN_OK);
+        REQUIRE(finishCopyOperation(copyingEngine, countdown) == (int) image::OPERATION_FINISHED);
+        size_t hammingCodeSize = 0;
+        bool hammingFlagSet = false;
+        REQUIRE(fram_read_ham_size(FLASH_SLOT, &hammingCodeSize, &hammingFlagSet) == 0);
+        CHECK(hammingFlagSet);
+        CHECK(hammingCodeSize == (IMAGE_SIZE + 255) / 256 * 3);
+
+        REQUIRE(scrubbingEngine.startScrubbingOperation(image::ImageSlot::FLASH) ==
+                (int) HasReturnvaluesIF::RETURN_OK);
+        REQUIRE(finishScrubbingOperation(scrubbingEngine, countdown) ==
+                (int) HasReturnvaluesIF::RETURN_OK);
+        ScrubbingEngine::ScrubbingStatus status = scrubbingEngine.getScrubbingStatus();
+        CHECK(status.finishedOperations == 1);
+        CHECK(status.lastFinishedSlot == image::ImageSlot::FLASH);
+        CHECK(status.correctedErrors == 0);
+        CHECK(status.uncorrectableErrors == 0);
+        CHECK(status.hammingCodeErrors == 0);
+
+        /* Programming can only clear bits, so the single bit error is detected but can not be
+        corrected in place */
+        size_t offset = (IMAGE_SIZE / 2) & ~static_cast<size_t>(0x01);
+        while(norImage[offset] == 0) {
+            offset += 2;
+        }
+        uint8_t word[2] = {norImage[offset], norImage[offset + 1]};
+        word[0] &= word[0] - 1;
+        REQUIRE(NORFLASH_WriteData(&NORFlash, BINARY_BASE_ADDRESS_WRITE + offset, word,
+                sizeof(word)) == 0);
+        REQUIRE(scrubbingEngine.startScrubbingOperation(image::ImageSlot::FLASH) ==
+                (int) HasReturnvaluesIF::RETURN_OK);
+        REQUIRE(finishScrubbingOperation(scrubbingEngine, countdown) ==
+                (int) HasReturnvaluesIF::RETURN_OK);
+        status = scrubbingEngine.getScrubbingStatus();
+        CHECK(status.finishedOperations == 2);
+        CHECK(status.correctedErrors == 0);
+        CHECK(status.uncorrectableErrors == 1);
+        CHECK(norImage[offset] == word[0]);
+    }
+
+    SECTION("Scrub an SD card image") {
+        REQUIRE(copyingEngine.startHammingCodeGenerationOperation(image::ImageSlot::SDC_SLOT_0) ==
+                (int) HasReturnvaluesIF::RETURN_OK);
+        REQUIRE(finishCopyOperation(copyingEngine, countdown) == (int) image::OPERATION_FINISHED);
+
+        std::vector<uint8_t> corruptedImage = image;
+        corruptedImage[IMAGE_SIZE - 10] ^= 0x20;
+        writeSlot0Image(corruptedImage);
+        REQUIRE(scrubbingEngine.startScrubbingOperation(image::ImageSlot::SDC_SLOT_0) ==
+                (int) HasReturnvaluesIF::RETURN_OK);
+        REQUIRE(finishScrubbingOperation(scrubbingEngine, countdown) ==
+                (int) HasReturnvaluesIF::RETURN_OK);
+        ScrubbingEngine::ScrubbingStatus status = scrubbingEngine.getScrubbingStatus();
+        CHECK(status.correctedErrors == 1);
+        CHECK(status.uncorrectableErrors == 0);
+
+        /* The corrected block was written back to the SD card */
+        REQUIRE(change_directory(config::SW_REPOSITORY, true) == F_NO_ERROR);
+        F_FILE* file = f_open(config::SW_SLOT_0_NAME, "r");
+        REQUIRE(file != nullptr);
+        std::vector<uint8_t> readBack(IMAGE_SIZE);
+        long bytesRead = f_read(readBack.data(), sizeof(uint8_t), readBack.size(), file);
+        f_close(file);
+        CHECK(bytesRead == static_cast<long>(IMAGE_SIZE));
+        CHECK(readBack == image);
+    }
+
+    SECTION("Apply a patch") {
+        const uint8_t oldImage[4] = {1, 2, 3, 4};
+        REQUIRE(create_file(config::SW_REPOSITORY, config::SW_SLOT_1_NAME, oldImage,
+                sizeof(oldImage)) == static_cast<int>(sizeof(oldImage)));
+        std::vector<uint8_t> literal(1000, 0x5a);
+        std::vector<uint8_t> target(image.begin(), image.begin() + IMAGE_SIZE / 2);
+        target.insert(target.end(), literal.begin(), literal.end());
+        std::vector<uint8_t> patch = createPatch(image, target.size(),
+                CRC::crc16ccitt(target.data(), target.size()), literal);
+        REQUIRE(create_file(config::SW_REPOSITORY, config::SW_PATCH_NAME, patch.data(),
+                patch.size()) == static_cast<int>(patch.size()));
+
+        REQUIRE(copyingEngine.startPatchOperation(image::ImageSlot::SDC_SLOT_0) ==
+                (int) HasReturnvaluesIF::RETURN_OK);
+        REQUIRE(finishCopyOperation(copyingEngine, countdown) == (int) image::OPERATION_FINISHED);
+        REQUIRE(change_directory(config::SW_REPOSITORY, true) == F_NO_ERROR);
+        CHECK(f_filelength(config::SW_SLOT_1_NAME) == static_cast<long>(target.size()));
+        /* The previous image is only kept until the rebuilt image replaced it */
+        CHECK(not fileExists(config::SW_PATCH_TARGET_NAME));
+        CHECK(not fileExists(config::SW_PATCH_BACKUP_NAME));
+    }
+
+    SECTION("Patch target exceeding the reserved image size") {
+        const uint8_t oldImage[4] = {1, 2, 3, 4};
+        REQUIRE(create_file(config::SW_REPOSITORY, config::SW_SLOT_1_NAME, oldImage,
+                sizeof(oldImage)) == static_cast<int>(sizeof(oldImage)));
+        std::vector<uint8_t> literal(1000, 0x5a);
+        std::vector<uint8_t> patch = createPatch(image, PRIMARY_IMAGE_RESERVED_SIZE + 1, 0,
+                literal);
+        REQUIRE(create_file(config::SW_REPOSITORY, config::SW_PATCH_NAME, patch.data(),
+                patch.size()) == static_cast<int>(patch.size()));
+
+        REQUIRE(copyingEngine.startPatchOperation(image::ImageSlot::SDC_SLOT_0) ==
+                (int) HasReturnvaluesIF::RETURN_OK);
+        CHECK(finishCopyOperation(copyingEngine, countdown) == (int) image::PATCH_INVALID);
+        /* Nothing was written */
+        CHECK(not fileExists(config::SW_PATCH_TARGET_NAME));
+        REQUIRE(change_directory(config::SW_REPOSITORY, true) == F_NO_ERROR);
+        CHECK(f_filelength(config::SW_SLOT_1_NAME) == static_cast<long>(sizeof(oldImage)));
+    }
+}
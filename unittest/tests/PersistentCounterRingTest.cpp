@@ -0,0 +1,103 @@
+#include "HostSdCard.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <bsp_sam9g20/memory/PersistentCounterRing.h>
+#include <bsp_sam9g20/common/fram/FRAMApi.h>
+#include <bsp_sam9g20/common/fram/VirtualFRAMApi.h>
+
+namespace {
+
+/* Sequence number, counters, reserved field and CRC */
+constexpr size_t RECORD_SIZE = 24;
+constexpr size_t NUMBER_OF_SLOTS = 10;
+constexpr uint32_t RING_ADDRESS = 0x40;
+constexpr size_t RING_SIZE = NUMBER_OF_SLOTS * RECORD_SIZE;
+
+void appendRecords(PersistentCounterRing& ring, uint32_t numberOfRecords) {
+    for(uint32_t idx = 1; idx <= numberOfRecords; idx++) {
+        PersistentCounterRing::Counters counters = {idx, 2 * idx, 3 * idx, 4 * idx};
+        REQUIRE(ring.append(counters) == (int) HasReturnvaluesIF::RETURN_OK);
+    }
+}
+
+/* Only the sequence number and the first counter of a new record reach the FRAM */
+void tearSlot(size_t slot, uint32_t sequenceNumber) {
+    uint32_t partialRecord[2] = {sequenceNumber, sequenceNumber};
+    REQUIRE(fram_write_counter_ring_range(RING_ADDRESS + slot * RECORD_SIZE,
+            reinterpret_cast<const uint8_t*>(partialRecord), sizeof(partialRecord)) == 0);
+}
+
+/* Write the image to the FRAM file and load it again, like after a reboot */
+void reloadFram() {
+    REQUIRE(virt_fram_flush() == 0);
+    REQUIRE(FRAM_start() == 0);
+}
+
+}
+
+TEST_CASE("Persistent Counter Ring Test", "[fram]") {
+    REQUIRE(hostsdcard::prepare() == F_NO_ERROR);
+    REQUIRE(FRAM_start() == 0);
+
+    PersistentCounterRing ring(RING_ADDRESS, RING_SIZE);
+    REQUIRE(ring.getNumberOfSlots() == NUMBER_OF_SLOTS);
+    /* A ring which was never written */
+    CHECK(ring.recover() == (int) HasReturnvaluesIF::RETURN_FAILED);
+    CHECK(ring.getSequenceNumber() == 0);
+
+    SECTION("Torn write after the newest record") {
+        appendRecords(ring, 4);
+        tearSlot(4, 5);
+        reloadFram();
+
+        PersistentCounterRing recoveredRing(RING_ADDRESS, RING_SIZE);
+        REQUIRE(recoveredRing.recover() == (int) HasReturnvaluesIF::RETURN_OK);
+        CHECK(recoveredRing.getSequenceNumber() == 4);
+        for(uint8_t idx = 0; idx < PersistentCounterRing::NUMBER_OF_COUNTERS; idx++) {
+            CHECK(recoveredRing.getCounter(idx) == 4 * (idx + 1));
+        }
+
+        /* The torn slot is written again by the next update */
+        PersistentCounterRing::Counters counters = {5, 10, 15, 20};
+        REQUIRE(recoveredRing.append(counters) == (int) HasReturnvaluesIF::RETURN_OK);
+        reloadFram();
+        PersistentCounterRing updatedRing(RING_ADDRESS, RING_SIZE);
+        REQUIRE(updatedRing.recover() == (int) HasReturnvaluesIF::RETURN_OK);
+        CHECK(updatedRing.getSequenceNumber() == 5);
+        CHECK(updatedRing.getCounters() == counters);
+    }
+
+    SECTION("Torn write of the first slot after wrapping around") {
+        appendRecords(ring, NUMBER_OF_SLOTS);
+        tearSlot(0, NUMBER_OF_SLOTS + 1);
+        reloadFram();
+
+        PersistentCounterRing recoveredRing(RING_ADDRESS, RING_SIZE);
+        REQUIRE(recoveredRing.recover() == (int) HasReturnvaluesIF::RETURN_OK);
+        CHECK(recoveredRing.getSequenceNumber() == NUMBER_OF_SLOTS);
+        CHECK(recoveredRing.getCounter(3) == 4 * NUMBER_OF_SLOTS);
+    }
+
+    SECTION("Torn write in the middle of the second round") {
+        appendRecords(ring, NUMBER_OF_SLOTS + 3);
+        tearSlot(3, NUMBER_OF_SLOTS + 4);
+        reloadFram();
+
+        PersistentCounterRing recoveredRing(RING_ADDRESS, RING_SIZE);
+        REQUIRE(recoveredRing.recover() == (int) HasReturnvaluesIF::RETURN_OK);
+        CHECK(recoveredRing.getSequenceNumber() == NUMBER_OF_SLOTS + 3);
+        CHECK(recoveredRing.getCounter(0) == NUMBER_OF_SLOTS + 3);
+    }
+
+    SECTION("Corrupted first slot in the second round") {
+        /* The last slot still holds an older record of the first round */
+        appendRecords(ring, NUMBER_OF_SLOTS + 3);
+        tearSlot(0, 0);
+        reloadFram();
+
+        PersistentCounterRing recoveredRing(RING_ADDRESS, RING_SIZE);
+        REQUIRE(recoveredRing.recover() == (int) HasReturnvaluesIF::RETURN_OK);
+        CHECK(recoveredRing.getSequenceNumber() == NUMBER_OF_SLOTS + 3);
+        CHECK(recoveredRing.getCounter(0) == NUMBER_OF_SLOTS + 3);
+    }
+}
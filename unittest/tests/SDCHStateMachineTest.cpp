@@ -0,0 +1,266 @@
+#include "HostSdCard.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <bsp_sam9g20/memory/SDCHStateMachine.h>
+#include <bsp_sam9g20/memory/SDCardHandler.h>
+#include <bsp_sam9g20/memory/sdcardHandlerDefinitions.h>
+#include <mission/memory/FileSystemMessage.h>
+#include <mission/utility/Crc32.h>
+
+#include <fsfw/globalfunctions/CRC.h>
+#include <fsfw/ipc/CommandMessage.h>
+#include <fsfw/ipc/QueueFactory.h>
+#include <fsfw/objectmanager/ObjectManager.h>
+#include <fsfw/serialize/SerializeAdapter.h>
+#include <fsfw/storagemanager/PoolManager.h>
+#include <fsfw/timemanager/Countdown.h>
+
+#include <cstring>
+#include <vector>
+
+namespace {
+
+/* Not registered in the test configuration, the handler is only used to send the replies */
+constexpr object_id_t TEST_SD_CARD_HANDLER = 0x4D0073AD;
+constexpr uint32_t CYCLE_TIME_MS = 20;
+constexpr uint32_t MAX_CYCLES = 1000;
+constexpr uint32_t WRITE_BYTES_PER_SECOND = 1000000;
+
+StorageManagerIF* getIpcStore() {
+    StorageManagerIF* ipcStore = ObjectManager::instance()->get<StorageManagerIF>(
+            objects::IPC_STORE);
+    if(ipcStore == nullptr) {
+        LocalPool::LocalPoolConfig poolConfig = {{10, 32}, {10, 64}, {10, 128}};
+        ipcStore = new PoolManager(objects::IPC_STORE, poolConfig);
+    }
+    return ipcStore;
+}
+
+std::vector<uint8_t> createTestFile(const char* repository, const char* name, size_t size) {
+    std::vector<uint8_t> content(size);
+    for(size_t idx = 0; idx < size; idx++) {
+        content[idx] = static_cast<uint8_t>(idx * 31 + idx / 256);
+    }
+    REQUIRE(create_file(repository, name, content.data(), size) ==
+            static_cast<int>(size));
+    return content;
+}
+
+void checkFileContent(const char* repository, const char* name, const uint8_t* expected,
+        size_t size) {
+    REQUIRE(change_directory(repository, true) == F_NO_ERROR);
+    REQUIRE(f_filelength(name) == static_cast<long>(size));
+    std::vector<uint8_t> content(size);
+    F_FILE* file = f_open(name, "r");
+    REQUIRE(file != nullptr);
+    long sizeRead = f_read(content.data(), sizeof(uint8_t), size, file);
+    f_close(file);
+    f_chdir("/");
+    REQUIRE(sizeRead == static_cast<long>(size));
+    CHECK(std::memcmp(content.data(), expected, size) == 0);
+}
+
+bool fileExists(const char* repository, const char* name) {
+    REQUIRE(change_directory(repository, true) == F_NO_ERROR);
+    bool exists = f_filelength(name) >= 0;
+    f_chdir("/");
+    return exists;
+}
+
+/* Drives the state machine like the handler task, one call per cycle */
+ReturnValue_t runToCompletion(SDCHStateMachine& stateMachine, Countdown& countdown) {
+    ReturnValue_t result = sdchandler::TASK_PERIOD_OVER_SOON;
+    for(uint32_t cycle = 0; cycle < MAX_CYCLES and result == sdchandler::TASK_PERIOD_OVER_SOON;
+            cycle++) {
+        countdown.resetTimer();
+        result = stateMachine.continueCurrentOperation();
+    }
+    return result;
+}
+
+void receiveCopyReply(MessageQueueIF* recipient, uint32_t expectedBytes,
+        uint32_t* bytesPerSecond) {
+    CommandMessage reply;
+    REQUIRE(recipient->receiveMessage(&reply) == (int) HasReturnvaluesIF::RETURN_OK);
+    REQUIRE(reply.getCommand() == (int) FileSystemMessage::COMPLETION_SUCCESS);
+    CHECK(FileSystemMessage::getCopiedBytes(&reply) == expectedBytes);
+    *bytesPerSecond = FileSystemMessage::getCopyThroughput(&reply);
+    CHECK(*bytesPerSecond > 0);
+}
+
+/* Returns the checksum of the checksum reply, which also contains the paths and the size */
+uint32_t receiveChecksumReply(MessageQueueIF* recipient, StorageManagerIF* ipcStore,
+        uint8_t expectedType, uint32_t expectedSize) {
+    CommandMessage reply;
+    REQUIRE(recipient->receiveMessage(&reply) == (int) HasReturnvaluesIF::RETURN_OK);
+    REQUIRE(reply.getCommand() == (int) FileSystemMessage::REPLY_CHECKSUM_FILE);
+    store_address_t storeId(reply.getParameter2());
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    REQUIRE(ipcStore->getData(storeId, &data, &size) == (int) HasReturnvaluesIF::RETURN_OK);
+
+    /* Skip the null terminated repository path and file name */
+    const char* repository = reinterpret_cast<const char*>(data);
+    CHECK(std::strcmp(repository, "SRC") == 0);
+    const char* fileName = repository + std::strlen(repository) + 1;
+    CHECK(std::strcmp(fileName, "DATA.BIN") == 0);
+    size_t namesSize = std::strlen(repository) + std::strlen(fileName) + 2;
+    REQUIRE(size == namesSize + 9);
+    data += namesSize;
+    size -= namesSize;
+
+    uint8_t checksumType = 0;
+    uint32_t checksum = 0;
+    uint32_t fileSize = 0;
+    SerializeAdapter::deSerialize(&checksumType, &data, &size, SerializeIF::Endianness::BIG);
+    SerializeAdapter::deSerialize(&checksum, &data, &size, SerializeIF::Endianness::BIG);
+    SerializeAdapter::deSerialize(&fileSize, &data, &size, SerializeIF::Endianness::BIG);
+    ipcStore->deleteData(storeId);
+    CHECK(checksumType == expectedType);
+    CHECK(fileSize == expectedSize);
+
+    REQUIRE(recipient->receiveMessage(&reply) == (int) HasReturnvaluesIF::RETURN_OK);
+    CHECK(reply.getCommand() == (int) FileSystemMessage::COMPLETION_SUCCESS);
+    return checksum;
+}
+
+}
+
+TEST_CASE("SD Card State Machine Test", "[sdcard]") {
+    StorageManagerIF* ipcStore = getIpcStore();
+    REQUIRE(ipcStore != nullptr);
+    REQUIRE(hostsdcard::prepare() == F_NO_ERROR);
+    REQUIRE(create_directory("/", "SRC") == F_NO_ERROR);
+    REQUIRE(create_directory("/", "DST") == F_NO_ERROR);
+
+    SDCardHandler handler(TEST_SD_CARD_HANDLER);
+    Countdown countdown(CYCLE_TIME_MS);
+    SDCHStateMachine stateMachine(&handler, &countdown);
+    MessageQueueIF* recipient = QueueFactory::instance()->createMessageQueue(5);
+
+    RepositoryPath sourceRepo = "SRC";
+    FileName sourceName = "DATA.BIN";
+    RepositoryPath targetRepo = "DST";
+
+    SECTION("Copy") {
+        /* Larger than the copy buffer, so the copy takes multiple steps */
+        size_t fileSize = 3 * SDCHStateMachine::COPY_BUFFER_SIZE + 100;
+        std::vector<uint8_t> content = createTestFile("SRC", "DATA.BIN", fileSize);
+        FileName targetName = "COPY.BIN";
+        REQUIRE(stateMachine.setCopyFileOperation(sourceRepo, sourceName, targetRepo,
+                targetName, recipient->getId()));
+        /* Only one operation at a time */
+        CHECK(not stateMachine.setCopyFileOperation(sourceRepo, sourceName, targetRepo,
+                targetName, recipient->getId()));
+        CHECK(runToCompletion(stateMachine, countdown) == sdchandler::OPERATION_FINISHED);
+        CHECK(stateMachine.getInternalState() == SDCHStateMachine::States::IDLE);
+
+        uint32_t bytesPerSecond = 0;
+        receiveCopyReply(recipient, fileSize, &bytesPerSecond);
+        checkFileContent("DST", "COPY.BIN", content.data(), fileSize);
+    }
+
+    SECTION("Copy throughput") {
+        /* The reported throughput has to reflect the write rate of the SD card */
+        HostFatConfig config = {};
+        config.write_bytes_per_second = WRITE_BYTES_PER_SECOND;
+        REQUIRE(hostsdcard::prepare(config) == F_NO_ERROR);
+        REQUIRE(create_directory("/", "SRC") == F_NO_ERROR);
+        REQUIRE(create_directory("/", "DST") == F_NO_ERROR);
+        size_t fileSize = 64 * 1024;
+        std::vector<uint8_t> content = createTestFile("SRC", "DATA.BIN", fileSize);
+        FileName targetName = "COPY.BIN";
+        REQUIRE(stateMachine.setCopyFileOperation(sourceRepo, sourceName, targetRepo,
+                targetName, recipient->getId()));
+        CHECK(runToCompletion(stateMachine, countdown) == sdchandler::OPERATION_FINISHED);
+
+        uint32_t bytesPerSecond = 0;
+        receiveCopyReply(recipient, fileSize, &bytesPerSecond);
+        CHECK(bytesPerSecond <= WRITE_BYTES_PER_SECOND + WRITE_BYTES_PER_SECOND / 10);
+        CHECK(bytesPerSecond >= WRITE_BYTES_PER_SECOND / 10);
+        checkFileContent("DST", "COPY.BIN", content.data(), fileSize);
+    }
+
+    SECTION("Split") {
+        size_t fileSize = 10000;
+        size_t partSize = 4096;
+        std::vector<uint8_t> content = createTestFile("SRC", "DATA.BIN", fileSize);
+        FileName partBaseName = "PART";
+        REQUIRE(stateMachine.setSplitFileOperation(sourceRepo, sourceName, targetRepo,
+                partBaseName, partSize, recipient->getId()));
+        CHECK(runToCompletion(stateMachine, countdown) == sdchandler::OPERATION_FINISHED);
+
+        uint32_t bytesPerSecond = 0;
+        receiveCopyReply(recipient, fileSize, &bytesPerSecond);
+        checkFileContent("DST", "PART.000", content.data(), partSize);
+        checkFileContent("DST", "PART.001", content.data() + partSize, partSize);
+        checkFileContent("DST", "PART.002", content.data() + 2 * partSize,
+                fileSize - 2 * partSize);
+        CHECK(not fileExists("DST", "PART.003"));
+
+        /* The part index extension does not fit behind a base name with 9 characters */
+        FileName longBaseName = "LONGNAME1";
+        CHECK(not stateMachine.setSplitFileOperation(sourceRepo, sourceName, targetRepo,
+                longBaseName, partSize, recipient->getId()));
+    }
+
+    SECTION("Split with the maximum number of parts") {
+        size_t partSize = 4;
+        size_t fileSize = SDCHStateMachine::MAX_NUMBER_OF_PARTS * partSize;
+        std::vector<uint8_t> content = createTestFile("SRC", "DATA.BIN", fileSize);
+        FileName partBaseName = "PART";
+        REQUIRE(stateMachine.setSplitFileOperation(sourceRepo, sourceName, targetRepo,
+                partBaseName, partSize, recipient->getId()));
+        CHECK(runToCompletion(stateMachine, countdown) == sdchandler::OPERATION_FINISHED);
+        uint32_t bytesPerSecond = 0;
+        receiveCopyReply(recipient, fileSize, &bytesPerSecond);
+        checkFileContent("DST", "PART.999", content.data() + fileSize - partSize, partSize);
+
+        /* One more byte would require another part */
+        REQUIRE(delete_file("SRC", "DATA.BIN") == F_NO_ERROR);
+        createTestFile("SRC", "DATA.BIN", fileSize + 1);
+        REQUIRE(stateMachine.setSplitFileOperation(sourceRepo, sourceName, targetRepo,
+                partBaseName, partSize, recipient->getId()));
+        CHECK(runToCompletion(stateMachine, countdown) ==
+                (int) HasReturnvaluesIF::RETURN_FAILED);
+        CommandMessage reply;
+        REQUIRE(recipient->receiveMessage(&reply) == (int) HasReturnvaluesIF::RETURN_OK);
+        CHECK(reply.getCommand() == (int) FileSystemMessage::COMPLETION_FAILED);
+        stateMachine.resetAndSetToIdle();
+    }
+
+    SECTION("Checksum") {
+        size_t fileSize = 2 * SDCHStateMachine::COPY_BUFFER_SIZE + 1234;
+        std::vector<uint8_t> content = createTestFile("SRC", "DATA.BIN", fileSize);
+
+        REQUIRE(stateMachine.setChecksumOperation(sourceRepo, sourceName, sdchandler::CRC32,
+                recipient->getId()));
+        CHECK(runToCompletion(stateMachine, countdown) == sdchandler::OPERATION_FINISHED);
+        CHECK(receiveChecksumReply(recipient, ipcStore, sdchandler::CRC32, fileSize) ==
+                Crc32::calculate(content.data(), fileSize));
+
+        REQUIRE(stateMachine.setChecksumOperation(sourceRepo, sourceName,
+                sdchandler::CRC16_CCITT, recipient->getId()));
+        CHECK(runToCompletion(stateMachine, countdown) == sdchandler::OPERATION_FINISHED);
+        CHECK(receiveChecksumReply(recipient, ipcStore, sdchandler::CRC16_CCITT, fileSize) ==
+                CRC::crc16ccitt(content.data(), fileSize));
+
+        /* Unknown checksum type */
+        CHECK(not stateMachine.setChecksumOperation(sourceRepo, sourceName, 2,
+                recipient->getId()));
+    }
+
+    SECTION("Missing source file") {
+        FileName targetName = "COPY.BIN";
+        REQUIRE(stateMachine.setCopyFileOperation(sourceRepo, sourceName, targetRepo,
+                targetName, recipient->getId()));
+        CHECK(runToCompletion(stateMachine, countdown) ==
+                (int) HasReturnvaluesIF::RETURN_FAILED);
+        CommandMessage reply;
+        REQUIRE(recipient->receiveMessage(&reply) == (int) HasReturnvaluesIF::RETURN_OK);
+        CHECK(reply.getCommand() == (int) FileSystemMessage::COMPLETION_FAILED);
+        stateMachine.resetAndSetToIdle();
+    }
+
+    QueueFactory::instance()->deleteMessageQueue(recipient);
+}
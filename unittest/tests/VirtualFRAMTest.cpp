@@ -0,0 +1,89 @@
+#include "HostSdCard.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <bsp_sam9g20/common/fram/FRAMApi.h>
+#include <bsp_sam9g20/common/fram/VirtualFRAMApi.h>
+
+#include <array>
+#include <cstring>
+
+TEST_CASE("Virtual FRAM Hamming Code Test", "[fram]") {
+    REQUIRE(hostsdcard::prepare() == F_NO_ERROR);
+    REQUIRE(create_directory(nullptr, VIRT_FRAM_PATH) == F_NO_ERROR);
+    REQUIRE(FRAM_start() == 0);
+
+    std::array<uint8_t, 100> code;
+    for(size_t idx = 0; idx < code.size(); idx++) {
+        code[idx] = idx + 1;
+    }
+
+    /* The code is written in parts like by the on-board generation, the offset is the position
+    inside the stored code */
+    REQUIRE(fram_write_ham_code(SDC_0_SL_1, code.data(), 0, 40) == 0);
+    REQUIRE(fram_write_ham_code(SDC_0_SL_1, code.data() + 40, 40, 30) == 0);
+    REQUIRE(fram_write_ham_code(SDC_0_SL_1, code.data() + 70, 70, 30) == 0);
+    REQUIRE(fram_write_ham_size(SDC_0_SL_1, code.size()) == 0);
+    REQUIRE(fram_set_img_ham_flag(SDC_0_SL_1) == 0);
+
+    size_t hammingSize = 0;
+    bool flagSet = false;
+    REQUIRE(fram_read_ham_size(SDC_0_SL_1, &hammingSize, &flagSet) == 0);
+    CHECK(hammingSize == code.size());
+    CHECK(flagSet);
+
+    SECTION("Whole code") {
+        std::array<uint8_t, 128> readBuffer = {};
+        size_t sizeRead = 0;
+        REQUIRE(fram_read_ham_code(SDC_0_SL_1, readBuffer.data(), readBuffer.size(), 0, 0,
+                &sizeRead) == 0);
+        REQUIRE(sizeRead == code.size());
+        CHECK(std::memcmp(readBuffer.data(), code.data(), code.size()) == 0);
+    }
+
+    SECTION("Part of the code") {
+        /* The part is written to the start of the buffer, which only needs to hold the part */
+        std::array<uint8_t, 30> readBuffer = {};
+        size_t sizeRead = 0;
+        REQUIRE(fram_read_ham_code(SDC_0_SL_1, readBuffer.data(), readBuffer.size(), 40,
+                readBuffer.size(), &sizeRead) == 0);
+        REQUIRE(sizeRead == readBuffer.size());
+        CHECK(std::memcmp(readBuffer.data(), code.data() + 40, readBuffer.size()) == 0);
+    }
+
+    SECTION("Other slots") {
+        bool otherFlagSet = true;
+        REQUIRE(fram_get_img_ham_flag(SDC_0_SL_0, &otherFlagSet) == 0);
+        CHECK(not otherFlagSet);
+        REQUIRE(fram_clear_img_ham_flag(SDC_0_SL_1) == 0);
+        REQUIRE(fram_get_img_ham_flag(SDC_0_SL_1, &flagSet) == 0);
+        CHECK(not flagSet);
+    }
+
+    SECTION("Large code") {
+        /* Large writes bypass the journal and are written to the FRAM file directly */
+        std::array<uint8_t, 4000> largeCode;
+        for(size_t idx = 0; idx < largeCode.size(); idx++) {
+            largeCode[idx] = idx * 7;
+        }
+        REQUIRE(fram_clear_img_ham_flag(SDC_1_SL_0) == 0);
+        REQUIRE(fram_write_ham_code(SDC_1_SL_0, largeCode.data(), 0, largeCode.size()) == 0);
+        CHECK(virt_fram_get_journal_fill() == 0);
+
+        /* Reload the FRAM file */
+        REQUIRE(FRAM_start() == 0);
+        bool largeFlagSet = true;
+        REQUIRE(fram_get_img_ham_flag(SDC_1_SL_0, &largeFlagSet) == 0);
+        CHECK(not largeFlagSet);
+        std::array<uint8_t, 4000> readBuffer = {};
+        size_t sizeRead = 0;
+        REQUIRE(fram_read_ham_code(SDC_1_SL_0, readBuffer.data(), readBuffer.size(), 0,
+                readBuffer.size(), &sizeRead) == 0);
+        REQUIRE(sizeRead == readBuffer.size());
+        CHECK(std::memcmp(readBuffer.data(), largeCode.data(), largeCode.size()) == 0);
+    }
+
+    SECTION("Reserved size") {
+        CHECK(fram_write_ham_code(SDC_0_SL_1, code.data(), IMAGES_HAMMING_RESERVED_SIZE - 10,
+                20) != 0);
+    }
+}